@@ -13,13 +13,17 @@
 #include <stdbool.h>
 #include <js_thread.h>
 #include <toolbox/path.h>
+#include <toolbox/crc32_calc.h>
 #include "js_app_i.h"
 #include "js_modules.h"
+#include "playlist.h"
+#include "views/playlist_view.h"
 
 #define TAG "FastJS"
 
 // Define custom event IDs
 #define VIEW_EVENT_ADD_SCRIPT 1
+#define VIEW_EVENT_SCRIPT_FINISHED 2
 
 // Define the submenu items for our FastJS application
 typedef enum
@@ -39,41 +43,29 @@ typedef enum
     FastJSViewConsole,   // Console output view
 } FastJSView;
 
-// Define a structure to hold settings, including the playlist
-#define MAX_PLAYLIST_SIZE 10
+// Longest script path that is stored
 #define MAX_SCRIPT_PATH_LENGTH 256
 
-typedef struct
-{
-    char script_path[MAX_SCRIPT_PATH_LENGTH];
-    size_t playlist_count;
-    char playlist[MAX_PLAYLIST_SIZE][MAX_SCRIPT_PATH_LENGTH];
-} SettingsData;
-
 // Forward declaration of FastJSApp for use in callbacks
 typedef struct FastJSApp FastJSApp;
 
-// Define the ScriptPlaylist structure
-typedef struct
-{
-    char scripts[MAX_PLAYLIST_SIZE][MAX_SCRIPT_PATH_LENGTH];
-    size_t count;
-} ScriptPlaylist;
-
 // Define the application structure
 struct FastJSApp
 {
     ViewDispatcher *view_dispatcher; // Switches between our views
     Submenu *submenu;                // The application submenu
     Widget *widget_about;            // The about screen
-    Submenu *config_view;            // The configuration screen (now a submenu)
+    JsPlaylistView *config_view;     // The configuration screen (lists the playlist)
     JsConsoleView *console_view;     // Console output view
+    JsConsolePipe *console_pipe;     // Queues script output for the console view
 
     char *selected_javascript_file; // Store the selected script file path
     char *temp_buffer;              // Temporary buffer
     uint32_t temp_buffer_size;      // Size of the temporary buffer
 
-    ScriptPlaylist playlist; // Script playlist
+    Playlist *playlist;  // Script playlist
+    size_t run_index;    // Playlist entry that's running
+    uint32_t run_start;  // Tick at which it started
 
     JsThread *js_thread; // JavaScript execution thread
     Gui *gui;            // GUI reference
@@ -82,178 +74,316 @@ struct FastJSApp
 // Path to save the settings
 #define REMEMBERED_SCRIPT_PATH STORAGE_EXT_PATH_PREFIX "/apps_data/fast_js_app/settings.bin"
 
-// Function to save settings, including the playlist
-static void save_settings(const char *script_path, const ScriptPlaylist *playlist)
+// Path of the console log, rotated to console.log.1 when full
+#define CONSOLE_LOG_PATH STORAGE_EXT_PATH_PREFIX "/apps_data/fast_js_app/console.log"
+
+// Period of moving queued output onto the console, about the frame rate
+#define CONSOLE_DRAIN_PERIOD_MS 33
+
+// Temporary file that settings are written to before replacing the old ones
+#define REMEMBERED_SCRIPT_TMP_PATH REMEMBERED_SCRIPT_PATH ".tmp"
+
+// Settings file header, followed by `payload_size` bytes of fields
+#define SETTINGS_MAGIC 0x53534A46 // "FJSS"
+#define SETTINGS_VERSION 3        // Version 1 had no header and native size_t fields
+
+typedef struct __attribute__((packed))
 {
-    // Create the directory for saving settings
-    char directory_path[256];
-    snprintf(directory_path, sizeof(directory_path), STORAGE_EXT_PATH_PREFIX "/apps_data/fast_js_app");
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t payload_size;
+    uint32_t payload_crc; // CRC32 of the payload
+} SettingsHeader;
+
+// Fixed-size fields of a playlist entry in version 3 settings
+typedef struct __attribute__((packed))
+{
+    uint16_t run_count;
+    uint32_t last_duration_ms;
+    uint32_t stack_size;
+    uint32_t heap_size;
+    uint8_t flags;
+} SettingsEntryMeta;
+
+#define SETTINGS_FLAG_PROFILE (1 << 0)
+#define SETTINGS_FLAG_HEAP_SNAPSHOT (1 << 1)
+#define SETTINGS_FLAG_LATENCY (1 << 2)
+
+// Appends a string with a 16-bit length to the settings buffer
+static uint8_t *settings_put_string(uint8_t *at, const char *str)
+{
+    uint16_t length = strlen(str);
+    memcpy(at, &length, sizeof(length));
+    memcpy(at + sizeof(length), str, length);
+    return at + sizeof(length) + length;
+}
 
-    // Create the directory
-    Storage *storage = furi_record_open(RECORD_STORAGE);
-    storage_common_mkdir(storage, directory_path);
+// Reads a string with a 16-bit length from the settings buffer into `out`
+static bool settings_get_string(const uint8_t **at, const uint8_t *end, char *out, size_t out_size)
+{
+    uint16_t length;
+    if (end - *at < (ptrdiff_t)sizeof(length))
+        return false;
+    memcpy(&length, *at, sizeof(length));
+    *at += sizeof(length);
+    if (end - *at < length || length >= out_size)
+        return false;
+    memcpy(out, *at, length);
+    out[length] = '\0';
+    *at += length;
+    return true;
+}
 
-    // Open the settings file
-    File *file = storage_file_alloc(storage);
-    if (!storage_file_open(file, REMEMBERED_SCRIPT_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+// Function to save settings, including the playlist
+static void save_settings(const char *script_path, Playlist *playlist)
+{
+    // Serialize everything into one buffer
+    size_t count = playlist_count(playlist);
+    size_t payload_size = sizeof(uint16_t) + strlen(script_path) + sizeof(uint16_t);
+    for (size_t i = 0; i < count; ++i)
     {
-        FURI_LOG_E(TAG, "Failed to open settings file for writing: %s", REMEMBERED_SCRIPT_PATH);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        return;
+        payload_size += sizeof(uint16_t) + strlen(playlist_get_path(playlist, i)) +
+                        sizeof(uint16_t) + strlen(playlist_get_group(playlist, i)) +
+                        sizeof(SettingsEntryMeta);
     }
 
-    // Write the length of script_path
-    size_t script_path_length = strlen(script_path) + 1; // Include null terminator
-    if (storage_file_write(file, &script_path_length, sizeof(size_t)) != sizeof(size_t))
+    uint8_t *buffer = malloc(sizeof(SettingsHeader) + payload_size);
+    uint8_t *payload = buffer + sizeof(SettingsHeader);
+    uint8_t *at = settings_put_string(payload, script_path);
+    uint16_t count_field = count;
+    memcpy(at, &count_field, sizeof(count_field));
+    at += sizeof(count_field);
+    for (size_t i = 0; i < count; ++i)
     {
-        FURI_LOG_E(TAG, "Failed to write script_path_length");
+        at = settings_put_string(at, playlist_get_path(playlist, i));
+        at = settings_put_string(at, playlist_get_group(playlist, i));
+        const PlaylistMeta *meta = playlist_get_meta(playlist, i);
+        SettingsEntryMeta entry_meta = {
+            .run_count = meta->run_count,
+            .last_duration_ms = meta->last_duration_ms,
+            .stack_size = meta->hints.stack_size,
+            .heap_size = meta->hints.heap_size,
+            .flags = (meta->hints.profile ? SETTINGS_FLAG_PROFILE : 0) |
+                     (meta->hints.heap_snapshot ? SETTINGS_FLAG_HEAP_SNAPSHOT : 0) |
+                     (meta->hints.latency ? SETTINGS_FLAG_LATENCY : 0),
+        };
+        memcpy(at, &entry_meta, sizeof(entry_meta));
+        at += sizeof(entry_meta);
     }
 
-    // Write the script_path
-    if (storage_file_write(file, script_path, script_path_length) != script_path_length)
-    {
-        FURI_LOG_E(TAG, "Failed to write script_path");
-    }
+    SettingsHeader header = {
+        .magic = SETTINGS_MAGIC,
+        .version = SETTINGS_VERSION,
+        .reserved = 0,
+        .payload_size = payload_size,
+        .payload_crc = crc32_calc_buffer(0, payload, payload_size),
+    };
+    memcpy(buffer, &header, sizeof(header));
 
-    // Write the playlist count
-    if (storage_file_write(file, &playlist->count, sizeof(size_t)) != sizeof(size_t))
+    // Write a temporary file in one go, then swap it in
+    Storage *storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, STORAGE_EXT_PATH_PREFIX "/apps_data/fast_js_app");
+    File *file = storage_file_alloc(storage);
+    size_t size = sizeof(SettingsHeader) + payload_size;
+    bool written = storage_file_open(file, REMEMBERED_SCRIPT_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, buffer, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    free(buffer);
+
+    if (!written)
     {
-        FURI_LOG_E(TAG, "Failed to write playlist count");
+        FURI_LOG_E(TAG, "Failed to write settings file: %s", REMEMBERED_SCRIPT_TMP_PATH);
+        storage_common_remove(storage, REMEMBERED_SCRIPT_TMP_PATH);
     }
-
-    // Write each playlist script with its length
-    for (size_t i = 0; i < playlist->count; ++i)
+    else
     {
-        size_t script_length = strlen(playlist->scripts[i]) + 1; // Include null terminator
-        if (storage_file_write(file, &script_length, sizeof(size_t)) != sizeof(size_t))
+        // The rename replaces the old file in one step, so there's always a complete
+        // settings file under one of the two names
+        if (storage_common_rename(storage, REMEMBERED_SCRIPT_TMP_PATH, REMEMBERED_SCRIPT_PATH) != FSE_OK)
         {
-            FURI_LOG_E(TAG, "Failed to write script length for script %zu", i);
+            FURI_LOG_E(TAG, "Failed to replace settings file: %s", REMEMBERED_SCRIPT_PATH);
         }
-        if (storage_file_write(file, playlist->scripts[i], script_length) != script_length)
+        else
         {
-            FURI_LOG_E(TAG, "Failed to write playlist script %zu", i);
+            FURI_LOG_I(TAG, "Settings saved: script_path=%s, playlist_count=%zu", script_path, count);
         }
     }
 
-    FURI_LOG_I(TAG, "Settings saved: script_path=%s, playlist_count=%zu", script_path, playlist->count);
-
-    storage_file_close(file);
-    storage_file_free(file);
     furi_record_close(RECORD_STORAGE);
 }
 
-// Function to load settings, including the playlist
-static bool load_settings(char *buffer, size_t buffer_size, ScriptPlaylist *playlist)
+// Parses version 2 and 3 settings, after the header has been checked. Version 2
+// only had paths.
+static bool parse_settings(const uint8_t *at, const uint8_t *end, uint16_t version, char *buffer, size_t buffer_size, Playlist *playlist)
 {
-    Storage *storage = furi_record_open(RECORD_STORAGE);
-    File *file = storage_file_alloc(storage);
+    uint16_t count;
+    if (!settings_get_string(&at, end, buffer, buffer_size) || end - at < (ptrdiff_t)sizeof(count))
+        return false;
+    memcpy(&count, at, sizeof(count));
+    at += sizeof(count);
 
-    if (!storage_file_open(file, REMEMBERED_SCRIPT_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+    char path[MAX_SCRIPT_PATH_LENGTH];
+    char group[MAX_SCRIPT_PATH_LENGTH];
+    for (size_t i = 0; i < count; ++i)
     {
-        FURI_LOG_E(TAG, "Failed to open settings file for reading: %s", REMEMBERED_SCRIPT_PATH);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        return false; // Return false if the file does not exist
+        if (!settings_get_string(&at, end, path, sizeof(path)))
+            return false;
+        if (version < 3)
+        {
+            playlist_add(playlist, path, NULL);
+            continue;
+        }
+
+        SettingsEntryMeta entry_meta;
+        if (!settings_get_string(&at, end, group, sizeof(group)) || end - at < (ptrdiff_t)sizeof(entry_meta))
+            return false;
+        memcpy(&entry_meta, at, sizeof(entry_meta));
+        at += sizeof(entry_meta);
+
+        int32_t index = playlist_add(playlist, path, group);
+        if (index < 0)
+            continue;
+        PlaylistMeta *meta = playlist_get_meta(playlist, index);
+        meta->run_count = entry_meta.run_count;
+        meta->last_duration_ms = entry_meta.last_duration_ms;
+        meta->hints.stack_size = entry_meta.stack_size;
+        meta->hints.heap_size = entry_meta.heap_size;
+        meta->hints.profile = entry_meta.flags & SETTINGS_FLAG_PROFILE;
+        meta->hints.heap_snapshot = entry_meta.flags & SETTINGS_FLAG_HEAP_SNAPSHOT;
+        meta->hints.latency = entry_meta.flags & SETTINGS_FLAG_LATENCY;
     }
+    return true;
+}
 
-    // Read the length of script_path
-    size_t script_path_length;
-    if (storage_file_read(file, &script_path_length, sizeof(size_t)) != sizeof(size_t))
-    {
-        FURI_LOG_E(TAG, "Failed to read script_path_length");
-        storage_file_close(file);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
+// Parses version 1 settings: size_t lengths of NUL-terminated strings and a size_t count
+static bool parse_settings_v1(const uint8_t *at, const uint8_t *end, char *buffer, size_t buffer_size, Playlist *playlist)
+{
+    size_t length, count;
+    if (end - at < (ptrdiff_t)sizeof(length))
         return false;
-    }
+    memcpy(&length, at, sizeof(length));
+    at += sizeof(length);
+    if (length == 0 || length > buffer_size || (size_t)(end - at) < length)
+        return false;
+    memcpy(buffer, at, length);
+    buffer[length - 1] = '\0';
+    at += length;
 
-    // Check if script_path_length fits in buffer_size
-    if (script_path_length > buffer_size)
-    {
-        FURI_LOG_E(TAG, "script_path_length exceeds buffer size");
-        storage_file_close(file);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
+    if (end - at < (ptrdiff_t)sizeof(count))
         return false;
-    }
+    memcpy(&count, at, sizeof(count));
+    at += sizeof(count);
 
-    // Read the script_path
-    if (storage_file_read(file, buffer, script_path_length) != script_path_length)
+    char path[MAX_SCRIPT_PATH_LENGTH];
+    for (size_t i = 0; i < count; ++i)
     {
-        FURI_LOG_E(TAG, "Failed to read script_path");
-        storage_file_close(file);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        return false;
+        if (end - at < (ptrdiff_t)sizeof(length))
+            return false;
+        memcpy(&length, at, sizeof(length));
+        at += sizeof(length);
+        if (length == 0 || length > sizeof(path) || (size_t)(end - at) < length)
+            return false;
+        memcpy(path, at, length);
+        path[length - 1] = '\0';
+        at += length;
+        playlist_add(playlist, path, NULL);
     }
+    return true;
+}
 
-    // Ensure null-termination
-    buffer[script_path_length - 1] = '\0';
+// Reads a whole file in one call, the caller frees the returned buffer
+static uint8_t *read_settings_file(Storage *storage, const char *path, size_t *size)
+{
+    File *file = storage_file_alloc(storage);
+    uint8_t *buffer = NULL;
+    if (storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING))
+    {
+        *size = storage_file_size(file);
+        buffer = malloc(MAX(*size, (size_t)1));
+        if (storage_file_read(file, buffer, *size) != *size)
+        {
+            free(buffer);
+            buffer = NULL;
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    return buffer;
+}
 
-    // Read the playlist count
-    if (storage_file_read(file, &playlist->count, sizeof(size_t)) != sizeof(size_t))
+// Function to load settings, including the playlist
+static bool load_settings(char *buffer, size_t buffer_size, Playlist *playlist)
+{
+    Storage *storage = furi_record_open(RECORD_STORAGE);
+    size_t size = 0;
+    uint8_t *data = read_settings_file(storage, REMEMBERED_SCRIPT_PATH, &size);
+    if (!data)
     {
-        FURI_LOG_E(TAG, "Failed to read playlist count");
-        storage_file_close(file);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        return false;
+        // Saving may have been cut off before the rename
+        data = read_settings_file(storage, REMEMBERED_SCRIPT_TMP_PATH, &size);
     }
+    furi_record_close(RECORD_STORAGE);
 
-    // Ensure the playlist count does not exceed maximum
-    if (playlist->count > MAX_PLAYLIST_SIZE)
+    if (!data)
     {
-        FURI_LOG_E(TAG, "Playlist count exceeds maximum allowed. Truncating to %d.", MAX_PLAYLIST_SIZE);
-        playlist->count = MAX_PLAYLIST_SIZE;
+        FURI_LOG_E(TAG, "Failed to open settings file for reading: %s", REMEMBERED_SCRIPT_PATH);
+        return false; // Return false if the file does not exist
     }
 
-    // Read each playlist script with its length
-    for (size_t i = 0; i < playlist->count; ++i)
+    SettingsHeader header;
+    bool loaded = false;
+    bool migrate = false;
+    if (size >= sizeof(header))
     {
-        size_t script_length;
-        if (storage_file_read(file, &script_length, sizeof(size_t)) != sizeof(size_t))
+        memcpy(&header, data, sizeof(header));
+    }
+    if (size >= sizeof(header) && header.magic == SETTINGS_MAGIC)
+    {
+        const uint8_t *payload = data + sizeof(header);
+        if (header.version < 2 || header.version > SETTINGS_VERSION)
         {
-            FURI_LOG_E(TAG, "Failed to read script length for script %zu", i);
-            storage_file_close(file);
-            storage_file_free(file);
-            furi_record_close(RECORD_STORAGE);
-            return false;
+            FURI_LOG_E(TAG, "Unknown settings version %u", header.version);
         }
-
-        if (script_length > MAX_SCRIPT_PATH_LENGTH)
+        else if (header.payload_size != size - sizeof(header) ||
+                 crc32_calc_buffer(0, payload, header.payload_size) != header.payload_crc)
         {
-            FURI_LOG_E(TAG, "Script length exceeds maximum allowed for script %zu", i);
-            storage_file_close(file);
-            storage_file_free(file);
-            furi_record_close(RECORD_STORAGE);
-            return false;
+            FURI_LOG_E(TAG, "Settings file is corrupted");
         }
-
-        if (storage_file_read(file, playlist->scripts[i], script_length) != script_length)
+        else
         {
-            FURI_LOG_E(TAG, "Failed to read playlist script %zu", i);
-            storage_file_close(file);
-            storage_file_free(file);
-            furi_record_close(RECORD_STORAGE);
-            return false;
+            loaded = parse_settings(payload, payload + header.payload_size, header.version, buffer, buffer_size, playlist);
+            migrate = header.version != SETTINGS_VERSION;
         }
+    }
+    else
+    {
+        loaded = migrate = parse_settings_v1(data, data + size, buffer, buffer_size, playlist);
+    }
+    free(data);
 
-        // Ensure null-termination
-        playlist->scripts[i][script_length - 1] = '\0';
+    if (!loaded)
+    {
+        FURI_LOG_E(TAG, "Failed to parse settings");
+        playlist_reset(playlist);
+        buffer[0] = '\0';
+        return false;
     }
 
-    FURI_LOG_I(TAG, "Settings loaded: script_path=%s, playlist_count=%zu", buffer, playlist->count);
+    FURI_LOG_I(TAG, "Settings loaded: script_path=%s, playlist_count=%zu", buffer, playlist_count(playlist));
 
     // Log all loaded scripts for verification
-    for (size_t i = 0; i < playlist->count; ++i)
+    for (size_t i = 0; i < playlist_count(playlist); ++i)
     {
-        FURI_LOG_I(TAG, "Loaded script[%zu]: %s", i, playlist->scripts[i]);
+        FURI_LOG_I(TAG, "Loaded script[%zu]: %s", i, playlist_get_path(playlist, i));
     }
 
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
+    if (migrate)
+    {
+        FURI_LOG_I(TAG, "Migrating settings to version %d", SETTINGS_VERSION);
+        save_settings(buffer, playlist);
+    }
     return true;
 }
 
@@ -286,16 +416,22 @@ static void js_callback(JsThreadEvent event, const char *msg, void *context)
     if (event == JsThreadEventDone)
     {
         FURI_LOG_I(TAG, "Script done");
-        console_view_print(app->console_view, "--- DONE ---");
+        console_pipe_print(app->console_pipe, "--- DONE ---");
+        view_dispatcher_send_custom_event(app->view_dispatcher, VIEW_EVENT_SCRIPT_FINISHED);
     }
     else if (event == JsThreadEventPrint)
     {
-        console_view_print(app->console_view, msg);
+        console_pipe_print(app->console_pipe, msg);
     }
     else if (event == JsThreadEventError)
     {
-        console_view_print(app->console_view, "--- ERROR ---");
-        console_view_print(app->console_view, msg);
+        console_pipe_print(app->console_pipe, "--- ERROR ---");
+        console_pipe_print(app->console_pipe, msg);
+        view_dispatcher_send_custom_event(app->view_dispatcher, VIEW_EVENT_SCRIPT_FINISHED);
+    }
+    else if (event == JsThreadEventUsage)
+    {
+        console_pipe_print(app->console_pipe, msg);
     }
     else if (event == JsThreadEventErrorTrace)
     {
@@ -321,77 +457,112 @@ static void js_callback(JsThreadEvent event, const char *msg, void *context)
 
         furi_string_free(file_name);
 
-        console_view_print(app->console_view, furi_string_get_cstr(compact_trace));
+        console_pipe_print(app->console_pipe, furi_string_get_cstr(compact_trace));
         furi_string_free(compact_trace);
-        console_view_print(app->console_view, "See logs for full trace");
+        console_pipe_print(app->console_pipe, "See logs for full trace");
     }
 }
 
+// Tick callback that moves queued script output onto the console
+static void fast_js_tick_callback(void *context)
+{
+    FastJSApp *app = (FastJSApp *)context;
+    console_pipe_drain(app->console_pipe);
+}
+
 // Navigation callback for the Console view to go back to the submenu
 static uint32_t fast_js_navigation_console_callback(void *context)
 {
     FastJSApp *app = (FastJSApp *)context;
-    // Stop the JS thread if it's still running
+    // Stop the JS thread if it's still running, along with the rest of the playlist
     if (app->js_thread)
     {
         js_thread_stop(app->js_thread);
         app->js_thread = NULL;
+        save_settings(app->selected_javascript_file, app->playlist);
     }
+    console_pipe_flush(app->console_pipe);
     return FastJSViewSubmenu;
 }
 
 // Callback function for configuration item selection
-static void playlist_item_callback(void *context, uint32_t index)
+static void playlist_item_callback(JsPlaylistViewEvent event, size_t index, void *context)
 {
     FastJSApp *app = (FastJSApp *)context;
-    if (index < app->playlist.count)
+    if (event == JsPlaylistViewEventSelected)
     {
         // Remove the script from the playlist
-        for (size_t i = index; i < app->playlist.count - 1; ++i)
-        {
-            strcpy(app->playlist.scripts[i], app->playlist.scripts[i + 1]);
-        }
-        app->playlist.count--;
-
-        // Update the config view
-        submenu_reset(app->config_view);
-
-        // Re-add the playlist items
-        for (size_t i = 0; i < app->playlist.count; ++i)
-        {
-            submenu_add_item(
-                app->config_view,
-                app->playlist.scripts[i],
-                i,
-                playlist_item_callback,
-                app);
-        }
-
-        // Re-add the "Add Script" option
-        submenu_add_item(
-            app->config_view,
-            "Add Script",
-            MAX_PLAYLIST_SIZE,
-            playlist_item_callback,
-            app);
+        playlist_view_remove(app->config_view, index);
 
         // Save settings
-        save_settings(app->selected_javascript_file, &app->playlist);
+        save_settings(app->selected_javascript_file, app->playlist);
 
-        console_view_print(app->console_view, "Script removed from playlist.");
+        console_pipe_print(app->console_pipe, "Script removed from playlist.");
     }
-    else if (index == MAX_PLAYLIST_SIZE)
+    else if (event == JsPlaylistViewEventMoved)
+    {
+        // Save the new order
+        save_settings(app->selected_javascript_file, app->playlist);
+    }
+    else if (event == JsPlaylistViewEventAdd)
     {
         // "Add Script" selected
         view_dispatcher_send_custom_event(app->view_dispatcher, VIEW_EVENT_ADD_SCRIPT);
     }
 }
 
+// Function to execute a playlist entry
+static void execute_script(FastJSApp *app, size_t index)
+{
+    FuriString *start_text = furi_string_alloc_printf("Running %s", playlist_get_name(app->playlist, index));
+    console_pipe_print(app->console_pipe, furi_string_get_cstr(start_text));
+    console_pipe_print(app->console_pipe, "------------");
+    furi_string_free(start_text);
+
+    PlaylistMeta *meta = playlist_get_meta(app->playlist, index);
+    meta->run_count++;
+    app->run_index = index;
+    app->run_start = furi_get_tick();
+    app->js_thread = js_thread_run_ex(playlist_get_path(app->playlist, index), &meta->hints, js_callback, app);
+}
+
+// Records how long the running script took and starts the next one, if any
+static void script_finished(FastJSApp *app)
+{
+    if (!app->js_thread)
+    {
+        // The run was stopped before this event got here
+        return;
+    }
+
+    js_thread_stop(app->js_thread);
+    app->js_thread = NULL;
+
+    PlaylistMeta *meta = playlist_get_meta(app->playlist, app->run_index);
+    meta->last_duration_ms = (uint64_t)(furi_get_tick() - app->run_start) * 1000 / furi_kernel_get_tick_frequency();
+
+    if (app->run_index + 1 < playlist_count(app->playlist))
+    {
+        execute_script(app, app->run_index + 1);
+    }
+    else
+    {
+        console_pipe_print(app->console_pipe, "--- PLAYLIST DONE ---");
+        save_settings(app->selected_javascript_file, app->playlist);
+    }
+}
+
 // Custom event callback to handle file browser dialog for adding scripts
 static bool fast_js_custom_event_callback(void *context, uint32_t event)
 {
     FastJSApp *app = (FastJSApp *)context;
 
+    if (event == VIEW_EVENT_SCRIPT_FINISHED)
+    {
+        script_finished(app);
+        return true;
+    }
+
     if (event == VIEW_EVENT_ADD_SCRIPT)
     {
         // Open file browser to select a script to add to the playlist
@@ -424,47 +595,21 @@ static bool fast_js_custom_event_callback(void *context, uint32_t event)
             // Store the selected script file path
             const char *file_path = furi_string_get_cstr(javascript_file_path);
 
-            // Check if playlist is full
-            if (app->playlist.count >= MAX_PLAYLIST_SIZE)
+            if (strlen(file_path) >= MAX_SCRIPT_PATH_LENGTH)
             {
-                console_view_print(app->console_view, "Playlist is full.");
+                console_pipe_print(app->console_pipe, "Script path is too long.");
+            }
+            // Add the script to the playlist, which fails if it's full
+            else if (playlist_view_add(app->config_view, file_path, NULL) < 0)
+            {
+                console_pipe_print(app->console_pipe, "Playlist is full.");
             }
             else
             {
-                // Add the script to the playlist
-                strncpy(app->playlist.scripts[app->playlist.count], file_path, MAX_SCRIPT_PATH_LENGTH);
-                app->playlist.scripts[app->playlist.count][MAX_SCRIPT_PATH_LENGTH - 1] = '\0'; // Ensure null-termination
-                app->playlist.count++;
-
-                // Update the config view
-                submenu_reset(app->config_view);
-
-                // Re-add the playlist items, showing only the filename
-                for (size_t i = 0; i < app->playlist.count; ++i)
-                {
-                    FuriString *filename = furi_string_alloc_set(app->playlist.scripts[i]);
-                    path_extract_filename(filename, filename, false); // Extract filename from path
-                    submenu_add_item(
-                        app->config_view,
-                        furi_string_get_cstr(filename), // Use only the filename
-                        i,
-                        playlist_item_callback,
-                        app);
-                    furi_string_free(filename); // Free the filename string after use
-                }
-
-                // Re-add the "Add Script" option
-                submenu_add_item(
-                    app->config_view,
-                    "Add Script",
-                    MAX_PLAYLIST_SIZE,
-                    playlist_item_callback,
-                    app);
-
                 // Save the updated playlist
-                save_settings(app->selected_javascript_file, &app->playlist);
+                save_settings(app->selected_javascript_file, app->playlist);
 
-                console_view_print(app->console_view, "Script added to playlist.");
+                console_pipe_print(app->console_pipe, "Script added to playlist.");
             }
         }
 
@@ -480,22 +625,6 @@ static bool fast_js_custom_event_callback(void *context, uint32_t event)
     return false; // Event not handled
 }
 
-// Function to execute a single script
-static void execute_script(FastJSApp *app, const char *script_path)
-{
-    FuriString *name = furi_string_alloc();
-    FuriString *script_path_str = furi_string_alloc_set(script_path);
-    path_extract_filename(script_path_str, name, false);
-    FuriString *start_text = furi_string_alloc_printf("Running %s", furi_string_get_cstr(name));
-    console_view_print(app->console_view, furi_string_get_cstr(start_text));
-    console_view_print(app->console_view, "------------");
-    furi_string_free(name);
-    furi_string_free(start_text);
-
-    app->js_thread = js_thread_run(furi_string_get_cstr(script_path_str), js_callback, app);
-    furi_string_free(script_path_str);
-}
-
 // Handle submenu item selection
 static void fast_js_submenu_callback(void *context, uint32_t index)
 {
@@ -504,19 +633,19 @@ static void fast_js_submenu_callback(void *context, uint32_t index)
     {
     case FastJSSubmenuIndexRun:
         // Execute all scripts in the playlist
-        if (app->playlist.count == 0)
+        if (playlist_count(app->playlist) == 0)
         {
-            console_view_print(app->console_view, "No scripts in the playlist.");
+            console_pipe_print(app->console_pipe, "No scripts in the playlist.");
         }
         else
         {
             // Switch to the console view
             view_dispatcher_switch_to_view(app->view_dispatcher, FastJSViewConsole);
 
-            // Execute each script sequentially
-            for (size_t i = 0; i < app->playlist.count; ++i)
+            // Execute the scripts one after another, each one that finishes starts the next
+            if (!app->js_thread)
             {
-                execute_script(app, app->playlist.scripts[i]);
+                execute_script(app, 0);
             }
         }
         break;
@@ -556,12 +685,14 @@ static FastJSApp *fast_js_app_alloc()
     app->selected_javascript_file[0] = '\0';
 
     // Initialize the playlist
-    app->playlist.count = 0;
+    app->playlist = playlist_alloc();
+    app->js_thread = NULL;
 
-    // Try to load the remembered settings
-    if (load_settings(app->selected_javascript_file, app->temp_buffer_size, &app->playlist))
+    // Try to load the remembered settings, timed since that's part of launching scripts
+    uint32_t load_start = furi_get_tick();
+    if (load_settings(app->selected_javascript_file, app->temp_buffer_size, app->playlist))
     {
-        FURI_LOG_I(TAG, "Settings loaded: script_path=%s, playlist_count=%zu", app->selected_javascript_file, app->playlist.count);
+        FURI_LOG_I(TAG, "Settings loaded: script_path=%s, playlist_count=%zu in %lums", app->selected_javascript_file, playlist_count(app->playlist), furi_get_tick() - load_start);
     }
     else
     {
@@ -572,6 +703,7 @@ static FastJSApp *fast_js_app_alloc()
     app->view_dispatcher = view_dispatcher_alloc();
     if (!app->view_dispatcher)
     {
+        playlist_free(app->playlist);
         free(app->temp_buffer);
         free(app->selected_javascript_file);
         free(app);
@@ -587,10 +719,12 @@ static FastJSApp *fast_js_app_alloc()
     view_dispatcher_set_custom_event_callback(app->view_dispatcher, fast_js_custom_event_callback);
 
     // Initialize the console view
-    app->console_view = console_view_alloc();
+    app->console_view = console_view_alloc(CONSOLE_SCROLLBACK_SIZE_DEFAULT);
     view_dispatcher_add_view(app->view_dispatcher, FastJSViewConsole, console_view_get_view(app->console_view));
-    view_set_previous_callback(console_view_get_view(app->console_view), fast_js_navigation_console_callback);
-    view_set_context(console_view_get_view(app->console_view), app);
+    console_view_set_previous_callback(app->console_view, fast_js_navigation_console_callback, app);
+    app->console_pipe = console_pipe_alloc(app->console_view, CONSOLE_LOG_PATH);
+    view_dispatcher_set_tick_event_callback(
+        app->view_dispatcher, fast_js_tick_callback, furi_ms_to_ticks(CONSOLE_DRAIN_PERIOD_MS));
 
     // Initialize the submenu view
     app->submenu = submenu_alloc();
@@ -602,32 +736,10 @@ static FastJSApp *fast_js_app_alloc()
     view_dispatcher_add_view(app->view_dispatcher, FastJSViewSubmenu, submenu_get_view(app->submenu));
 
     // Initialize the configuration view
-    app->config_view = submenu_alloc();
-    submenu_set_header(app->config_view, "Playlist");
-    // Add existing scripts to the submenu, showing only the filename
-    for (size_t i = 0; i < app->playlist.count; ++i)
-    {
-        FuriString *filename = furi_string_alloc_set(app->playlist.scripts[i]);
-        path_extract_filename(filename, filename, false); // Extract filename from path
-        submenu_add_item(
-            app->config_view,
-            furi_string_get_cstr(filename), // Use only the filename
-            i,
-            playlist_item_callback,
-            app);
-        furi_string_free(filename); // Free the filename string after use
-    }
-
-    // Add "Add Script" option
-    submenu_add_item(
-        app->config_view,
-        "Add Script",
-        MAX_PLAYLIST_SIZE,
-        playlist_item_callback,
-        app);
-
-    view_set_previous_callback(submenu_get_view(app->config_view), fast_js_navigation_configure_callback);
-    view_dispatcher_add_view(app->view_dispatcher, FastJSViewConfigure, submenu_get_view(app->config_view));
+    app->config_view = playlist_view_alloc(app->playlist);
+    playlist_view_set_callback(app->config_view, playlist_item_callback, app);
+    playlist_view_set_previous_callback(app->config_view, fast_js_navigation_configure_callback, app);
+    view_dispatcher_add_view(app->view_dispatcher, FastJSViewConfigure, playlist_view_get_view(app->config_view));
 
     // Initialize the about view
     app->widget_about = widget_alloc();
@@ -637,7 +749,7 @@ static FastJSApp *fast_js_app_alloc()
         0,
         128,
         64,
-        "FastJS App v1.3\n---\nExecute your scripts\nseamlessly.\n---\nManage your\nplaylist in the config menu.\nYou will click 'Add Script'\nto add a script, or click\nthe script to remove it.\n---\nPress BACK to return.");
+        "FastJS App v1.3\n---\nExecute your scripts\nseamlessly.\n---\nManage your\nplaylist in the config menu.\nYou will click 'Add Script'\nto add a script, or click\nthe script to remove it.\nLeft/Right moves a script.\n---\nPress BACK to return.");
     view_set_previous_callback(widget_get_view(app->widget_about), fast_js_navigation_about_callback);
     view_dispatcher_add_view(app->view_dispatcher, FastJSViewAbout, widget_get_view(app->widget_about));
 
@@ -660,7 +772,8 @@ static void fast_js_app_free(FastJSApp *app)
         app->js_thread = NULL;
     }
 
-    // Free console view
+    // Free console pipe and view
+    console_pipe_free(app->console_pipe);
     view_dispatcher_remove_view(app->view_dispatcher, FastJSViewConsole);
     console_view_free(app->console_view);
 
@@ -670,13 +783,14 @@ static void fast_js_app_free(FastJSApp *app)
 
     // Free configuration view
     view_dispatcher_remove_view(app->view_dispatcher, FastJSViewConfigure);
-    submenu_free(app->config_view);
+    playlist_view_free(app->config_view);
 
     // Free about view
     view_dispatcher_remove_view(app->view_dispatcher, FastJSViewAbout);
     widget_free(app->widget_about);
 
-    // Free buffers
+    // Free the playlist and buffers
+    playlist_free(app->playlist);
     free(app->temp_buffer);
     free(app->selected_javascript_file);
 
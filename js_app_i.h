@@ -3,6 +3,7 @@
 #include <gui/view_dispatcher.h>
 #include <gui/modules/loading.h>
 #include "views/console_view.h"
+#include "views/console_pipe.h"
 
 typedef enum {
     JsAppViewConsole,
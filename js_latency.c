@@ -0,0 +1,209 @@
+#include "js_latency.h"
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <toolbox/strint.h>
+
+#define TAG "JsLatency"
+
+#define JS_LATENCY_CYCLES() (DWT->CYCCNT)
+
+/**
+ * @brief Past this, the cycle counter may have wrapped and ticks are used
+ */
+#define JS_LATENCY_CYCLES_MS_MAX 30000
+
+// A stage is reported if it got this much slower than the baseline
+#define JS_LATENCY_REGRESSION_PERCENT 25
+#define JS_LATENCY_REGRESSION_US_MIN  500 //<! Below this it's noise
+
+#define JS_LATENCY_CSV_HEADER "hints_us,setup_us,require_us,first_print_us,exec_us,teardown_us\n"
+#define JS_LATENCY_ROW_LEN    80
+
+/**
+ * @brief Time of a stage that never ended, an empty CSV field
+ */
+#define JS_LATENCY_NONE UINT32_MAX
+
+static const char* const js_latency_stage_names[JsLatencyStageCount] = {
+    [JsLatencyStageHints] = "hints",
+    [JsLatencyStageSetup] = "setup",
+    [JsLatencyStageRequire] = "require",
+    [JsLatencyStageFirstPrint] = "first_print",
+    [JsLatencyStageExec] = "exec",
+    [JsLatencyStageTeardown] = "teardown",
+};
+
+struct JsLatency {
+    uint32_t start_cycles[JsLatencyStageCount];
+    uint32_t start_tick[JsLatencyStageCount];
+    uint32_t us[JsLatencyStageCount];
+    bool ended[JsLatencyStageCount];
+};
+
+JsLatency* js_latency_alloc(void) {
+    JsLatency* latency = malloc(sizeof(JsLatency));
+    memset(latency, 0, sizeof(JsLatency));
+    return latency;
+}
+
+void js_latency_free(JsLatency* latency) {
+    free(latency);
+}
+
+void js_latency_begin(JsLatency* latency, JsLatencyStage stage) {
+    latency->start_tick[stage] = furi_get_tick();
+    latency->start_cycles[stage] = JS_LATENCY_CYCLES();
+}
+
+void js_latency_end(JsLatency* latency, JsLatencyStage stage) {
+    uint32_t cycles = JS_LATENCY_CYCLES() - latency->start_cycles[stage];
+    uint32_t ms = (uint64_t)(furi_get_tick() - latency->start_tick[stage]) * 1000 /
+                  furi_kernel_get_tick_frequency();
+    latency->us[stage] += ms > JS_LATENCY_CYCLES_MS_MAX ?
+                              ms * 1000 :
+                              cycles / furi_hal_cortex_instructions_per_microsecond();
+    latency->ended[stage] = true;
+}
+
+void js_latency_end_once(JsLatency* latency, JsLatencyStage stage) {
+    if(!latency->ended[stage]) js_latency_end(latency, stage);
+}
+
+/**
+ * @brief Gets the stage times, `JS_LATENCY_NONE` for stages that never ended
+ */
+static void js_latency_get_times(const JsLatency* latency, uint32_t* us) {
+    for(size_t i = 0; i < JsLatencyStageCount; i++) {
+        us[i] = latency->ended[i] ? latency->us[i] : JS_LATENCY_NONE;
+    }
+}
+
+static size_t js_latency_format_row(const uint32_t* us, char* row) {
+    size_t len = 0;
+    for(size_t i = 0; i < JsLatencyStageCount; i++) {
+        char separator = i + 1 < JsLatencyStageCount ? ',' : '\n';
+        if(us[i] == JS_LATENCY_NONE) {
+            len += snprintf(&row[len], JS_LATENCY_ROW_LEN - len, "%c", separator);
+        } else {
+            len += snprintf(
+                &row[len], JS_LATENCY_ROW_LEN - len, "%lu%c", (unsigned long)us[i], separator);
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief Reads the stage times from the second line of a baseline file
+ */
+static bool js_latency_read_baseline(File* file, uint32_t* us) {
+    char text[sizeof(JS_LATENCY_CSV_HEADER) + JS_LATENCY_ROW_LEN];
+    size_t len = storage_file_read(file, text, sizeof(text) - 1);
+    text[len] = '\0';
+
+    char* at = strchr(text, '\n');
+    if(!at) return false;
+    for(size_t i = 0; i < JsLatencyStageCount; i++) {
+        char separator = i + 1 < JsLatencyStageCount ? ',' : '\n';
+        if(at[1] == separator) {
+            us[i] = JS_LATENCY_NONE;
+            at++;
+        } else if(strint_to_uint32(at + 1, &at, &us[i], 10) != StrintParseNoError) {
+            return false;
+        }
+        if(*at != separator) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a baseline file
+ * @returns false if it doesn't exist or isn't valid
+ */
+static bool js_latency_load_baseline(Storage* storage, const char* path, uint32_t* us) {
+    File* file = storage_file_alloc(storage);
+    bool loaded = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                  js_latency_read_baseline(file, us);
+    storage_file_close(file);
+    storage_file_free(file);
+    return loaded;
+}
+
+static bool js_latency_write_file(
+    Storage* storage,
+    const char* path,
+    FS_OpenMode mode,
+    const char* row,
+    size_t row_len) {
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, path, FSAM_WRITE, mode);
+    if(ok && storage_file_size(file) == 0) {
+        size_t header_len = strlen(JS_LATENCY_CSV_HEADER);
+        ok = storage_file_write(file, JS_LATENCY_CSV_HEADER, header_len) == header_len;
+    }
+    ok = ok && storage_file_write(file, row, row_len) == row_len;
+    storage_file_close(file);
+    storage_file_free(file);
+    return ok;
+}
+
+bool js_latency_write_report(JsLatency* latency, const char* script_path, FuriString* summary) {
+    uint32_t us[JsLatencyStageCount];
+    js_latency_get_times(latency, us);
+    char row[JS_LATENCY_ROW_LEN];
+    size_t row_len = js_latency_format_row(us, row);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FuriString* path = furi_string_alloc_printf("%s.latency.csv", script_path);
+    bool ok = js_latency_write_file(
+        storage, furi_string_get_cstr(path), FSOM_OPEN_APPEND, row, row_len);
+    if(!ok) FURI_LOG_E(TAG, "Failed to write %s", furi_string_get_cstr(path));
+
+    // a reference that's kept along with the script wins over a recorded baseline
+    uint32_t baseline[JsLatencyStageCount];
+    furi_string_printf(path, "%s.latency.ref", script_path);
+    bool is_reference = js_latency_load_baseline(storage, furi_string_get_cstr(path), baseline);
+    bool has_baseline = is_reference;
+    if(!has_baseline) {
+        furi_string_printf(path, "%s.latency.base", script_path);
+        has_baseline = js_latency_load_baseline(storage, furi_string_get_cstr(path), baseline);
+    }
+    if(!has_baseline) {
+        js_latency_write_file(
+            storage, furi_string_get_cstr(path), FSOM_CREATE_ALWAYS, row, row_len);
+    }
+    furi_string_free(path);
+    furi_record_close(RECORD_STORAGE);
+
+    furi_string_set(summary, "Latency (us):");
+    for(size_t i = 0; i < JsLatencyStageCount; i++) {
+        if(us[i] == JS_LATENCY_NONE) {
+            furi_string_cat_printf(summary, " %s -", js_latency_stage_names[i]);
+        } else {
+            furi_string_cat_printf(
+                summary, " %s %lu", js_latency_stage_names[i], (unsigned long)us[i]);
+        }
+    }
+    if(!has_baseline) {
+        furi_string_cat(summary, ". Saved as baseline");
+        return ok;
+    }
+
+    const char* regressed_prefix =
+        is_reference ? ". Slower than reference:" : ". Slower than baseline:";
+    bool regressed = false;
+    for(size_t i = 0; i < JsLatencyStageCount; i++) {
+        if(us[i] == JS_LATENCY_NONE || baseline[i] == JS_LATENCY_NONE) continue;
+        // stages of over 42 s would overflow these in 32 bits
+        uint64_t slower = us[i] - MIN(us[i], baseline[i]);
+        uint64_t threshold = (uint64_t)baseline[i] * JS_LATENCY_REGRESSION_PERCENT;
+        if(slower < JS_LATENCY_REGRESSION_US_MIN || slower * 100 < threshold) continue;
+        furi_string_cat_printf(
+            summary,
+            "%s %s +%llu%%",
+            regressed ? "," : regressed_prefix,
+            js_latency_stage_names[i],
+            (unsigned long long)(baseline[i] ? slower * 100 / baseline[i] : 100));
+        regressed = true;
+    }
+    return ok;
+}
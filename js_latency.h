@@ -0,0 +1,73 @@
+#pragma once
+
+#include "js_thread_i.h"
+
+/**
+ * @file js_latency.h
+ *
+ * Launch latency trace, enabled per script with the `latency` token in its
+ * `// @fastjs` header.
+ *
+ * The time of each stage of a run is measured with the cycle counter:
+ *   - `hints`: opening the script and reading its header;
+ *   - `setup`: creating the interpreter, modules and globals;
+ *   - `require`: all `require()` calls together;
+ *   - `first_print`: from the start of execution to the first `print()`,
+ *     which covers reading and parsing the script;
+ *   - `exec`: the whole of `mjs_exec_file`;
+ *   - `teardown`: destroying the interpreter and modules.
+ *
+ * Each run appends a row to `<script>.latency.csv`. A stage that never ended,
+ * such as `first_print` in a script that doesn't print, is left empty.
+ *
+ * Runs are compared to a baseline and stages that got slower are reported.
+ * The baseline is `<script>.latency.ref` if it exists: a CSV in the same
+ * format that is kept under version control along with the script and is
+ * never written by the app, so that regressions between builds are caught.
+ * Otherwise the first run writes `<script>.latency.base`, which only tracks
+ * changes on this device. Delete it to record a new one.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    JsLatencyStageHints,
+    JsLatencyStageSetup,
+    JsLatencyStageRequire,
+    JsLatencyStageFirstPrint,
+    JsLatencyStageExec,
+    JsLatencyStageTeardown,
+    JsLatencyStageCount,
+} JsLatencyStage;
+
+typedef struct JsLatency JsLatency;
+
+JsLatency* js_latency_alloc(void);
+
+void js_latency_free(JsLatency* latency);
+
+void js_latency_begin(JsLatency* latency, JsLatencyStage stage);
+
+/**
+ * @brief Adds the time since `js_latency_begin` to the stage
+ */
+void js_latency_end(JsLatency* latency, JsLatencyStage stage);
+
+/**
+ * @brief Ends a stage unless it has ended before
+ */
+void js_latency_end_once(JsLatency* latency, JsLatencyStage stage);
+
+/**
+ * @brief Appends the run to `<script_path>.latency.csv` and compares it to
+ * the baseline
+ * @param summary Set to a one line summary, with the regressions if any
+ * @returns false if the CSV could not be written
+ */
+bool js_latency_write_report(JsLatency* latency, const char* script_path, FuriString* summary);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,116 @@
+#include "js_memstats.h"
+#include <m-array.h>
+
+ARRAY_DEF(JsCensusStack, mjs_val_t, M_BASIC_OPLIST); //-V575
+
+/**
+ * @brief Set of the objects that have been visited, open addressing over a
+ * power of 2 number of slots. 0 is never an object, so it marks free slots.
+ */
+typedef struct {
+    mjs_val_t* slots;
+    size_t capacity;
+    size_t count;
+} JsCensusVisited;
+
+static size_t js_census_slot(mjs_val_t value, size_t capacity) {
+    // object values differ in their low bits, mix in the rest anyway
+    uint64_t hash = value * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(hash >> 32) & (capacity - 1);
+}
+
+static void js_census_visited_grow(JsCensusVisited* visited) {
+    size_t old_capacity = visited->capacity;
+    mjs_val_t* old_slots = visited->slots;
+    visited->capacity = old_capacity ? old_capacity * 2 : 64;
+    visited->slots = malloc(visited->capacity * sizeof(mjs_val_t));
+    memset(visited->slots, 0, visited->capacity * sizeof(mjs_val_t));
+
+    for(size_t i = 0; i < old_capacity; i++) {
+        if(!old_slots[i]) continue;
+        size_t slot = js_census_slot(old_slots[i], visited->capacity);
+        while(visited->slots[slot])
+            slot = (slot + 1) & (visited->capacity - 1);
+        visited->slots[slot] = old_slots[i];
+    }
+    free(old_slots);
+}
+
+/**
+ * @brief Adds an object to the set
+ * @returns false if it was already there
+ */
+static bool js_census_visit(JsCensusVisited* visited, mjs_val_t object) {
+    if((visited->count + 1) * 4 > visited->capacity * 3) js_census_visited_grow(visited);
+
+    size_t slot = js_census_slot(object, visited->capacity);
+    while(visited->slots[slot]) {
+        if(visited->slots[slot] == object) return false;
+        slot = (slot + 1) & (visited->capacity - 1);
+    }
+    visited->slots[slot] = object;
+    visited->count++;
+    return true;
+}
+
+static void js_census_count(
+    struct mjs* mjs,
+    JsHeapCensus* census,
+    JsCensusVisited* visited,
+    JsCensusStack_t pending,
+    mjs_val_t value) {
+    if(mjs_is_string(value)) {
+        size_t len;
+        mjs_get_string(mjs, &value, &len);
+        census->strings++;
+        census->string_bytes += len;
+    } else if(mjs_is_array_buf(value)) {
+        size_t len;
+        mjs_array_buf_get_ptr(mjs, value, &len);
+        census->array_bufs++;
+        census->array_buf_bytes += len;
+    } else if(mjs_is_function(value)) {
+        census->functions++;
+    } else if(mjs_is_object(value) && js_census_visit(visited, value)) {
+        JsCensusStack_push_back(pending, value);
+    }
+}
+
+void js_heap_census(struct mjs* mjs, JsHeapCensus* census) {
+    memset(census, 0, sizeof(JsHeapCensus));
+    JsCensusVisited visited = {0};
+    // walk iteratively, the script's data can be nested deeper than the stack allows
+    JsCensusStack_t pending;
+    JsCensusStack_init(pending);
+
+    mjs_val_t global = mjs_get_global(mjs);
+    js_census_visit(&visited, global);
+    JsCensusStack_push_back(pending, global);
+
+    mjs_val_t object;
+    while(!JsCensusStack_empty_p(pending)) {
+        JsCensusStack_pop_back(&object, pending);
+        census->objects++;
+
+        if(mjs_is_array(object)) {
+            unsigned long length = mjs_array_length(mjs, object);
+            census->properties += length;
+            for(unsigned long i = 0; i < length; i++) {
+                js_census_count(mjs, census, &visited, pending, mjs_array_get(mjs, object, i));
+            }
+            continue;
+        }
+
+        mjs_val_t iter = MJS_UNDEFINED, key;
+        while((key = mjs_next(mjs, object, &iter)) != MJS_UNDEFINED) {
+            size_t name_len;
+            const char* name = mjs_get_string(mjs, &key, &name_len);
+            census->properties++;
+            js_census_count(
+                mjs, census, &visited, pending, mjs_get(mjs, object, name, name_len));
+        }
+    }
+
+    JsCensusStack_clear(pending);
+    free(visited.slots);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "js_thread_i.h"
+
+/**
+ * @file js_memstats.h
+ *
+ * Census of the values that a script keeps alive, for `runtime.memStats()`
+ * and the heap snapshot at exit.
+ *
+ * mJS doesn't expose the fill level of its arenas, so the census walks the
+ * object graph from the global object instead and counts what it reaches.
+ * Values that are only referenced from the stack of the running function
+ * aren't counted. The walk visits every live object, so it's meant to be
+ * taken on demand, not polled.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t objects; //<! Including arrays
+    uint32_t properties; //<! Including array elements
+    uint32_t functions;
+    uint32_t strings;
+    uint32_t string_bytes;
+    uint32_t array_bufs;
+    uint32_t array_buf_bytes;
+} JsHeapCensus;
+
+/**
+ * @brief Counts the values reachable from the global object
+ */
+void js_heap_census(struct mjs* mjs, JsHeapCensus* census);
+
+#ifdef __cplusplus
+}
+#endif
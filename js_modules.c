@@ -5,7 +5,16 @@
 #include <fast_js_app_icons.h>
 
 #include "modules/js_flipper.h"
-#ifdef FW_CFG_unit_tests
+#include "modules/js_bench.h"
+#include "modules/js_event_loop/js_event_loop.h"
+#include "modules/js_worker.h"
+#include "modules/js_json.h"
+#include "modules/js_msgpack.h"
+#include "modules/js_struct.h"
+#include "modules/js_bytes.h"
+#include "modules/js_badusb.h"
+// the tests module ships with unit test firmware, or with apps built with JS_TESTS
+#if defined(FW_CFG_unit_tests) || defined(JS_TESTS)
 #include "modules/js_tests.h"
 #endif
 
@@ -33,8 +42,19 @@ ARRAY_DEF(JsModuleArray, JsModuleData, M_POD_OPLIST);
 
 static const JsModuleDescriptor modules_builtin[] = {
     {"flipper", js_flipper_create, NULL, NULL},
-#ifdef FW_CFG_unit_tests
-    {"tests", js_tests_create, NULL, NULL},
+    {"bench", js_bench_create, js_bench_destroy, NULL},
+    {"event_loop",
+     js_event_loop_create,
+     js_event_loop_destroy,
+     &js_event_loop_hashtable_api_interface},
+    {"worker", js_worker_create, js_worker_destroy, NULL},
+    {"json", js_json_create, NULL, NULL},
+    {"msgpack", js_msgpack_create, NULL, NULL},
+    {"struct", js_struct_create, js_struct_destroy, NULL},
+    {"bytes", js_bytes_create, NULL, NULL},
+    {"badusb", js_badusb_create, js_badusb_destroy, NULL},
+#if defined(FW_CFG_unit_tests) || defined(JS_TESTS)
+    {"tests", js_tests_create, js_tests_destroy, NULL},
 #endif
 };
 
@@ -123,6 +143,11 @@ mjs_val_t js_module_require(JsModules *modules, const char *name, size_t name_le
                 .name = furi_string_alloc_set_str(name),
             };
             JsModuleArray_push_at(modules->modules, 0, module);
+            if (modules_builtin[i].api_interface)
+            {
+                FURI_LOG_I(TAG, "Added module API to composite resolver: %s", name);
+                composite_api_resolver_add(modules->resolver, modules_builtin[i].api_interface);
+            }
             module_found = true;
             FURI_LOG_I(TAG, "Using built-in module %s", name);
             break;
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include "js_thread_i.h"
 #include "js_value.h"
+#include "js_profile.h"
 #include <flipper_application/flipper_application.h>
 #include <flipper_application/plugins/plugin_manager.h>
 #include <flipper_application/plugins/composite_resolver.h>
@@ -66,6 +67,7 @@ extern "C" {
 typedef enum {
     JsForeignMagicStart = 0x15BAD000,
     JsForeignMagic_JsEventLoopContract,
+    JsForeignMagic_JsStorageFile,
 } JsForeignMagic;
 
 /**
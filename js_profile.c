@@ -0,0 +1,199 @@
+#include "js_profile.h"
+
+#ifdef JS_PROFILE
+
+#include <storage/storage.h>
+
+#define TAG "JsProfile"
+
+#define JS_PROFILE_SLOTS 256
+
+typedef struct {
+    mjs_func_ptr_t fn;
+    const char* name;
+} JsProfileSlot;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t max_cycles;
+    uint64_t total_cycles; //<! Including nested native calls
+    uint64_t parse_cycles;
+} JsProfileEntry;
+
+struct JsProfiler {
+    JsProfileEntry entries[JS_PROFILE_SLOTS];
+    int32_t current; //<! Slot of the running native function, -1 if none
+    uint32_t unprofiled; //<! Functions that didn't get a slot
+};
+
+// shared by all JS threads, so that trampolines are too. Reset when a
+// profiler is allocated while none is alive, so that no interpreter can still
+// hold a trampoline and no entry outlives the plugins of a previous run.
+static JsProfileSlot js_profile_slots[JS_PROFILE_SLOTS];
+static size_t js_profile_slot_count;
+static size_t js_profile_profilers; //<! Profilers that are alive
+
+/**
+ * @brief Body of every trampoline
+ *
+ * Trampolines take and pass on a second argument, because object destructors
+ * are registered through `MJS_MK_FN` as well and receive the object.
+ */
+static void js_profile_call(struct mjs* mjs, mjs_val_t arg, size_t slot) {
+    void (*fn)(struct mjs*, mjs_val_t) = (void*)js_profile_slots[slot].fn;
+    JsProfiler* profiler = js_thread_get_profiler(mjs);
+    if(!profiler) {
+        fn(mjs, arg);
+        return;
+    }
+
+    int32_t outer = profiler->current;
+    profiler->current = slot;
+    uint32_t start = JS_PROFILE_CYCLES();
+    fn(mjs, arg);
+    uint32_t cycles = JS_PROFILE_CYCLES() - start;
+    profiler->current = outer;
+
+    JsProfileEntry* entry = &profiler->entries[slot];
+    entry->calls++;
+    entry->total_cycles += cycles;
+    entry->max_cycles = MAX(entry->max_cycles, cycles);
+}
+
+#define JS_PROFILE_TRAMPOLINE(n)                                          \
+    static void js_profile_trampoline_##n(struct mjs* mjs, mjs_val_t arg) { \
+        js_profile_call(mjs, arg, n);                                     \
+    }
+#define JS_PROFILE_TRAMPOLINE_REF(n) (mjs_func_ptr_t)js_profile_trampoline_##n,
+
+#define JS_PROFILE_ROW(X, h)                                                                   \
+    X(0x##h##0) X(0x##h##1) X(0x##h##2) X(0x##h##3) X(0x##h##4) X(0x##h##5) X(0x##h##6)        \
+        X(0x##h##7) X(0x##h##8) X(0x##h##9) X(0x##h##A) X(0x##h##B) X(0x##h##C) X(0x##h##D) \
+            X(0x##h##E) X(0x##h##F)
+#define JS_PROFILE_TABLE(X)                                                                   \
+    JS_PROFILE_ROW(X, 0) JS_PROFILE_ROW(X, 1) JS_PROFILE_ROW(X, 2) JS_PROFILE_ROW(X, 3)       \
+        JS_PROFILE_ROW(X, 4) JS_PROFILE_ROW(X, 5) JS_PROFILE_ROW(X, 6) JS_PROFILE_ROW(X, 7)   \
+            JS_PROFILE_ROW(X, 8) JS_PROFILE_ROW(X, 9) JS_PROFILE_ROW(X, A)                    \
+                JS_PROFILE_ROW(X, B) JS_PROFILE_ROW(X, C) JS_PROFILE_ROW(X, D)                \
+                    JS_PROFILE_ROW(X, E) JS_PROFILE_ROW(X, F)
+
+JS_PROFILE_TABLE(JS_PROFILE_TRAMPOLINE)
+
+static const mjs_func_ptr_t js_profile_trampolines[JS_PROFILE_SLOTS] = {
+    JS_PROFILE_TABLE(JS_PROFILE_TRAMPOLINE_REF)};
+
+mjs_val_t js_profile_mk_fn(struct mjs* mjs, mjs_func_ptr_t fn, const char* name) {
+    int32_t slot = -1;
+    FURI_CRITICAL_ENTER();
+    for(size_t i = 0; i < js_profile_slot_count; i++) {
+        if(js_profile_slots[i].fn == fn) {
+            slot = i;
+            break;
+        }
+    }
+    if(slot < 0 && js_profile_slot_count < JS_PROFILE_SLOTS) {
+        slot = js_profile_slot_count++;
+        js_profile_slots[slot] = (JsProfileSlot){.fn = fn, .name = name};
+    }
+    FURI_CRITICAL_EXIT();
+
+    if(slot < 0) {
+        FURI_LOG_W(TAG, "Out of slots, not profiling %s", name);
+        JsProfiler* profiler = js_thread_get_profiler(mjs);
+        if(profiler) profiler->unprofiled++;
+        return mjs_mk_foreign_func(mjs, fn);
+    }
+    return mjs_mk_foreign_func(mjs, js_profile_trampolines[slot]);
+}
+
+JsProfiler* js_profiler_alloc(void) {
+    JsProfiler* profiler = malloc(sizeof(JsProfiler));
+    memset(profiler->entries, 0, sizeof(profiler->entries));
+    profiler->current = -1;
+    profiler->unprofiled = 0;
+
+    FURI_CRITICAL_ENTER();
+    if(!js_profile_profilers++) js_profile_slot_count = 0;
+    FURI_CRITICAL_EXIT();
+    return profiler;
+}
+
+void js_profiler_free(JsProfiler* profiler) {
+    FURI_CRITICAL_ENTER();
+    js_profile_profilers--;
+    FURI_CRITICAL_EXIT();
+    free(profiler);
+}
+
+void js_profiler_add_parse_time(struct mjs* mjs, uint32_t cycles) {
+    JsProfiler* profiler = js_thread_get_profiler(mjs);
+    if(!profiler || profiler->current < 0) return;
+    profiler->entries[profiler->current].parse_cycles += cycles;
+}
+
+bool js_profiler_write_report(JsProfiler* profiler, const char* path) {
+    // sort the slots that have been called by total time, there are few
+    uint16_t order[JS_PROFILE_SLOTS];
+    size_t count = 0;
+    for(size_t i = 0; i < js_profile_slot_count; i++) {
+        if(!profiler->entries[i].calls) continue;
+        size_t j = count++;
+        for(; j > 0 && profiler->entries[order[j - 1]].total_cycles <
+                           profiler->entries[i].total_cycles;
+            j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool success = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+
+    if(success) {
+        uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+        FuriString* line = furi_string_alloc_set_str(
+            "function\tcalls\ttotal_us\tmax_us\tavg_us\tparse_us\n");
+        success = storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line)) ==
+                  furi_string_size(line);
+
+        for(size_t i = 0; success && i < count; i++) {
+            const JsProfileEntry* entry = &profiler->entries[order[i]];
+            furi_string_printf(
+                line,
+                "%s\t%lu\t%lu\t%lu\t%lu\t%lu\n",
+                js_profile_slots[order[i]].name,
+                entry->calls,
+                (uint32_t)(entry->total_cycles / cycles_per_us),
+                entry->max_cycles / cycles_per_us,
+                (uint32_t)(entry->total_cycles / entry->calls / cycles_per_us),
+                (uint32_t)(entry->parse_cycles / cycles_per_us));
+            success = storage_file_write(
+                          file, furi_string_get_cstr(line), furi_string_size(line)) ==
+                      furi_string_size(line);
+        }
+
+        if(success && profiler->unprofiled) {
+            furi_string_printf(
+                line, "# %lu functions not profiled, out of slots\n", profiler->unprofiled);
+            success = storage_file_write(
+                          file, furi_string_get_cstr(line), furi_string_size(line)) ==
+                      furi_string_size(line);
+        }
+        furi_string_free(line);
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    if(!success) FURI_LOG_E(TAG, "Failed to write %s", path);
+    return success;
+}
+
+#else
+
+mjs_val_t js_profile_mk_fn(struct mjs* mjs, mjs_func_ptr_t fn, const char* name) {
+    UNUSED(name);
+    return mjs_mk_foreign_func(mjs, fn);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "js_thread_i.h"
+
+/**
+ * @file js_profile.h
+ *
+ * Native call profiler, built in with `JS_PROFILE`.
+ *
+ * When enabled, `MJS_MK_FN` registers every native function in a slot table
+ * and hands mJS a trampoline for that slot instead, which counts calls and
+ * measures their time. Since the macro is expanded where the functions are
+ * registered, this covers both built-in and plugin modules, as long as they
+ * are built with the same flag. Time spent parsing arguments with
+ * `js_value_parse` is attributed to the native function that's running.
+ *
+ * Without `JS_PROFILE` nothing is wrapped and the profiler costs nothing.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wraps a native function in a profiling trampoline
+ *
+ * Exported regardless of `JS_PROFILE` so that plugins built with the flag
+ * can be loaded by an app that's built without it; the function is then
+ * returned unwrapped.
+ */
+mjs_val_t js_profile_mk_fn(struct mjs* mjs, mjs_func_ptr_t fn, const char* name);
+
+#ifdef JS_PROFILE
+
+#include <furi_hal.h>
+
+#undef MJS_MK_FN
+#define MJS_MK_FN(fn) js_profile_mk_fn(mjs, (mjs_func_ptr_t)(fn), #fn)
+
+#ifndef JS_PROFILE_CYCLES
+#define JS_PROFILE_CYCLES() (DWT->CYCCNT)
+#endif
+
+typedef struct JsProfiler JsProfiler;
+
+JsProfiler* js_profiler_alloc(void);
+
+void js_profiler_free(JsProfiler* profiler);
+
+/**
+ * @brief Attributes argument parsing time to the native function that's
+ * currently running
+ */
+void js_profiler_add_parse_time(struct mjs* mjs, uint32_t cycles);
+
+/**
+ * @brief Writes the report sorted by total time, one function per line
+ * @returns false if the file could not be written
+ */
+bool js_profiler_write_report(JsProfiler* profiler, const char* path);
+
+/**
+ * @brief Gets the profiler of the thread that `mjs` runs on, implemented
+ * by `js_thread.c`
+ */
+JsProfiler* js_thread_get_profiler(struct mjs* mjs);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,204 @@
+#include "js_sampler.h"
+#include <storage/storage.h>
+
+#define TAG "JsSampler"
+
+/**
+ * @brief Innermost call frames that are recorded per sample
+ */
+#define JS_SAMPLER_DEPTH 8
+
+/**
+ * @brief Distinct call stacks that are kept, must be a power of 2
+ */
+#define JS_SAMPLER_STACKS 128
+
+typedef struct {
+    uint32_t count; //<! 0 if the entry is unused
+    uint8_t depth;
+    int32_t offsets[JS_SAMPLER_DEPTH]; //<! Innermost frame first
+} JsSamplerStack;
+
+struct JsSampler {
+    uint32_t last_tick;
+    uint32_t samples;
+    uint32_t dropped; //<! Samples of stacks that didn't fit into the table
+    JsSamplerStack stacks[JS_SAMPLER_STACKS];
+};
+
+/**
+ * @brief Source location of a line in the flat profile
+ */
+typedef struct {
+    const char* file;
+    int line;
+    uint32_t count;
+} JsSamplerLine;
+
+JsSampler* js_sampler_alloc(void) {
+    JsSampler* sampler = malloc(sizeof(JsSampler));
+    memset(sampler, 0, sizeof(JsSampler));
+    return sampler;
+}
+
+void js_sampler_free(JsSampler* sampler) {
+    free(sampler);
+}
+
+static uint32_t js_sampler_hash(const int32_t* offsets, uint8_t depth) {
+    uint32_t hash = 2166136261UL; // FNV-1a
+    for(uint8_t i = 0; i < depth; i++) {
+        hash ^= (uint32_t)offsets[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+void js_sampler_sample(JsSampler* sampler, struct mjs* mjs) {
+    uint32_t now = furi_get_tick();
+    if(now == sampler->last_tick) return;
+    sampler->last_tick = now;
+    sampler->samples++;
+
+    int32_t offsets[JS_SAMPLER_DEPTH];
+    uint8_t depth = 0;
+    while(depth < JS_SAMPLER_DEPTH) {
+        int offset = mjs_get_offset_by_call_frame_num(mjs, depth);
+        if(offset < 0) break;
+        offsets[depth++] = offset;
+    }
+    if(!depth) return;
+
+    // open addressing with linear probing
+    uint32_t index = js_sampler_hash(offsets, depth);
+    for(size_t probe = 0; probe < JS_SAMPLER_STACKS; probe++, index++) {
+        JsSamplerStack* stack = &sampler->stacks[index & (JS_SAMPLER_STACKS - 1)];
+        if(!stack->count) {
+            stack->depth = depth;
+            memcpy(stack->offsets, offsets, depth * sizeof(offsets[0]));
+        } else if(
+            stack->depth != depth ||
+            memcmp(stack->offsets, offsets, depth * sizeof(offsets[0])) != 0) {
+            continue;
+        }
+        stack->count++;
+        return;
+    }
+    sampler->dropped++;
+}
+
+static void js_sampler_cat_location(FuriString* str, struct mjs* mjs, int32_t offset) {
+    const char* file = mjs_get_bcode_filename_by_offset(mjs, offset);
+    const char* name = file ? strrchr(file, '/') : NULL;
+    furi_string_cat_printf(
+        str,
+        "%s:%d",
+        name ? name + 1 : (file ? file : "?"),
+        mjs_get_lineno_by_offset(mjs, offset));
+}
+
+static bool js_sampler_write_line(File* file, FuriString* line) {
+    return storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line)) ==
+           furi_string_size(line);
+}
+
+static bool js_sampler_write_folded(
+    JsSampler* sampler,
+    struct mjs* mjs,
+    File* file,
+    FuriString* line) {
+    bool success = true;
+    for(size_t i = 0; success && i < JS_SAMPLER_STACKS; i++) {
+        const JsSamplerStack* stack = &sampler->stacks[i];
+        if(!stack->count) continue;
+
+        furi_string_reset(line);
+        for(uint8_t frame = stack->depth; frame > 0; frame--) {
+            js_sampler_cat_location(line, mjs, stack->offsets[frame - 1]);
+            if(frame > 1) furi_string_push_back(line, ';');
+        }
+        furi_string_cat_printf(line, " %lu\n", stack->count);
+        success = js_sampler_write_line(file, line);
+    }
+
+    if(success && sampler->dropped) {
+        furi_string_printf(line, "[other] %lu\n", sampler->dropped);
+        success = js_sampler_write_line(file, line);
+    }
+    return success;
+}
+
+static bool js_sampler_write_flat(JsSampler* sampler, struct mjs* mjs, File* file, FuriString* line) {
+    // merge stacks by their innermost line, sorted by samples
+    JsSamplerLine* lines = malloc(sizeof(JsSamplerLine) * JS_SAMPLER_STACKS);
+    size_t line_count = 0;
+    for(size_t i = 0; i < JS_SAMPLER_STACKS; i++) {
+        const JsSamplerStack* stack = &sampler->stacks[i];
+        if(!stack->count) continue;
+        JsSamplerLine location = {
+            .file = mjs_get_bcode_filename_by_offset(mjs, stack->offsets[0]),
+            .line = mjs_get_lineno_by_offset(mjs, stack->offsets[0]),
+            .count = stack->count,
+        };
+
+        size_t j = 0;
+        while(j < line_count && (lines[j].line != location.line || lines[j].file != location.file))
+            j++;
+        if(j < line_count) {
+            location.count += lines[j].count;
+        } else {
+            j = line_count++;
+        }
+        for(; j > 0 && lines[j - 1].count < location.count; j--)
+            lines[j] = lines[j - 1];
+        lines[j] = location;
+    }
+
+    furi_string_printf(line, "samples\tpercent\tlocation\n");
+    bool success = js_sampler_write_line(file, line);
+    for(size_t i = 0; success && i < line_count; i++) {
+        furi_string_printf(
+            line, "%lu\t%lu%%\t", lines[i].count, lines[i].count * 100 / sampler->samples);
+        const char* name = lines[i].file ? strrchr(lines[i].file, '/') : NULL;
+        furi_string_cat_printf(
+            line,
+            "%s:%d\n",
+            name ? name + 1 : (lines[i].file ? lines[i].file : "?"),
+            lines[i].line);
+        success = js_sampler_write_line(file, line);
+    }
+
+    free(lines);
+    return success;
+}
+
+bool js_sampler_write_reports(JsSampler* sampler, struct mjs* mjs, const char* script_path) {
+    if(!sampler->samples) return true;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FuriString* path = furi_string_alloc();
+    FuriString* line = furi_string_alloc();
+
+    furi_string_printf(path, "%s.flat", script_path);
+    bool success =
+        storage_file_open(file, furi_string_get_cstr(path), FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+        js_sampler_write_flat(sampler, mjs, file, line);
+    storage_file_close(file);
+
+    furi_string_printf(path, "%s.folded", script_path);
+    success = success &&
+              storage_file_open(
+                  file, furi_string_get_cstr(path), FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              js_sampler_write_folded(sampler, mjs, file, line);
+    storage_file_close(file);
+
+    furi_string_free(line);
+    furi_string_free(path);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    FURI_LOG_I(TAG, "%lu samples, %lu dropped", sampler->samples, sampler->dropped);
+    if(!success) FURI_LOG_E(TAG, "Failed to write reports for %s", script_path);
+    return success;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "js_thread_i.h"
+
+/**
+ * @file js_sampler.h
+ *
+ * Sampling bytecode profiler, enabled per script with the `profile` token
+ * in its `// @fastjs` header.
+ *
+ * The sampler piggybacks on the exec flags poller: a script that is being
+ * profiled gets a poller that also records the bytecode offsets of all call
+ * frames, at most once per tick. Scripts that aren't being profiled keep the
+ * plain poller, so they pay nothing.
+ *
+ * At exit, the offsets are mapped to source lines with the same line tables
+ * that `mjs_disasm_all` uses, and two reports are written next to the script:
+ *   - `<script>.flat`: samples per source line, where the line was on top
+ *     of the stack;
+ *   - `<script>.folded`: one `outer;inner count` line per distinct call
+ *     stack, as consumed by `flamegraph.pl`.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct JsSampler JsSampler;
+
+JsSampler* js_sampler_alloc(void);
+
+void js_sampler_free(JsSampler* sampler);
+
+/**
+ * @brief Records the current call stack, unless it has already been
+ * recorded during this tick
+ */
+void js_sampler_sample(JsSampler* sampler, struct mjs* mjs);
+
+/**
+ * @brief Writes `<script_path>.flat` and `<script_path>.folded`
+ * @warning Needs the interpreter that ran the script, call before
+ * `mjs_destroy`
+ */
+bool js_sampler_write_reports(JsSampler* sampler, struct mjs* mjs, const char* script_path);
+
+#ifdef __cplusplus
+}
+#endif
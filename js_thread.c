@@ -10,9 +10,23 @@
 #include "js_thread.h"
 #include "js_thread_i.h"
 #include "js_modules.h"
+#include "js_profile.h"
+#include "js_sampler.h"
+#include "js_memstats.h"
+#include "js_latency.h"
 
 #define TAG "JS"
 
+#define JS_THREAD_STACK_SIZE     (8 * 1024)
+#define JS_THREAD_STACK_SIZE_MIN (4 * 1024)
+#define JS_THREAD_STACK_SIZE_MAX (32 * 1024)
+
+/**
+ * @brief Bytes at the start of a script that are searched for the header
+ */
+#define JS_HINTS_HEADER_LEN 256
+#define JS_HINTS_TAG        "@fastjs"
+
 struct JsThread {
     FuriThread* thread;
     FuriString* path;
@@ -20,6 +34,27 @@ struct JsThread {
     JsThreadCallback app_callback;
     void* context;
     JsModules* modules;
+    void* channel; //<! Link to the parent script, NULL unless this is a worker
+    FuriString* print_str; //<! Reused by `print`, which scripts call a lot
+
+    JsThreadResources hints;
+    size_t heap_base; //<! Heap allocated by the thread before the script starts
+    size_t heap_peak; //<! Most heap that the script has had allocated at once
+    uint32_t heap_sample_tick;
+    JsSampler* sampler; //<! NULL unless the script is being profiled
+    JsLatency* latency; //<! NULL unless the launch is being timed
+
+    uint32_t gc_count; //<! Collections requested with `runtime.gc()`
+    uint64_t gc_cycles;
+    uint32_t low_memory_watermark; //<! Free heap in bytes, 0 if there's no callback
+    bool low_memory_armed; //<! Free heap has been above the watermark since the last call
+    bool low_memory_running;
+    bool low_memory_pending; //<! The callback is due at the next native-call boundary
+    mjs_val_t low_memory_callback;
+
+#ifdef JS_PROFILE
+    JsProfiler* profiler; //<! NULL while the interpreter is torn down
+#endif
 };
 
 static void js_str_print(FuriString* msg_str, struct mjs* mjs) {
@@ -43,19 +78,19 @@ static void js_str_print(FuriString* msg_str, struct mjs* mjs) {
 }
 
 static void js_print(struct mjs* mjs) {
-    FuriString* msg_str = furi_string_alloc();
-    js_str_print(msg_str, mjs);
-
     JsThread* worker = mjs_get_context(mjs);
     furi_assert(worker);
+    FuriString* msg_str = worker->print_str;
+    furi_string_reset(msg_str);
+    js_str_print(msg_str, mjs);
+    if(worker->latency) js_latency_end_once(worker->latency, JsLatencyStageFirstPrint);
+
     if(worker->app_callback) {
         worker->app_callback(JsThreadEventPrint, furi_string_get_cstr(msg_str), worker->context);
     } else {
         FURI_LOG_D(TAG, "%s\r\n", furi_string_get_cstr(msg_str));
     }
 
-    furi_string_free(msg_str);
-
     mjs_return(mjs, MJS_UNDEFINED);
 }
 
@@ -91,7 +126,64 @@ static void js_console_debug(struct mjs* mjs) {
     mjs_return(mjs, MJS_UNDEFINED);
 }
 
+/**
+ * @brief Heap allocated by the script thread, 0 unless heap tracing is enabled
+ */
+static size_t js_heap_size(JsThread* worker) {
+    return worker->hints.heap_trace ? furi_thread_get_heap_size(worker->thread) : 0;
+}
+
+/**
+ * @brief Samples the heap usage of the script, at most once per tick
+ * @returns false if it has already been sampled during this tick
+ */
+static bool js_heap_sample(JsThread* worker) {
+    uint32_t now = furi_get_tick();
+    if(now == worker->heap_sample_tick) return false;
+    worker->heap_sample_tick = now;
+    size_t heap = js_heap_size(worker);
+    if(heap > worker->heap_peak) worker->heap_peak = heap;
+    return true;
+}
+
+/**
+ * @brief Schedules the `runtime.onLowMemory` callback once when free heap
+ * drops below the watermark. It's scheduled again only after free heap has
+ * recovered.
+ *
+ * Runs from the exec flags poller in the middle of bytecode, where calling JS
+ * is not safe, so the callback is left to `js_thread_run_deferred`.
+ */
+static void js_low_memory_check(JsThread* worker) {
+    if(!worker->low_memory_watermark || worker->low_memory_running) return;
+
+    size_t heap_free = memmgr_get_free_heap();
+    if(heap_free >= worker->low_memory_watermark) {
+        worker->low_memory_armed = true;
+        return;
+    }
+    if(!worker->low_memory_armed) return;
+
+    worker->low_memory_armed = false;
+    worker->low_memory_pending = true;
+}
+
+void js_thread_run_deferred(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    if(!worker || !worker->low_memory_pending || worker->low_memory_running) return;
+
+    worker->low_memory_pending = false;
+    worker->low_memory_running = true;
+    mjs_val_t result, free_arg = mjs_mk_number(mjs, memmgr_get_free_heap());
+    mjs_err_t error =
+        mjs_apply(mjs, &result, worker->low_memory_callback, MJS_UNDEFINED, 1, &free_arg);
+    if(error != MJS_OK) FURI_LOG_E(TAG, "onLowMemory: %s", mjs_strerror(mjs, error));
+    worker->low_memory_running = false;
+}
+
 static void js_exit_flag_poll(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    if(js_heap_sample(worker)) js_low_memory_check(worker);
     uint32_t flags = furi_thread_flags_wait(ThreadEventStop, FuriFlagWaitAny | FuriFlagNoClear, 0);
     if(flags & FuriFlagError) {
         return;
@@ -101,7 +193,14 @@ static void js_exit_flag_poll(struct mjs* mjs) {
     }
 }
 
+static void js_exit_flag_poll_sampled(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    js_sampler_sample(worker->sampler, mjs);
+    js_exit_flag_poll(mjs);
+}
+
 bool js_delay_with_flags(struct mjs* mjs, uint32_t time) {
+    js_thread_run_deferred(mjs);
     uint32_t flags =
         furi_thread_flags_wait(ThreadEventStop, FuriFlagWaitAny | FuriFlagNoClear, time);
     if(flags & FuriFlagError) {
@@ -192,7 +291,9 @@ static void js_require(struct mjs* mjs) {
     } else {
         JsThread* worker = mjs_get_context(mjs);
         furi_assert(worker);
+        if(worker->latency) js_latency_begin(worker->latency, JsLatencyStageRequire);
         req_object = js_module_require(worker->modules, name, len);
+        if(worker->latency) js_latency_end(worker->latency, JsLatencyStageRequire);
     }
     mjs_return(mjs, req_object);
 }
@@ -215,6 +316,79 @@ static void js_parse_int(struct mjs* mjs) {
     mjs_return(mjs, mjs_mk_number(mjs, num));
 }
 
+/**
+ * @brief Heap used by the script, updating the peak
+ */
+static size_t js_heap_used(JsThread* worker) {
+    size_t heap = js_heap_size(worker);
+    if(heap > worker->heap_peak) worker->heap_peak = heap;
+    return heap - MIN(worker->heap_base, heap);
+}
+
+static void js_runtime_mem_stats(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    furi_assert(worker);
+
+    JsHeapCensus census;
+    js_heap_census(mjs, &census);
+    size_t heap_used = js_heap_used(worker);
+    uint32_t gc_us =
+        (uint32_t)(worker->gc_cycles / furi_hal_cortex_instructions_per_microsecond());
+
+    mjs_val_t stats = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, stats) {
+        JS_FIELD("heapUsed", mjs_mk_number(mjs, heap_used));
+        JS_FIELD("heapPeak", mjs_mk_number(mjs, worker->heap_peak - worker->heap_base));
+        JS_FIELD("heapFree", mjs_mk_number(mjs, memmgr_get_free_heap()));
+        JS_FIELD("heapMinFree", mjs_mk_number(mjs, memmgr_get_minimum_free_heap()));
+        JS_FIELD("objects", mjs_mk_number(mjs, census.objects));
+        JS_FIELD("properties", mjs_mk_number(mjs, census.properties));
+        JS_FIELD("functions", mjs_mk_number(mjs, census.functions));
+        JS_FIELD("strings", mjs_mk_number(mjs, census.strings));
+        JS_FIELD("stringBytes", mjs_mk_number(mjs, census.string_bytes));
+        JS_FIELD("arrayBuffers", mjs_mk_number(mjs, census.array_bufs));
+        JS_FIELD("arrayBufferBytes", mjs_mk_number(mjs, census.array_buf_bytes));
+        JS_FIELD("gcCount", mjs_mk_number(mjs, worker->gc_count));
+        JS_FIELD("gcTimeUs", mjs_mk_number(mjs, gc_us));
+    }
+    mjs_return(mjs, stats);
+}
+
+static void js_runtime_gc(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    furi_assert(worker);
+
+    size_t heap_before = js_heap_size(worker);
+    uint32_t start = DWT->CYCCNT;
+    mjs_gc(mjs, 1);
+    worker->gc_cycles += DWT->CYCCNT - start;
+    worker->gc_count++;
+    size_t heap_after = js_heap_size(worker);
+
+    mjs_return(mjs, mjs_mk_number(mjs, heap_before - MIN(heap_after, heap_before)));
+}
+
+static void js_runtime_on_low_memory(struct mjs* mjs) {
+    static const JsValueDeclaration js_runtime_on_low_memory_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+    };
+    static const JsValueArguments js_runtime_on_low_memory_args =
+        JS_VALUE_ARGS(js_runtime_on_low_memory_arg_list);
+
+    int32_t watermark;
+    mjs_val_t callback;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_runtime_on_low_memory_args, &watermark, &callback);
+    if(watermark <= 0) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "watermark must be positive");
+
+    JsThread* worker = mjs_get_context(mjs);
+    furi_assert(worker);
+    worker->low_memory_watermark = watermark;
+    worker->low_memory_callback = callback;
+    worker->low_memory_armed = true;
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
 #ifdef JS_DEBUG
 static void js_dump_write_callback(void* ctx, const char* format, ...) {
     File* file = ctx;
@@ -233,16 +407,186 @@ static void js_dump_write_callback(void* ctx, const char* format, ...) {
 }
 #endif
 
+/**
+ * @brief Parses a size like `16k` or `2048`
+ * @returns 0 if the size is invalid
+ */
+static uint32_t js_hints_parse_size(const char* value) {
+    uint32_t size;
+    char* end;
+    if(strint_to_uint32(value, &end, &size, 10) != StrintParseNoError) return 0;
+    if(*end == 'k' || *end == 'K') size *= 1024;
+    return size;
+}
+
+/**
+ * @brief Reads the `// @fastjs stack=16k heap=24k profile snapshot latency` header comment
+ * of a script into the fields of `hints` that are 0
+ */
+static void js_hints_read(const char* script_path, JsThreadResources* hints) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    char header[JS_HINTS_HEADER_LEN + 1];
+    size_t header_len = 0;
+    if(storage_file_open(file, script_path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        header_len = storage_file_read(file, header, JS_HINTS_HEADER_LEN);
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    header[header_len] = '\0';
+
+    // only look at the leading comment lines
+    char* line = header;
+    while(strncmp(line, "//", 2) == 0) {
+        char* line_end = strchr(line, '\n');
+        if(line_end) *line_end = '\0';
+
+        char* tag = strstr(line, JS_HINTS_TAG);
+        if(tag) {
+            char* saveptr;
+            for(char* token = strtok_r(tag + strlen(JS_HINTS_TAG), " \t\r", &saveptr); token;
+                token = strtok_r(NULL, " \t\r", &saveptr)) {
+                if(!hints->stack_size && strncmp(token, "stack=", 6) == 0) {
+                    hints->stack_size = js_hints_parse_size(token + 6);
+                } else if(!hints->heap_size && strncmp(token, "heap=", 5) == 0) {
+                    hints->heap_size = js_hints_parse_size(token + 5);
+                } else if(strcmp(token, "profile") == 0) {
+                    hints->profile = true;
+                } else if(strcmp(token, "snapshot") == 0) {
+                    hints->heap_snapshot = true;
+                } else if(strcmp(token, "heap") == 0) {
+                    hints->heap_trace = true;
+                } else if(strcmp(token, "latency") == 0) {
+                    hints->latency = true;
+                }
+            }
+            break;
+        }
+
+        if(!line_end) break;
+        line = line_end + 1;
+    }
+}
+
+/**
+ * @brief Rounds up to whole KiB with a quarter of headroom
+ */
+static uint32_t js_hints_suggest(size_t used) {
+    return ((used + used / 4 + 1023) / 1024) * 1024;
+}
+
+/**
+ * @brief Reports the peak stack and heap usage of the script along with
+ * hints that would fit it
+ */
+static void js_report_usage(JsThread* worker) {
+    if(!worker->app_callback) return;
+
+    size_t stack_free = furi_thread_get_stack_space(furi_thread_get_current_id());
+    size_t stack_used = worker->hints.stack_size - MIN(stack_free, worker->hints.stack_size);
+    size_t heap_used = worker->heap_peak - MIN(worker->heap_base, worker->heap_peak);
+    uint32_t stack_hint = CLAMP(
+        js_hints_suggest(stack_used), JS_THREAD_STACK_SIZE_MAX, JS_THREAD_STACK_SIZE_MIN);
+
+    FuriString* usage;
+    if(worker->hints.heap_trace) {
+        usage = furi_string_alloc_printf(
+            "Peak stack %zu/%luB, heap %zuB. Suggested: // " JS_HINTS_TAG " stack=%luk heap=%luk",
+            stack_used,
+            worker->hints.stack_size,
+            heap_used,
+            stack_hint / 1024,
+            js_hints_suggest(heap_used) / 1024);
+    } else {
+        usage = furi_string_alloc_printf(
+            "Peak stack %zu/%luB. Suggested: // " JS_HINTS_TAG " stack=%luk",
+            stack_used,
+            worker->hints.stack_size,
+            stack_hint / 1024);
+    }
+    FURI_LOG_I(TAG, "%s", furi_string_get_cstr(usage));
+    worker->app_callback(JsThreadEventUsage, furi_string_get_cstr(usage), worker->context);
+    furi_string_free(usage);
+}
+
+/**
+ * @brief Reports what the script has left on the heap when it ends
+ */
+static void js_report_heap_snapshot(JsThread* worker, struct mjs* mjs) {
+    JsHeapCensus census;
+    js_heap_census(mjs, &census);
+
+    FuriString* snapshot = furi_string_alloc_printf(
+        "Heap %zuB: %lu objects, %lu properties, %lu functions, %lu strings (%luB), "
+        "%lu ArrayBuffers (%luB). %lu GCs",
+        js_heap_used(worker),
+        census.objects,
+        census.properties,
+        census.functions,
+        census.strings,
+        census.string_bytes,
+        census.array_bufs,
+        census.array_buf_bytes,
+        worker->gc_count);
+    FURI_LOG_I(TAG, "%s", furi_string_get_cstr(snapshot));
+    if(worker->app_callback) {
+        worker->app_callback(JsThreadEventUsage, furi_string_get_cstr(snapshot), worker->context);
+    }
+    furi_string_free(snapshot);
+}
+
+/**
+ * @brief Writes the launch latency trace and reports how it compares to the
+ * baseline. Comes after the script is done, since teardown is timed too.
+ */
+static void js_report_latency(JsThread* worker) {
+    FuriString* summary = furi_string_alloc();
+    js_latency_write_report(worker->latency, furi_string_get_cstr(worker->path), summary);
+    FURI_LOG_I(TAG, "%s", furi_string_get_cstr(summary));
+    if(worker->app_callback) {
+        worker->app_callback(JsThreadEventUsage, furi_string_get_cstr(summary), worker->context);
+    }
+    furi_string_free(summary);
+}
+
 static int32_t js_thread(void* arg) {
     JsThread* worker = arg;
+
+    size_t heap_free = memmgr_get_free_heap();
+    if(heap_free < worker->hints.heap_size) {
+        FuriString* error = furi_string_alloc_printf(
+            "Script needs %luB of heap, %zuB free", worker->hints.heap_size, heap_free);
+        FURI_LOG_E(TAG, "%s", furi_string_get_cstr(error));
+        if(worker->app_callback) {
+            worker->app_callback(JsThreadEventError, furi_string_get_cstr(error), worker->context);
+        }
+        furi_string_free(error);
+        return -1;
+    }
+    worker->heap_base = worker->heap_peak = js_heap_size(worker);
+    worker->heap_sample_tick = 0;
+    worker->gc_count = 0;
+    worker->gc_cycles = 0;
+    worker->low_memory_watermark = 0;
+    worker->low_memory_running = false;
+    worker->low_memory_pending = false;
+    worker->low_memory_callback = MJS_UNDEFINED;
+    if(worker->latency) js_latency_begin(worker->latency, JsLatencyStageSetup);
+
     worker->resolver = composite_api_resolver_alloc();
     composite_api_resolver_add(worker->resolver, firmware_api_interface);
     composite_api_resolver_add(worker->resolver, application_api_interface);
 
+#ifdef JS_PROFILE
+    worker->profiler = js_profiler_alloc();
+#endif
+
     struct mjs* mjs = mjs_create(worker);
     worker->modules = js_modules_create(mjs, worker->resolver);
     mjs_val_t global = mjs_get_global(mjs);
     mjs_val_t console_obj = mjs_mk_object(mjs);
+    mjs_val_t runtime_obj = mjs_mk_object(mjs);
+    mjs_own(mjs, &worker->low_memory_callback);
 
     if(worker->path) {
         FuriString* dirpath = furi_string_alloc();
@@ -270,6 +614,7 @@ static int32_t js_thread(void* arg) {
         JS_FIELD("ffi_address", MJS_MK_FN(js_ffi_address));
         JS_FIELD("require", MJS_MK_FN(js_require));
         JS_FIELD("console", console_obj);
+        JS_FIELD("runtime", runtime_obj);
 
         JS_FIELD("sdkCompatibilityStatus", MJS_MK_FN(js_sdk_compatibility_status));
         JS_FIELD("isSdkCompatible", MJS_MK_FN(js_is_sdk_compatible));
@@ -285,11 +630,25 @@ static int32_t js_thread(void* arg) {
         JS_FIELD("debug", MJS_MK_FN(js_console_debug));
     }
 
+    JS_ASSIGN_MULTI(mjs, runtime_obj) {
+        JS_FIELD("memStats", MJS_MK_FN(js_runtime_mem_stats));
+        JS_FIELD("gc", MJS_MK_FN(js_runtime_gc));
+        JS_FIELD("onLowMemory", MJS_MK_FN(js_runtime_on_low_memory));
+    }
+
     mjs_set_ffi_resolver(mjs, js_dlsym, worker->resolver);
 
-    mjs_set_exec_flags_poller(mjs, js_exit_flag_poll);
+    worker->sampler = worker->hints.profile ? js_sampler_alloc() : NULL;
+    mjs_set_exec_flags_poller(
+        mjs, worker->sampler ? js_exit_flag_poll_sampled : js_exit_flag_poll);
 
+    if(worker->latency) {
+        js_latency_end(worker->latency, JsLatencyStageSetup);
+        js_latency_begin(worker->latency, JsLatencyStageFirstPrint);
+        js_latency_begin(worker->latency, JsLatencyStageExec);
+    }
     mjs_err_t err = mjs_exec_file(mjs, furi_string_get_cstr(worker->path), NULL);
+    if(worker->latency) js_latency_end(worker->latency, JsLatencyStageExec);
 
 #ifdef JS_DEBUG
     if(furi_hal_rtc_is_flag_set(FuriHalRtcFlagDebug)) {
@@ -312,6 +671,27 @@ static int32_t js_thread(void* arg) {
     }
 #endif
 
+    js_heap_sample(worker);
+    js_report_usage(worker);
+    if(worker->hints.heap_snapshot) js_report_heap_snapshot(worker, mjs);
+
+    if(worker->sampler) {
+        js_sampler_write_reports(worker->sampler, mjs, furi_string_get_cstr(worker->path));
+        mjs_set_exec_flags_poller(mjs, js_exit_flag_poll);
+        js_sampler_free(worker->sampler);
+        worker->sampler = NULL;
+    }
+
+#ifdef JS_PROFILE
+    FuriString* profile_path = furi_string_alloc_set(worker->path);
+    furi_string_cat(profile_path, ".prof");
+    js_profiler_write_report(worker->profiler, furi_string_get_cstr(profile_path));
+    furi_string_free(profile_path);
+    // destructors are still called through trampolines, don't count them
+    JsProfiler* profiler = worker->profiler;
+    worker->profiler = NULL;
+#endif
+
     if(err != MJS_OK) {
         FURI_LOG_E(TAG, "Exec error: %s", mjs_strerror(mjs, err));
         if(worker->app_callback) {
@@ -330,28 +710,118 @@ static int32_t js_thread(void* arg) {
         }
     }
 
+    if(worker->latency) js_latency_begin(worker->latency, JsLatencyStageTeardown);
     mjs_destroy(mjs);
+#ifdef JS_PROFILE
+    js_profiler_free(profiler);
+#endif
     js_modules_destroy(worker->modules);
 
     composite_api_resolver_free(worker->resolver);
 
+    if(worker->latency) {
+        js_latency_end(worker->latency, JsLatencyStageTeardown);
+        js_report_latency(worker);
+    }
+
     return 0;
 }
 
-JsThread* js_thread_run(const char* script_path, JsThreadCallback callback, void* context) {
+static JsThread* js_thread_alloc(
+    const char* name,
+    const char* script_path,
+    const JsThreadResources* hints,
+    JsThreadCallback callback,
+    void* context,
+    void* channel) {
     JsThread* worker = malloc(sizeof(JsThread)); //-V799
     worker->path = furi_string_alloc_set(script_path);
-    worker->thread = furi_thread_alloc_ex("JsThread", 8 * 1024, js_thread, worker);
     worker->app_callback = callback;
     worker->context = context;
+    worker->channel = channel;
+    worker->print_str = furi_string_alloc();
+
+    worker->hints = hints ? *hints : (JsThreadResources){0};
+    // the header says whether to keep the trace, so always time reading it
+    worker->latency = js_latency_alloc();
+    js_latency_begin(worker->latency, JsLatencyStageHints);
+    js_hints_read(script_path, &worker->hints);
+    js_latency_end(worker->latency, JsLatencyStageHints);
+    if(!worker->hints.latency) {
+        js_latency_free(worker->latency);
+        worker->latency = NULL;
+    }
+    if(!worker->hints.stack_size) worker->hints.stack_size = JS_THREAD_STACK_SIZE;
+    worker->hints.stack_size =
+        CLAMP(worker->hints.stack_size, JS_THREAD_STACK_SIZE_MAX, JS_THREAD_STACK_SIZE_MIN);
+
+    worker->thread = furi_thread_alloc_ex(name, worker->hints.stack_size, js_thread, worker);
+    // tracing slows down every allocation, so only do it when asked to
+    if(worker->hints.heap_snapshot) worker->hints.heap_trace = true;
+    if(worker->hints.heap_trace) furi_thread_enable_heap_trace(worker->thread);
+    return worker;
+}
+
+JsThread* js_thread_run_ex(
+    const char* script_path,
+    const JsThreadResources* hints,
+    JsThreadCallback callback,
+    void* context) {
+    JsThread* worker = js_thread_alloc("JsThread", script_path, hints, callback, context, NULL);
     furi_thread_start(worker->thread);
     return worker;
 }
 
+JsThread* js_thread_run(const char* script_path, JsThreadCallback callback, void* context) {
+    return js_thread_run_ex(script_path, NULL, callback, context);
+}
+
+/**
+ * @brief Reports the output of a worker through its parent, prefixed so that
+ * it can be told apart. The worker finishing is not reported, as that's not
+ * the end of the script.
+ */
+static void js_thread_worker_callback(JsThreadEvent event, const char* msg, void* context) {
+    JsThread* parent = context;
+    if(!parent->app_callback || event == JsThreadEventDone) return;
+
+    bool is_error = event == JsThreadEventError || event == JsThreadEventErrorTrace;
+    FuriString* prefixed =
+        furi_string_alloc_printf("[worker]%s %s", is_error ? " error:" : "", msg);
+    parent->app_callback(JsThreadEventPrint, furi_string_get_cstr(prefixed), parent->context);
+    furi_string_free(prefixed);
+}
+
+JsThread* js_thread_spawn(struct mjs* mjs, const char* script_path, void* channel) {
+    JsThread* parent = mjs_get_context(mjs);
+    furi_assert(parent);
+    JsThread* worker =
+        js_thread_alloc("JsWorker", script_path, NULL, js_thread_worker_callback, parent, channel);
+    // the parent preempts the worker, which keeps its event handling responsive
+    furi_thread_set_priority(worker->thread, FuriThreadPriorityLow);
+    furi_thread_start(worker->thread);
+    return worker;
+}
+
+#ifdef JS_PROFILE
+JsProfiler* js_thread_get_profiler(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    return worker ? worker->profiler : NULL;
+}
+#endif
+
+void* js_thread_get_channel(struct mjs* mjs) {
+    JsThread* worker = mjs_get_context(mjs);
+    furi_assert(worker);
+    return worker->channel;
+}
+
 void js_thread_stop(JsThread* worker) {
     furi_thread_flags_set(furi_thread_get_id(worker->thread), ThreadEventStop);
     furi_thread_join(worker->thread);
     furi_thread_free(worker->thread);
     furi_string_free(worker->path);
+    furi_string_free(worker->print_str);
+    if(worker->latency) js_latency_free(worker->latency);
     free(worker);
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -11,12 +14,33 @@ typedef enum {
     JsThreadEventError,
     JsThreadEventPrint,
     JsThreadEventErrorTrace,
+    JsThreadEventUsage, //<! Resource usage summary and suggested hints
 } JsThreadEvent;
 
+/**
+ * @brief Resource hints of a script. A field that's 0 is taken from the
+ * `// @fastjs stack=16k heap=24k profile snapshot latency` header comment of the
+ * script, or defaults. The `heap` token on its own enables `heap_trace`.
+ */
+typedef struct {
+    uint32_t stack_size; //<! Stack size of the JS thread in bytes
+    uint32_t heap_size; //<! Heap that must be free before the script starts
+    bool profile; //<! Sample the script, see `js_sampler.h`
+    bool heap_snapshot; //<! Report what's left on the heap when the script ends
+    bool heap_trace; //<! Track the heap of the script thread, implied by `heap_snapshot`
+    bool latency; //<! Time the stages of the launch, see `js_latency.h`
+} JsThreadResources;
+
 typedef void (*JsThreadCallback)(JsThreadEvent event, const char* msg, void* context);
 
 JsThread* js_thread_run(const char* script_path, JsThreadCallback callback, void* context);
 
+JsThread* js_thread_run_ex(
+    const char* script_path,
+    const JsThreadResources* hints,
+    JsThreadCallback callback,
+    void* context);
+
 void js_thread_stop(JsThread* worker);
 
 #ifdef __cplusplus
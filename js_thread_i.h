@@ -10,6 +10,7 @@
 #include <mjs_util_public.h>
 #include <mjs_primitive_public.h>
 #include <mjs_array_buf_public.h>
+#include "js_thread.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,12 +23,35 @@ typedef enum {
     ThreadEventCustomDataRx = (1 << 1),
 } WorkerEventFlags;
 
+/**
+ * @brief Runs JS callbacks that were deferred because they came up in the
+ * middle of bytecode, such as `runtime.onLowMemory`. Native code calls it
+ * wherever JS may safely run, e.g. between event loop callbacks.
+ */
+void js_thread_run_deferred(struct mjs* mjs);
+
 bool js_delay_with_flags(struct mjs* mjs, uint32_t time);
 
 void js_flags_set(struct mjs* mjs, uint32_t flags);
 
 uint32_t js_flags_wait(struct mjs* mjs, uint32_t flags, uint32_t timeout);
 
+/**
+ * @brief Runs a worker script on its own thread, with its own interpreter and
+ * modules. The worker runs at a lower priority than its parent, and its
+ * output is reported through the parent. Stop it with `js_thread_stop`.
+ *
+ * @param mjs Interpreter of the parent script
+ * @param channel Opaque link to the parent, see `js_thread_get_channel`
+ */
+JsThread* js_thread_spawn(struct mjs* mjs, const char* script_path, void* channel);
+
+/**
+ * @brief Gets the channel that a worker was spawned with
+ * @returns NULL if the script isn't a worker
+ */
+void* js_thread_get_channel(struct mjs* mjs);
+
 #ifdef __cplusplus
 }
 #endif
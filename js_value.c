@@ -277,6 +277,10 @@ JsValueParseStatus js_value_parse(
     UNUSED(js_value_resulting_c_values_count);
 #endif
 
+#ifdef JS_PROFILE
+    uint32_t start = JS_PROFILE_CYCLES();
+#endif
+
     va_list out_pointers;
     va_start(out_pointers, n_c_vals);
 
@@ -287,5 +291,9 @@ JsValueParseStatus js_value_parse(
 
     va_end(out_pointers);
 
+#ifdef JS_PROFILE
+    js_profiler_add_parse_time(mjs, JS_PROFILE_CYCLES() - start);
+#endif
+
     return status;
 }
@@ -1,57 +1,94 @@
 #include <core/common_defines.h>
-#include "../js_modules.h"
+#include "js_badusb.h"
 #include <furi_hal.h>
+#include <m-array.h>
+#include <toolbox/path.h>
+#include <toolbox/strint.h>
 
-#define ASCII_TO_KEY(layout, x) (((uint8_t)x < 128) ? (layout[(uint8_t)x]) : HID_KEYBOARD_NONE)
+#define TAG "JsBadusb"
+
+#define ASCII_TO_KEY(layout, x) \
+    (((uint8_t)x < 128) ? ((layout).ascii[(uint8_t)x]) : HID_KEYBOARD_NONE)
+
+#define LAYOUT_ASCII_SIZE  128
+#define LAYOUT_UTF8_MAX    96 //<! Max number of non-ASCII code points in a layout
+#define LAYOUT_UTF8_ENTRY  6 //<! u32 code point + u16 keycode in a layout file
+#define LAYOUT_CACHE_SIZE  2
+#define LAYOUT_PATH_MAX    128
+#define UTF8_REPLACEMENT   0xFFFD
+
+typedef struct {
+    uint32_t code_point;
+    uint16_t keycode;
+} BadusbUtf8Key;
+
+/**
+ * @brief Keyboard layout
+ *
+ * Layout files start with 128 little-endian keycodes for ASCII characters,
+ * optionally followed by `{u32 code point, u16 keycode}` pairs for other
+ * Unicode characters. The pairs are kept sorted by code point in memory.
+ */
+typedef struct {
+    uint16_t ascii[LAYOUT_ASCII_SIZE];
+    uint16_t utf8_count;
+    BadusbUtf8Key utf8[LAYOUT_UTF8_MAX];
+} BadusbLayout;
+
+/**
+ * @brief Layouts loaded by previous `setup()` calls, keyed by path, size and
+ * modification time
+ *
+ * Kept at module scope, so it outlives module instances and saves the read
+ * when the next script sets up the same layout. Workers run scripts on other
+ * threads, so entries are only touched inside a critical section.
+ */
+typedef struct {
+    char path[LAYOUT_PATH_MAX];
+    uint32_t timestamp;
+    uint64_t size;
+    uint32_t last_used;
+    BadusbLayout layout;
+} BadusbLayoutCacheEntry;
+
+typedef struct {
+    uint32_t use_counter;
+    BadusbLayoutCacheEntry entries[LAYOUT_CACHE_SIZE];
+} BadusbLayoutCache;
+
+static BadusbLayoutCache badusb_layout_cache;
 
 typedef struct {
     FuriHalUsbHidConfig* hid_cfg;
-    uint16_t layout[128];
+    BadusbLayout layout;
     FuriHalUsbInterface* usb_if_prev;
     uint8_t key_hold_cnt;
 } JsBadusbInst;
 
+/**
+ * @brief Key names, sorted by `strcmp` order for binary search
+ * @warning Keep this table sorted when adding keys
+ */
 static const struct {
-    char* name;
+    const char* name;
     uint16_t code;
 } key_codes[] = {
-    {"CTRL", KEY_MOD_LEFT_CTRL},
-    {"SHIFT", KEY_MOD_LEFT_SHIFT},
     {"ALT", KEY_MOD_LEFT_ALT},
-    {"GUI", KEY_MOD_LEFT_GUI},
-
-    {"DOWN", HID_KEYBOARD_DOWN_ARROW},
-    {"LEFT", HID_KEYBOARD_LEFT_ARROW},
-    {"RIGHT", HID_KEYBOARD_RIGHT_ARROW},
-    {"UP", HID_KEYBOARD_UP_ARROW},
-
-    {"ENTER", HID_KEYBOARD_RETURN},
-    {"PAUSE", HID_KEYBOARD_PAUSE},
+    {"APP", HID_KEYBOARD_APPLICATION},
+    {"BACKSPACE", HID_KEYBOARD_DELETE},
+    {"BREAK", HID_KEYBOARD_PAUSE},
     {"CAPSLOCK", HID_KEYBOARD_CAPS_LOCK},
+    {"COMMAND", KEY_MOD_LEFT_GUI},
+    {"CONTROL", KEY_MOD_LEFT_CTRL},
+    {"CTRL", KEY_MOD_LEFT_CTRL},
     {"DELETE", HID_KEYBOARD_DELETE_FORWARD},
-    {"BACKSPACE", HID_KEYBOARD_DELETE},
+    {"DOWN", HID_KEYBOARD_DOWN_ARROW},
+    {"DOWNARROW", HID_KEYBOARD_DOWN_ARROW},
     {"END", HID_KEYBOARD_END},
+    {"ENTER", HID_KEYBOARD_RETURN},
     {"ESC", HID_KEYBOARD_ESCAPE},
-    {"HOME", HID_KEYBOARD_HOME},
-    {"INSERT", HID_KEYBOARD_INSERT},
-    {"NUMLOCK", HID_KEYPAD_NUMLOCK},
-    {"PAGEUP", HID_KEYBOARD_PAGE_UP},
-    {"PAGEDOWN", HID_KEYBOARD_PAGE_DOWN},
-    {"PRINTSCREEN", HID_KEYBOARD_PRINT_SCREEN},
-    {"SCROLLLOCK", HID_KEYBOARD_SCROLL_LOCK},
-    {"SPACE", HID_KEYBOARD_SPACEBAR},
-    {"TAB", HID_KEYBOARD_TAB},
-    {"MENU", HID_KEYBOARD_APPLICATION},
-
+    {"ESCAPE", HID_KEYBOARD_ESCAPE},
     {"F1", HID_KEYBOARD_F1},
-    {"F2", HID_KEYBOARD_F2},
-    {"F3", HID_KEYBOARD_F3},
-    {"F4", HID_KEYBOARD_F4},
-    {"F5", HID_KEYBOARD_F5},
-    {"F6", HID_KEYBOARD_F6},
-    {"F7", HID_KEYBOARD_F7},
-    {"F8", HID_KEYBOARD_F8},
-    {"F9", HID_KEYBOARD_F9},
     {"F10", HID_KEYBOARD_F10},
     {"F11", HID_KEYBOARD_F11},
     {"F12", HID_KEYBOARD_F12},
@@ -62,12 +99,25 @@ static const struct {
     {"F17", HID_KEYBOARD_F17},
     {"F18", HID_KEYBOARD_F18},
     {"F19", HID_KEYBOARD_F19},
+    {"F2", HID_KEYBOARD_F2},
     {"F20", HID_KEYBOARD_F20},
     {"F21", HID_KEYBOARD_F21},
     {"F22", HID_KEYBOARD_F22},
     {"F23", HID_KEYBOARD_F23},
     {"F24", HID_KEYBOARD_F24},
-
+    {"F3", HID_KEYBOARD_F3},
+    {"F4", HID_KEYBOARD_F4},
+    {"F5", HID_KEYBOARD_F5},
+    {"F6", HID_KEYBOARD_F6},
+    {"F7", HID_KEYBOARD_F7},
+    {"F8", HID_KEYBOARD_F8},
+    {"F9", HID_KEYBOARD_F9},
+    {"GUI", KEY_MOD_LEFT_GUI},
+    {"HOME", HID_KEYBOARD_HOME},
+    {"INSERT", HID_KEYBOARD_INSERT},
+    {"LEFT", HID_KEYBOARD_LEFT_ARROW},
+    {"LEFTARROW", HID_KEYBOARD_LEFT_ARROW},
+    {"MENU", HID_KEYBOARD_APPLICATION},
     {"NUM0", HID_KEYPAD_0},
     {"NUM1", HID_KEYPAD_1},
     {"NUM2", HID_KEYPAD_2},
@@ -78,6 +128,21 @@ static const struct {
     {"NUM7", HID_KEYPAD_7},
     {"NUM8", HID_KEYPAD_8},
     {"NUM9", HID_KEYPAD_9},
+    {"NUMLOCK", HID_KEYPAD_NUMLOCK},
+    {"PAGEDOWN", HID_KEYBOARD_PAGE_DOWN},
+    {"PAGEUP", HID_KEYBOARD_PAGE_UP},
+    {"PAUSE", HID_KEYBOARD_PAUSE},
+    {"PRINTSCREEN", HID_KEYBOARD_PRINT_SCREEN},
+    {"RETURN", HID_KEYBOARD_RETURN},
+    {"RIGHT", HID_KEYBOARD_RIGHT_ARROW},
+    {"RIGHTARROW", HID_KEYBOARD_RIGHT_ARROW},
+    {"SCROLLLOCK", HID_KEYBOARD_SCROLL_LOCK},
+    {"SHIFT", KEY_MOD_LEFT_SHIFT},
+    {"SPACE", HID_KEYBOARD_SPACEBAR},
+    {"TAB", HID_KEYBOARD_TAB},
+    {"UP", HID_KEYBOARD_UP_ARROW},
+    {"UPARROW", HID_KEYBOARD_UP_ARROW},
+    {"WINDOWS", KEY_MOD_LEFT_GUI},
 };
 
 static void js_badusb_quit_free(JsBadusbInst* badusb) {
@@ -92,6 +157,171 @@ static void js_badusb_quit_free(JsBadusbInst* badusb) {
     }
 }
 
+// ================
+// Keyboard layouts
+// ================
+
+static void badusb_layout_set_default(BadusbLayout* layout) {
+    memcpy(layout->ascii, hid_asciimap, MIN(sizeof(hid_asciimap), sizeof(layout->ascii)));
+    layout->utf8_count = 0;
+}
+
+static bool badusb_layout_read(File* file, BadusbLayout* layout) {
+    if(storage_file_read(file, layout->ascii, sizeof(layout->ascii)) != sizeof(layout->ascii))
+        return false;
+
+    layout->utf8_count = 0;
+    uint8_t entry[LAYOUT_UTF8_ENTRY];
+    while(storage_file_read(file, entry, sizeof(entry)) == sizeof(entry)) {
+        if(layout->utf8_count == LAYOUT_UTF8_MAX) {
+            FURI_LOG_W(TAG, "Layout has more than %d Unicode keys", LAYOUT_UTF8_MAX);
+            break;
+        }
+        BadusbUtf8Key key = {
+            .code_point = entry[0] | (entry[1] << 8) | (entry[2] << 16) |
+                          ((uint32_t)entry[3] << 24),
+            .keycode = entry[4] | (entry[5] << 8),
+        };
+
+        // insertion sort, tables are small and usually already sorted
+        size_t pos = layout->utf8_count;
+        while(pos > 0 && layout->utf8[pos - 1].code_point > key.code_point) {
+            layout->utf8[pos] = layout->utf8[pos - 1];
+            pos--;
+        }
+        layout->utf8[pos] = key;
+        layout->utf8_count++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Loads a layout file, going through the module layout cache
+ */
+static bool badusb_layout_load(const char* path, BadusbLayout* layout) {
+    BadusbLayoutCache* cache = &badusb_layout_cache;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    FileInfo info;
+    uint32_t timestamp;
+    bool cacheable = strlen(path) < LAYOUT_PATH_MAX &&
+                     storage_common_stat(storage, path, &info) == FSE_OK &&
+                     storage_common_timestamp(storage, path, &timestamp) == FSE_OK;
+
+    if(cacheable) {
+        bool hit = false;
+        FURI_CRITICAL_ENTER();
+        cache->use_counter++;
+        for(size_t i = 0; i < LAYOUT_CACHE_SIZE; i++) {
+            BadusbLayoutCacheEntry* entry = &cache->entries[i];
+            if(entry->size == info.size && entry->timestamp == timestamp &&
+               strcmp(entry->path, path) == 0) {
+                entry->last_used = cache->use_counter;
+                memcpy(layout, &entry->layout, sizeof(BadusbLayout));
+                hit = true;
+                break;
+            }
+        }
+        FURI_CRITICAL_EXIT();
+        if(hit) {
+            furi_record_close(RECORD_STORAGE);
+            return true;
+        }
+    }
+
+    File* file = storage_file_alloc(storage);
+    bool loaded = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                  badusb_layout_read(file, layout);
+    storage_file_free(file);
+
+    if(cacheable && loaded) {
+        FURI_CRITICAL_ENTER();
+        // evict the least recently used entry
+        BadusbLayoutCacheEntry* victim = &cache->entries[0];
+        for(size_t i = 1; i < LAYOUT_CACHE_SIZE; i++) {
+            if(cache->entries[i].last_used < victim->last_used) victim = &cache->entries[i];
+        }
+        strlcpy(victim->path, path, sizeof(victim->path));
+        victim->size = info.size;
+        victim->timestamp = timestamp;
+        victim->last_used = cache->use_counter;
+        memcpy(&victim->layout, layout, sizeof(BadusbLayout));
+        FURI_CRITICAL_EXIT();
+    }
+
+    furi_record_close(RECORD_STORAGE);
+    return loaded;
+}
+
+/**
+ * @brief Decodes one UTF-8 sequence at `text[*pos]` and advances `*pos`
+ * @returns The code point, `UTF8_REPLACEMENT` for malformed input
+ */
+static uint32_t badusb_utf8_decode(const char* text, size_t len, size_t* pos) {
+    uint8_t lead = text[(*pos)++];
+    if(lead < 0x80) return lead;
+
+    size_t extra;
+    uint32_t code_point;
+    if((lead & 0xE0) == 0xC0) {
+        extra = 1;
+        code_point = lead & 0x1F;
+    } else if((lead & 0xF0) == 0xE0) {
+        extra = 2;
+        code_point = lead & 0x0F;
+    } else if((lead & 0xF8) == 0xF0) {
+        extra = 3;
+        code_point = lead & 0x07;
+    } else {
+        return UTF8_REPLACEMENT;
+    }
+
+    for(size_t i = 0; i < extra; i++) {
+        if(*pos >= len || ((uint8_t)text[*pos] & 0xC0) != 0x80) return UTF8_REPLACEMENT;
+        code_point = (code_point << 6) | ((uint8_t)text[(*pos)++] & 0x3F);
+    }
+    return code_point;
+}
+
+static uint16_t badusb_keycode_by_code_point(const BadusbLayout* layout, uint32_t code_point) {
+    if(code_point < LAYOUT_ASCII_SIZE) return layout->ascii[code_point];
+
+    size_t low = 0, high = layout->utf8_count;
+    while(low < high) {
+        size_t mid = (low + high) / 2;
+        uint32_t mid_code_point = layout->utf8[mid].code_point;
+        if(mid_code_point == code_point) return layout->utf8[mid].keycode;
+        if(mid_code_point < code_point) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return HID_KEYBOARD_NONE;
+}
+
+/**
+ * @brief Binary search over `key_codes`
+ */
+static uint16_t badusb_keycode_by_key_name(const char* key_name, size_t name_len) {
+    size_t low = 0, high = COUNT_OF(key_codes);
+    while(low < high) {
+        size_t mid = (low + high) / 2;
+        const char* mid_name = key_codes[mid].name;
+        int cmp = strncmp(key_name, mid_name, name_len);
+        // `key_name` is a prefix of `mid_name`, so it goes first
+        if(cmp == 0 && mid_name[name_len] != '\0') cmp = -1;
+        if(cmp == 0) return key_codes[mid].code;
+        if(cmp > 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return HID_KEYBOARD_NONE;
+}
+
 static bool setup_parse_params(
     JsBadusbInst* badusb,
     struct mjs* mjs,
@@ -137,17 +367,11 @@ static bool setup_parse_params(
         if((str_len == 0) || (str_temp == NULL)) {
             return false;
         }
-        File* file = storage_file_alloc(furi_record_open(RECORD_STORAGE));
-        bool layout_loaded = storage_file_open(file, str_temp, FSAM_READ, FSOM_OPEN_EXISTING) &&
-                             storage_file_read(file, badusb->layout, sizeof(badusb->layout)) ==
-                                 sizeof(badusb->layout);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        if(!layout_loaded) {
+        if(!badusb_layout_load(str_temp, &badusb->layout)) {
             return false;
         }
     } else {
-        memcpy(badusb->layout, hid_asciimap, MIN(sizeof(hid_asciimap), sizeof(badusb->layout)));
+        badusb_layout_set_default(&badusb->layout);
     }
 
     return true;
@@ -228,18 +452,14 @@ uint16_t get_keycode_by_name(JsBadusbInst* badusb, const char* key_name, size_t
         return (ASCII_TO_KEY(badusb->layout, key_name[0]));
     }
 
-    for(size_t i = 0; i < COUNT_OF(key_codes); i++) {
-        size_t key_cmd_len = strlen(key_codes[i].name);
-        if(key_cmd_len != name_len) {
-            continue;
-        }
-
-        if(strncmp(key_name, key_codes[i].name, name_len) == 0) {
-            return key_codes[i].code;
-        }
+    if((uint8_t)key_name[0] & 0x80) { // Single non-ASCII char
+        size_t pos = 0;
+        uint32_t code_point = badusb_utf8_decode(key_name, name_len, &pos);
+        if(pos != name_len) return HID_KEYBOARD_NONE;
+        return badusb_keycode_by_code_point(&badusb->layout, code_point);
     }
 
-    return HID_KEYBOARD_NONE;
+    return badusb_keycode_by_key_name(key_name, name_len);
 }
 
 static bool parse_keycode(JsBadusbInst* badusb, struct mjs* mjs, size_t nargs, uint16_t* keycode) {
@@ -447,14 +667,15 @@ static void badusb_print(struct mjs* mjs, bool ln, bool alt) {
     if(alt) {
         ducky_numlock_on();
     }
-    for(size_t i = 0; i < text_len; i++) {
+    for(size_t i = 0; i < text_len;) {
         if(alt) {
             // Convert character to ascii numeric value
             char ascii_str[4];
-            snprintf(ascii_str, sizeof(ascii_str), "%u", (uint8_t)text_str[i]);
+            snprintf(ascii_str, sizeof(ascii_str), "%u", (uint8_t)text_str[i++]);
             ducky_altchar(badusb, ascii_str);
         } else {
-            uint16_t keycode = ASCII_TO_KEY(badusb->layout, text_str[i]);
+            uint32_t code_point = badusb_utf8_decode(text_str, text_len, &i);
+            uint16_t keycode = badusb_keycode_by_code_point(&badusb->layout, code_point);
             furi_hal_hid_kb_press(keycode);
             furi_hal_hid_kb_release(keycode);
         }
@@ -490,9 +711,670 @@ static void js_badusb_alt_println(struct mjs* mjs) {
     badusb_print(mjs, true, true);
 }
 
-static void* js_badusb_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+// =====================
+// Macro compiler/player
+// =====================
+
+#define MACRO_MAGIC         0x434D4442 // "BDMC"
+#define MACRO_VERSION       2
+#define MACRO_LINE_MAX      256
+#define MACRO_TOKENS_MAX    8
+#define MACRO_STOP_POLL_OPS 32
+
+/**
+ * @brief Instructions of a compiled macro
+ *
+ * Every instruction is a one-byte opcode followed by little-endian operands.
+ * Key names are resolved at compile time, so playback never touches strings.
+ */
+typedef enum {
+    MacroOpPress = 0x01, //<! u16 keycode
+    MacroOpHold = 0x02, //<! u16 keycode
+    MacroOpRelease = 0x03, //<! u16 keycode
+    MacroOpReleaseAll = 0x04, //<! no operands
+    MacroOpDelay = 0x05, //<! u32 milliseconds
+    MacroOpDefaultDelay = 0x06, //<! u32 milliseconds
+    MacroOpType = 0x07, //<! u16 char delay, u16 count, count * u16 keycodes
+    MacroOpAltType = 0x08, //<! u16 char delay, u16 count, count * u8 chars
+    MacroOpRepeat = 0x09, //<! u16 count, u16 distance back to the repeated line, u16 its length
+} MacroOp;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t source_hash; //<! Hash of the source text and the layout it was compiled with
+    uint32_t code_size;
+} MacroHeader;
+
+ARRAY_DEF(MacroCode, uint8_t, M_BASIC_OPLIST); //-V575
+
+static uint32_t macro_hash(uint32_t hash, const void* data, size_t len) {
+    // FNV-1a
+    const uint8_t* bytes = data;
+    for(size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes macro text with the layout it was compiled for
+ *
+ * `BadusbUtf8Key` has padding, so its fields are hashed one by one.
+ */
+static uint32_t macro_source_hash(JsBadusbInst* badusb, const char* text, size_t text_len) {
+    const BadusbLayout* layout = &badusb->layout;
+    uint32_t hash = macro_hash(2166136261UL, text, text_len);
+    hash = macro_hash(hash, layout->ascii, sizeof(layout->ascii));
+    for(size_t i = 0; i < layout->utf8_count; i++) {
+        const BadusbUtf8Key* key = &layout->utf8[i];
+        hash = macro_hash(hash, &key->code_point, sizeof(key->code_point));
+        hash = macro_hash(hash, &key->keycode, sizeof(key->keycode));
+    }
+    return hash;
+}
+
+static void macro_emit_u8(MacroCode_t code, uint8_t value) {
+    MacroCode_push_back(code, value);
+}
+
+static void macro_emit_u16(MacroCode_t code, uint16_t value) {
+    MacroCode_push_back(code, value & 0xFF);
+    MacroCode_push_back(code, value >> 8);
+}
+
+static void macro_emit_u32(MacroCode_t code, uint32_t value) {
+    macro_emit_u16(code, value & 0xFFFF);
+    macro_emit_u16(code, value >> 16);
+}
+
+static uint16_t macro_read_u16(const uint8_t* ptr) {
+    return ptr[0] | (ptr[1] << 8);
+}
+
+static uint32_t macro_read_u32(const uint8_t* ptr) {
+    return macro_read_u16(ptr) | ((uint32_t)macro_read_u16(ptr + 2) << 16);
+}
+
+/**
+ * @brief Resolves a space-separated key combination, e.g. `CTRL-ALT DELETE`
+ * @returns false if a key is unknown or more than one main key is given
+ */
+static bool macro_parse_combo(JsBadusbInst* badusb, const char* combo, uint16_t* keycode) {
+    uint16_t key_tmp = 0;
+    size_t token_cnt = 0;
+    const char* cursor = combo;
+
+    while(*cursor) {
+        while(*cursor == ' ') cursor++;
+        if(!*cursor) break;
+
+        // '-' joins modifiers ("CTRL-ALT"), unless it is the key itself
+        const char* start = cursor;
+        while(*cursor && *cursor != ' ' && !(*cursor == '-' && cursor != start)) cursor++;
+        size_t token_len = cursor - start;
+        if(*cursor == '-') cursor++;
+
+        if(++token_cnt > MACRO_TOKENS_MAX) return false;
+        uint16_t key = get_keycode_by_name(badusb, start, token_len);
+        if(key == HID_KEYBOARD_NONE) return false;
+        if((key & 0xFF) && (key_tmp & 0xFF)) return false;
+        key_tmp |= key;
+    }
+
+    if(key_tmp == 0) return false;
+    *keycode = key_tmp;
+    return true;
+}
+
+static bool macro_parse_uint(const char* str, uint32_t* value) {
+    if(!*str) return false;
+    return strint_to_uint32(str, NULL, value, 10) == StrintParseNoError;
+}
+
+/**
+ * @brief Checks whether `line` starts with the command `cmd` and returns its
+ * argument. Commands without arguments match only if nothing follows them.
+ */
+static const char* macro_match_cmd(const char* line, const char* cmd) {
+    size_t cmd_len = strlen(cmd);
+    if(strncmp(line, cmd, cmd_len) != 0) return NULL;
+    if(line[cmd_len] == '\0') return &line[cmd_len];
+    if(line[cmd_len] != ' ') return NULL;
+    return &line[cmd_len + 1];
+}
+
+static bool macro_emit_type(
+    JsBadusbInst* badusb,
+    MacroCode_t code,
+    const char* text,
+    uint16_t char_delay,
+    bool alt) {
+    size_t len = strlen(text);
+    if(len == 0 || len > UINT16_MAX) return false;
+
+    macro_emit_u8(code, alt ? MacroOpAltType : MacroOpType);
+    macro_emit_u16(code, char_delay);
+    size_t count_offset = MacroCode_size(code);
+    macro_emit_u16(code, 0);
+
+    size_t count = 0;
+    for(size_t i = 0; i < len; count++) {
+        if(alt) {
+            macro_emit_u8(code, text[i++]);
+        } else {
+            uint32_t code_point = badusb_utf8_decode(text, len, &i);
+            uint16_t keycode = badusb_keycode_by_code_point(&badusb->layout, code_point);
+            if(keycode == HID_KEYBOARD_NONE) return false;
+            macro_emit_u16(code, keycode);
+        }
+    }
+
+    *MacroCode_get(code, count_offset) = count & 0xFF;
+    *MacroCode_get(code, count_offset + 1) = count >> 8;
+    return true;
+}
+
+/**
+ * @brief Code of the last line that REPEAT can repeat
+ */
+typedef struct {
+    size_t start; //<! SIZE_MAX if there is none yet
+    size_t end;
+} MacroLine;
+
+/**
+ * @brief Compiles a single macro line
+ * @returns false on syntax error
+ */
+static bool macro_compile_line(
+    JsBadusbInst* badusb,
+    MacroCode_t code,
+    const char* line,
+    MacroLine* last_line,
+    uint16_t* string_delay) {
+    const char* arg;
+    uint32_t number;
+    size_t cmd_start = MacroCode_size(code);
+
+    if(line[0] == '\0' || macro_match_cmd(line, "REM")) {
+        return true;
+
+    } else if((arg = macro_match_cmd(line, "DEFAULT_DELAY")) ||
+              (arg = macro_match_cmd(line, "DEFAULTDELAY"))) {
+        if(!macro_parse_uint(arg, &number)) return false;
+        macro_emit_u8(code, MacroOpDefaultDelay);
+        macro_emit_u32(code, number);
+        return true;
+
+    } else if(
+        (arg = macro_match_cmd(line, "STRING_DELAY")) ||
+        (arg = macro_match_cmd(line, "STRINGDELAY"))) {
+        if(!macro_parse_uint(arg, &number) || number > UINT16_MAX) return false;
+        *string_delay = number;
+        return true;
+
+    } else if((arg = macro_match_cmd(line, "DELAY"))) {
+        if(!macro_parse_uint(arg, &number)) return false;
+        macro_emit_u8(code, MacroOpDelay);
+        macro_emit_u32(code, number);
+
+    } else if((arg = macro_match_cmd(line, "REPEAT"))) {
+        if(!macro_parse_uint(arg, &number) || number > UINT16_MAX) return false;
+        if(last_line->start == SIZE_MAX || cmd_start - last_line->start > UINT16_MAX)
+            return false;
+        // the whole line is repeated, e.g. both the text and Enter of STRINGLN
+        macro_emit_u8(code, MacroOpRepeat);
+        macro_emit_u16(code, number);
+        macro_emit_u16(code, cmd_start - last_line->start);
+        macro_emit_u16(code, last_line->end - last_line->start);
+        // the repeated line stays the same, so that REPEAT can follow REPEAT
+        return true;
+
+    } else if(
+        (arg = macro_match_cmd(line, "STRINGLN")) || (arg = macro_match_cmd(line, "STRING"))) {
+        bool ln = (line[6] == 'L');
+        if(!macro_emit_type(badusb, code, arg, *string_delay, false)) return false;
+        if(ln) {
+            macro_emit_u8(code, MacroOpPress);
+            macro_emit_u16(code, HID_KEYBOARD_RETURN);
+        }
+        *string_delay = 0;
+
+    } else if(
+        (arg = macro_match_cmd(line, "ALTSTRINGLN")) ||
+        (arg = macro_match_cmd(line, "ALTSTRING"))) {
+        bool ln = (line[9] == 'L');
+        if(!macro_emit_type(badusb, code, arg, *string_delay, true)) return false;
+        if(ln) {
+            macro_emit_u8(code, MacroOpPress);
+            macro_emit_u16(code, HID_KEYBOARD_RETURN);
+        }
+        *string_delay = 0;
+
+    } else if((arg = macro_match_cmd(line, "HOLD"))) {
+        uint16_t keycode;
+        if(!macro_parse_combo(badusb, arg, &keycode)) return false;
+        macro_emit_u8(code, MacroOpHold);
+        macro_emit_u16(code, keycode);
+
+    } else if((arg = macro_match_cmd(line, "RELEASE"))) {
+        if(*arg == '\0') {
+            macro_emit_u8(code, MacroOpReleaseAll);
+        } else {
+            uint16_t keycode;
+            if(!macro_parse_combo(badusb, arg, &keycode)) return false;
+            macro_emit_u8(code, MacroOpRelease);
+            macro_emit_u16(code, keycode);
+        }
+
+    } else {
+        // anything else is a key combination
+        uint16_t keycode;
+        if(!macro_parse_combo(badusb, line, &keycode)) return false;
+        macro_emit_u8(code, MacroOpPress);
+        macro_emit_u16(code, keycode);
+    }
+
+    last_line->start = cmd_start;
+    last_line->end = MacroCode_size(code);
+    return true;
+}
+
+/**
+ * @brief Compiles macro text into `code`, prepending a `MacroHeader`
+ * @returns 0 on success, otherwise the number of the offending line
+ */
+static size_t
+    macro_compile(JsBadusbInst* badusb, const char* text, size_t text_len, MacroCode_t code) {
+    MacroHeader header = {
+        .magic = MACRO_MAGIC,
+        .version = MACRO_VERSION,
+        .source_hash = macro_source_hash(badusb, text, text_len),
+    };
+    for(size_t i = 0; i < sizeof(header); i++)
+        macro_emit_u8(code, 0);
+
+    char line[MACRO_LINE_MAX];
+    size_t line_num = 0;
+    MacroLine last_line = {.start = SIZE_MAX};
+    uint16_t string_delay = 0;
+    const char* cursor = text;
+    const char* text_end = text + text_len;
+
+    while(cursor < text_end) {
+        line_num++;
+        const char* line_end = memchr(cursor, '\n', text_end - cursor);
+        if(!line_end) line_end = text_end;
+        size_t line_len = line_end - cursor;
+
+        // trim indentation and CR, but not trailing spaces, which STRING types
+        while(line_len && (*cursor == ' ' || *cursor == '\t')) {
+            cursor++;
+            line_len--;
+        }
+        if(line_len && cursor[line_len - 1] == '\r') line_len--;
+        if(line_len >= sizeof(line)) return line_num;
+        memcpy(line, cursor, line_len);
+        line[line_len] = '\0';
+
+        if(!macro_compile_line(badusb, code, line, &last_line, &string_delay)) return line_num;
+        cursor = line_end + 1;
+    }
+
+    header.code_size = MacroCode_size(code) - sizeof(header);
+    memcpy(MacroCode_get(code, 0), &header, sizeof(header));
+    return 0;
+}
+
+static bool macro_cache_load(const char* path, uint32_t source_hash, MacroCode_t code) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool loaded = false;
+
+    do {
+        if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+        MacroHeader header;
+        if(storage_file_read(file, &header, sizeof(header)) != sizeof(header)) break;
+        if(header.magic != MACRO_MAGIC || header.version != MACRO_VERSION) break;
+        if(header.source_hash != source_hash) break;
+        if(storage_file_size(file) != sizeof(header) + header.code_size) break;
+
+        MacroCode_resize(code, sizeof(header) + header.code_size);
+        memcpy(MacroCode_get(code, 0), &header, sizeof(header));
+        if(storage_file_read(file, MacroCode_get(code, sizeof(header)), header.code_size) !=
+           header.code_size)
+            break;
+        loaded = true;
+    } while(0);
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return loaded;
+}
+
+static void macro_cache_save(const char* path, MacroCode_t code) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    FuriString* dir_path = furi_string_alloc();
+    path_extract_dirname(path, dir_path);
+    storage_simply_mkdir(storage, furi_string_get_cstr(dir_path));
+    furi_string_free(dir_path);
+
+    size_t size = MacroCode_size(code);
+    if(!storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       storage_file_write(file, MacroCode_get(code, 0), size) != size) {
+        FURI_LOG_W(TAG, "Failed to cache macro to %s", path);
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void js_badusb_compile(struct mjs* mjs) {
+    static const JsValueDeclaration js_badusb_compile_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeString),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeString, str_val, NULL),
+    };
+    static const JsValueArguments js_badusb_compile_args =
+        JS_VALUE_ARGS(js_badusb_compile_arg_list);
+
+    const char* text;
+    const char* cache_path;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_badusb_compile_args, &text, &cache_path);
+
+    JsBadusbInst* badusb = JS_GET_CONTEXT(mjs);
+    size_t text_len = strlen(text);
+
+    MacroCode_t code;
+    MacroCode_init(code);
+
+    bool cached = cache_path &&
+                  macro_cache_load(cache_path, macro_source_hash(badusb, text, text_len), code);
+    if(!cached) {
+        MacroCode_reset(code);
+        size_t error_line = macro_compile(badusb, text, text_len, code);
+        if(error_line) {
+            MacroCode_clear(code);
+            JS_ERROR_AND_RETURN(
+                mjs, MJS_BAD_ARGS_ERROR, "macro line %zu: syntax error", error_line);
+        }
+        if(cache_path) macro_cache_save(cache_path, code);
+    }
+
+    mjs_val_t compiled =
+        mjs_mk_array_buf(mjs, (char*)MacroCode_get(code, 0), MacroCode_size(code));
+    MacroCode_clear(code);
+    mjs_return(mjs, compiled);
+}
+
+typedef struct {
+    struct mjs* mjs;
+    JsBadusbInst* badusb;
+    const uint8_t* code;
+    size_t code_size;
+    uint32_t default_delay;
+    uint32_t deadline; //<! Tick at which the last scheduled delay ends
+    uint32_t ops_since_poll;
+} MacroPlayer;
+
+/**
+ * @brief Sleeps until `ms` after the previous deadline, so that time spent
+ * sending reports does not accumulate into the schedule
+ * @returns true if the script was asked to stop
+ */
+static bool macro_player_delay(MacroPlayer* player, uint32_t ms) {
+    uint32_t now = furi_get_tick();
+    player->deadline += furi_ms_to_ticks(ms);
+    int32_t remaining = (int32_t)(player->deadline - now);
+    if(remaining <= 0) {
+        // fell behind (or the delay is 0): resync instead of bursting to catch up
+        player->deadline = now;
+        remaining = 0;
+    }
+    player->ops_since_poll = 0;
+    return js_delay_with_flags(player->mjs, remaining);
+}
+
+static bool macro_player_poll_stop(MacroPlayer* player) {
+    if(++player->ops_since_poll < MACRO_STOP_POLL_OPS) return false;
+    player->ops_since_poll = 0;
+    return js_delay_with_flags(player->mjs, 0);
+}
+
+typedef enum {
+    MacroStepOk,
+    MacroStepStop,
+    MacroStepError,
+    MacroStepTooManyKeys, //<! A hold over the HID limit, which isn't corruption
+} MacroStep;
+
+#define MACRO_NEED(player, pc, n) \
+    if((pc) + (n) > (player)->code_size) return MacroStepError
+
+/**
+ * @brief Executes the instruction at `*pc` and advances `*pc` past it
+ */
+static MacroStep macro_player_step(MacroPlayer* player, size_t* pc, bool allow_repeat) {
+    const uint8_t* code = player->code;
+    JsBadusbInst* badusb = player->badusb;
+
+    MACRO_NEED(player, *pc, 1);
+    MacroOp op = code[(*pc)++];
+
+    switch(op) {
+    case MacroOpPress:
+    case MacroOpHold:
+    case MacroOpRelease: {
+        MACRO_NEED(player, *pc, 2);
+        uint16_t keycode = macro_read_u16(&code[*pc]);
+        *pc += 2;
+        if(op == MacroOpPress) {
+            furi_hal_hid_kb_press(keycode);
+            furi_hal_hid_kb_release(keycode);
+        } else if(op == MacroOpHold) {
+            if(keycode & 0xFF) {
+                if(badusb->key_hold_cnt >= (HID_KB_MAX_KEYS - 1)) return MacroStepTooManyKeys;
+                badusb->key_hold_cnt++;
+            }
+            furi_hal_hid_kb_press(keycode);
+        } else {
+            if((keycode & 0xFF) && (badusb->key_hold_cnt > 0)) badusb->key_hold_cnt--;
+            furi_hal_hid_kb_release(keycode);
+        }
+    } break;
+
+    case MacroOpReleaseAll:
+        furi_hal_hid_kb_release_all();
+        badusb->key_hold_cnt = 0;
+        break;
+
+    case MacroOpDelay:
+    case MacroOpDefaultDelay: {
+        MACRO_NEED(player, *pc, 4);
+        uint32_t ms = macro_read_u32(&code[*pc]);
+        *pc += 4;
+        if(op == MacroOpDefaultDelay) {
+            player->default_delay = ms;
+            return MacroStepOk;
+        }
+        return macro_player_delay(player, ms) ? MacroStepStop : MacroStepOk;
+    }
+
+    case MacroOpType:
+    case MacroOpAltType: {
+        MACRO_NEED(player, *pc, 4);
+        uint16_t char_delay = macro_read_u16(&code[*pc]);
+        uint16_t count = macro_read_u16(&code[*pc + 2]);
+        *pc += 4;
+        size_t char_size = (op == MacroOpType) ? 2 : 1;
+        MACRO_NEED(player, *pc, (size_t)count * char_size);
+
+        if(op == MacroOpAltType) ducky_numlock_on();
+        for(size_t i = 0; i < count; i++) {
+            if(op == MacroOpType) {
+                uint16_t keycode = macro_read_u16(&code[*pc + i * 2]);
+                furi_hal_hid_kb_press(keycode);
+                furi_hal_hid_kb_release(keycode);
+            } else {
+                char ascii_str[4];
+                snprintf(ascii_str, sizeof(ascii_str), "%u", code[*pc + i]);
+                ducky_altchar(badusb, ascii_str);
+            }
+            if(char_delay > 0) {
+                if(macro_player_delay(player, char_delay)) return MacroStepStop;
+            } else if(macro_player_poll_stop(player)) {
+                return MacroStepStop;
+            }
+        }
+        *pc += (size_t)count * char_size;
+    } break;
+
+    case MacroOpRepeat: {
+        if(!allow_repeat) return MacroStepError;
+        size_t op_start = *pc - 1;
+        MACRO_NEED(player, *pc, 6);
+        uint16_t count = macro_read_u16(&code[*pc]);
+        uint16_t back = macro_read_u16(&code[*pc + 2]);
+        uint16_t len = macro_read_u16(&code[*pc + 4]);
+        *pc += 6;
+        if(back == 0 || back > op_start - sizeof(MacroHeader) || len == 0 || len > back)
+            return MacroStepError;
+
+        for(size_t i = 0; i < count; i++) {
+            size_t repeat_pc = op_start - back;
+            while(repeat_pc < op_start - back + len) {
+                MacroStep step = macro_player_step(player, &repeat_pc, false);
+                if(step != MacroStepOk) return step;
+            }
+        }
+        // the last repetition already waited for the default delay
+        return MacroStepOk;
+    }
+
+    default:
+        return MacroStepError;
+    }
+
+    if(player->default_delay > 0) {
+        return macro_player_delay(player, player->default_delay) ? MacroStepStop : MacroStepOk;
+    }
+    return macro_player_poll_stop(player) ? MacroStepStop : MacroStepOk;
+}
+
+#undef MACRO_NEED
+
+static void js_badusb_play(struct mjs* mjs) {
+    static const JsValueDeclaration js_badusb_play_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_badusb_play_args = JS_VALUE_ARGS(js_badusb_play_arg_list);
+
+    mjs_val_t compiled;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_badusb_play_args, &compiled);
+
+    JsBadusbInst* badusb = JS_GET_CONTEXT(mjs);
+    if(badusb->usb_if_prev == NULL)
+        JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "HID is not started");
+    if(!mjs_is_array_buf(compiled))
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "argument 0: expected ArrayBuffer");
+
+    size_t size = 0;
+    const uint8_t* data = (const uint8_t*)mjs_array_buf_get_ptr(mjs, compiled, &size);
+    MacroHeader header;
+    if(size < sizeof(header))
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "not a compiled macro");
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != MACRO_MAGIC || header.version != MACRO_VERSION ||
+       header.code_size != size - sizeof(header))
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "not a compiled macro");
+
+    MacroPlayer player = {
+        .mjs = mjs,
+        .badusb = badusb,
+        .code = data,
+        .code_size = size,
+        .deadline = furi_get_tick(),
+    };
+
+    MacroStep step = MacroStepOk;
+    size_t pc = sizeof(header);
+    while(pc < size && step == MacroStepOk) {
+        step = macro_player_step(&player, &pc, true);
+    }
+
+    if(step != MacroStepOk) {
+        furi_hal_hid_kb_release_all();
+        badusb->key_hold_cnt = 0;
+    }
+    if(step == MacroStepError)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "corrupted macro at offset %zu", pc);
+    if(step == MacroStepTooManyKeys)
+        JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "Too many keys are held at offset %zu", pc);
+
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+/**
+ * @brief Measures key name lookup speed over all known key names and the
+ * printable ASCII range
+ *
+ * `benchmarkLookup(iterations = 10000)` returns
+ * `{lookups, cycles, nsPerLookup}`.
+ */
+static void js_badusb_benchmark_lookup(struct mjs* mjs) {
+    static const JsValueDeclaration js_badusb_benchmark_arg_list[] = {
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 10000),
+    };
+    static const JsValueArguments js_badusb_benchmark_args =
+        JS_VALUE_ARGS(js_badusb_benchmark_arg_list);
+
+    int32_t iterations;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_badusb_benchmark_args, &iterations);
+    if(iterations <= 0)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "iterations must be positive");
+
+    JsBadusbInst* badusb = JS_GET_CONTEXT(mjs);
+    uint32_t lookups = 0;
+    volatile uint16_t sink = 0;
+
+    uint32_t start = DWT->CYCCNT;
+    for(int32_t i = 0; i < iterations; i++) {
+        const char* name = key_codes[i % COUNT_OF(key_codes)].name;
+        sink = get_keycode_by_name(badusb, name, strlen(name));
+        char ch = ' ' + (i % ('~' - ' '));
+        sink = get_keycode_by_name(badusb, &ch, 1);
+        lookups += 2;
+    }
+    uint32_t cycles = DWT->CYCCNT - start;
+    UNUSED(sink);
+
+    uint32_t ns_per_lookup =
+        (uint64_t)cycles * 1000 / furi_hal_cortex_instructions_per_microsecond() / lookups;
+
+    mjs_val_t result = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, result) {
+        JS_FIELD("lookups", mjs_mk_number(mjs, lookups));
+        JS_FIELD("cycles", mjs_mk_number(mjs, cycles));
+        JS_FIELD("nsPerLookup", mjs_mk_number(mjs, ns_per_lookup));
+    }
+    mjs_return(mjs, result);
+}
+
+void* js_badusb_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
     UNUSED(modules);
+#ifdef FURI_DEBUG
+    // `badusb_keycode_by_key_name()` relies on this order
+    for(size_t i = 1; i < COUNT_OF(key_codes); i++) {
+        furi_check(strcmp(key_codes[i - 1].name, key_codes[i].name) < 0);
+    }
+#endif
     JsBadusbInst* badusb = malloc(sizeof(JsBadusbInst));
+    // default layout, so that macros can be compiled before `setup()`
+    badusb_layout_set_default(&badusb->layout);
     mjs_val_t badusb_obj = mjs_mk_object(mjs);
     mjs_set(mjs, badusb_obj, INST_PROP_NAME, ~0, mjs_mk_foreign(mjs, badusb));
     mjs_set(mjs, badusb_obj, "setup", ~0, MJS_MK_FN(js_badusb_setup));
@@ -505,29 +1387,15 @@ static void* js_badusb_create(struct mjs* mjs, mjs_val_t* object, JsModules* mod
     mjs_set(mjs, badusb_obj, "println", ~0, MJS_MK_FN(js_badusb_println));
     mjs_set(mjs, badusb_obj, "altPrint", ~0, MJS_MK_FN(js_badusb_alt_print));
     mjs_set(mjs, badusb_obj, "altPrintln", ~0, MJS_MK_FN(js_badusb_alt_println));
+    mjs_set(mjs, badusb_obj, "compile", ~0, MJS_MK_FN(js_badusb_compile));
+    mjs_set(mjs, badusb_obj, "play", ~0, MJS_MK_FN(js_badusb_play));
+    mjs_set(mjs, badusb_obj, "benchmarkLookup", ~0, MJS_MK_FN(js_badusb_benchmark_lookup));
     *object = badusb_obj;
     return badusb;
 }
 
-static void js_badusb_destroy(void* inst) {
+void js_badusb_destroy(void* inst) {
     JsBadusbInst* badusb = inst;
     js_badusb_quit_free(badusb);
     free(badusb);
 }
-
-static const JsModuleDescriptor js_badusb_desc = {
-    "badusb",
-    js_badusb_create,
-    js_badusb_destroy,
-    NULL,
-};
-
-static const FlipperAppPluginDescriptor plugin_descriptor = {
-    .appid = PLUGIN_APP_ID,
-    .ep_api_version = PLUGIN_API_VERSION,
-    .entry_point = &js_badusb_desc,
-};
-
-const FlipperAppPluginDescriptor* js_badusb_ep(void) {
-    return &plugin_descriptor;
-}
@@ -0,0 +1,20 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_badusb.h
+ *
+ * Built-in `badusb` module that types on the host through a USB HID keyboard:
+ *   - `badusb.setup(settings?)`, `badusb.quit()` and `badusb.isConnected()`;
+ *   - `badusb.press(...keys)`, `badusb.hold(...keys)` and
+ *     `badusb.release(...keys?)`;
+ *   - `badusb.print(text, delay?)` and `badusb.println(text, delay?)`, plus
+ *     `badusb.altPrint` and `badusb.altPrintln`, which type with Alt codes;
+ *   - `badusb.compile(text)`, which turns macro text into an ArrayBuffer, and
+ *     `badusb.play(macro)`, which replays it;
+ *   - `badusb.benchmarkLookup(count?)`, which times key name lookups.
+ */
+
+void* js_badusb_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
+void js_badusb_destroy(void* inst);
@@ -0,0 +1,236 @@
+#include "js_bench.h"
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <toolbox/version.h>
+
+#ifdef JS_HOST
+#include <time.h>
+#endif
+
+#define TAG "JsBench"
+
+#define BENCH_RESULTS_PATH STORAGE_EXT_PATH_PREFIX "/apps_data/fast_js_app/bench.json"
+#define BENCH_ITERATIONS_MAX 4096 //<! Each one keeps a 4 byte sample while the run lasts
+#define BENCH_RESULTS_MAX    32
+#define BENCH_NAME_LEN       32
+
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    uint32_t iterations;
+    uint64_t min_ns;
+    uint64_t median_ns;
+    uint64_t p99_ns;
+} JsBenchResult;
+
+typedef struct {
+    JsBenchResult results[BENCH_RESULTS_MAX];
+    size_t count;
+    bool saved; //<! No results since the last save
+} JsBench;
+
+/**
+ * @brief Reads the clock that samples are taken with: the cycle counter on
+ * the device, nanoseconds of the monotonic clock on the host, where the
+ * emulated counter would only add the cost of its own conversion
+ */
+static inline uint32_t js_bench_clock(void) {
+#ifdef JS_HOST
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * @brief Converts a difference of two clock readings to nanoseconds.
+ * Anything over ~67 ms at 64 MHz doesn't fit in 32 bits of nanoseconds.
+ */
+static uint64_t js_bench_clock_to_ns(uint32_t ticks) {
+#ifdef JS_HOST
+    return ticks;
+#else
+    return (uint64_t)ticks * 1000 / furi_hal_cortex_instructions_per_microsecond();
+#endif
+}
+
+static int js_bench_compare(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void js_bench_cycles(struct mjs* mjs) {
+    mjs_return(mjs, mjs_mk_number(mjs, js_bench_clock()));
+}
+
+static void js_bench_ns(struct mjs* mjs) {
+    static const JsValueDeclaration js_bench_ns_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeDouble),
+        JS_VALUE_SIMPLE(JsValueTypeDouble),
+    };
+    static const JsValueArguments js_bench_ns_args = JS_VALUE_ARGS(js_bench_ns_arg_list);
+
+    double start, end;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bench_ns_args, &start, &end);
+    // the clock is 32 bits, so this is right across one wrap
+    uint32_t ticks = (uint32_t)end - (uint32_t)start;
+    mjs_return(mjs, mjs_mk_number(mjs, js_bench_clock_to_ns(ticks)));
+}
+
+static void js_bench_run(struct mjs* mjs) {
+    static const JsValueDeclaration js_bench_iterations =
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 100);
+    static const JsValueDeclaration js_bench_warmup =
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 10);
+    static const JsValueObjectField js_bench_options_fields[] = {
+        {"iterations", &js_bench_iterations},
+        {"warmup", &js_bench_warmup},
+    };
+    static const JsValueDeclaration js_bench_run_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeString),
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+        JS_VALUE_OBJECT_W_DEFAULTS(js_bench_options_fields),
+    };
+    static const JsValueArguments js_bench_run_args = JS_VALUE_ARGS(js_bench_run_arg_list);
+
+    const char* name;
+    mjs_val_t fn;
+    int32_t iterations = 100, warmup = 10;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bench_run_args, &name, &fn, &iterations, &warmup);
+    if(iterations < 1 || iterations > BENCH_ITERATIONS_MAX)
+        JS_ERROR_AND_RETURN(
+            mjs, MJS_BAD_ARGS_ERROR, "iterations must be 1-%d", BENCH_ITERATIONS_MAX);
+    if(warmup < 0) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "warmup can't be negative");
+
+    JsBench* bench = JS_GET_CONTEXT(mjs);
+    JsBenchResult result;
+    // the name may move while the function allocates
+    strlcpy(result.name, name, sizeof(result.name));
+    result.iterations = iterations;
+
+    mjs_val_t ret;
+    for(int32_t i = 0; i < warmup; i++) {
+        if(mjs_apply(mjs, &ret, fn, MJS_UNDEFINED, 0, NULL) != MJS_OK) {
+            mjs_return(mjs, MJS_UNDEFINED);
+            return;
+        }
+    }
+
+    uint32_t* samples = malloc(iterations * sizeof(uint32_t));
+    for(int32_t i = 0; i < iterations; i++) {
+        uint32_t start = js_bench_clock();
+        mjs_err_t error = mjs_apply(mjs, &ret, fn, MJS_UNDEFINED, 0, NULL);
+        samples[i] = js_bench_clock() - start;
+        if(error != MJS_OK) {
+            free(samples);
+            mjs_return(mjs, MJS_UNDEFINED);
+            return;
+        }
+    }
+
+    qsort(samples, iterations, sizeof(uint32_t), js_bench_compare);
+    result.min_ns = js_bench_clock_to_ns(samples[0]);
+    result.median_ns = js_bench_clock_to_ns(samples[iterations / 2]);
+    result.p99_ns = js_bench_clock_to_ns(samples[MIN(iterations - 1, iterations * 99 / 100)]);
+    free(samples);
+
+    if(bench->count < BENCH_RESULTS_MAX) {
+        bench->results[bench->count++] = result;
+        bench->saved = false;
+    } else {
+        FURI_LOG_W(TAG, "Too many results, %s is not saved", result.name);
+    }
+
+    mjs_val_t result_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, result_obj) {
+        JS_FIELD("name", mjs_mk_string(mjs, result.name, ~0, true));
+        JS_FIELD("iterations", mjs_mk_number(mjs, result.iterations));
+        JS_FIELD("min", mjs_mk_number(mjs, result.min_ns));
+        JS_FIELD("median", mjs_mk_number(mjs, result.median_ns));
+        JS_FIELD("p99", mjs_mk_number(mjs, result.p99_ns));
+    }
+    mjs_return(mjs, result_obj);
+}
+
+static void js_bench_json_string(FuriString* json, const char* str) {
+    furi_string_push_back(json, '"');
+    for(; *str; str++) {
+        if(*str == '"' || *str == '\\') furi_string_push_back(json, '\\');
+        furi_string_push_back(json, (uint8_t)*str < ' ' ? '?' : *str);
+    }
+    furi_string_push_back(json, '"');
+}
+
+static bool js_bench_write(JsBench* bench, const char* path) {
+    FuriString* json = furi_string_alloc_set("{\"firmware\":");
+    js_bench_json_string(json, version_get_version(NULL));
+    furi_string_cat(json, ",\"unit\":\"ns\",\"results\":[");
+    for(size_t i = 0; i < bench->count; i++) {
+        const JsBenchResult* result = &bench->results[i];
+        furi_string_cat(json, i ? ",{\"name\":" : "{\"name\":");
+        js_bench_json_string(json, result->name);
+        furi_string_cat_printf(
+            json,
+            ",\"iterations\":%lu,\"min\":%llu,\"median\":%llu,\"p99\":%llu}",
+            (unsigned long)result->iterations,
+            (unsigned long long)result->min_ns,
+            (unsigned long long)result->median_ns,
+            (unsigned long long)result->p99_ns);
+    }
+    furi_string_cat(json, "]}\n");
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    size_t size = furi_string_size(json);
+    bool ok = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, furi_string_get_cstr(json), size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(json);
+
+    if(ok) {
+        bench->saved = true;
+    } else {
+        FURI_LOG_E(TAG, "Failed to write %s", path);
+    }
+    return ok;
+}
+
+static void js_bench_save(struct mjs* mjs) {
+    static const JsValueDeclaration js_bench_save_arg_list[] = {
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeString, str_val, BENCH_RESULTS_PATH),
+    };
+    static const JsValueArguments js_bench_save_args = JS_VALUE_ARGS(js_bench_save_arg_list);
+
+    const char* path;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bench_save_args, &path);
+    JsBench* bench = JS_GET_CONTEXT(mjs);
+    mjs_return(mjs, mjs_mk_boolean(mjs, js_bench_write(bench, path)));
+}
+
+void* js_bench_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+    UNUSED(modules);
+    JsBench* bench = malloc(sizeof(JsBench));
+    bench->count = 0;
+    bench->saved = true;
+
+    mjs_val_t bench_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, bench_obj) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, bench));
+        JS_FIELD("cycles", MJS_MK_FN(js_bench_cycles));
+        JS_FIELD("ns", MJS_MK_FN(js_bench_ns));
+        JS_FIELD("run", MJS_MK_FN(js_bench_run));
+        JS_FIELD("save", MJS_MK_FN(js_bench_save));
+    }
+    *object = bench_obj;
+
+    return bench;
+}
+
+void js_bench_destroy(void* inst) {
+    JsBench* bench = inst;
+    if(!bench->saved) js_bench_write(bench, BENCH_RESULTS_PATH);
+    free(bench);
+}
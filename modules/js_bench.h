@@ -0,0 +1,25 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_bench.h
+ *
+ * Built-in `bench` module for micro-benchmarks:
+ *   - `bench.cycles()`: the CPU cycle counter, which wraps in about a minute
+ *     (on the host build, nanoseconds of the monotonic clock, which wrap in
+ *     about 4 seconds);
+ *   - `bench.ns(start, end)`: nanoseconds between two `cycles()` readings;
+ *   - `bench.run(name, fn, {iterations, warmup})`: calls `fn` `warmup`
+ *     times, then times each of `iterations` calls and returns
+ *     `{name, iterations, min, median, p99}` in nanoseconds;
+ *   - `bench.save(path)`: writes the results of all runs as JSON.
+ *
+ * Results that haven't been saved when the script ends are written to
+ * `apps_data/fast_js_app/bench.json`. The firmware version is included, so
+ * that runs on different firmware can be compared.
+ */
+
+void* js_bench_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
+
+void js_bench_destroy(void* inst);
@@ -0,0 +1,465 @@
+#include "js_bytes.h"
+
+#define TAG "JsBytes"
+
+#define BYTES_KEY_WORDS_MAX 64 //<! Keys up to this many bytes are applied a word at a time
+
+/**
+ * @brief Word for the bitwise loops, which may alias the bytes of a buffer
+ */
+typedef uint32_t __attribute__((may_alias)) JsBytesWord;
+
+typedef enum {
+    JsBytesOpXor,
+    JsBytesOpAnd,
+    JsBytesOpOr,
+} JsBytesOp;
+
+/**
+ * @brief Finds the bytes of an ArrayBuffer, typed array or DataView. They
+ * stay put until the script makes a new value.
+ */
+static uint8_t* js_bytes_get(struct mjs* mjs, mjs_val_t value, size_t* len) {
+    if(mjs_is_data_view(value)) value = mjs_dataview_get_buf(mjs, value);
+    if(!mjs_is_array_buf(value) && !mjs_is_typed_array(value)) return NULL;
+    *len = 0;
+    return (uint8_t*)mjs_array_buf_get_ptr(mjs, value, len);
+}
+
+/**
+ * @brief Resolves a `start, end` pair like `Array.prototype.slice` does,
+ * counting negative indices from the end
+ */
+static size_t js_bytes_index(int32_t index, size_t len) {
+    if(index < 0) return len - MIN((size_t)-(int64_t)index, len);
+    return MIN((size_t)index, len);
+}
+
+static void js_bytes_copy_within(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_copy_within_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, INT32_MAX),
+    };
+    static const JsValueArguments js_bytes_copy_within_args =
+        JS_VALUE_ARGS(js_bytes_copy_within_arg_list);
+
+    mjs_val_t buf;
+    int32_t target, start, end;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_copy_within_args, &buf, &target, &start, &end);
+    size_t len;
+    uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    size_t to = js_bytes_index(target, len);
+    size_t from = js_bytes_index(start, len);
+    size_t until = js_bytes_index(end, len);
+    if(until > from) memmove(&data[to], &data[from], MIN(until - from, len - to));
+    mjs_return(mjs, buf);
+}
+
+static void js_bytes_fill(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_fill_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 0),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, INT32_MAX),
+    };
+    static const JsValueArguments js_bytes_fill_args = JS_VALUE_ARGS(js_bytes_fill_arg_list);
+
+    mjs_val_t buf;
+    int32_t value, start, end;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_fill_args, &buf, &value, &start, &end);
+    size_t len;
+    uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    size_t from = js_bytes_index(start, len);
+    size_t until = js_bytes_index(end, len);
+    if(until > from) memset(&data[from], value, until - from);
+    mjs_return(mjs, buf);
+}
+
+static void js_bytes_index_of(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_index_of_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 0),
+    };
+    static const JsValueArguments js_bytes_index_of_args =
+        JS_VALUE_ARGS(js_bytes_index_of_arg_list);
+
+    mjs_val_t buf, needle_val;
+    int32_t start;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_index_of_args, &buf, &needle_val, &start);
+    size_t len;
+    const uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    // the needle is a byte, a string or another buffer
+    uint8_t byte;
+    const uint8_t* needle;
+    size_t needle_len;
+    if(mjs_is_number(needle_val)) {
+        byte = mjs_get_int32(mjs, needle_val);
+        needle = &byte;
+        needle_len = 1;
+    } else if(mjs_is_string(needle_val)) {
+        needle = (const uint8_t*)mjs_get_string(mjs, &needle_val, &needle_len);
+    } else if(!(needle = js_bytes_get(mjs, needle_val, &needle_len))) {
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected a byte, string or ArrayBuffer");
+    }
+
+    int32_t found = -1;
+    size_t at = js_bytes_index(start, len);
+    if(!needle_len) {
+        found = at;
+    } else {
+        // memchr skips to candidates a word at a time
+        while(len - at >= needle_len) {
+            const uint8_t* first = memchr(&data[at], needle[0], len - at - needle_len + 1);
+            if(!first) break;
+            at = first - data;
+            if(memcmp(first, needle, needle_len) == 0) {
+                found = at;
+                break;
+            }
+            at++;
+        }
+    }
+    mjs_return(mjs, mjs_mk_number(mjs, found));
+}
+
+static void js_bytes_compare(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_compare_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_bytes_compare_args = JS_VALUE_ARGS(js_bytes_compare_arg_list);
+
+    mjs_val_t a, b;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_compare_args, &a, &b);
+    size_t a_len, b_len;
+    const uint8_t* a_data = js_bytes_get(mjs, a, &a_len);
+    if(!a_data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+    const uint8_t* b_data = js_bytes_get(mjs, b, &b_len);
+    if(!b_data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    int result = memcmp(a_data, b_data, MIN(a_len, b_len));
+    if(result == 0) result = (a_len > b_len) - (a_len < b_len);
+    mjs_return(mjs, mjs_mk_number(mjs, (result > 0) - (result < 0)));
+}
+
+static inline uint8_t js_bytes_op_byte(JsBytesOp op, uint8_t a, uint8_t b) {
+    return op == JsBytesOpXor ? a ^ b : op == JsBytesOpAnd ? a & b : a | b;
+}
+
+/**
+ * @brief Applies `op` with `key` repeated over `data`. Keys of up to
+ * `BYTES_KEY_WORDS_MAX` bytes are repeated into a pattern of whole words
+ * first, which is then applied a word at a time.
+ */
+static void js_bytes_apply(
+    JsBytesOp op,
+    uint8_t* data,
+    size_t len,
+    const uint8_t* key,
+    size_t key_len) {
+    size_t at = 0;
+    if(key_len <= BYTES_KEY_WORDS_MAX) {
+        // up to the first aligned word
+        size_t head = MIN((size_t)(-(uintptr_t)data & 3), len);
+        for(; at < head; at++)
+            data[at] = js_bytes_op_byte(op, data[at], key[at % key_len]);
+
+        // the pattern is the key repeated to a multiple of 4 bytes, and
+        // starts where the key is at the first word
+        size_t pattern_len = key_len % 4 == 0 ? key_len :
+                             key_len % 2 == 0 ? key_len * 2 :
+                                                key_len * 4;
+        JsBytesWord pattern[BYTES_KEY_WORDS_MAX];
+        uint8_t* pattern_bytes = (uint8_t*)pattern;
+        for(size_t i = 0; i < pattern_len; i++)
+            pattern_bytes[i] = key[(head + i) % key_len];
+
+        JsBytesWord* words = (JsBytesWord*)&data[head];
+        size_t n_words = (len - head) / 4, n_pattern = pattern_len / 4, p = 0;
+        switch(op) {
+        case JsBytesOpXor:
+            for(size_t w = 0; w < n_words; w++, p = p + 1 == n_pattern ? 0 : p + 1)
+                words[w] ^= pattern[p];
+            break;
+        case JsBytesOpAnd:
+            for(size_t w = 0; w < n_words; w++, p = p + 1 == n_pattern ? 0 : p + 1)
+                words[w] &= pattern[p];
+            break;
+        case JsBytesOpOr:
+            for(size_t w = 0; w < n_words; w++, p = p + 1 == n_pattern ? 0 : p + 1)
+                words[w] |= pattern[p];
+            break;
+        }
+        at = head + n_words * 4;
+    }
+    for(; at < len; at++)
+        data[at] = js_bytes_op_byte(op, data[at], key[at % key_len]);
+}
+
+static void js_bytes_bitwise(struct mjs* mjs, JsBytesOp op) {
+    static const JsValueDeclaration js_bytes_bitwise_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_bytes_bitwise_args = JS_VALUE_ARGS(js_bytes_bitwise_arg_list);
+
+    mjs_val_t buf, key_val;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_bitwise_args, &buf, &key_val);
+    size_t len;
+    uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    uint8_t byte;
+    const uint8_t* key;
+    size_t key_len;
+    if(mjs_is_number(key_val)) {
+        byte = mjs_get_int32(mjs, key_val);
+        key = &byte;
+        key_len = 1;
+    } else if(!(key = js_bytes_get(mjs, key_val, &key_len))) {
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected a byte or ArrayBuffer as the key");
+    }
+    if(!key_len) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "empty key");
+
+    // the key may be the buffer itself
+    uint8_t* key_copy = NULL;
+    if(key != &byte && key < data + len && data < key + key_len) {
+        key_copy = malloc(key_len);
+        memcpy(key_copy, key, key_len);
+        key = key_copy;
+    }
+    js_bytes_apply(op, data, len, key, key_len);
+    free(key_copy);
+    mjs_return(mjs, buf);
+}
+
+static void js_bytes_xor(struct mjs* mjs) {
+    js_bytes_bitwise(mjs, JsBytesOpXor);
+}
+
+static void js_bytes_and(struct mjs* mjs) {
+    js_bytes_bitwise(mjs, JsBytesOpAnd);
+}
+
+static void js_bytes_or(struct mjs* mjs) {
+    js_bytes_bitwise(mjs, JsBytesOpOr);
+}
+
+static void js_bytes_swap(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_swap_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+    };
+    static const JsValueArguments js_bytes_swap_args = JS_VALUE_ARGS(js_bytes_swap_arg_list);
+
+    mjs_val_t buf;
+    int32_t width;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_swap_args, &buf, &width);
+    size_t len;
+    uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+    if(width != 2 && width != 4 && width != 8)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "width must be 2, 4 or 8");
+    if(len % width)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "length must be a multiple of %ld", width);
+
+    // memcpy keeps the loads safe when the buffer isn't aligned, and
+    // compiles to plain loads and stores
+    for(size_t at = 0; at < len; at += width) {
+        if(width == 2) {
+            uint16_t value;
+            memcpy(&value, &data[at], sizeof(value));
+            value = __builtin_bswap16(value);
+            memcpy(&data[at], &value, sizeof(value));
+        } else if(width == 4) {
+            uint32_t value;
+            memcpy(&value, &data[at], sizeof(value));
+            value = __builtin_bswap32(value);
+            memcpy(&data[at], &value, sizeof(value));
+        } else {
+            uint64_t value;
+            memcpy(&value, &data[at], sizeof(value));
+            value = __builtin_bswap64(value);
+            memcpy(&data[at], &value, sizeof(value));
+        }
+    }
+    mjs_return(mjs, buf);
+}
+
+// ================
+// Hex and base64
+// ================
+
+static const char js_bytes_hex_digits[] = "0123456789abcdef";
+static const char js_bytes_base64_digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int js_bytes_hex_value(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int js_bytes_base64_value(char c) {
+    if(c >= 'A' && c <= 'Z') return c - 'A';
+    if(c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if(c >= '0' && c <= '9') return c - '0' + 52;
+    if(c == '+') return 62;
+    if(c == '/') return 63;
+    return -1;
+}
+
+static void js_bytes_to_hex(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_to_hex_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_bytes_to_hex_args = JS_VALUE_ARGS(js_bytes_to_hex_arg_list);
+
+    mjs_val_t buf;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_to_hex_args, &buf);
+    size_t len;
+    const uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    char* hex = malloc(len * 2 + 1);
+    for(size_t i = 0; i < len; i++) {
+        hex[i * 2] = js_bytes_hex_digits[data[i] >> 4];
+        hex[i * 2 + 1] = js_bytes_hex_digits[data[i] & 0x0f];
+    }
+    mjs_val_t result = mjs_mk_string(mjs, hex, len * 2, true);
+    free(hex);
+    mjs_return(mjs, result);
+}
+
+static void js_bytes_from_hex(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_from_hex_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_bytes_from_hex_args =
+        JS_VALUE_ARGS(js_bytes_from_hex_arg_list);
+
+    mjs_val_t str_val;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_from_hex_args, &str_val);
+    if(!mjs_is_string(str_val)) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected a string");
+    size_t len;
+    const char* hex = mjs_get_string(mjs, &str_val, &len);
+    if(len % 2) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "odd number of hex digits");
+
+    uint8_t* data = malloc(MAX(len / 2, 1U));
+    for(size_t i = 0; i < len / 2; i++) {
+        int high = js_bytes_hex_value(hex[i * 2]), low = js_bytes_hex_value(hex[i * 2 + 1]);
+        if(high < 0 || low < 0) {
+            free(data);
+            JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "bad hex digit at %zu", i * 2);
+        }
+        data[i] = high << 4 | low;
+    }
+    mjs_val_t result = mjs_mk_array_buf(mjs, (char*)data, len / 2);
+    free(data);
+    mjs_return(mjs, result);
+}
+
+static void js_bytes_to_base64(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_to_base64_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_bytes_to_base64_args =
+        JS_VALUE_ARGS(js_bytes_to_base64_arg_list);
+
+    mjs_val_t buf;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_to_base64_args, &buf);
+    size_t len;
+    const uint8_t* data = js_bytes_get(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    size_t out_len = (len + 2) / 3 * 4;
+    char* out = malloc(out_len + 1);
+    char* at = out;
+    for(size_t i = 0; i < len; i += 3) {
+        uint32_t group = data[i] << 16;
+        if(i + 1 < len) group |= data[i + 1] << 8;
+        if(i + 2 < len) group |= data[i + 2];
+        *at++ = js_bytes_base64_digits[group >> 18];
+        *at++ = js_bytes_base64_digits[(group >> 12) & 0x3f];
+        *at++ = i + 1 < len ? js_bytes_base64_digits[(group >> 6) & 0x3f] : '=';
+        *at++ = i + 2 < len ? js_bytes_base64_digits[group & 0x3f] : '=';
+    }
+    mjs_val_t result = mjs_mk_string(mjs, out, out_len, true);
+    free(out);
+    mjs_return(mjs, result);
+}
+
+static void js_bytes_from_base64(struct mjs* mjs) {
+    static const JsValueDeclaration js_bytes_from_base64_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_bytes_from_base64_args =
+        JS_VALUE_ARGS(js_bytes_from_base64_arg_list);
+
+    mjs_val_t str_val;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_bytes_from_base64_args, &str_val);
+    if(!mjs_is_string(str_val)) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected a string");
+    size_t len;
+    const char* str = mjs_get_string(mjs, &str_val, &len);
+    // padding is optional
+    while(len && str[len - 1] == '=')
+        len--;
+    if(len % 4 == 1) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "bad base64 length");
+
+    uint8_t* data = malloc(MAX(len * 3 / 4, 1U));
+    size_t out_len = 0;
+    uint32_t group = 0;
+    for(size_t i = 0; i < len; i++) {
+        int value = js_bytes_base64_value(str[i]);
+        if(value < 0) {
+            free(data);
+            JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "bad base64 digit at %zu", i);
+        }
+        group = group << 6 | value;
+        if(i % 4 == 3) {
+            data[out_len++] = group >> 16;
+            data[out_len++] = group >> 8;
+            data[out_len++] = group;
+        }
+    }
+    if(len % 4 == 2) {
+        data[out_len++] = group >> 4;
+    } else if(len % 4 == 3) {
+        data[out_len++] = group >> 10;
+        data[out_len++] = group >> 2;
+    }
+    mjs_val_t result = mjs_mk_array_buf(mjs, (char*)data, out_len);
+    free(data);
+    mjs_return(mjs, result);
+}
+
+void* js_bytes_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+    UNUSED(modules);
+    mjs_val_t bytes_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, bytes_obj) {
+        JS_FIELD("copyWithin", MJS_MK_FN(js_bytes_copy_within));
+        JS_FIELD("fill", MJS_MK_FN(js_bytes_fill));
+        JS_FIELD("indexOf", MJS_MK_FN(js_bytes_index_of));
+        JS_FIELD("compare", MJS_MK_FN(js_bytes_compare));
+        JS_FIELD("xor", MJS_MK_FN(js_bytes_xor));
+        JS_FIELD("and", MJS_MK_FN(js_bytes_and));
+        JS_FIELD("or", MJS_MK_FN(js_bytes_or));
+        JS_FIELD("swap", MJS_MK_FN(js_bytes_swap));
+        JS_FIELD("toHex", MJS_MK_FN(js_bytes_to_hex));
+        JS_FIELD("fromHex", MJS_MK_FN(js_bytes_from_hex));
+        JS_FIELD("toBase64", MJS_MK_FN(js_bytes_to_base64));
+        JS_FIELD("fromBase64", MJS_MK_FN(js_bytes_from_base64));
+    }
+    *object = bytes_obj;
+    return (void*)1;
+}
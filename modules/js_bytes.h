@@ -0,0 +1,23 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_bytes.h
+ *
+ * Built-in `bytes` module with native versions of byte loops. These work in
+ * place on an ArrayBuffer, typed array or DataView and return it:
+ *   - `bytes.copyWithin(buf, target, start, end?)`;
+ *   - `bytes.fill(buf, byte, start?, end?)`;
+ *   - `bytes.xor(buf, key)`, `bytes.and(buf, key)` and `bytes.or(buf, key)`,
+ *     with a byte or a repeated key buffer;
+ *   - `bytes.swap(buf, width)`, which reverses each 2, 4 or 8 byte group.
+ *
+ * These return other values:
+ *   - `bytes.indexOf(buf, needle, from?)`: a byte, string or buffer, or -1;
+ *   - `bytes.compare(a, b)`: -1, 0 or 1;
+ *   - `bytes.toHex`, `bytes.fromHex`, `bytes.toBase64` and
+ *     `bytes.fromBase64`: conversions to and from strings.
+ */
+
+void* js_bytes_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
@@ -1,6 +1,8 @@
 #include "js_event_loop.h"
+#include "js_event_loop_timer_wheel.h"
 #include "../../js_modules.h" // IWYU pragma: keep
 #include <expansion/expansion.h>
+#include <furi_hal.h>
 #include <mlib/m-array.h>
 
 /**
@@ -8,12 +10,78 @@
  */
 #define SYSTEM_ARGS 2
 
+/**
+ * @brief Items per call of batched subscriptions that only set a time window
+ */
+#define BATCH_SIZE_DEFAULT 16
+
+/**
+ * @brief Length of a scheduling quantum in ticks
+ */
+#define QUANTUM_TICKS 10
+
+/**
+ * @brief Deferred items per subscription. Beyond that, the oldest item is
+ * dispatched regardless of the budget so that nothing is lost.
+ */
+#define BACKLOG_MAX 64
+
+/**
+ * @brief JS calls per quantum that each priority class may make before its
+ * events are deferred
+ */
+static const uint32_t js_event_loop_quantum_budget[JsEventLoopPriorityCount] = {
+    [JsEventLoopPriorityNormal] = 8,
+    [JsEventLoopPriorityHigh] = UINT32_MAX,
+    [JsEventLoopPriorityLow] = 2,
+};
+
+/**
+ * @brief Deferred items that a subscription of each class may replay in a row
+ * before the next subscription gets its turn
+ */
+static const uint32_t js_event_loop_round_robin_weight[JsEventLoopPriorityCount] = {
+    [JsEventLoopPriorityNormal] = 4,
+    [JsEventLoopPriorityHigh] = UINT32_MAX,
+    [JsEventLoopPriorityLow] = 1,
+};
+
+static const JsValueEnumVariant js_event_loop_priority_variants[] = {
+    {"normal", JsEventLoopPriorityNormal},
+    {"high", JsEventLoopPriorityHigh},
+    {"low", JsEventLoopPriorityLow},
+};
 /**
  * @brief Context passed to the generic event callback
  */
 typedef struct {
     FuriEventLoop* event_loop;
+    JsEventLoop* module;
     JsEventLoopObjectType object_type;
+    bool stateless; //<! Don't thread the returned array into the next call
+    void* subscription; // JsEventLoopSubscription, which isn't defined yet
+    bool dispatching; //<! The JS callback is running
+    bool cancelled; //<! Cancelled by its own callback, freed once it returns
+
+    uint32_t batch_size; //<! Max items per call, 0 if not batching
+    uint32_t batch_window; //<! Ticks to wait for more items after the first one
+    uint32_t batched; //<! Items in `batch`
+    mjs_val_t batch; //<! Array of collected items, owned
+    JsTimerId batch_timer; //<! Flushes the batch once the window closes
+
+    JsEventLoopPriority priority;
+    mjs_val_t backlog; //<! Ring of `BACKLOG_MAX` deferred items, owned
+    uint32_t backlog_ticks[BACKLOG_MAX]; //<! Arrival tick of each deferred item
+    uint32_t backlog_head; //<! Ring index of the oldest deferred item
+    uint32_t backlog_size; //<! Number of deferred items
+
+    // statistics
+    uint32_t dispatched;
+    uint32_t deferred;
+    uint32_t max_latency; //<! Ticks from arrival to dispatch
+    uint64_t total_latency;
+    uint32_t max_call_cycles;
+    uint64_t total_call_cycles;
 
     struct mjs* mjs;
     mjs_val_t callback;
@@ -35,26 +103,98 @@ typedef struct {
     JsEventLoopCallbackContext* context;
     JsEventLoopContract* contract;
     void* subscriptions; // SubscriptionArray_t, which we can't reference in this definition
+    JsTimerWheel* timers;
+    JsTimerId timer_id; //<! Wheel node of timer subscriptions
 } JsEventLoopSubscription;
 
+/**
+ * @brief Subscription options accepted by `subscribeWith`
+ */
+typedef struct {
+    bool stateless;
+    int32_t batch; //<! Max items per call
+    int32_t window; //<! Milliseconds to collect items for
+    JsEventLoopPriority priority; //<! `JsEventLoopPriorityCount` to use the contract's
+} JsEventLoopSubscribeOptions;
+
 ARRAY_DEF(SubscriptionArray, JsEventLoopSubscription*, M_PTR_OPLIST); //-V575
 ARRAY_DEF(ContractArray, JsEventLoopContract*, M_PTR_OPLIST); //-V575
+ARRAY_DEF(TaskArray, void*, M_PTR_OPLIST); //-V575
 
 /**
  * @brief Per-module instance control structure
  */
 struct JsEventLoop {
     FuriEventLoop* loop;
+    struct mjs* mjs;
+    bool running;
+    uint32_t stop_poll_tick; //<! Tick of the last stop flag check
+    bool stop_poll_pending;
+
+    uint32_t quantum_start; //<! Tick at which the current quantum has started
+    uint32_t quantum_used[JsEventLoopPriorityCount]; //<! JS calls made in this quantum
+    JsTimerId replay_timer; //<! Replays deferred items in the next quantum
+    size_t replay_cursor; //<! Subscription whose turn it is
+    uint32_t replay_credits; //<! Items it may still replay in a row
+
+    JsTimerWheel* timers; //<! Backs all timer subscriptions and `setTimeout`/`setInterval`
     SubscriptionArray_t subscriptions;
     ContractArray_t owned_contracts; //<! Contracts that were produced by this module
+
+    TaskArray_t tasks; //<! JsEventLoopTask, which isn't defined yet
+    size_t task_cursor; //<! Task whose turn is next
+    JsTimerId task_timer; //<! Runs the next turn
 };
 
+static void js_event_loop_subscription_free(JsEventLoopSubscription* subscription);
+
+/**
+ * @brief Checks whether the thread has been asked to stop
+ *
+ * Only peeks at the flag: it is left set for the exec flags poller, which
+ * terminates the script once control returns to it.
+ */
+static void js_event_loop_poll_stop(void* param) {
+    JsEventLoop* module = param;
+    module->stop_poll_pending = false;
+    module->stop_poll_tick = furi_get_tick();
+    if(furi_thread_flags_get() & ThreadEventStop) furi_event_loop_stop(module->loop);
+}
+
+/**
+ * @brief Called after every JS callback that this module makes
+ *
+ * The stop flag is checked at most once per tick. A check that falls into
+ * an already checked tick is deferred until after the current event instead
+ * of being dropped, so that a stop request can't get lost when the loop goes
+ * idle. Callbacks that the thread has deferred run here, between events.
+ */
+static void js_event_loop_dispatched(void* param, mjs_err_t error) {
+    JsEventLoop* module = param;
+    if(error != MJS_OK) {
+        furi_event_loop_stop(module->loop);
+        return;
+    }
+
+    js_thread_run_deferred(module->mjs);
+    if(furi_get_tick() != module->stop_poll_tick) {
+        js_event_loop_poll_stop(module);
+    } else if(!module->stop_poll_pending) {
+        module->stop_poll_pending = true;
+        furi_event_loop_pend_callback(module->loop, js_event_loop_poll_stop, module);
+    }
+}
+
 /**
  * @brief Generic event callback, handles all events by calling the JS callbacks
+ * @returns false if the callback has cancelled its subscription, which frees
+ * the context
  */
-static void js_event_loop_callback_generic(void* param) {
+static bool js_event_loop_callback_generic(void* param) {
     JsEventLoopCallbackContext* context = param;
     mjs_val_t result;
+    context->dispatching = true;
+    uint32_t start = DWT->CYCCNT;
     mjs_err_t error = mjs_apply(
         context->mjs,
         &result,
@@ -62,66 +202,282 @@ static void js_event_loop_callback_generic(void* param) {
         MJS_UNDEFINED,
         context->arity,
         context->arguments);
+    uint32_t cycles = DWT->CYCCNT - start;
+    context->dispatching = false;
 
-    bool is_error = strcmp(mjs_strerror(context->mjs, error), "NO_ERROR") != 0;
-    bool asked_to_stop = js_flags_wait(context->mjs, ThreadEventStop, 0) & ThreadEventStop;
-    if(is_error || asked_to_stop) {
-        furi_event_loop_stop(context->event_loop);
+    context->dispatched++;
+    context->total_call_cycles += cycles;
+    context->max_call_cycles = MAX(context->max_call_cycles, cycles);
+
+    js_event_loop_dispatched(context->module, error);
+    if(context->cancelled) {
+        js_event_loop_subscription_free(context->subscription);
+        return false;
     }
 
     // save returned args for next call
-    if(mjs_array_length(context->mjs, result) != context->arity - SYSTEM_ARGS) return;
-    for(size_t i = 0; i < context->arity - SYSTEM_ARGS; i++) {
-        mjs_disown(context->mjs, &context->arguments[i + SYSTEM_ARGS]);
+    // the array slots stay owned, so no need to disown and own them again
+    size_t user_arity = context->arity - SYSTEM_ARGS;
+    if(context->stateless || !user_arity || error != MJS_OK) return true;
+    if(mjs_array_length(context->mjs, result) != user_arity) return true;
+    for(size_t i = 0; i < user_arity; i++) {
         context->arguments[i + SYSTEM_ARGS] = mjs_array_get(context->mjs, result, i);
-        mjs_own(context->mjs, &context->arguments[i + SYSTEM_ARGS]);
     }
+    return true;
+}
+
+// ==========
+// Scheduling
+// ==========
+
+/**
+ * @brief Starts a new quantum if the current one is over
+ */
+static void js_event_loop_quantum_update(JsEventLoop* module) {
+    uint32_t now = furi_get_tick();
+    if(now - module->quantum_start < QUANTUM_TICKS) return;
+    module->quantum_start = now;
+    memset(module->quantum_used, 0, sizeof(module->quantum_used));
+}
+
+static bool js_event_loop_has_budget(JsEventLoop* module, JsEventLoopPriority priority) {
+    return module->quantum_used[priority] < js_event_loop_quantum_budget[priority];
 }
 
 /**
- * @brief Handles non-timer events
+ * @brief Passes one item to JS
+ * @param arrival Tick at which the item has arrived
+ * @returns false if the callback has cancelled its subscription
  */
-static void js_event_loop_callback(void* object, void* param) {
-    JsEventLoopCallbackContext* context = param;
+static bool js_event_loop_dispatch_item(
+    JsEventLoopCallbackContext* context,
+    mjs_val_t item,
+    uint32_t arrival) {
+    uint32_t latency = furi_get_tick() - arrival;
+    context->total_latency += latency;
+    context->max_latency = MAX(context->max_latency, latency);
+    context->module->quantum_used[context->priority]++;
 
-    if(context->transformer) {
-        mjs_disown(context->mjs, &context->arguments[1]);
-        context->arguments[1] =
-            context->transformer(context->mjs, object, context->transformer_context);
-        mjs_own(context->mjs, &context->arguments[1]);
-    } else {
-        // default behavior: take semaphores and mutexes
-        switch(context->object_type) {
-        case JsEventLoopObjectTypeSemaphore: {
-            FuriSemaphore* semaphore = object;
-            furi_check(furi_semaphore_acquire(semaphore, 0) == FuriStatusOk);
-        } break;
-        default:
-            // the corresponding check has been performed when we were given the contract
-            furi_crash();
+    context->arguments[1] = item;
+    return js_event_loop_callback_generic(context);
+}
+
+static inline uint32_t js_event_loop_backlog_size(JsEventLoopCallbackContext* context) {
+    return context->backlog_size;
+}
+
+/**
+ * @brief Dispatches the oldest deferred item
+ */
+static bool js_event_loop_backlog_replay(JsEventLoopCallbackContext* context) {
+    struct mjs* mjs = context->mjs;
+    uint32_t head = context->backlog_head;
+    uint32_t arrival = context->backlog_ticks[head];
+    mjs_val_t item = mjs_array_get(mjs, context->backlog, head);
+    // let the GC collect the item once it has been handled
+    mjs_array_set(mjs, context->backlog, head, MJS_UNDEFINED);
+    context->backlog_head = (head + 1) % BACKLOG_MAX;
+    context->backlog_size--;
+    return js_event_loop_dispatch_item(context, item, arrival);
+}
+
+static void js_event_loop_replay(void* param);
+
+static void js_event_loop_schedule_replay(JsEventLoop* module) {
+    if(module->replay_timer != JS_TIMER_ID_INVALID) return;
+    uint32_t elapsed = furi_get_tick() - module->quantum_start;
+    uint32_t delay = elapsed < QUANTUM_TICKS ? QUANTUM_TICKS - elapsed : 1;
+    module->replay_timer = js_timer_wheel_add(
+        module->timers, delay, 0, js_event_loop_replay, NULL, module);
+}
+
+/**
+ * @brief Replays deferred items in weighted round-robin order until the
+ * budgets of the quantum are used up
+ */
+static void js_event_loop_replay(void* param) {
+    JsEventLoop* module = param;
+    module->replay_timer = JS_TIMER_ID_INVALID;
+    bool left = false;
+
+    while(true) {
+        js_event_loop_quantum_update(module);
+
+        // find the next subscription with deferred items and budget,
+        // starting with the current one if it has credits left
+        size_t count = SubscriptionArray_size(module->subscriptions);
+        JsEventLoopCallbackContext* next = NULL;
+        left = false;
+        for(size_t i = 0; i < count; i++) {
+            size_t index = (module->replay_cursor + i) % count;
+            JsEventLoopSubscription* subscription =
+                *SubscriptionArray_get(module->subscriptions, index);
+            JsEventLoopCallbackContext* context = subscription->context;
+            if(!js_event_loop_backlog_size(context)) continue;
+            left = true;
+            if(!js_event_loop_has_budget(module, context->priority)) continue;
+
+            if(i != 0 || !module->replay_credits) {
+                module->replay_cursor = index;
+                module->replay_credits = js_event_loop_round_robin_weight[context->priority];
+            }
+            next = context;
+            break;
         }
+        if(!next) break;
+
+        if(--module->replay_credits == 0) module->replay_cursor++;
+        js_event_loop_backlog_replay(next);
     }
 
-    js_event_loop_callback_generic(param);
+    if(left) js_event_loop_schedule_replay(module);
 }
 
 /**
- * @brief Cancels an event subscription
+ * @brief Passes an item to JS now, or defers it if its priority class is out
+ * of budget for this quantum
+ * @returns false if the callback has cancelled its subscription
  */
-static void js_event_loop_subscription_cancel(struct mjs* mjs) {
-    JsEventLoopSubscription* subscription = JS_GET_CONTEXT(mjs);
+static bool js_event_loop_deliver(JsEventLoopCallbackContext* context, mjs_val_t item) {
+    JsEventLoop* module = context->module;
+    struct mjs* mjs = context->mjs;
+    uint32_t now = furi_get_tick();
+    js_event_loop_quantum_update(module);
 
-    if(subscription->object_type == JsEventLoopObjectTypeTimer) {
-        // timer operations are deferred, which creates lifetime issues
-        // just stop the timer and let the cleanup routine free everything when the script is done
-        furi_event_loop_timer_stop(subscription->object);
+    // keep the order of items: once something is deferred, so is the rest
+    if(!js_event_loop_backlog_size(context) && js_event_loop_has_budget(module, context->priority))
+        return js_event_loop_dispatch_item(context, item, now);
+
+    if(js_event_loop_backlog_size(context) >= BACKLOG_MAX) {
+        if(!js_event_loop_backlog_replay(context)) return false;
+    }
+
+    if(context->backlog == MJS_UNDEFINED) context->backlog = mjs_mk_array(mjs);
+    uint32_t tail = (context->backlog_head + context->backlog_size) % BACKLOG_MAX;
+    context->backlog_ticks[tail] = now;
+    mjs_array_set(mjs, context->backlog, tail, item);
+    context->backlog_size++;
+    context->deferred++;
+    js_event_loop_schedule_replay(module);
+    return true;
+}
+
+/**
+ * @brief Takes one item out of an object that has signalled an event
+ */
+static mjs_val_t js_event_loop_take_item(JsEventLoopCallbackContext* context, void* object) {
+    if(context->transformer)
+        return context->transformer(context->mjs, object, context->transformer_context);
+
+    // default behavior: take semaphores and mutexes
+    switch(context->object_type) {
+    case JsEventLoopObjectTypeSemaphore: {
+        FuriSemaphore* semaphore = object;
+        furi_check(furi_semaphore_acquire(semaphore, 0) == FuriStatusOk);
+    } break;
+    default:
+        // the corresponding check has been performed when we were given the contract
+        furi_crash();
+    }
+    return MJS_UNDEFINED;
+}
+
+/**
+ * @brief Number of items that can be taken out of an object without blocking
+ */
+static uint32_t js_event_loop_pending_items(JsEventLoopObjectType type, void* object) {
+    switch(type) {
+    case JsEventLoopObjectTypeQueue:
+        return furi_message_queue_get_count(object);
+    case JsEventLoopObjectTypeSemaphore:
+        return furi_semaphore_get_count(object);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Passes the collected items to JS and starts a new batch
+ */
+static void js_event_loop_batch_flush(JsEventLoopCallbackContext* context) {
+    if(context->batch_timer != JS_TIMER_ID_INVALID) {
+        js_timer_wheel_cancel(context->module->timers, context->batch_timer);
+        context->batch_timer = JS_TIMER_ID_INVALID;
+    }
+
+    mjs_val_t batch = context->batch;
+    context->batched = 0;
+    context->batch = mjs_mk_array(context->mjs);
+    js_event_loop_deliver(context, batch);
+}
+
+/**
+ * @brief Called by the timer wheel when the window of a batch closes
+ */
+static void js_event_loop_batch_timeout(void* param) {
+    JsEventLoopCallbackContext* context = param;
+    context->batch_timer = JS_TIMER_ID_INVALID;
+    js_event_loop_batch_flush(context);
+}
+
+/**
+ * @brief Handles non-timer events
+ *
+ * Batched subscriptions drain everything that's pending, up to the batch
+ * size, into an array. The array is passed to JS right away if it's full or
+ * if there's no window to wait for more items in.
+ */
+static void js_event_loop_callback(void* object, void* param) {
+    JsEventLoopCallbackContext* context = param;
+
+    if(!context->batch_size) {
+        js_event_loop_deliver(context, js_event_loop_take_item(context, object));
         return;
     }
 
-    furi_event_loop_unsubscribe(subscription->loop, subscription->object);
+    do {
+        mjs_array_push(context->mjs, context->batch, js_event_loop_take_item(context, object));
+        context->batched++;
+    } while(context->batched < context->batch_size &&
+            js_event_loop_pending_items(context->object_type, object));
+
+    if(context->batched >= context->batch_size || !context->batch_window) {
+        js_event_loop_batch_flush(context);
+    } else if(context->batch_timer == JS_TIMER_ID_INVALID) {
+        context->batch_timer = js_timer_wheel_add(
+            context->module->timers,
+            context->batch_window,
+            0,
+            js_event_loop_batch_timeout,
+            NULL,
+            context);
+    }
+}
+
+/**
+ * @brief Releases the values owned by a subscription and frees it
+ */
+static void js_event_loop_subscription_free(JsEventLoopSubscription* subscription) {
+    JsEventLoopCallbackContext* context = subscription->context;
+    if(context->batch_timer != JS_TIMER_ID_INVALID)
+        js_timer_wheel_cancel(context->module->timers, context->batch_timer);
+
+    // the JS object can outlive the subscription, make `cancel()` a no-op
+    mjs_set(
+        context->mjs,
+        context->arguments[0],
+        INST_PROP_NAME,
+        ~0,
+        mjs_mk_foreign(context->mjs, NULL));
+
+    mjs_disown(context->mjs, &context->callback);
+    mjs_disown(context->mjs, &context->batch);
+    mjs_disown(context->mjs, &context->backlog);
+    for(size_t i = 0; i < context->arity; i++)
+        mjs_disown(context->mjs, &context->arguments[i]);
 
-    free(subscription->context->arguments);
-    free(subscription->context);
+    free(context->arguments);
+    free(context);
 
     // find and remove ourselves from the array
     SubscriptionArray_it_t iterator;
@@ -133,28 +489,102 @@ static void js_event_loop_subscription_cancel(struct mjs* mjs) {
     }
     SubscriptionArray_remove(subscription->subscriptions, iterator);
     free(subscription);
+}
 
-    mjs_return(mjs, MJS_UNDEFINED);
+/**
+ * @brief Handles timer events
+ */
+static void js_event_loop_timer_callback(void* param) {
+    JsEventLoopSubscription* subscription = param;
+    js_event_loop_callback_generic(subscription->context);
 }
 
 /**
- * @brief Subscribes a JavaScript function to an event
+ * @brief Called by the timer wheel once a timer subscription is cancelled or
+ * a one-shot timer has fired
  */
-static void js_event_loop_subscribe(struct mjs* mjs) {
-    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+static void js_event_loop_timer_destructor(void* param) {
+    js_event_loop_subscription_free(param);
+}
 
-    // get arguments
-    static const JsValueDeclaration js_loop_subscribe_arg_list[] = {
-        JS_VALUE_SIMPLE(JsValueTypeRawPointer),
-        JS_VALUE_SIMPLE(JsValueTypeFunction),
-    };
-    static const JsValueArguments js_loop_subscribe_args =
-        JS_VALUE_ARGS(js_loop_subscribe_arg_list);
+/**
+ * @brief Makes the object returned by `stats()`
+ */
+static mjs_val_t js_event_loop_make_stats(struct mjs* mjs, JsEventLoopSubscription* subscription) {
+    JsEventLoopCallbackContext* context = subscription->context;
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    uint32_t dispatched = MAX(context->dispatched, 1UL);
+    uint32_t pending =
+        js_event_loop_pending_items(subscription->object_type, subscription->object);
 
-    JsEventLoopContract* contract;
-    mjs_val_t callback;
-    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_subscribe_args, &contract, &callback);
+    mjs_val_t stats = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, stats) {
+        JS_FIELD(
+            "priority",
+            mjs_mk_string(
+                mjs, js_event_loop_priority_variants[context->priority].string_value, ~0, false));
+        JS_FIELD("dispatched", mjs_mk_number(mjs, context->dispatched));
+        JS_FIELD("deferred", mjs_mk_number(mjs, context->deferred));
+        JS_FIELD("backlog", mjs_mk_number(mjs, js_event_loop_backlog_size(context)));
+        JS_FIELD("pending", mjs_mk_number(mjs, pending));
+        JS_FIELD("maxLatencyMs", mjs_mk_number(mjs, context->max_latency));
+        JS_FIELD(
+            "avgLatencyMs", mjs_mk_number(mjs, (double)context->total_latency / dispatched));
+        JS_FIELD("maxCallUs", mjs_mk_number(mjs, context->max_call_cycles / cycles_per_us));
+        JS_FIELD(
+            "avgCallUs",
+            mjs_mk_number(mjs, (double)context->total_call_cycles / cycles_per_us / dispatched));
+    }
+    return stats;
+}
+
+/**
+ * @brief Returns dispatch statistics of a subscription
+ */
+static void js_event_loop_subscription_stats(struct mjs* mjs) {
+    JsEventLoopSubscription* subscription = JS_GET_CONTEXT(mjs);
+    if(!subscription) JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "subscription is cancelled");
+    mjs_return(mjs, js_event_loop_make_stats(mjs, subscription));
+}
 
+/**
+ * @brief Cancels an event subscription
+ */
+static void js_event_loop_subscription_cancel(struct mjs* mjs) {
+    JsEventLoopSubscription* subscription = JS_GET_CONTEXT(mjs);
+    mjs_return(mjs, MJS_UNDEFINED);
+    if(!subscription) return;
+
+    if(subscription->object_type == JsEventLoopObjectTypeTimer) {
+        // the subscription is freed by `js_event_loop_timer_destructor`, which
+        // is deferred if the timer is currently running
+        js_timer_wheel_cancel(subscription->timers, subscription->timer_id);
+        return;
+    }
+
+    if(subscription->context->cancelled) return;
+    furi_event_loop_unsubscribe(subscription->loop, subscription->object);
+    if(subscription->context->dispatching) {
+        // we're inside of this subscription's callback, which still needs the context
+        subscription->context->cancelled = true;
+    } else {
+        js_event_loop_subscription_free(subscription);
+    }
+}
+
+/**
+ * @brief Subscribes a JavaScript function to an event
+ * @param first_arg Index of the first JS argument that is passed through to
+ * the callback
+ * @returns The JS subscription object
+ */
+static mjs_val_t js_event_loop_subscribe_common(
+    struct mjs* mjs,
+    JsEventLoop* module,
+    JsEventLoopContract* contract,
+    mjs_val_t callback,
+    size_t first_arg,
+    const JsEventLoopSubscribeOptions* options) {
     // create subscription object
     JsEventLoopSubscription* subscription = malloc(sizeof(JsEventLoopSubscription));
     JsEventLoopCallbackContext* context = malloc(sizeof(JsEventLoopCallbackContext));
@@ -162,20 +592,44 @@ static void js_event_loop_subscribe(struct mjs* mjs) {
     subscription->object_type = contract->object_type;
     subscription->context = context;
     subscription->subscriptions = module->subscriptions;
-    if(contract->object_type == JsEventLoopObjectTypeTimer) subscription->contract = contract;
+    subscription->timers = module->timers;
+    subscription->contract = contract;
     mjs_val_t subscription_obj = mjs_mk_object(mjs);
     mjs_set(mjs, subscription_obj, INST_PROP_NAME, ~0, mjs_mk_foreign(mjs, subscription));
     mjs_set(mjs, subscription_obj, "cancel", ~0, MJS_MK_FN(js_event_loop_subscription_cancel));
+    mjs_set(mjs, subscription_obj, "stats", ~0, MJS_MK_FN(js_event_loop_subscription_stats));
 
     // create callback context
     context->event_loop = module->loop;
+    context->module = module;
     context->object_type = contract->object_type;
-    context->arity = mjs_nargs(mjs) - SYSTEM_ARGS + 2;
+    context->stateless = options->stateless;
+    context->subscription = subscription;
+    context->dispatching = false;
+    context->cancelled = false;
+    context->batch_size = options->batch;
+    if(!context->batch_size && options->window) context->batch_size = BATCH_SIZE_DEFAULT;
+    context->batch_window = furi_ms_to_ticks(options->window);
+    context->batched = 0;
+    context->batch = context->batch_size ? mjs_mk_array(mjs) : MJS_UNDEFINED;
+    context->batch_timer = JS_TIMER_ID_INVALID;
+    context->priority = options->priority;
+    if(context->priority == JsEventLoopPriorityCount) {
+        bool is_timer = contract->object_type == JsEventLoopObjectTypeTimer;
+        // timers pace themselves
+        context->priority = is_timer ? JsEventLoopPriorityHigh : contract->non_timer.priority;
+    }
+    context->backlog = MJS_UNDEFINED;
+    context->backlog_head = context->backlog_size = 0;
+    context->dispatched = context->deferred = 0;
+    context->max_latency = context->max_call_cycles = 0;
+    context->total_latency = context->total_call_cycles = 0;
+    context->arity = mjs_nargs(mjs) - first_arg + SYSTEM_ARGS;
     context->arguments = calloc(context->arity, sizeof(mjs_val_t));
     context->arguments[0] = subscription_obj;
     context->arguments[1] = MJS_UNDEFINED;
     for(size_t i = SYSTEM_ARGS; i < context->arity; i++) {
-        mjs_val_t arg = mjs_arg(mjs, i - SYSTEM_ARGS + 2);
+        mjs_val_t arg = mjs_arg(mjs, i - SYSTEM_ARGS + first_arg);
         context->arguments[i] = arg;
         mjs_own(mjs, &context->arguments[i]);
     }
@@ -184,6 +638,8 @@ static void js_event_loop_subscribe(struct mjs* mjs) {
     mjs_own(mjs, &context->callback);
     mjs_own(mjs, &context->arguments[0]);
     mjs_own(mjs, &context->arguments[1]);
+    mjs_own(mjs, &context->batch);
+    mjs_own(mjs, &context->backlog);
 
     // queue and stream contracts must have a transform callback, others are allowed to delegate
     // the obvious default behavior to this module
@@ -197,10 +653,15 @@ static void js_event_loop_subscribe(struct mjs* mjs) {
     // subscribe
     switch(contract->object_type) {
     case JsEventLoopObjectTypeTimer: {
-        FuriEventLoopTimer* timer = furi_event_loop_timer_alloc(
-            module->loop, js_event_loop_callback_generic, contract->timer.type, context);
-        furi_event_loop_timer_start(timer, contract->timer.interval_ticks);
-        contract->object = timer;
+        uint32_t interval = contract->timer.interval_ticks;
+        bool periodic = contract->timer.type == FuriEventLoopTimerTypePeriodic;
+        subscription->timer_id = js_timer_wheel_add(
+            module->timers,
+            interval,
+            periodic ? MAX(interval, 1UL) : 0,
+            js_event_loop_timer_callback,
+            js_event_loop_timer_destructor,
+            subscription);
     } break;
     case JsEventLoopObjectTypeSemaphore:
         furi_event_loop_subscribe_semaphore(
@@ -224,7 +685,98 @@ static void js_event_loop_subscribe(struct mjs* mjs) {
 
     subscription->object = contract->object;
     SubscriptionArray_push_back(module->subscriptions, subscription);
-    mjs_return(mjs, subscription_obj);
+    return subscription_obj;
+}
+
+/**
+ * @brief Subscribes a JavaScript function to an event:
+ * `subscribe(contract, callback, ...args)`
+ */
+static void js_event_loop_subscribe(struct mjs* mjs) {
+    static const JsValueDeclaration js_loop_subscribe_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeRawPointer),
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+    };
+    static const JsValueArguments js_loop_subscribe_args =
+        JS_VALUE_ARGS(js_loop_subscribe_arg_list);
+
+    JsEventLoopContract* contract;
+    mjs_val_t callback;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_subscribe_args, &contract, &callback);
+
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    static const JsEventLoopSubscribeOptions default_options = {
+        .priority = JsEventLoopPriorityCount,
+    };
+    mjs_return(
+        mjs, js_event_loop_subscribe_common(mjs, module, contract, callback, 2, &default_options));
+}
+
+/**
+ * @brief Subscribes a JavaScript function to an event with extra options:
+ * `subscribeWith(contract, options, callback, ...args)`
+ *
+ * With `stateless: true` the return value of the callback is ignored and the
+ * extra arguments are passed unchanged on every call, which is cheaper for
+ * high-rate events.
+ *
+ * With `batch: n` and/or `window: ms` the callback receives an array of up to
+ * `n` items instead of a single item: everything that's pending when the
+ * first item arrives, plus whatever arrives within `window` milliseconds.
+ * Only queues and semaphores can be batched.
+ *
+ * `priority` is one of `"high"`, `"normal"` and `"low"` and defaults to the
+ * priority suggested by the contract.
+ */
+static void js_event_loop_subscribe_with(struct mjs* mjs) {
+    static const JsValueDeclaration js_loop_stateless = JS_VALUE_SIMPLE_W_DEFAULT(
+        JsValueTypeBool, bool_val, false);
+
+    static const JsValueDeclaration js_loop_batch =
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 0);
+    static const JsValueDeclaration js_loop_window =
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 0);
+    static const JsValueDeclaration js_loop_priority = JS_VALUE_ENUM_W_DEFAULT(
+        JsEventLoopPriority, js_event_loop_priority_variants, JsEventLoopPriorityCount);
+
+    static const JsValueObjectField js_loop_options_fields[] = {
+        {"stateless", &js_loop_stateless},
+        {"batch", &js_loop_batch},
+        {"window", &js_loop_window},
+        {"priority", &js_loop_priority},
+    };
+
+    static const JsValueDeclaration js_loop_subscribe_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeRawPointer),
+        JS_VALUE_OBJECT_W_DEFAULTS(js_loop_options_fields),
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+    };
+    static const JsValueArguments js_loop_subscribe_args =
+        JS_VALUE_ARGS(js_loop_subscribe_arg_list);
+
+    JsEventLoopContract* contract;
+    JsEventLoopSubscribeOptions options;
+    mjs_val_t callback;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(
+        mjs,
+        &js_loop_subscribe_args,
+        &contract,
+        &options.stateless,
+        &options.batch,
+        &options.window,
+        &options.priority,
+        &callback);
+
+    if(options.batch < 0 || options.window < 0)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "batch and window can't be negative");
+    if((options.batch || options.window) &&
+       contract->object_type != JsEventLoopObjectTypeQueue &&
+       contract->object_type != JsEventLoopObjectTypeSemaphore)
+        JS_ERROR_AND_RETURN(
+            mjs, MJS_BAD_ARGS_ERROR, "only queues and semaphores can be batched");
+
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    mjs_return(mjs, js_event_loop_subscribe_common(mjs, module, contract, callback, 3, &options));
 }
 
 /**
@@ -232,7 +784,26 @@ static void js_event_loop_subscribe(struct mjs* mjs) {
  */
 static void js_event_loop_run(struct mjs* mjs) {
     JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    module->running = true;
     furi_event_loop_run(module->loop);
+    module->running = false;
+}
+
+/**
+ * @brief Returns dispatch statistics of all active subscriptions
+ */
+static void js_event_loop_stats(struct mjs* mjs) {
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    mjs_val_t result = mjs_mk_array(mjs);
+
+    SubscriptionArray_it_t iterator;
+    for(SubscriptionArray_it(iterator, module->subscriptions); !SubscriptionArray_end_p(iterator);
+        SubscriptionArray_next(iterator)) {
+        JsEventLoopSubscription* subscription = *SubscriptionArray_cref(iterator);
+        mjs_array_push(mjs, result, js_event_loop_make_stats(mjs, subscription));
+    }
+
+    mjs_return(mjs, result);
 }
 
 /**
@@ -243,6 +814,91 @@ static void js_event_loop_stop(struct mjs* mjs) {
     furi_event_loop_stop(module->loop);
 }
 
+/**
+ * @brief Benchmark transformer: takes the semaphore and stops the loop once
+ * all events have been delivered. The item is the number of events left.
+ */
+static mjs_val_t js_event_loop_benchmark_transformer(
+    struct mjs* mjs,
+    FuriEventLoopObject* object,
+    void* context) {
+    JsEventLoop* module = context;
+    furi_check(furi_semaphore_acquire(object, 0) == FuriStatusOk);
+    uint32_t left = furi_semaphore_get_count(object);
+    if(!left) furi_event_loop_stop(module->loop);
+    return mjs_mk_number(mjs, left);
+}
+
+/**
+ * @brief Measures event dispatch throughput:
+ * `benchmark(callback, events = 10000, stateless = false)`
+ *
+ * Delivers `events` semaphore events to `callback` through the regular
+ * dispatch path and returns `{events, ms, eventsPerSecond}`. Must be called
+ * before `run()`. The subscription has high priority, so that the result
+ * isn't skewed by scheduling.
+ */
+static void js_event_loop_benchmark(struct mjs* mjs) {
+    static const JsValueDeclaration js_loop_benchmark_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 10000),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeBool, bool_val, false),
+    };
+    static const JsValueArguments js_loop_benchmark_args =
+        JS_VALUE_ARGS(js_loop_benchmark_arg_list);
+
+    mjs_val_t callback;
+    int32_t events;
+    JsEventLoopSubscribeOptions options = {.priority = JsEventLoopPriorityHigh};
+    JS_VALUE_PARSE_ARGS_OR_RETURN(
+        mjs, &js_loop_benchmark_args, &callback, &events, &options.stateless);
+
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    if(module->running)
+        JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "can't benchmark a running loop");
+    if(events <= 0) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "events must be positive");
+
+    FuriSemaphore* semaphore = furi_semaphore_alloc(events, events);
+    JsEventLoopContract contract = {
+        .magic = JsForeignMagic_JsEventLoopContract,
+        .object_type = JsEventLoopObjectTypeSemaphore,
+        .object = semaphore,
+        .non_timer =
+            {
+                .event = FuriEventLoopEventIn,
+                .transformer = js_event_loop_benchmark_transformer,
+                .transformer_context = module,
+            },
+    };
+    mjs_val_t subscription_obj = js_event_loop_subscribe_common(
+        mjs, module, &contract, callback, mjs_nargs(mjs), &options);
+
+    uint32_t start = furi_get_tick();
+    module->running = true;
+    furi_event_loop_run(module->loop);
+    module->running = false;
+    uint32_t elapsed = (furi_get_tick() - start) * 1000 / furi_kernel_get_tick_frequency();
+
+    // the callback may have cancelled the subscription by itself
+    JsEventLoopSubscription* subscription = JS_GET_INST(mjs, subscription_obj);
+    if(subscription) {
+        furi_event_loop_unsubscribe(module->loop, semaphore);
+        js_event_loop_subscription_free(subscription);
+    }
+    uint32_t delivered = events - furi_semaphore_get_count(semaphore);
+    furi_semaphore_free(semaphore);
+
+    mjs_val_t result = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, result) {
+        JS_FIELD("events", mjs_mk_number(mjs, delivered));
+        JS_FIELD("ms", mjs_mk_number(mjs, elapsed));
+        JS_FIELD(
+            "eventsPerSecond",
+            mjs_mk_number(mjs, elapsed ? (double)delivered * 1000 / elapsed : 0));
+    }
+    mjs_return(mjs, result);
+}
+
 /**
  * @brief Creates a timer event that can be subscribed to just like any other
  * event
@@ -282,22 +938,303 @@ static void js_event_loop_timer(struct mjs* mjs) {
 }
 
 /**
- * @brief Queue transformer. Takes `mjs_val_t` pointers out of a queue and
- * returns their dereferenced value
+ * @brief Common part of `setTimeout` and `setInterval`
+ */
+static void js_event_loop_set_timer(struct mjs* mjs, bool periodic) {
+    static const JsValueDeclaration js_loop_set_timer_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+    };
+    static const JsValueArguments js_loop_set_timer_args =
+        JS_VALUE_ARGS(js_loop_set_timer_arg_list);
+
+    mjs_val_t callback;
+    int32_t delay;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_set_timer_args, &callback, &delay);
+
+    size_t arity = mjs_nargs(mjs) - 2;
+    if(arity > JS_TIMER_WHEEL_ARGS_MAX)
+        JS_ERROR_AND_RETURN(
+            mjs, MJS_BAD_ARGS_ERROR, "at most %d callback arguments", JS_TIMER_WHEEL_ARGS_MAX);
+
+    mjs_val_t arguments[JS_TIMER_WHEEL_ARGS_MAX];
+    for(size_t i = 0; i < arity; i++)
+        arguments[i] = mjs_arg(mjs, i + 2);
+
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    uint32_t ticks = furi_ms_to_ticks(MAX(delay, 0));
+    JsTimerId id = js_timer_wheel_add_js(
+        module->timers, ticks, periodic ? MAX(ticks, 1UL) : 0, callback, arguments, arity);
+    mjs_return(mjs, mjs_mk_number(mjs, id));
+}
+
+/**
+ * @brief Calls a function once after a delay, returns a timer ID
+ */
+static void js_event_loop_set_timeout(struct mjs* mjs) {
+    js_event_loop_set_timer(mjs, false);
+}
+
+/**
+ * @brief Calls a function periodically, returns a timer ID
+ */
+static void js_event_loop_set_interval(struct mjs* mjs) {
+    js_event_loop_set_timer(mjs, true);
+}
+
+/**
+ * @brief Cancels a timer made with `setTimeout` or `setInterval`. Stale IDs
+ * are ignored.
+ */
+static void js_event_loop_clear_timer(struct mjs* mjs) {
+    static const JsValueDeclaration js_loop_clear_timer_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeDouble),
+    };
+    static const JsValueArguments js_loop_clear_timer_args =
+        JS_VALUE_ARGS(js_loop_clear_timer_arg_list);
+
+    double id;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_clear_timer_args, &id);
+
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    js_timer_wheel_cancel(module->timers, (JsTimerId)id);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+// =====
+// Tasks
+// =====
+
+/**
+ * @brief Default time slice of a task in milliseconds
+ */
+#define TASK_SLICE_DEFAULT 8
+
+/**
+ * @brief Cooperative task made by `task()`
+ */
+typedef struct {
+    JsEventLoop* module;
+    struct mjs* mjs;
+    uint32_t slice; //<! Ticks that a turn may take
+    bool running; //<! A step or the completion callback is running
+    bool cancelled; //<! Cancelled while running, freed once the turn is over
+
+    uint32_t steps;
+    uint32_t turns;
+    uint32_t ticks; //<! Time spent in steps
+
+    mjs_val_t object; //<! JS task object, owned
+    mjs_val_t step; //<! Owned
+    mjs_val_t state; //<! Owned
+    mjs_val_t on_done; //<! Owned, may be undefined
+} JsEventLoopTask;
+
+/**
+ * @brief Releases the values owned by a task and frees it
+ */
+static void js_event_loop_task_free(JsEventLoopTask* task) {
+    JsEventLoop* module = task->module;
+    struct mjs* mjs = task->mjs;
+
+    // the JS object can outlive the task, make `cancel()` a no-op
+    mjs_set(mjs, task->object, INST_PROP_NAME, ~0, mjs_mk_foreign(mjs, NULL));
+    mjs_disown(mjs, &task->object);
+    mjs_disown(mjs, &task->step);
+    mjs_disown(mjs, &task->state);
+    mjs_disown(mjs, &task->on_done);
+
+    for(size_t i = 0; i < TaskArray_size(module->tasks); i++) {
+        if(*TaskArray_get(module->tasks, i) != task) continue;
+        TaskArray_erase(module->tasks, i);
+        if(i < module->task_cursor) module->task_cursor--;
+        break;
+    }
+    free(task);
+}
+
+static void js_event_loop_task_turn(void* param);
+
+/**
+ * @brief Schedules the next turn for the next tick, which lets the event
+ * loop handle everything that has arrived in the meantime
+ */
+static void js_event_loop_schedule_tasks(JsEventLoop* module) {
+    if(module->task_timer != JS_TIMER_ID_INVALID) return;
+    if(TaskArray_empty_p(module->tasks)) return;
+    module->task_timer =
+        js_timer_wheel_add(module->timers, 0, 0, js_event_loop_task_turn, NULL, module);
+}
+
+/**
+ * @brief Gives the next task in round-robin order one time slice
+ *
+ * The step function is called until it returns anything but `true` or the
+ * slice is used up. One task runs per turn, so that events are handled
+ * between the slices of different tasks too.
+ */
+static void js_event_loop_task_turn(void* param) {
+    JsEventLoop* module = param;
+    module->task_timer = JS_TIMER_ID_INVALID;
+    if(TaskArray_empty_p(module->tasks)) return;
+
+    if(module->task_cursor >= TaskArray_size(module->tasks)) module->task_cursor = 0;
+    JsEventLoopTask* task = *TaskArray_get(module->tasks, module->task_cursor++);
+    struct mjs* mjs = task->mjs;
+    task->running = true;
+    task->turns++;
+
+    uint32_t start = furi_get_tick();
+    mjs_val_t result;
+    mjs_err_t error;
+    bool more;
+    do {
+        error = mjs_apply(mjs, &result, task->step, MJS_UNDEFINED, 1, &task->state);
+        task->steps++;
+        more = error == MJS_OK && mjs_is_boolean(result) && mjs_get_bool(mjs, result);
+    } while(more && !task->cancelled && furi_get_tick() - start < task->slice);
+    task->ticks += furi_get_tick() - start;
+    js_event_loop_dispatched(module, error);
+
+    if(!more && !task->cancelled && error == MJS_OK && mjs_is_function(task->on_done)) {
+        mjs_val_t arguments[] = {result, task->state};
+        error = mjs_apply(
+            mjs, &result, task->on_done, MJS_UNDEFINED, COUNT_OF(arguments), arguments);
+        js_event_loop_dispatched(module, error);
+    }
+
+    task->running = false;
+    if(!more || task->cancelled) js_event_loop_task_free(task);
+    js_event_loop_schedule_tasks(module);
+}
+
+/**
+ * @brief Cancels a task. A running task stops after its current step.
+ */
+static void js_event_loop_task_cancel(struct mjs* mjs) {
+    JsEventLoopTask* task = JS_GET_CONTEXT(mjs);
+    mjs_return(mjs, MJS_UNDEFINED);
+    if(!task) return;
+
+    if(task->running) {
+        task->cancelled = true;
+    } else {
+        js_event_loop_task_free(task);
+    }
+}
+
+/**
+ * @brief Returns the progress of a task: `{ steps, turns, ms }`
+ */
+static void js_event_loop_task_stats(struct mjs* mjs) {
+    JsEventLoopTask* task = JS_GET_CONTEXT(mjs);
+    if(!task) JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "task is finished");
+
+    double ms = task->ticks * 1000.0 / furi_kernel_get_tick_frequency();
+    mjs_val_t stats = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, stats) {
+        JS_FIELD("steps", mjs_mk_number(mjs, task->steps));
+        JS_FIELD("turns", mjs_mk_number(mjs, task->turns));
+        JS_FIELD("ms", mjs_mk_number(mjs, ms));
+    }
+    mjs_return(mjs, stats);
+}
+
+/**
+ * @brief Starts a cooperative task: `task(step, state, { slice, onDone })`
+ *
+ * `step(state)` does a small piece of work and returns `true` while there's
+ * more to do. It is called repeatedly for up to `slice` milliseconds per turn,
+ * after which the event loop gets to handle pending events and other tasks
+ * get their turns. Any other return value finishes the task and is passed to
+ * `onDone(result, state)`.
+ */
+static void js_event_loop_task(struct mjs* mjs) {
+    static const JsValueDeclaration js_loop_task_slice =
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, TASK_SLICE_DEFAULT);
+    static const JsValueDeclaration js_loop_task_on_done = JS_VALUE_SIMPLE(JsValueTypeAny);
+
+    static const JsValueObjectField js_loop_task_options_fields[] = {
+        {"slice", &js_loop_task_slice},
+        {"onDone", &js_loop_task_on_done},
+    };
+
+    static const JsValueDeclaration js_loop_task_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_OBJECT_W_DEFAULTS(js_loop_task_options_fields),
+    };
+    static const JsValueArguments js_loop_task_args = JS_VALUE_ARGS(js_loop_task_arg_list);
+
+    mjs_val_t step, state, on_done;
+    int32_t slice;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_task_args, &step, &state, &slice, &on_done);
+
+    if(slice <= 0) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "slice must be positive");
+    if(!mjs_is_undefined(on_done) && !mjs_is_function(on_done))
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "onDone must be a function");
+
+    JsEventLoop* module = JS_GET_CONTEXT(mjs);
+    JsEventLoopTask* task = malloc(sizeof(JsEventLoopTask));
+    task->module = module;
+    task->mjs = mjs;
+    task->slice = MAX(furi_ms_to_ticks(slice), 1UL);
+    task->running = false;
+    task->cancelled = false;
+    task->steps = task->turns = task->ticks = 0;
+    task->step = step;
+    task->state = state;
+    task->on_done = on_done;
+    task->object = mjs_mk_object(mjs);
+    mjs_own(mjs, &task->object);
+    mjs_own(mjs, &task->step);
+    mjs_own(mjs, &task->state);
+    mjs_own(mjs, &task->on_done);
+
+    JS_ASSIGN_MULTI(mjs, task->object) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, task));
+        JS_FIELD("cancel", MJS_MK_FN(js_event_loop_task_cancel));
+        JS_FIELD("stats", MJS_MK_FN(js_event_loop_task_stats));
+    }
+
+    TaskArray_push_back(module->tasks, task);
+    js_event_loop_schedule_tasks(module);
+    mjs_return(mjs, task->object);
+}
+
+/**
+ * @brief Message storage of a queue made by `queue()`
+ *
+ * mJS requires owned values to stay at the same address, so messages can't
+ * be stored in the `FuriMessageQueue` itself. Instead, every queue gets one
+ * slot per entry that's owned for its whole lifetime; the queue carries slot
+ * indices. Queues are FIFO and only filled by `send()`, so slots are used in
+ * ring order.
+ */
+typedef struct {
+    uint32_t length;
+    uint32_t write_index;
+    mjs_val_t slots[];
+} JsEventLoopQueueSlab;
+
+/**
+ * @brief Queue transformer. Takes slot indices out of a queue and returns the
+ * values in those slots
  */
 static mjs_val_t
     js_event_loop_queue_transformer(struct mjs* mjs, FuriEventLoopObject* object, void* context) {
-    UNUSED(context);
-    mjs_val_t* message_ptr;
-    furi_check(furi_message_queue_get(object, &message_ptr, 0) == FuriStatusOk);
-    mjs_val_t message = *message_ptr;
-    mjs_disown(mjs, message_ptr);
-    free(message_ptr);
+    UNUSED(mjs);
+    JsEventLoopQueueSlab* slab = context;
+    uint32_t slot;
+    furi_check(furi_message_queue_get(object, &slot, 0) == FuriStatusOk);
+    mjs_val_t message = slab->slots[slot];
+    slab->slots[slot] = MJS_UNDEFINED;
     return message;
 }
 
 /**
- * @brief Sends a message to a queue
+ * @brief Sends a message to a queue. Messages sent to a full queue are
+ * dropped.
  */
 static void js_event_loop_queue_send(struct mjs* mjs) {
     // get arguments
@@ -310,12 +1247,15 @@ static void js_event_loop_queue_send(struct mjs* mjs) {
     JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_q_send_args, &message);
 
     JsEventLoopContract* contract = JS_GET_CONTEXT(mjs);
+    JsEventLoopQueueSlab* slab = contract->non_timer.transformer_context;
 
     // send message
-    mjs_val_t* message_ptr = malloc(sizeof(mjs_val_t));
-    *message_ptr = message;
-    mjs_own(mjs, message_ptr);
-    furi_message_queue_put(contract->object, &message_ptr, 0);
+    if(furi_message_queue_get_space(contract->object)) {
+        uint32_t slot = slab->write_index;
+        slab->write_index = (slot + 1) % slab->length;
+        slab->slots[slot] = message;
+        furi_check(furi_message_queue_put(contract->object, &slot, 0) == FuriStatusOk);
+    }
 
     mjs_return(mjs, MJS_UNDEFINED);
 }
@@ -332,20 +1272,31 @@ static void js_event_loop_queue(struct mjs* mjs) {
 
     int32_t length;
     JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_loop_q_args, &length);
+    if(length <= 0) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "length must be positive");
 
     JsEventLoop* module = JS_GET_CONTEXT(mjs);
 
+    // allocate message slots, owned until the module is destroyed
+    JsEventLoopQueueSlab* slab =
+        malloc(sizeof(JsEventLoopQueueSlab) + (size_t)length * sizeof(mjs_val_t));
+    slab->length = length;
+    slab->write_index = 0;
+    for(int32_t i = 0; i < length; i++) {
+        slab->slots[i] = MJS_UNDEFINED;
+        mjs_own(mjs, &slab->slots[i]);
+    }
+
     // make queue contract
     JsEventLoopContract* contract = malloc(sizeof(JsEventLoopContract));
     *contract = (JsEventLoopContract){
         .magic = JsForeignMagic_JsEventLoopContract,
         .object_type = JsEventLoopObjectTypeQueue,
-        // we could store `mjs_val_t`s in the queue directly if not for mJS' requirement to have consistent pointers to owned values
-        .object = furi_message_queue_alloc((size_t)length, sizeof(mjs_val_t*)),
+        .object = furi_message_queue_alloc((size_t)length, sizeof(uint32_t)),
         .non_timer =
             {
                 .event = FuriEventLoopEventIn,
                 .transformer = js_event_loop_queue_transformer,
+                .transformer_context = slab,
             },
     };
     ContractArray_push_back(module->owned_contracts, contract);
@@ -358,31 +1309,54 @@ static void js_event_loop_queue(struct mjs* mjs) {
     mjs_return(mjs, queue);
 }
 
-static void* js_event_loop_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+void* js_event_loop_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
     UNUSED(modules);
     mjs_val_t event_loop_obj = mjs_mk_object(mjs);
     JsEventLoop* module = malloc(sizeof(JsEventLoop));
     module->loop = furi_event_loop_alloc();
+    module->mjs = mjs;
+    module->running = false;
+    module->stop_poll_tick = 0;
+    module->stop_poll_pending = false;
+    module->quantum_start = furi_get_tick();
+    memset(module->quantum_used, 0, sizeof(module->quantum_used));
+    module->replay_timer = JS_TIMER_ID_INVALID;
+    module->replay_cursor = 0;
+    module->replay_credits = 0;
+    module->timers =
+        js_timer_wheel_alloc(module->loop, mjs, js_event_loop_dispatched, module);
     SubscriptionArray_init(module->subscriptions);
     ContractArray_init(module->owned_contracts);
+    TaskArray_init(module->tasks);
+    module->task_cursor = 0;
+    module->task_timer = JS_TIMER_ID_INVALID;
 
     JS_ASSIGN_MULTI(mjs, event_loop_obj) {
         JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, module));
         JS_FIELD("subscribe", MJS_MK_FN(js_event_loop_subscribe));
+        JS_FIELD("subscribeWith", MJS_MK_FN(js_event_loop_subscribe_with));
         JS_FIELD("run", MJS_MK_FN(js_event_loop_run));
         JS_FIELD("stop", MJS_MK_FN(js_event_loop_stop));
         JS_FIELD("timer", MJS_MK_FN(js_event_loop_timer));
+        JS_FIELD("setTimeout", MJS_MK_FN(js_event_loop_set_timeout));
+        JS_FIELD("setInterval", MJS_MK_FN(js_event_loop_set_interval));
+        JS_FIELD("clearTimeout", MJS_MK_FN(js_event_loop_clear_timer));
+        JS_FIELD("clearInterval", MJS_MK_FN(js_event_loop_clear_timer));
         JS_FIELD("queue", MJS_MK_FN(js_event_loop_queue));
+        JS_FIELD("benchmark", MJS_MK_FN(js_event_loop_benchmark));
+        JS_FIELD("task", MJS_MK_FN(js_event_loop_task));
+        JS_FIELD("stats", MJS_MK_FN(js_event_loop_stats));
     }
 
     *object = event_loop_obj;
     return module;
 }
 
-static void js_event_loop_destroy(void* inst) {
+void js_event_loop_destroy(void* inst) {
     if(inst) {
         JsEventLoop* module = inst;
         furi_event_loop_stop(module->loop);
+        js_timer_wheel_free(module->timers);
 
         // free subscriptions
         SubscriptionArray_it_t sub_iterator;
@@ -396,28 +1370,34 @@ static void js_event_loop_destroy(void* inst) {
         }
         SubscriptionArray_clear(module->subscriptions);
 
+        // free tasks
+        TaskArray_it_t task_iterator;
+        for(TaskArray_it(task_iterator, module->tasks); !TaskArray_end_p(task_iterator);
+            TaskArray_next(task_iterator)) {
+            free(*TaskArray_cref(task_iterator));
+        }
+        TaskArray_clear(module->tasks);
+
         // free owned contracts
         ContractArray_it_t iterator;
         for(ContractArray_it(iterator, module->owned_contracts); !ContractArray_end_p(iterator);
             ContractArray_next(iterator)) {
-            // unsubscribe object
+            // timer contracts don't own an object, timers live in the wheel
             JsEventLoopContract* contract = *ContractArray_cref(iterator);
             if(contract->object_type == JsEventLoopObjectTypeTimer) {
-                furi_event_loop_timer_stop(contract->object);
-            } else {
-                furi_event_loop_unsubscribe(module->loop, contract->object);
+                free(contract);
+                continue;
             }
 
-            // free object
+            // unsubscribe and free object
+            furi_event_loop_unsubscribe(module->loop, contract->object);
             switch(contract->object_type) {
-            case JsEventLoopObjectTypeTimer:
-                furi_event_loop_timer_free(contract->object);
-                break;
             case JsEventLoopObjectTypeSemaphore:
                 furi_semaphore_free(contract->object);
                 break;
             case JsEventLoopObjectTypeQueue:
                 furi_message_queue_free(contract->object);
+                free(contract->non_timer.transformer_context);
                 break;
             default:
                 furi_crash("unimplemented");
@@ -432,25 +1412,6 @@ static void js_event_loop_destroy(void* inst) {
     }
 }
 
-extern const ElfApiInterface js_event_loop_hashtable_api_interface;
-
-static const JsModuleDescriptor js_event_loop_desc = {
-    "event_loop",
-    js_event_loop_create,
-    js_event_loop_destroy,
-    &js_event_loop_hashtable_api_interface,
-};
-
-static const FlipperAppPluginDescriptor plugin_descriptor = {
-    .appid = PLUGIN_APP_ID,
-    .ep_api_version = PLUGIN_API_VERSION,
-    .entry_point = &js_event_loop_desc,
-};
-
-const FlipperAppPluginDescriptor* js_event_loop_ep(void) {
-    return &plugin_descriptor;
-}
-
 FuriEventLoop* js_event_loop_get_loop(JsEventLoop* loop) {
     // porta: not the proudest function that i ever wrote
     furi_check(loop);
@@ -41,10 +41,26 @@ typedef enum {
 typedef mjs_val_t (
     *JsEventLoopTransformer)(struct mjs* mjs, FuriEventLoopObject* object, void* context);
 
+/**
+ * @brief Scheduling class of a subscription
+ *
+ * Normal and low priority subscriptions may only make a limited number of
+ * JS calls per scheduling quantum; further events are deferred and replayed
+ * in weighted round-robin order. High priority subscriptions are never
+ * deferred and should be reserved for user input.
+ */
+typedef enum {
+    JsEventLoopPriorityNormal,
+    JsEventLoopPriorityHigh,
+    JsEventLoopPriorityLow,
+    JsEventLoopPriorityCount,
+} JsEventLoopPriority;
+
 typedef struct {
     FuriEventLoopEvent event;
     JsEventLoopTransformer transformer;
     void* transformer_context;
+    JsEventLoopPriority priority; //<! Default priority of subscriptions to this contract
 } JsEventLoopNonTimerContract;
 
 typedef struct {
@@ -99,6 +115,17 @@ static_assert(offsetof(JsEventLoopContract, magic) == 0);
  */
 FuriEventLoop* js_event_loop_get_loop(JsEventLoop* loop);
 
+/**
+ * @brief Symbols that modules loaded as plugins resolve through
+ *
+ * `event_loop` is built into the app, so this table is added to the API
+ * resolver when a script requires it.
+ */
+extern const ElfApiInterface js_event_loop_hashtable_api_interface;
+
+void* js_event_loop_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
+void js_event_loop_destroy(void* inst);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,406 @@
+#include "js_event_loop_timer_wheel.h"
+#include <mlib/m-array.h>
+
+#define SLOT_BITS   6
+#define SLOTS       (1 << SLOT_BITS)
+#define SLOT_MASK   (SLOTS - 1)
+#define CHUNK_NODES 16
+#define NIL         UINT16_MAX
+
+/**
+ * @brief Node states other than "scheduled on level n"
+ */
+typedef enum {
+    JsTimerStateExpiring = 0xFD, //<! Due, waiting in the `expiring` list
+    JsTimerStateRunning = 0xFE, //<! Callback is being called
+    JsTimerStateFree = 0xFF,
+} JsTimerState;
+
+typedef struct {
+    uint32_t deadline;
+    uint32_t interval; //<! Period in ticks, 0 for one-shot timers
+    uint16_t next;
+    uint16_t prev;
+    uint16_t generation;
+    uint8_t state; //<! Wheel level, or `JsTimerState`
+    uint8_t slot;
+    bool cancelled;
+
+    JsTimerWheelCallback callback;
+    JsTimerWheelCallback destructor;
+    void* context;
+
+    mjs_val_t function; //<! `MJS_UNDEFINED` for native timers
+    uint8_t arity;
+    mjs_val_t arguments[JS_TIMER_WHEEL_ARGS_MAX];
+} JsTimerNode;
+
+ARRAY_DEF(JsTimerChunkArray, JsTimerNode*, M_PTR_OPLIST); //-V575
+
+struct JsTimerWheel {
+    FuriEventLoopTimer* timer;
+    struct mjs* mjs;
+    JsTimerWheelDispatchCallback dispatched;
+    void* dispatched_context;
+
+    uint32_t current; //<! Last tick the wheel has been turned to
+    bool turning; //<! Timers are being run, the timer is rearmed afterwards
+    bool armed;
+    uint32_t armed_deadline;
+
+    uint64_t occupied[JS_TIMER_WHEEL_LEVELS];
+    uint16_t slots[JS_TIMER_WHEEL_LEVELS][SLOTS];
+    uint16_t expiring;
+    uint16_t free_list;
+    size_t count;
+
+    JsTimerChunkArray_t chunks;
+};
+
+static inline JsTimerNode* js_timer_wheel_node(JsTimerWheel* wheel, uint16_t index) {
+    return &(*JsTimerChunkArray_get(wheel->chunks, index / CHUNK_NODES))[index % CHUNK_NODES];
+}
+
+static inline uint64_t js_timer_wheel_rotr(uint64_t value, uint32_t shift) {
+    shift &= 63;
+    return shift ? (value >> shift) | (value << (64 - shift)) : value;
+}
+
+static uint16_t* js_timer_wheel_head(JsTimerWheel* wheel, JsTimerNode* node) {
+    return node->state == JsTimerStateExpiring ? &wheel->expiring :
+                                                 &wheel->slots[node->state][node->slot];
+}
+
+static void js_timer_wheel_push(JsTimerWheel* wheel, uint16_t* head, uint16_t index) {
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    node->prev = NIL;
+    node->next = *head;
+    if(*head != NIL) js_timer_wheel_node(wheel, *head)->prev = index;
+    *head = index;
+}
+
+static void js_timer_wheel_unlink(JsTimerWheel* wheel, uint16_t index) {
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    uint16_t* head = js_timer_wheel_head(wheel, node);
+
+    if(node->prev == NIL) {
+        *head = node->next;
+    } else {
+        js_timer_wheel_node(wheel, node->prev)->next = node->next;
+    }
+    if(node->next != NIL) js_timer_wheel_node(wheel, node->next)->prev = node->prev;
+
+    if(node->state < JS_TIMER_WHEEL_LEVELS && *head == NIL)
+        wheel->occupied[node->state] &= ~(1ULL << node->slot);
+}
+
+/**
+ * @brief Places a node on the lowest level that can hold its deadline
+ * @param now Whether a deadline equal to the current tick may be placed into
+ * the current slot, which is only valid right before that slot is expired
+ */
+static void js_timer_wheel_place(JsTimerWheel* wheel, uint16_t index, bool now) {
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+
+    uint32_t target = node->deadline;
+    int32_t delta = (int32_t)(target - wheel->current);
+    if(delta < 0 || (delta == 0 && !now)) target = wheel->current + 1;
+
+    uint8_t level = 0;
+    uint32_t slot = 0;
+    for(; level < JS_TIMER_WHEEL_LEVELS; level++) {
+        uint32_t shift = level * SLOT_BITS;
+        if((target >> shift) - (wheel->current >> shift) < SLOTS) {
+            slot = (target >> shift) & SLOT_MASK;
+            break;
+        }
+    }
+    if(level == JS_TIMER_WHEEL_LEVELS) {
+        // too far in the future: park in the farthest slot, it will be placed
+        // again when that slot is cascaded
+        level = JS_TIMER_WHEEL_LEVELS - 1;
+        slot = ((wheel->current >> (level * SLOT_BITS)) + SLOTS - 1) & SLOT_MASK;
+    }
+
+    node->state = level;
+    node->slot = slot;
+    js_timer_wheel_push(wheel, &wheel->slots[level][slot], index);
+    wheel->occupied[level] |= 1ULL << slot;
+}
+
+/**
+ * @brief Finds the next tick at which a slot has to be expired or cascaded
+ */
+static bool js_timer_wheel_next_tick(JsTimerWheel* wheel, uint32_t* tick) {
+    bool found = false;
+    for(uint32_t level = 0; level < JS_TIMER_WHEEL_LEVELS; level++) {
+        if(!wheel->occupied[level]) continue;
+        uint32_t shift = level * SLOT_BITS;
+        uint32_t current_slot = (wheel->current >> shift) & SLOT_MASK;
+        uint64_t rotated = js_timer_wheel_rotr(wheel->occupied[level], current_slot + 1);
+        uint32_t distance = __builtin_ctzll(rotated) + 1;
+        uint32_t level_tick = ((wheel->current >> shift) + distance) << shift;
+        if(!found || (int32_t)(level_tick - *tick) < 0) *tick = level_tick;
+        found = true;
+    }
+    return found;
+}
+
+static uint16_t js_timer_wheel_alloc_node(JsTimerWheel* wheel) {
+    if(wheel->free_list == NIL) {
+        size_t chunk_count = JsTimerChunkArray_size(wheel->chunks);
+        furi_check((chunk_count + 1) * CHUNK_NODES < NIL, "too many timers");
+        JsTimerNode* chunk = malloc(CHUNK_NODES * sizeof(JsTimerNode));
+        JsTimerChunkArray_push_back(wheel->chunks, chunk);
+        for(size_t i = CHUNK_NODES; i > 0; i--) {
+            uint16_t index = chunk_count * CHUNK_NODES + i - 1;
+            chunk[i - 1] = (JsTimerNode){
+                .state = JsTimerStateFree,
+                .generation = 1,
+                .next = wheel->free_list,
+            };
+            wheel->free_list = index;
+        }
+    }
+
+    uint16_t index = wheel->free_list;
+    wheel->free_list = js_timer_wheel_node(wheel, index)->next;
+    wheel->count++;
+    return index;
+}
+
+static void js_timer_wheel_free_node(JsTimerWheel* wheel, uint16_t index) {
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+
+    if(node->function != MJS_UNDEFINED) {
+        mjs_disown(wheel->mjs, &node->function);
+        for(size_t i = 0; i < node->arity; i++)
+            mjs_disown(wheel->mjs, &node->arguments[i]);
+    }
+    if(node->destructor) node->destructor(node->context);
+
+    node->state = JsTimerStateFree;
+    if(++node->generation == 0) node->generation = 1;
+    node->next = wheel->free_list;
+    wheel->free_list = index;
+    wheel->count--;
+}
+
+static inline JsTimerId js_timer_wheel_id(JsTimerWheel* wheel, uint16_t index) {
+    return ((uint32_t)js_timer_wheel_node(wheel, index)->generation << 16) | index;
+}
+
+/**
+ * @brief Arms the underlying timer for the next occupied slot
+ */
+static void js_timer_wheel_rearm(JsTimerWheel* wheel) {
+    uint32_t next;
+    if(!js_timer_wheel_next_tick(wheel, &next)) {
+        if(wheel->armed) furi_event_loop_timer_stop(wheel->timer);
+        wheel->armed = false;
+        return;
+    }
+
+    int32_t delay = (int32_t)(next - furi_get_tick());
+    furi_event_loop_timer_start(wheel->timer, MAX(delay, 1));
+    wheel->armed = true;
+    wheel->armed_deadline = next;
+}
+
+static void js_timer_wheel_run(JsTimerWheel* wheel, uint16_t index) {
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    node->state = JsTimerStateRunning;
+
+    if(node->function == MJS_UNDEFINED) {
+        node->callback(node->context);
+    } else {
+        mjs_val_t result;
+        mjs_err_t error = mjs_apply(
+            wheel->mjs, &result, node->function, MJS_UNDEFINED, node->arity, node->arguments);
+        wheel->dispatched(wheel->dispatched_context, error);
+    }
+
+    if(node->cancelled || !node->interval) {
+        js_timer_wheel_free_node(wheel, index);
+        return;
+    }
+
+    node->deadline += node->interval;
+    uint32_t now = furi_get_tick();
+    // don't try to catch up on periods that were missed entirely
+    if((int32_t)(node->deadline - now) <= 0) node->deadline = now + node->interval;
+    js_timer_wheel_place(wheel, index, false);
+}
+
+/**
+ * @brief Turns the wheel up to `now`, running all timers that are due
+ */
+static void js_timer_wheel_advance(JsTimerWheel* wheel, uint32_t now) {
+    uint32_t next;
+    while(js_timer_wheel_next_tick(wheel, &next) && (int32_t)(next - now) <= 0) {
+        wheel->current = next;
+
+        for(uint32_t level = JS_TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+            uint32_t shift = level * SLOT_BITS;
+            if(next & ((1UL << shift) - 1)) continue;
+            uint32_t slot = (next >> shift) & SLOT_MASK;
+            uint16_t index;
+            while((index = wheel->slots[level][slot]) != NIL) {
+                js_timer_wheel_unlink(wheel, index);
+                js_timer_wheel_place(wheel, index, true);
+            }
+        }
+
+        // move due timers out of the wheel first, callbacks may add new ones
+        uint32_t slot = next & SLOT_MASK;
+        uint16_t index;
+        while((index = wheel->slots[0][slot]) != NIL) {
+            js_timer_wheel_unlink(wheel, index);
+            JsTimerNode* node = js_timer_wheel_node(wheel, index);
+            node->state = JsTimerStateExpiring;
+            js_timer_wheel_push(wheel, &wheel->expiring, index);
+        }
+        while((index = wheel->expiring) != NIL) {
+            js_timer_wheel_unlink(wheel, index);
+            js_timer_wheel_run(wheel, index);
+        }
+    }
+
+    if((int32_t)(now - wheel->current) > 0) wheel->current = now;
+}
+
+static void js_timer_wheel_timer_callback(void* context) {
+    JsTimerWheel* wheel = context;
+    wheel->turning = true;
+    js_timer_wheel_advance(wheel, furi_get_tick());
+    wheel->turning = false;
+    js_timer_wheel_rearm(wheel);
+}
+
+JsTimerWheel* js_timer_wheel_alloc(
+    FuriEventLoop* loop,
+    struct mjs* mjs,
+    JsTimerWheelDispatchCallback dispatched,
+    void* dispatched_context) {
+    JsTimerWheel* wheel = malloc(sizeof(JsTimerWheel));
+    wheel->mjs = mjs;
+    wheel->dispatched = dispatched;
+    wheel->dispatched_context = dispatched_context;
+    wheel->timer = furi_event_loop_timer_alloc(
+        loop, js_timer_wheel_timer_callback, FuriEventLoopTimerTypeOnce, wheel);
+    wheel->current = furi_get_tick();
+    wheel->turning = false;
+    wheel->armed = false;
+    wheel->expiring = NIL;
+    wheel->free_list = NIL;
+    wheel->count = 0;
+    for(size_t level = 0; level < JS_TIMER_WHEEL_LEVELS; level++) {
+        wheel->occupied[level] = 0;
+        for(size_t slot = 0; slot < SLOTS; slot++)
+            wheel->slots[level][slot] = NIL;
+    }
+    JsTimerChunkArray_init(wheel->chunks);
+    return wheel;
+}
+
+void js_timer_wheel_free(JsTimerWheel* wheel) {
+    furi_event_loop_timer_stop(wheel->timer);
+    furi_event_loop_timer_free(wheel->timer);
+
+    JsTimerChunkArray_it_t iterator;
+    for(JsTimerChunkArray_it(iterator, wheel->chunks); !JsTimerChunkArray_end_p(iterator);
+        JsTimerChunkArray_next(iterator)) {
+        free(*JsTimerChunkArray_cref(iterator));
+    }
+    JsTimerChunkArray_clear(wheel->chunks);
+    free(wheel);
+}
+
+static JsTimerId js_timer_wheel_schedule(
+    JsTimerWheel* wheel,
+    uint16_t index,
+    uint32_t delay_ticks,
+    uint32_t interval_ticks) {
+    uint32_t now = furi_get_tick();
+    // an idle wheel may not have been turned for a long time
+    if(!wheel->turning && !wheel->armed) wheel->current = now;
+
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    node->deadline = now + delay_ticks;
+    node->interval = interval_ticks;
+    node->cancelled = false;
+    js_timer_wheel_place(wheel, index, false);
+
+    if(!wheel->turning &&
+       (!wheel->armed || (int32_t)(node->deadline - wheel->armed_deadline) < 0))
+        js_timer_wheel_rearm(wheel);
+
+    return js_timer_wheel_id(wheel, index);
+}
+
+JsTimerId js_timer_wheel_add(
+    JsTimerWheel* wheel,
+    uint32_t delay_ticks,
+    uint32_t interval_ticks,
+    JsTimerWheelCallback callback,
+    JsTimerWheelCallback destructor,
+    void* context) {
+    furi_check(callback);
+    uint16_t index = js_timer_wheel_alloc_node(wheel);
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    node->callback = callback;
+    node->destructor = destructor;
+    node->context = context;
+    node->function = MJS_UNDEFINED;
+    node->arity = 0;
+    return js_timer_wheel_schedule(wheel, index, delay_ticks, interval_ticks);
+}
+
+JsTimerId js_timer_wheel_add_js(
+    JsTimerWheel* wheel,
+    uint32_t delay_ticks,
+    uint32_t interval_ticks,
+    mjs_val_t function,
+    const mjs_val_t* arguments,
+    size_t arity) {
+    furi_check(arity <= JS_TIMER_WHEEL_ARGS_MAX);
+    uint16_t index = js_timer_wheel_alloc_node(wheel);
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    node->callback = NULL;
+    node->destructor = NULL;
+    node->context = NULL;
+    node->function = function;
+    mjs_own(wheel->mjs, &node->function);
+    node->arity = arity;
+    for(size_t i = 0; i < arity; i++) {
+        node->arguments[i] = arguments[i];
+        mjs_own(wheel->mjs, &node->arguments[i]);
+    }
+    return js_timer_wheel_schedule(wheel, index, delay_ticks, interval_ticks);
+}
+
+bool js_timer_wheel_cancel(JsTimerWheel* wheel, JsTimerId id) {
+    uint16_t index = id & 0xFFFF;
+    uint16_t generation = id >> 16;
+    if(index / CHUNK_NODES >= JsTimerChunkArray_size(wheel->chunks)) return false;
+
+    JsTimerNode* node = js_timer_wheel_node(wheel, index);
+    if(node->generation != generation || node->state == JsTimerStateFree || node->cancelled)
+        return false;
+
+    if(node->state == JsTimerStateRunning) {
+        // reclaimed by `js_timer_wheel_run` once the callback returns
+        node->cancelled = true;
+        return true;
+    }
+
+    js_timer_wheel_unlink(wheel, index);
+    js_timer_wheel_free_node(wheel, index);
+    // the underlying timer is left armed, a spurious wakeup is cheaper than
+    // searching for the next deadline on every cancellation
+    return true;
+}
+
+size_t js_timer_wheel_count(JsTimerWheel* wheel) {
+    return wheel->count;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "../../js_thread_i.h"
+#include <furi/core/event_loop.h>
+#include <furi/core/event_loop_timer.h>
+
+/**
+ * @file js_event_loop_timer_wheel.h
+ *
+ * Hierarchical timer wheel used by `js_event_loop` to multiplex any number of
+ * JS timers onto a single `FuriEventLoopTimer`.
+ *
+ * The wheel has `JS_TIMER_WHEEL_LEVELS` levels of 64 slots. Level `n` slots
+ * span `64^n` ticks; a timer is placed on the lowest level that can tell its
+ * deadline apart from the current tick and is cascaded down as the wheel
+ * turns. Inserting and cancelling a timer is O(1), and the underlying timer
+ * is only armed for the next occupied slot.
+ *
+ * Timer nodes live in fixed-size chunks that are never moved, so that mJS
+ * values can be owned by nodes directly. Nodes are returned to a free list as
+ * soon as they are cancelled or have finished; chunks are only freed together
+ * with the wheel.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JS_TIMER_WHEEL_LEVELS   4
+#define JS_TIMER_WHEEL_ARGS_MAX 4
+
+typedef struct JsTimerWheel JsTimerWheel;
+
+/**
+ * @brief Opaque timer handle, generation-checked so that stale IDs are
+ * harmless. Never 0.
+ */
+typedef uint32_t JsTimerId;
+
+#define JS_TIMER_ID_INVALID 0
+
+typedef void (*JsTimerWheelCallback)(void* context);
+
+/**
+ * @brief Called after every JS timer function with its result, so that the
+ * owner can stop the loop on errors
+ */
+typedef void (*JsTimerWheelDispatchCallback)(void* context, mjs_err_t error);
+
+JsTimerWheel* js_timer_wheel_alloc(
+    FuriEventLoop* loop,
+    struct mjs* mjs,
+    JsTimerWheelDispatchCallback dispatched,
+    void* dispatched_context);
+
+/**
+ * @brief Frees the wheel and all of its nodes
+ * @warning Does not touch the mJS instance and does not call destructors, as
+ * the interpreter is already gone when modules are destroyed
+ */
+void js_timer_wheel_free(JsTimerWheel* wheel);
+
+/**
+ * @brief Schedules a native callback
+ *
+ * @param delay_ticks Ticks until the first call
+ * @param interval_ticks Period for repeating timers, 0 for one-shot timers
+ * @param destructor Called with `context` once the node is reclaimed, may be
+ * NULL
+ */
+JsTimerId js_timer_wheel_add(
+    JsTimerWheel* wheel,
+    uint32_t delay_ticks,
+    uint32_t interval_ticks,
+    JsTimerWheelCallback callback,
+    JsTimerWheelCallback destructor,
+    void* context);
+
+/**
+ * @brief Schedules a JS function, called with up to
+ * `JS_TIMER_WHEEL_ARGS_MAX` arguments. The function and the arguments are
+ * owned by the node.
+ */
+JsTimerId js_timer_wheel_add_js(
+    JsTimerWheel* wheel,
+    uint32_t delay_ticks,
+    uint32_t interval_ticks,
+    mjs_val_t function,
+    const mjs_val_t* arguments,
+    size_t arity);
+
+/**
+ * @brief Cancels a timer. A timer that is currently running is reclaimed as
+ * soon as its callback returns.
+ * @returns false if the ID is stale
+ */
+bool js_timer_wheel_cancel(JsTimerWheel* wheel, JsTimerId id);
+
+/**
+ * @brief Number of scheduled timers
+ */
+size_t js_timer_wheel_count(JsTimerWheel* wheel);
+
+#ifdef __cplusplus
+}
+#endif
@@ -111,6 +111,7 @@ static JsByteKbContext* ctx_make(struct mjs* mjs, ByteInput* input, mjs_val_t vi
                 .event = FuriEventLoopEventIn,
                 .transformer = (JsEventLoopTransformer)input_transformer,
                 .transformer_context = context,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
     byte_input_set_result_callback(
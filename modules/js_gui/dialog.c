@@ -81,6 +81,7 @@ static JsDialogCtx* ctx_make(struct mjs* mjs, DialogEx* dialog, mjs_val_t view_o
             {
                 .event = FuriEventLoopEventIn,
                 .transformer = (JsEventLoopTransformer)input_transformer,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
     mjs_set(mjs, view_obj, "input", ~0, mjs_mk_foreign(mjs, &context->contract));
@@ -158,6 +158,7 @@ static void* js_gui_create(struct mjs* mjs, mjs_val_t* object, JsModules* module
             {
                 .event = FuriEventLoopEventIn,
                 .transformer = js_gui_vd_custom_transformer,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
     module->navigation_contract = (JsEventLoopContract){
@@ -167,6 +168,7 @@ static void* js_gui_create(struct mjs* mjs, mjs_val_t* object, JsModules* module
         .non_timer =
             {
                 .event = FuriEventLoopEventIn,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
 
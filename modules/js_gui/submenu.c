@@ -54,6 +54,7 @@ static JsSubmenuCtx* ctx_make(struct mjs* mjs, Submenu* input, mjs_val_t view_ob
             {
                 .event = FuriEventLoopEventIn,
                 .transformer = (JsEventLoopTransformer)choose_transformer,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
     mjs_set(mjs, view_obj, "chosen", ~0, mjs_mk_foreign(mjs, &context->contract));
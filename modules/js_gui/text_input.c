@@ -133,6 +133,7 @@ static JsKbdContext* ctx_make(struct mjs* mjs, TextInput* input, mjs_val_t view_
                 .event = FuriEventLoopEventIn,
                 .transformer = (JsEventLoopTransformer)input_transformer,
                 .transformer_context = context,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
     text_input_set_result_callback(
@@ -290,6 +290,7 @@ static void* js_widget_custom_make(struct mjs* mjs, Widget* widget, mjs_val_t vi
             {
                 .event = FuriEventLoopEventIn,
                 .transformer = (JsEventLoopTransformer)js_widget_button_event_transformer,
+                .priority = JsEventLoopPriorityHigh,
             },
     };
     mjs_set(mjs, view_obj, "button", ~0, mjs_mk_foreign(mjs, &context->contract));
@@ -0,0 +1,723 @@
+#include "js_json.h"
+#include "js_storage.h"
+
+#define TAG "JsJson"
+
+#define JSON_CHUNK_SIZE 64 //<! Bytes read from the source at a time
+#define JSON_WRITE_SIZE 128 //<! Bytes of output written to a file at a time
+#define JSON_DEPTH_MAX  32
+#define JSON_NUMBER_LEN 32
+
+// ======
+// Reader
+// ======
+
+/**
+ * Input is read through a small buffer whether it's a string or a file.
+ * String contents can move when the script allocates, so they're looked up
+ * again on every refill rather than kept as a pointer.
+ */
+typedef struct {
+    struct mjs* mjs;
+    mjs_val_t string; //<! MJS_UNDEFINED when reading a file
+    File* file;
+    size_t offset; //<! Of the next chunk in the source
+    char chunk[JSON_CHUNK_SIZE];
+    size_t chunk_len;
+    size_t chunk_pos;
+} JsJsonReader;
+
+static bool js_json_refill(JsJsonReader* reader) {
+    if(reader->file) {
+        reader->chunk_len = storage_file_read(reader->file, reader->chunk, JSON_CHUNK_SIZE);
+    } else {
+        size_t len;
+        const char* str = mjs_get_string(reader->mjs, &reader->string, &len);
+        reader->chunk_len = MIN(len - MIN(len, reader->offset), (size_t)JSON_CHUNK_SIZE);
+        memcpy(reader->chunk, str + reader->offset, reader->chunk_len);
+    }
+    reader->offset += reader->chunk_len;
+    reader->chunk_pos = 0;
+    return reader->chunk_len > 0;
+}
+
+/**
+ * @returns the next character without consuming it, or -1 at the end
+ */
+static int js_json_peek(JsJsonReader* reader) {
+    if(reader->chunk_pos == reader->chunk_len && !js_json_refill(reader)) return -1;
+    return (uint8_t)reader->chunk[reader->chunk_pos];
+}
+
+static int js_json_next(JsJsonReader* reader) {
+    int c = js_json_peek(reader);
+    if(c >= 0) reader->chunk_pos++;
+    return c;
+}
+
+static size_t js_json_position(JsJsonReader* reader) {
+    return reader->offset - reader->chunk_len + reader->chunk_pos;
+}
+
+static int js_json_skip_space(JsJsonReader* reader) {
+    int c;
+    while((c = js_json_peek(reader)) == ' ' || c == '\t' || c == '\n' || c == '\r')
+        reader->chunk_pos++;
+    return c;
+}
+
+// ======
+// Parser
+// ======
+
+typedef enum {
+    JsJsonEventObjectStart,
+    JsJsonEventObjectEnd,
+    JsJsonEventArrayStart,
+    JsJsonEventArrayEnd,
+    JsJsonEventKey,
+    JsJsonEventValue, //<! Scalar value
+} JsJsonEvent;
+
+typedef struct JsJsonParser JsJsonParser;
+
+/**
+ * @returns false to stop parsing
+ */
+typedef bool (*JsJsonEventCallback)(JsJsonParser* parser, JsJsonEvent event, mjs_val_t value);
+
+struct JsJsonParser {
+    JsJsonReader reader;
+    JsJsonEventCallback callback;
+    void* context;
+    const char* error; //<! Set when the input is invalid
+    FuriString* string; //<! Reused for string tokens
+};
+
+static void js_json_utf8_encode(FuriString* out, uint32_t code) {
+    if(code < 0x80) {
+        furi_string_push_back(out, code);
+    } else if(code < 0x800) {
+        furi_string_push_back(out, 0xC0 | (code >> 6));
+        furi_string_push_back(out, 0x80 | (code & 0x3F));
+    } else if(code < 0x10000) {
+        furi_string_push_back(out, 0xE0 | (code >> 12));
+        furi_string_push_back(out, 0x80 | ((code >> 6) & 0x3F));
+        furi_string_push_back(out, 0x80 | (code & 0x3F));
+    } else {
+        furi_string_push_back(out, 0xF0 | (code >> 18));
+        furi_string_push_back(out, 0x80 | ((code >> 12) & 0x3F));
+        furi_string_push_back(out, 0x80 | ((code >> 6) & 0x3F));
+        furi_string_push_back(out, 0x80 | (code & 0x3F));
+    }
+}
+
+static bool js_json_read_hex4(JsJsonReader* reader, uint32_t* code) {
+    *code = 0;
+    for(size_t i = 0; i < 4; i++) {
+        int c = js_json_next(reader);
+        uint32_t digit;
+        if(c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if(c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if(c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        *code = (*code << 4) | digit;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a string token, after the opening quote, into `parser->string`
+ */
+static bool js_json_read_string(JsJsonParser* parser) {
+    JsJsonReader* reader = &parser->reader;
+    furi_string_reset(parser->string);
+    while(true) {
+        int c = js_json_next(reader);
+        if(c < 0) {
+            parser->error = "unterminated string";
+            return false;
+        } else if(c == '"') {
+            return true;
+        } else if(c < ' ') {
+            parser->error = "control character in string";
+            return false;
+        } else if(c != '\\') {
+            furi_string_push_back(parser->string, c);
+            continue;
+        }
+
+        c = js_json_next(reader);
+        uint32_t code;
+        switch(c) {
+        case '"':
+        case '\\':
+        case '/':
+            furi_string_push_back(parser->string, c);
+            break;
+        case 'b':
+            furi_string_push_back(parser->string, '\b');
+            break;
+        case 'f':
+            furi_string_push_back(parser->string, '\f');
+            break;
+        case 'n':
+            furi_string_push_back(parser->string, '\n');
+            break;
+        case 'r':
+            furi_string_push_back(parser->string, '\r');
+            break;
+        case 't':
+            furi_string_push_back(parser->string, '\t');
+            break;
+        case 'u':
+            if(!js_json_read_hex4(reader, &code)) {
+                parser->error = "bad \\u escape";
+                return false;
+            }
+            if(code >= 0xD800 && code < 0xDC00) {
+                // high surrogate, which must be followed by a low one
+                uint32_t low;
+                if(js_json_next(reader) != '\\' || js_json_next(reader) != 'u' ||
+                   !js_json_read_hex4(reader, &low) || low < 0xDC00 || low >= 0xE000) {
+                    parser->error = "bad surrogate pair";
+                    return false;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            js_json_utf8_encode(parser->string, code);
+            break;
+        default:
+            parser->error = "bad escape";
+            return false;
+        }
+    }
+}
+
+static bool js_json_read_number(JsJsonParser* parser, double* number) {
+    JsJsonReader* reader = &parser->reader;
+    char text[JSON_NUMBER_LEN + 1];
+    size_t len = 0;
+    int c;
+    while((c = js_json_peek(reader)) >= 0 && (strchr("+-.eE", c) || (c >= '0' && c <= '9'))) {
+        if(len == JSON_NUMBER_LEN) {
+            parser->error = "number too long";
+            return false;
+        }
+        text[len++] = c;
+        reader->chunk_pos++;
+    }
+    text[len] = '\0';
+
+    char* end;
+    *number = strtod(text, &end);
+    if(len == 0 || *end != '\0') {
+        parser->error = "bad number";
+        return false;
+    }
+    return true;
+}
+
+static bool js_json_expect_word(JsJsonParser* parser, const char* word) {
+    for(; *word; word++) {
+        if(js_json_next(&parser->reader) != *word) {
+            parser->error = "unexpected character";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a scalar value starting at `c`
+ */
+static bool js_json_read_scalar(JsJsonParser* parser, int c, mjs_val_t* value) {
+    struct mjs* mjs = parser->reader.mjs;
+    if(c == '"') {
+        parser->reader.chunk_pos++;
+        if(!js_json_read_string(parser)) return false;
+        *value = mjs_mk_string(
+            mjs, furi_string_get_cstr(parser->string), furi_string_size(parser->string), true);
+    } else if(c == 't') {
+        if(!js_json_expect_word(parser, "true")) return false;
+        *value = mjs_mk_boolean(mjs, true);
+    } else if(c == 'f') {
+        if(!js_json_expect_word(parser, "false")) return false;
+        *value = mjs_mk_boolean(mjs, false);
+    } else if(c == 'n') {
+        if(!js_json_expect_word(parser, "null")) return false;
+        *value = MJS_NULL;
+    } else if(c == '-' || (c >= '0' && c <= '9')) {
+        double number;
+        if(!js_json_read_number(parser, &number)) return false;
+        *value = mjs_mk_number(mjs, number);
+    } else {
+        parser->error = c < 0 ? "unexpected end" : "unexpected character";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads `"key":` and reports the key
+ */
+static bool js_json_read_key(JsJsonParser* parser) {
+    if(js_json_skip_space(&parser->reader) != '"') {
+        parser->error = "expected a key";
+        return false;
+    }
+    parser->reader.chunk_pos++;
+    if(!js_json_read_string(parser)) return false;
+    if(js_json_skip_space(&parser->reader) != ':') {
+        parser->error = "expected ':'";
+        return false;
+    }
+    parser->reader.chunk_pos++;
+
+    mjs_val_t key = mjs_mk_string(
+        parser->reader.mjs,
+        furi_string_get_cstr(parser->string),
+        furi_string_size(parser->string),
+        true);
+    return parser->callback(parser, JsJsonEventKey, key);
+}
+
+/**
+ * @brief Parses one value, reporting its structure as events. Nesting is
+ * tracked with a bit per level rather than recursion, since the script's
+ * stack is small.
+ * @returns false if the input is invalid or a callback stopped parsing
+ */
+static bool js_json_parse_events(JsJsonParser* parser) {
+    JsJsonReader* reader = &parser->reader;
+    uint32_t in_array = 0; //<! Bit per level, set for arrays
+    size_t depth = 0;
+
+    while(true) {
+        // a value
+        int c = js_json_skip_space(reader);
+        if(c == '{' || c == '[') {
+            reader->chunk_pos++;
+            if(depth == JSON_DEPTH_MAX) {
+                parser->error = "nested too deep";
+                return false;
+            }
+            bool array = c == '[';
+            in_array = (in_array & ~(1UL << depth)) | ((uint32_t)array << depth);
+            depth++;
+            if(!parser->callback(
+                   parser, array ? JsJsonEventArrayStart : JsJsonEventObjectStart, MJS_UNDEFINED))
+                return false;
+
+            c = js_json_skip_space(reader);
+            if(c == (array ? ']' : '}')) {
+                reader->chunk_pos++;
+                depth--;
+                if(!parser->callback(
+                       parser, array ? JsJsonEventArrayEnd : JsJsonEventObjectEnd, MJS_UNDEFINED))
+                    return false;
+            } else {
+                if(!array && !js_json_read_key(parser)) return false;
+                continue;
+            }
+        } else {
+            mjs_val_t value;
+            if(!js_json_read_scalar(parser, c, &value)) return false;
+            if(!parser->callback(parser, JsJsonEventValue, value)) return false;
+        }
+
+        // what follows a value: the next one in the container, or its end
+        while(depth) {
+            bool array = in_array & (1UL << (depth - 1));
+            c = js_json_skip_space(reader);
+            if(c >= 0) reader->chunk_pos++;
+            if(c == ',') {
+                if(!array && !js_json_read_key(parser)) return false;
+                break;
+            } else if(c == (array ? ']' : '}')) {
+                depth--;
+                if(!parser->callback(
+                       parser, array ? JsJsonEventArrayEnd : JsJsonEventObjectEnd, MJS_UNDEFINED))
+                    return false;
+            } else {
+                parser->error = c < 0 ? "unexpected end" : "expected ',' or end of container";
+                return false;
+            }
+        }
+        if(!depth) break;
+    }
+
+    if(js_json_skip_space(reader) >= 0) {
+        parser->error = "trailing characters";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sets up the reader for a string or a storage file object
+ */
+static bool js_json_reader_init(JsJsonReader* reader, struct mjs* mjs, mjs_val_t source) {
+    reader->mjs = mjs;
+    reader->offset = reader->chunk_len = reader->chunk_pos = 0;
+    reader->file = NULL;
+    reader->string = MJS_UNDEFINED;
+    if(mjs_is_string(source)) {
+        reader->string = source;
+        return true;
+    }
+    reader->file = js_storage_file_get(mjs, source);
+    return reader->file != NULL;
+}
+
+/**
+ * @brief Runs the parser and turns a syntax error into a script error
+ * @returns false if there was an error, which has been set
+ */
+static bool js_json_run(struct mjs* mjs, JsJsonParser* parser, mjs_val_t source) {
+    if(!js_json_reader_init(&parser->reader, mjs, source)) {
+        mjs_prepend_errorf(mjs, MJS_BAD_ARGS_ERROR, "expected a string or a file");
+        return false;
+    }
+    parser->error = NULL;
+    parser->string = furi_string_alloc();
+    // the source string has to outlive any garbage collection that callbacks cause
+    mjs_own(mjs, &parser->reader.string);
+    bool ok = js_json_parse_events(parser);
+    mjs_disown(mjs, &parser->reader.string);
+    furi_string_free(parser->string);
+
+    if(parser->error) {
+        mjs_prepend_errorf(
+            mjs,
+            MJS_BAD_ARGS_ERROR,
+            "JSON: %s at offset %zu",
+            parser->error,
+            js_json_position(&parser->reader));
+    }
+    return ok || !parser->error;
+}
+
+// ==========
+// Tree sink
+// ==========
+
+typedef struct {
+    mjs_val_t containers[JSON_DEPTH_MAX];
+    mjs_val_t keys[JSON_DEPTH_MAX];
+    size_t depth;
+    mjs_val_t root;
+} JsJsonTree;
+
+static void js_json_tree_attach(JsJsonParser* parser, JsJsonTree* tree, mjs_val_t value) {
+    struct mjs* mjs = parser->reader.mjs;
+    if(!tree->depth) {
+        tree->root = value;
+        return;
+    }
+    mjs_val_t parent = tree->containers[tree->depth - 1];
+    if(mjs_is_array(parent)) {
+        mjs_array_push(mjs, parent, value);
+    } else {
+        mjs_val_t key = tree->keys[tree->depth - 1];
+        size_t key_len;
+        const char* key_str = mjs_get_string(mjs, &key, &key_len);
+        mjs_set(mjs, parent, key_str, key_len, value);
+    }
+}
+
+static bool js_json_tree_callback(JsJsonParser* parser, JsJsonEvent event, mjs_val_t value) {
+    JsJsonTree* tree = parser->context;
+    struct mjs* mjs = parser->reader.mjs;
+    switch(event) {
+    case JsJsonEventObjectStart:
+    case JsJsonEventArrayStart:
+        value = event == JsJsonEventObjectStart ? mjs_mk_object(mjs) : mjs_mk_array(mjs);
+        js_json_tree_attach(parser, tree, value);
+        tree->containers[tree->depth++] = value;
+        break;
+    case JsJsonEventObjectEnd:
+    case JsJsonEventArrayEnd:
+        tree->depth--;
+        break;
+    case JsJsonEventKey:
+        tree->keys[tree->depth - 1] = value;
+        break;
+    case JsJsonEventValue:
+        js_json_tree_attach(parser, tree, value);
+        break;
+    }
+    return true;
+}
+
+static void js_json_parse(struct mjs* mjs) {
+    static const JsValueDeclaration js_json_parse_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_json_parse_args = JS_VALUE_ARGS(js_json_parse_arg_list);
+
+    mjs_val_t source;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_json_parse_args, &source);
+
+    // containers are attached to their parent as soon as they're created,
+    // so everything but the root is reachable while parsing
+    JsJsonTree* tree = malloc(sizeof(JsJsonTree));
+    tree->depth = 0;
+    tree->root = MJS_UNDEFINED;
+    JsJsonParser parser = {.callback = js_json_tree_callback, .context = tree};
+    bool ok = js_json_run(mjs, &parser, source);
+    mjs_val_t root = tree->root;
+    free(tree);
+    mjs_return(mjs, ok ? root : MJS_UNDEFINED);
+}
+
+// =========
+// SAX sink
+// =========
+
+typedef struct {
+    mjs_val_t handlers;
+    mjs_err_t error; //<! Of the last handler call
+} JsJsonSax;
+
+static bool js_json_sax_callback(JsJsonParser* parser, JsJsonEvent event, mjs_val_t value) {
+    static const char* const handler_names[] = {
+        [JsJsonEventObjectStart] = "onObjectStart",
+        [JsJsonEventObjectEnd] = "onObjectEnd",
+        [JsJsonEventArrayStart] = "onArrayStart",
+        [JsJsonEventArrayEnd] = "onArrayEnd",
+        [JsJsonEventKey] = "onKey",
+        [JsJsonEventValue] = "onValue",
+    };
+    JsJsonSax* sax = parser->context;
+    struct mjs* mjs = parser->reader.mjs;
+    mjs_val_t handler = mjs_get(mjs, sax->handlers, handler_names[event], ~0);
+    if(!mjs_is_function(handler)) return true;
+
+    mjs_val_t result;
+    bool has_value = event == JsJsonEventKey || event == JsJsonEventValue;
+    sax->error = mjs_apply(mjs, &result, handler, MJS_UNDEFINED, has_value ? 1 : 0, &value);
+    // a handler stops parsing by returning false
+    return sax->error == MJS_OK && !(mjs_is_boolean(result) && !mjs_get_bool(mjs, result));
+}
+
+static void js_json_parse_events_js(struct mjs* mjs) {
+    static const JsValueDeclaration js_json_events_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeAnyObject),
+    };
+    static const JsValueArguments js_json_events_args = JS_VALUE_ARGS(js_json_events_arg_list);
+
+    mjs_val_t source;
+    JsJsonSax sax = {.error = MJS_OK};
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_json_events_args, &source, &sax.handlers);
+
+    JsJsonParser parser = {.callback = js_json_sax_callback, .context = &sax};
+    bool ok = js_json_run(mjs, &parser, source);
+    // a handler error is already set and stops the script
+    mjs_return(mjs, mjs_mk_boolean(mjs, ok && sax.error == MJS_OK));
+}
+
+// ======
+// Writer
+// ======
+
+/**
+ * Output goes through a small buffer into a file, or into a string if
+ * there's no file.
+ */
+typedef struct {
+    struct mjs* mjs;
+    File* file;
+    FuriString* string;
+    char buffer[JSON_WRITE_SIZE];
+    size_t len;
+    bool failed;
+} JsJsonWriter;
+
+static void js_json_flush(JsJsonWriter* writer) {
+    if(writer->file) {
+        if(storage_file_write(writer->file, writer->buffer, writer->len) != writer->len)
+            writer->failed = true;
+    } else {
+        // escaping leaves no NUL characters in the output
+        furi_string_cat_printf(writer->string, "%.*s", (int)writer->len, writer->buffer);
+    }
+    writer->len = 0;
+}
+
+static void js_json_write(JsJsonWriter* writer, const char* data, size_t len) {
+    while(len) {
+        if(writer->len == JSON_WRITE_SIZE) js_json_flush(writer);
+        size_t part = MIN(len, JSON_WRITE_SIZE - writer->len);
+        memcpy(&writer->buffer[writer->len], data, part);
+        writer->len += part;
+        data += part;
+        len -= part;
+    }
+}
+
+static void js_json_write_str(JsJsonWriter* writer, const char* str) {
+    js_json_write(writer, str, strlen(str));
+}
+
+static void js_json_write_string(JsJsonWriter* writer, const char* str, size_t len) {
+    js_json_write(writer, "\"", 1);
+    size_t run = 0; //<! Characters that need no escaping, written together
+    for(size_t i = 0; i < len; i++) {
+        uint8_t c = str[i];
+        if(c >= ' ' && c != '"' && c != '\\') {
+            run++;
+            continue;
+        }
+        js_json_write(writer, &str[i - run], run);
+        run = 0;
+
+        char escape[7];
+        switch(c) {
+        case '"':
+        case '\\':
+            snprintf(escape, sizeof(escape), "\\%c", c);
+            break;
+        case '\n':
+            snprintf(escape, sizeof(escape), "\\n");
+            break;
+        case '\r':
+            snprintf(escape, sizeof(escape), "\\r");
+            break;
+        case '\t':
+            snprintf(escape, sizeof(escape), "\\t");
+            break;
+        default:
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            break;
+        }
+        js_json_write_str(writer, escape);
+    }
+    js_json_write(writer, &str[len - run], run);
+    js_json_write(writer, "\"", 1);
+}
+
+static bool js_json_is_skipped(mjs_val_t value) {
+    return mjs_is_undefined(value) || mjs_is_function(value) || mjs_is_foreign(value);
+}
+
+/**
+ * @returns false if the value is nested too deep, which is likely a cycle
+ */
+static bool js_json_write_value(JsJsonWriter* writer, mjs_val_t value, size_t depth) {
+    struct mjs* mjs = writer->mjs;
+    if(depth > JSON_DEPTH_MAX) return false;
+
+    if(mjs_is_string(value)) {
+        size_t len;
+        const char* str = mjs_get_string(mjs, &value, &len);
+        js_json_write_string(writer, str, len);
+    } else if(mjs_is_number(value)) {
+        // JSON has no NaN or Infinity
+        double number = mjs_get_double(mjs, value);
+        if(isnan(number) || isinf(number)) {
+            js_json_write_str(writer, "null");
+            return true;
+        }
+        char* str = NULL;
+        size_t len = 0;
+        int need_free = 0;
+        mjs_to_string(mjs, &value, &str, &len, &need_free);
+        js_json_write(writer, str, len);
+        if(need_free) free(str);
+    } else if(mjs_is_boolean(value)) {
+        js_json_write_str(writer, mjs_get_bool(mjs, value) ? "true" : "false");
+    } else if(mjs_is_array(value)) {
+        js_json_write(writer, "[", 1);
+        unsigned long length = mjs_array_length(mjs, value);
+        for(unsigned long i = 0; i < length; i++) {
+            if(i) js_json_write(writer, ",", 1);
+            mjs_val_t item = mjs_array_get(mjs, value, i);
+            if(js_json_is_skipped(item)) {
+                js_json_write_str(writer, "null");
+            } else if(!js_json_write_value(writer, item, depth + 1)) {
+                return false;
+            }
+        }
+        js_json_write(writer, "]", 1);
+    } else if(mjs_is_object(value)) {
+        js_json_write(writer, "{", 1);
+        bool first = true;
+        mjs_val_t iter = MJS_UNDEFINED, key;
+        while((key = mjs_next(mjs, value, &iter)) != MJS_UNDEFINED) {
+            size_t key_len;
+            const char* key_str = mjs_get_string(mjs, &key, &key_len);
+            mjs_val_t item = mjs_get(mjs, value, key_str, key_len);
+            if(js_json_is_skipped(item)) continue;
+            if(!first) js_json_write(writer, ",", 1);
+            first = false;
+            js_json_write_string(writer, key_str, key_len);
+            js_json_write(writer, ":", 1);
+            if(!js_json_write_value(writer, item, depth + 1)) return false;
+        }
+        js_json_write(writer, "}", 1);
+    } else {
+        js_json_write_str(writer, "null");
+    }
+    return true;
+}
+
+static void js_json_stringify(struct mjs* mjs) {
+    static const JsValueDeclaration js_json_stringify_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeAny), // optional file
+    };
+    static const JsValueArguments js_json_stringify_args =
+        JS_VALUE_ARGS(js_json_stringify_arg_list);
+
+    mjs_val_t value, file_obj;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_json_stringify_args, &value, &file_obj);
+
+    File* file = NULL;
+    if(!mjs_is_undefined(file_obj)) {
+        file = js_storage_file_get(mjs, file_obj);
+        if(!file) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "argument 1: expected a file");
+    }
+
+    JsJsonWriter* writer = malloc(sizeof(JsJsonWriter));
+    writer->mjs = mjs;
+    writer->file = file;
+    writer->string = file ? NULL : furi_string_alloc();
+    writer->len = 0;
+    writer->failed = false;
+
+    bool ok = js_json_write_value(writer, value, 0);
+    js_json_flush(writer);
+
+    mjs_val_t result;
+    if(!ok) {
+        mjs_prepend_errorf(mjs, MJS_BAD_ARGS_ERROR, "JSON: nested too deep, or a cycle");
+        result = MJS_UNDEFINED;
+    } else if(writer->file) {
+        result = mjs_mk_boolean(mjs, !writer->failed);
+    } else {
+        result = mjs_mk_string(
+            mjs, furi_string_get_cstr(writer->string), furi_string_size(writer->string), true);
+    }
+    if(writer->string) furi_string_free(writer->string);
+    free(writer);
+    mjs_return(mjs, result);
+}
+
+void* js_json_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+    UNUSED(modules);
+    mjs_val_t json_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, json_obj) {
+        JS_FIELD("parse", MJS_MK_FN(js_json_parse));
+        JS_FIELD("parseEvents", MJS_MK_FN(js_json_parse_events_js));
+        JS_FIELD("stringify", MJS_MK_FN(js_json_stringify));
+    }
+    *object = json_obj;
+    return (void*)1;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_json.h
+ *
+ * Built-in `json` module with a streaming parser and writer:
+ *   - `json.parse(source)`: builds the value tree;
+ *   - `json.parseEvents(source, handlers)`: calls `onObjectStart`,
+ *     `onObjectEnd`, `onArrayStart`, `onArrayEnd`, `onKey` and `onValue`
+ *     instead, and stops early if a handler returns false;
+ *   - `json.stringify(value, file?)`: returns a string, or writes to the file
+ *     and returns whether that worked. `NaN` and `Infinity` become `null`.
+ *
+ * The source is a string or a file object from the `storage` module.
+ */
+
+void* js_json_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
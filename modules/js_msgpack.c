@@ -0,0 +1,681 @@
+#include "js_msgpack.h"
+#include "js_storage.h"
+#include <math.h>
+
+#define TAG "JsMsgpack"
+
+#define MSGPACK_CHUNK_SIZE  64 //<! Bytes read from a file at a time
+#define MSGPACK_WRITE_SIZE  128 //<! Bytes of output written to a file at a time
+#define MSGPACK_DEPTH_MAX   32
+#define MSGPACK_PENDING_MAX 8192 //<! Of an incomplete value held by a stream decoder
+
+// ======
+// Reader
+// ======
+
+static bool js_msgpack_is_blob(mjs_val_t value) {
+    return mjs_is_array_buf(value) || mjs_is_typed_array(value);
+}
+
+static const uint8_t* js_msgpack_blob_get(struct mjs* mjs, mjs_val_t value, size_t* len) {
+    if(mjs_is_data_view(value)) value = mjs_dataview_get_buf(mjs, value);
+    *len = 0;
+    return (const uint8_t*)mjs_array_buf_get_ptr(mjs, value, len);
+}
+
+/**
+ * Input is either script buffers, read by offset, or a file, which is read
+ * through a small chunk. Buffer contents can move when the script allocates,
+ * so they're looked up again on every read rather than kept as a pointer.
+ */
+typedef struct {
+    struct mjs* mjs;
+    mjs_val_t buffers[2]; //<! Read one after the other, MJS_UNDEFINED when unused
+    size_t size; //<! Of all buffers
+    size_t pos; //<! Bytes consumed
+    File* file;
+    uint8_t chunk[MSGPACK_CHUNK_SIZE];
+    size_t chunk_len;
+    size_t chunk_pos;
+    uint8_t* scratch; //<! For bytes that values are made from, or that span a boundary
+    size_t scratch_size;
+} JsMsgpackReader;
+
+static uint8_t* js_msgpack_scratch(JsMsgpackReader* reader, size_t len) {
+    if(!reader->scratch || reader->scratch_size < len) {
+        free(reader->scratch);
+        reader->scratch = malloc(MAX(len, 1U));
+        reader->scratch_size = len;
+    }
+    return reader->scratch;
+}
+
+static const uint8_t* js_msgpack_take_buffers(JsMsgpackReader* reader, size_t len, bool copy) {
+    if(reader->size - reader->pos < len) return NULL;
+    size_t offset = reader->pos;
+    reader->pos += len;
+
+    uint8_t* scratch = copy ? js_msgpack_scratch(reader, len) : NULL;
+    size_t copied = 0;
+    for(size_t i = 0; copied < len; i++) {
+        if(!js_msgpack_is_blob(reader->buffers[i])) continue;
+        size_t part_len;
+        const uint8_t* part = js_msgpack_blob_get(reader->mjs, reader->buffers[i], &part_len);
+        if(offset >= part_len) {
+            offset -= part_len;
+            continue;
+        }
+        size_t part_take = MIN(part_len - offset, len - copied);
+        if(!scratch && part_take == len) return &part[offset];
+        if(!scratch) scratch = js_msgpack_scratch(reader, len);
+        memcpy(&scratch[copied], &part[offset], part_take);
+        copied += part_take;
+        offset = 0;
+    }
+    return scratch;
+}
+
+/**
+ * @param copy Whether a value is going to be made from the bytes. Buffer
+ * input is then copied to scratch first, since making the value can move it.
+ * @returns the next `len` bytes, valid until the next call, or NULL if the
+ * input ends first
+ */
+static const uint8_t* js_msgpack_take(JsMsgpackReader* reader, size_t len, bool copy) {
+    if(!reader->file) return js_msgpack_take_buffers(reader, len, copy);
+
+    size_t buffered = reader->chunk_len - reader->chunk_pos;
+    if(len > buffered && len <= MSGPACK_CHUNK_SIZE) {
+        memmove(reader->chunk, &reader->chunk[reader->chunk_pos], buffered);
+        size_t free_len = MSGPACK_CHUNK_SIZE - buffered;
+        reader->chunk_len =
+            buffered + storage_file_read(reader->file, &reader->chunk[buffered], free_len);
+        reader->chunk_pos = 0;
+        buffered = reader->chunk_len;
+        if(len > buffered) return NULL;
+    }
+    if(len <= buffered) {
+        const uint8_t* at = &reader->chunk[reader->chunk_pos];
+        reader->chunk_pos += len;
+        reader->pos += len;
+        return at;
+    }
+
+    // long strings and blobs are read past the chunk, if the file has them
+    size_t rest = len - buffered;
+    if(rest > storage_file_size(reader->file) - storage_file_tell(reader->file)) return NULL;
+    uint8_t* scratch = js_msgpack_scratch(reader, len);
+    memcpy(scratch, &reader->chunk[reader->chunk_pos], buffered);
+    reader->chunk_pos = reader->chunk_len;
+    if(storage_file_read(reader->file, &scratch[buffered], rest) != rest) return NULL;
+    reader->pos += len;
+    return scratch;
+}
+
+static bool js_msgpack_take_uint(JsMsgpackReader* reader, size_t size, uint64_t* value) {
+    const uint8_t* at = js_msgpack_take(reader, size, false);
+    if(!at) return false;
+    *value = 0;
+    for(size_t i = 0; i < size; i++)
+        *value = (*value << 8) | at[i];
+    return true;
+}
+
+// =======
+// Decoder
+// =======
+
+typedef enum {
+    JsMsgpackStatusOk,
+    JsMsgpackStatusIncomplete, //<! The input ended inside a value
+    JsMsgpackStatusInvalid,
+} JsMsgpackStatus;
+
+typedef enum {
+    JsMsgpackKindValue,
+    JsMsgpackKindArray,
+    JsMsgpackKindMap,
+} JsMsgpackKind;
+
+typedef struct {
+    mjs_val_t container;
+    uint32_t remaining; //<! Items, or key and value pairs for maps
+    bool is_map;
+    bool want_key;
+    mjs_val_t key;
+} JsMsgpackLevel;
+
+typedef struct {
+    struct mjs* mjs;
+    JsMsgpackReader reader;
+    const char* error; //<! Set when the input is invalid
+    JsMsgpackLevel levels[MSGPACK_DEPTH_MAX];
+} JsMsgpackDecoder;
+
+/**
+ * @brief Reads a scalar, or the header of an array or map
+ * @param count Set to the number of items for arrays and maps
+ */
+static JsMsgpackStatus js_msgpack_read_item(
+    JsMsgpackDecoder* decoder,
+    mjs_val_t* value,
+    JsMsgpackKind* kind,
+    uint64_t* count) {
+    struct mjs* mjs = decoder->mjs;
+    JsMsgpackReader* reader = &decoder->reader;
+    const uint8_t* at = js_msgpack_take(reader, 1, false);
+    if(!at) return JsMsgpackStatusIncomplete;
+    uint8_t type = *at;
+    *kind = JsMsgpackKindValue;
+    uint64_t number, len;
+
+    if(type <= 0x7f || type >= 0xe0) {
+        *value = mjs_mk_number(mjs, (int8_t)type);
+    } else if(type <= 0x8f) {
+        *kind = JsMsgpackKindMap;
+        *count = type & 0x0f;
+    } else if(type <= 0x9f) {
+        *kind = JsMsgpackKindArray;
+        *count = type & 0x0f;
+    } else if(type <= 0xbf || (type >= 0xd9 && type <= 0xdb)) {
+        if(type <= 0xbf) {
+            len = type & 0x1f;
+        } else if(!js_msgpack_take_uint(reader, 1 << (type - 0xd9), &len)) {
+            return JsMsgpackStatusIncomplete;
+        }
+        if(!(at = js_msgpack_take(reader, len, true))) return JsMsgpackStatusIncomplete;
+        *value = mjs_mk_string(mjs, (const char*)at, len, true);
+    } else if(type >= 0xc4 && type <= 0xc6) {
+        if(!js_msgpack_take_uint(reader, 1 << (type - 0xc4), &len))
+            return JsMsgpackStatusIncomplete;
+        if(!(at = js_msgpack_take(reader, len, true))) return JsMsgpackStatusIncomplete;
+        *value = mjs_mk_array_buf(mjs, (char*)at, len);
+    } else if(type == 0xc0) {
+        *value = MJS_NULL;
+    } else if(type == 0xc2 || type == 0xc3) {
+        *value = mjs_mk_boolean(mjs, type == 0xc3);
+    } else if(type == 0xca) {
+        if(!js_msgpack_take_uint(reader, 4, &number)) return JsMsgpackStatusIncomplete;
+        uint32_t bits = number;
+        float single;
+        memcpy(&single, &bits, sizeof(single));
+        *value = mjs_mk_number(mjs, single);
+    } else if(type == 0xcb) {
+        if(!js_msgpack_take_uint(reader, 8, &number)) return JsMsgpackStatusIncomplete;
+        double dbl;
+        memcpy(&dbl, &number, sizeof(dbl));
+        *value = mjs_mk_number(mjs, dbl);
+    } else if(type >= 0xcc && type <= 0xd3) {
+        size_t size = 1 << (type & 3);
+        if(!js_msgpack_take_uint(reader, size, &number)) return JsMsgpackStatusIncomplete;
+        if(type >= 0xd0 && size < 8 && (number >> (size * 8 - 1))) {
+            number |= UINT64_MAX << (size * 8); // sign extend
+        }
+        *value = mjs_mk_number(mjs, type >= 0xd0 ? (double)(int64_t)number : (double)number);
+    } else if(type >= 0xdc && type <= 0xdf) {
+        *kind = type <= 0xdd ? JsMsgpackKindArray : JsMsgpackKindMap;
+        if(!js_msgpack_take_uint(reader, 2 << (type & 1), count)) return JsMsgpackStatusIncomplete;
+    } else {
+        decoder->error = "unsupported type";
+        return JsMsgpackStatusInvalid;
+    }
+
+    if(*kind == JsMsgpackKindArray) *value = mjs_mk_array(mjs);
+    if(*kind == JsMsgpackKindMap) *value = mjs_mk_object(mjs);
+    return JsMsgpackStatusOk;
+}
+
+static bool js_msgpack_set_key(JsMsgpackDecoder* decoder, JsMsgpackLevel* level, mjs_val_t key) {
+    struct mjs* mjs = decoder->mjs;
+    if(mjs_is_number(key)) {
+        char* str = NULL;
+        size_t len = 0;
+        int need_free = 0;
+        mjs_to_string(mjs, &key, &str, &len, &need_free);
+        key = mjs_mk_string(mjs, str, len, true);
+        if(need_free) free(str);
+    } else if(!mjs_is_string(key)) {
+        decoder->error = "map key is not a string or number";
+        return false;
+    }
+    level->key = key;
+    level->want_key = false;
+    return true;
+}
+
+/**
+ * @brief Decodes one value. Nesting is kept in `decoder->levels` rather
+ * than on the stack, since the script's stack is small.
+ */
+static JsMsgpackStatus js_msgpack_decode_value(JsMsgpackDecoder* decoder, mjs_val_t* result) {
+    struct mjs* mjs = decoder->mjs;
+    size_t depth = 0;
+    while(true) {
+        mjs_val_t value = MJS_UNDEFINED;
+        JsMsgpackKind kind;
+        uint64_t count = 0;
+        JsMsgpackStatus status = js_msgpack_read_item(decoder, &value, &kind, &count);
+        if(status != JsMsgpackStatusOk) return status;
+
+        // containers are attached as soon as they're made, so that
+        // everything but the result is reachable while decoding
+        if(depth) {
+            JsMsgpackLevel* level = &decoder->levels[depth - 1];
+            if(level->want_key) {
+                if(!js_msgpack_set_key(decoder, level, value)) return JsMsgpackStatusInvalid;
+                continue;
+            }
+            if(level->is_map) {
+                size_t key_len;
+                const char* key = mjs_get_string(mjs, &level->key, &key_len);
+                mjs_set(mjs, level->container, key, key_len, value);
+                level->want_key = true;
+            } else {
+                mjs_array_push(mjs, level->container, value);
+            }
+            level->remaining--;
+        } else {
+            *result = value;
+        }
+
+        if(kind != JsMsgpackKindValue && count) {
+            if(depth == MSGPACK_DEPTH_MAX) {
+                decoder->error = "nested too deep";
+                return JsMsgpackStatusInvalid;
+            }
+            decoder->levels[depth++] = (JsMsgpackLevel){
+                .container = value,
+                .remaining = count,
+                .is_map = kind == JsMsgpackKindMap,
+                .want_key = kind == JsMsgpackKindMap,
+            };
+            continue;
+        }
+
+        while(depth && !decoder->levels[depth - 1].remaining)
+            depth--;
+        if(!depth) return JsMsgpackStatusOk;
+    }
+}
+
+/**
+ * @brief Sets up the reader for up to two buffers, which are kept alive
+ * until `js_msgpack_reader_deinit`
+ */
+static void js_msgpack_reader_init(
+    JsMsgpackReader* reader,
+    struct mjs* mjs,
+    mjs_val_t first,
+    mjs_val_t second) {
+    reader->mjs = mjs;
+    reader->buffers[0] = first;
+    reader->buffers[1] = second;
+    for(size_t i = 0; i < COUNT_OF(reader->buffers); i++) {
+        if(!js_msgpack_is_blob(reader->buffers[i])) continue;
+        size_t len;
+        js_msgpack_blob_get(mjs, reader->buffers[i], &len);
+        reader->size += len;
+        mjs_own(mjs, &reader->buffers[i]);
+    }
+}
+
+static void js_msgpack_reader_deinit(JsMsgpackReader* reader) {
+    for(size_t i = 0; i < COUNT_OF(reader->buffers); i++) {
+        if(js_msgpack_is_blob(reader->buffers[i])) mjs_disown(reader->mjs, &reader->buffers[i]);
+    }
+    free(reader->scratch);
+}
+
+static void js_msgpack_decode(struct mjs* mjs) {
+    static const JsValueDeclaration js_msgpack_decode_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_msgpack_decode_args =
+        JS_VALUE_ARGS(js_msgpack_decode_arg_list);
+
+    mjs_val_t source;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_msgpack_decode_args, &source);
+
+    JsMsgpackDecoder* decoder = malloc(sizeof(JsMsgpackDecoder));
+    memset(decoder, 0, sizeof(JsMsgpackDecoder));
+    decoder->mjs = mjs;
+    JsMsgpackReader* reader = &decoder->reader;
+    if(js_msgpack_is_blob(source)) {
+        js_msgpack_reader_init(reader, mjs, source, MJS_UNDEFINED);
+    } else if((reader->file = js_storage_file_get(mjs, source))) {
+        js_msgpack_reader_init(reader, mjs, MJS_UNDEFINED, MJS_UNDEFINED);
+    } else {
+        free(decoder);
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer or a file");
+    }
+
+    mjs_val_t result = MJS_UNDEFINED;
+    JsMsgpackStatus status = js_msgpack_decode_value(decoder, &result);
+    if(reader->file) {
+        // leave the file at the end of the value for the next call
+        size_t unread = reader->chunk_len - reader->chunk_pos;
+        storage_file_seek(reader->file, storage_file_tell(reader->file) - unread, true);
+        if(status == JsMsgpackStatusIncomplete && reader->pos == 0) {
+            status = JsMsgpackStatusOk; // end of file
+        }
+    } else if(status == JsMsgpackStatusOk && reader->pos != reader->size) {
+        decoder->error = "trailing bytes";
+        status = JsMsgpackStatusInvalid;
+    }
+
+    if(status == JsMsgpackStatusIncomplete) decoder->error = "truncated input";
+    if(status != JsMsgpackStatusOk) {
+        mjs_prepend_errorf(
+            mjs, MJS_BAD_ARGS_ERROR, "msgpack: %s at offset %zu", decoder->error, reader->pos);
+        result = MJS_UNDEFINED;
+    }
+    js_msgpack_reader_deinit(reader);
+    free(decoder);
+    mjs_return(mjs, result);
+}
+
+/**
+ * @brief Decodes the values that are complete in the pending and new bytes,
+ * and keeps the rest in `this.pending` for the next call
+ */
+static void js_msgpack_decoder_push(struct mjs* mjs) {
+    static const JsValueDeclaration js_msgpack_push_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+    };
+    static const JsValueArguments js_msgpack_push_args = JS_VALUE_ARGS(js_msgpack_push_arg_list);
+
+    mjs_val_t data;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_msgpack_push_args, &data);
+    if(!js_msgpack_is_blob(data))
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer");
+
+    mjs_val_t this_obj = mjs_get_this(mjs);
+    mjs_val_t pending = mjs_get(mjs, this_obj, "pending", ~0);
+
+    JsMsgpackDecoder* decoder = malloc(sizeof(JsMsgpackDecoder));
+    memset(decoder, 0, sizeof(JsMsgpackDecoder));
+    decoder->mjs = mjs;
+    JsMsgpackReader* reader = &decoder->reader;
+    // the pending bytes are read before the new ones, without joining them
+    js_msgpack_reader_init(reader, mjs, pending, data);
+
+    mjs_val_t values = mjs_mk_array(mjs);
+    JsMsgpackStatus status = JsMsgpackStatusOk;
+    while(reader->pos < reader->size) {
+        size_t start = reader->pos;
+        mjs_val_t value;
+        status = js_msgpack_decode_value(decoder, &value);
+        if(status == JsMsgpackStatusOk) {
+            mjs_array_push(mjs, values, value);
+        } else {
+            if(status == JsMsgpackStatusIncomplete) reader->pos = start;
+            break;
+        }
+    }
+
+    size_t rest = reader->size - reader->pos;
+    if(status == JsMsgpackStatusIncomplete && rest > MSGPACK_PENDING_MAX) {
+        decoder->error = "value too long to buffer";
+        status = JsMsgpackStatusInvalid;
+    }
+    if(status == JsMsgpackStatusInvalid) {
+        mjs_prepend_errorf(
+            mjs, MJS_BAD_ARGS_ERROR, "msgpack: %s at offset %zu", decoder->error, reader->pos);
+        values = MJS_UNDEFINED;
+        rest = 0; // drop the stream so far
+    }
+    reader->pos = reader->size - rest;
+    pending = mjs_mk_array_buf(mjs, (char*)js_msgpack_take(reader, rest, true), rest);
+    mjs_set(mjs, this_obj, "pending", ~0, pending);
+    js_msgpack_reader_deinit(reader);
+    free(decoder);
+    mjs_return(mjs, values);
+}
+
+static void js_msgpack_decoder(struct mjs* mjs) {
+    mjs_val_t decoder_obj = mjs_mk_object(mjs);
+    mjs_set(mjs, decoder_obj, "push", ~0, MJS_MK_FN(js_msgpack_decoder_push));
+    mjs_return(mjs, decoder_obj);
+}
+
+// =======
+// Encoder
+// =======
+
+/**
+ * Output goes into a growing buffer, or through a small one into a file.
+ */
+typedef struct {
+    struct mjs* mjs;
+    File* file;
+    uint8_t* data;
+    size_t len;
+    size_t capacity;
+    bool failed;
+} JsMsgpackWriter;
+
+static void js_msgpack_flush(JsMsgpackWriter* writer) {
+    if(writer->file && writer->len) {
+        if(storage_file_write(writer->file, writer->data, writer->len) != writer->len)
+            writer->failed = true;
+        writer->len = 0;
+    }
+}
+
+static void js_msgpack_write(JsMsgpackWriter* writer, const void* data, size_t len) {
+    if(writer->capacity - writer->len < len) {
+        if(writer->file) {
+            js_msgpack_flush(writer);
+            // blobs go to the file straight from the script's memory
+            if(len >= writer->capacity) {
+                if(storage_file_write(writer->file, data, len) != len) writer->failed = true;
+                return;
+            }
+        } else {
+            while(writer->capacity - writer->len < len)
+                writer->capacity *= 2;
+            writer->data = realloc(writer->data, writer->capacity); //-V701
+        }
+    }
+    memcpy(&writer->data[writer->len], data, len);
+    writer->len += len;
+}
+
+/**
+ * @brief Writes a type byte followed by `size` big-endian bytes of `value`
+ */
+static void
+    js_msgpack_write_head(JsMsgpackWriter* writer, uint8_t type, uint64_t value, size_t size) {
+    uint8_t head[9] = {type};
+    for(size_t i = 0; i < size; i++)
+        head[size - i] = value >> (i * 8);
+    js_msgpack_write(writer, head, size + 1);
+}
+
+static void js_msgpack_write_number(JsMsgpackWriter* writer, double number) {
+    if(number == trunc(number) && (number != 0 || !signbit(number)) &&
+       number >= -9223372036854775808.0 && number < 18446744073709551616.0) {
+        if(number >= 0) {
+            uint64_t value = number;
+            if(value <= 0x7f) {
+                js_msgpack_write_head(writer, value, 0, 0);
+            } else if(value <= UINT8_MAX) {
+                js_msgpack_write_head(writer, 0xcc, value, 1);
+            } else if(value <= UINT16_MAX) {
+                js_msgpack_write_head(writer, 0xcd, value, 2);
+            } else if(value <= UINT32_MAX) {
+                js_msgpack_write_head(writer, 0xce, value, 4);
+            } else {
+                js_msgpack_write_head(writer, 0xcf, value, 8);
+            }
+        } else {
+            int64_t value = number;
+            if(value >= -32) {
+                js_msgpack_write_head(writer, (uint8_t)value, 0, 0);
+            } else if(value >= INT8_MIN) {
+                js_msgpack_write_head(writer, 0xd0, value, 1);
+            } else if(value >= INT16_MIN) {
+                js_msgpack_write_head(writer, 0xd1, value, 2);
+            } else if(value >= INT32_MIN) {
+                js_msgpack_write_head(writer, 0xd2, value, 4);
+            } else {
+                js_msgpack_write_head(writer, 0xd3, value, 8);
+            }
+        }
+        return;
+    }
+
+    float single = number;
+    if((double)single == number) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        js_msgpack_write_head(writer, 0xca, bits, 4);
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        js_msgpack_write_head(writer, 0xcb, bits, 8);
+    }
+}
+
+static void js_msgpack_write_string(JsMsgpackWriter* writer, const char* str, size_t len) {
+    if(len < 32) {
+        js_msgpack_write_head(writer, 0xa0 | len, 0, 0);
+    } else if(len <= UINT8_MAX) {
+        js_msgpack_write_head(writer, 0xd9, len, 1);
+    } else if(len <= UINT16_MAX) {
+        js_msgpack_write_head(writer, 0xda, len, 2);
+    } else {
+        js_msgpack_write_head(writer, 0xdb, len, 4);
+    }
+    js_msgpack_write(writer, str, len);
+}
+
+static bool js_msgpack_is_skipped(mjs_val_t value) {
+    return mjs_is_undefined(value) || mjs_is_function(value) || mjs_is_foreign(value);
+}
+
+/**
+ * @returns false if the value is nested too deep, which is likely a cycle
+ */
+static bool js_msgpack_write_value(JsMsgpackWriter* writer, mjs_val_t value, size_t depth) {
+    struct mjs* mjs = writer->mjs;
+    if(depth > MSGPACK_DEPTH_MAX) return false;
+
+    if(mjs_is_string(value)) {
+        size_t len;
+        const char* str = mjs_get_string(mjs, &value, &len);
+        js_msgpack_write_string(writer, str, len);
+    } else if(mjs_is_number(value)) {
+        js_msgpack_write_number(writer, mjs_get_double(mjs, value));
+    } else if(mjs_is_boolean(value)) {
+        js_msgpack_write_head(writer, mjs_get_bool(mjs, value) ? 0xc3 : 0xc2, 0, 0);
+    } else if(js_msgpack_is_blob(value)) {
+        size_t len;
+        js_msgpack_blob_get(mjs, value, &len);
+        if(len <= UINT8_MAX) {
+            js_msgpack_write_head(writer, 0xc4, len, 1);
+        } else if(len <= UINT16_MAX) {
+            js_msgpack_write_head(writer, 0xc5, len, 2);
+        } else {
+            js_msgpack_write_head(writer, 0xc6, len, 4);
+        }
+        js_msgpack_write(writer, js_msgpack_blob_get(mjs, value, &len), len);
+    } else if(mjs_is_array(value)) {
+        unsigned long length = mjs_array_length(mjs, value);
+        if(length < 16) {
+            js_msgpack_write_head(writer, 0x90 | length, 0, 0);
+        } else if(length <= UINT16_MAX) {
+            js_msgpack_write_head(writer, 0xdc, length, 2);
+        } else {
+            js_msgpack_write_head(writer, 0xdd, length, 4);
+        }
+        for(unsigned long i = 0; i < length; i++) {
+            mjs_val_t item = mjs_array_get(mjs, value, i);
+            if(js_msgpack_is_skipped(item)) {
+                js_msgpack_write_head(writer, 0xc0, 0, 0);
+            } else if(!js_msgpack_write_value(writer, item, depth + 1)) {
+                return false;
+            }
+        }
+    } else if(mjs_is_object(value)) {
+        // the header needs the count of the fields that are written
+        size_t count = 0;
+        mjs_val_t iter = MJS_UNDEFINED, key;
+        while((key = mjs_next(mjs, value, &iter)) != MJS_UNDEFINED) {
+            size_t key_len;
+            const char* key_str = mjs_get_string(mjs, &key, &key_len);
+            if(!js_msgpack_is_skipped(mjs_get(mjs, value, key_str, key_len))) count++;
+        }
+        if(count < 16) {
+            js_msgpack_write_head(writer, 0x80 | count, 0, 0);
+        } else if(count <= UINT16_MAX) {
+            js_msgpack_write_head(writer, 0xde, count, 2);
+        } else {
+            js_msgpack_write_head(writer, 0xdf, count, 4);
+        }
+
+        iter = MJS_UNDEFINED;
+        while((key = mjs_next(mjs, value, &iter)) != MJS_UNDEFINED) {
+            size_t key_len;
+            const char* key_str = mjs_get_string(mjs, &key, &key_len);
+            mjs_val_t item = mjs_get(mjs, value, key_str, key_len);
+            if(js_msgpack_is_skipped(item)) continue;
+            js_msgpack_write_string(writer, key_str, key_len);
+            if(!js_msgpack_write_value(writer, item, depth + 1)) return false;
+        }
+    } else {
+        js_msgpack_write_head(writer, 0xc0, 0, 0);
+    }
+    return true;
+}
+
+static void js_msgpack_encode(struct mjs* mjs) {
+    static const JsValueDeclaration js_msgpack_encode_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeAny), // optional file
+    };
+    static const JsValueArguments js_msgpack_encode_args =
+        JS_VALUE_ARGS(js_msgpack_encode_arg_list);
+
+    mjs_val_t value, file_obj;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_msgpack_encode_args, &value, &file_obj);
+
+    File* file = NULL;
+    if(!mjs_is_undefined(file_obj)) {
+        file = js_storage_file_get(mjs, file_obj);
+        if(!file) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "argument 1: expected a file");
+    }
+
+    JsMsgpackWriter writer = {
+        .mjs = mjs,
+        .file = file,
+        .capacity = MSGPACK_WRITE_SIZE,
+    };
+    writer.data = malloc(writer.capacity);
+    bool ok = js_msgpack_write_value(&writer, value, 0);
+    js_msgpack_flush(&writer);
+
+    mjs_val_t result;
+    if(!ok) {
+        mjs_prepend_errorf(mjs, MJS_BAD_ARGS_ERROR, "msgpack: nested too deep, or a cycle");
+        result = MJS_UNDEFINED;
+    } else if(writer.file) {
+        result = mjs_mk_boolean(mjs, !writer.failed);
+    } else {
+        result = mjs_mk_array_buf(mjs, (char*)writer.data, writer.len);
+    }
+    free(writer.data);
+    mjs_return(mjs, result);
+}
+
+void* js_msgpack_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+    UNUSED(modules);
+    mjs_val_t msgpack_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, msgpack_obj) {
+        JS_FIELD("encode", MJS_MK_FN(js_msgpack_encode));
+        JS_FIELD("decode", MJS_MK_FN(js_msgpack_decode));
+        JS_FIELD("decoder", MJS_MK_FN(js_msgpack_decoder));
+    }
+    *object = msgpack_obj;
+    return (void*)1;
+}
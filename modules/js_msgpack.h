@@ -0,0 +1,20 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_msgpack.h
+ *
+ * Built-in `msgpack` module, a MessagePack codec:
+ *   - `msgpack.encode(value, file?)`: returns an ArrayBuffer, or writes to
+ *     the file and returns whether that worked;
+ *   - `msgpack.decode(source)`: decodes an ArrayBuffer, typed array or
+ *     DataView, or reads the next value from a file, returning `undefined` at
+ *     its end;
+ *   - `msgpack.decoder()`: a stream decoder whose `push(data)` returns the
+ *     values completed so far.
+ *
+ * Files are file objects from the `storage` module.
+ */
+
+void* js_msgpack_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
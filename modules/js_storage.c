@@ -1,4 +1,4 @@
-#include "../js_modules.h" // IWYU pragma: keep
+#include "js_storage.h"
 #include <path.h>
 
 // ==========================
@@ -25,13 +25,18 @@ static const JsValueArguments js_storage_2_str_args = JS_VALUE_ARGS(js_storage_2
 // File object operations
 // ======================
 
+static File* js_storage_file_this(struct mjs* mjs) {
+    JsStorageFile* storage_file = JS_GET_CONTEXT(mjs);
+    return storage_file->file;
+}
+
 static void js_storage_file_close(struct mjs* mjs) {
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_close(file)));
 }
 
 static void js_storage_file_is_open(struct mjs* mjs) {
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_is_open(file)));
 }
 
@@ -54,7 +59,7 @@ static void js_storage_file_read(struct mjs* mjs) {
     int32_t length;
     JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_storage_read_args, &read_mode, &length);
 
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     char buffer[length];
     size_t actually_read = storage_file_read(file, buffer, length);
     if(read_mode == JsStorageReadModeAscii) {
@@ -83,41 +88,41 @@ static void js_storage_file_write(struct mjs* mjs) {
     } else {
         JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "argument 0: expected string or ArrayBuffer");
     }
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_number(mjs, storage_file_write(file, buf, len)));
 }
 
 static void js_storage_file_seek_relative(struct mjs* mjs) {
     int32_t offset;
     JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_storage_1_int_args, &offset);
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_seek(file, offset, false)));
 }
 
 static void js_storage_file_seek_absolute(struct mjs* mjs) {
     int32_t offset;
     JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_storage_1_int_args, &offset);
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_seek(file, offset, true)));
 }
 
 static void js_storage_file_tell(struct mjs* mjs) {
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_number(mjs, storage_file_tell(file)));
 }
 
 static void js_storage_file_truncate(struct mjs* mjs) {
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_truncate(file)));
 }
 
 static void js_storage_file_size(struct mjs* mjs) {
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_number(mjs, storage_file_size(file)));
 }
 
 static void js_storage_file_eof(struct mjs* mjs) {
-    File* file = JS_GET_CONTEXT(mjs);
+    File* file = js_storage_file_this(mjs);
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_eof(file)));
 }
 
@@ -133,8 +138,9 @@ static void js_storage_file_copy_to(struct mjs* mjs) {
     int32_t bytes;
     JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_storage_file_write_args, &dest_obj, &bytes);
 
-    File* source = JS_GET_CONTEXT(mjs);
-    File* destination = JS_GET_INST(mjs, dest_obj);
+    File* source = js_storage_file_this(mjs);
+    File* destination = js_storage_file_get(mjs, dest_obj);
+    if(!destination) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "argument 0: expected a file");
     mjs_return(mjs, mjs_mk_boolean(mjs, storage_file_copy_to_file(source, destination, bytes)));
 }
 
@@ -144,8 +150,9 @@ static void js_storage_file_copy_to(struct mjs* mjs) {
 
 // common destructor for file and dir objects
 static void js_storage_file_destructor(struct mjs* mjs, mjs_val_t obj) {
-    File* file = JS_GET_INST(mjs, obj);
-    storage_file_free(file);
+    JsStorageFile* storage_file = JS_GET_INST(mjs, obj);
+    storage_file_free(storage_file->file);
+    free(storage_file);
 }
 
 static void js_storage_open_file(struct mjs* mjs) {
@@ -184,9 +191,13 @@ static void js_storage_open_file(struct mjs* mjs) {
         return;
     }
 
+    JsStorageFile* storage_file = malloc(sizeof(JsStorageFile));
+    storage_file->magic = JsForeignMagic_JsStorageFile;
+    storage_file->file = file;
+
     mjs_val_t file_obj = mjs_mk_object(mjs);
     JS_ASSIGN_MULTI(mjs, file_obj) {
-        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, file));
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, storage_file));
         JS_FIELD(MJS_DESTRUCTOR_PROP_NAME, MJS_MK_FN(js_storage_file_destructor));
         JS_FIELD("close", MJS_MK_FN(js_storage_file_close));
         JS_FIELD("isOpen", MJS_MK_FN(js_storage_file_is_open));
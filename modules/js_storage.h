@@ -0,0 +1,32 @@
+#pragma once
+#include "../js_modules.h" // IWYU pragma: keep
+#include <storage/storage.h>
+
+/**
+ * @file js_storage.h
+ *
+ * File objects made by `storage.openFile()` keep a `JsStorageFile` as their
+ * foreign pointer. Modules that read from or write to such objects should
+ * get the file with `js_storage_file_get`, which checks the magic, rather
+ * than casting `INST_PROP_NAME` of whatever object they were given.
+ */
+
+typedef struct {
+    JsForeignMagic magic; // <! `JsForeignMagic_JsStorageFile`
+    File* file;
+} JsStorageFile;
+
+static_assert(offsetof(JsStorageFile, magic) == 0);
+
+/**
+ * @brief Gets the file of a storage file object
+ * @returns NULL if `obj` is not a storage file object
+ */
+static inline File* js_storage_file_get(struct mjs* mjs, mjs_val_t obj) {
+    if(!mjs_is_object(obj)) return NULL;
+    mjs_val_t inst = mjs_get(mjs, obj, INST_PROP_NAME, ~0);
+    if(!mjs_is_foreign(inst)) return NULL;
+    JsStorageFile* storage_file = mjs_get_ptr(mjs, inst);
+    if(!storage_file || storage_file->magic != JsForeignMagic_JsStorageFile) return NULL;
+    return storage_file->file;
+}
@@ -0,0 +1,547 @@
+#include "js_struct.h"
+#include <m-array.h>
+#include <math.h>
+
+#define TAG "JsStruct"
+
+#define STRUCT_FIELDS_MAX 64
+#define STRUCT_SIZE_MAX   UINT16_MAX
+
+typedef enum {
+    JsStructTypePad,
+    JsStructTypeInt,
+    JsStructTypeUint,
+    JsStructTypeBool,
+    JsStructTypeFloat,
+    JsStructTypeBytes, //<! Read as a string up to the first NUL
+} JsStructType;
+
+/**
+ * @brief What a format character stands for
+ */
+typedef struct {
+    char code;
+    JsStructType type;
+    uint8_t size;
+} JsStructCode;
+
+static const JsStructCode js_struct_codes[] = {
+    {'x', JsStructTypePad, 1},
+    {'b', JsStructTypeInt, 1},
+    {'B', JsStructTypeUint, 1},
+    {'?', JsStructTypeBool, 1},
+    {'h', JsStructTypeInt, 2},
+    {'H', JsStructTypeUint, 2},
+    {'i', JsStructTypeInt, 4},
+    {'I', JsStructTypeUint, 4},
+    {'l', JsStructTypeInt, 4},
+    {'L', JsStructTypeUint, 4},
+    {'q', JsStructTypeInt, 8},
+    {'Q', JsStructTypeUint, 8},
+    {'f', JsStructTypeFloat, 4},
+    {'d', JsStructTypeFloat, 8},
+    {'s', JsStructTypeBytes, 1},
+};
+
+/**
+ * @brief A value in a record. Pad bytes have a field too, but no value.
+ */
+typedef struct {
+    JsStructType type;
+    uint16_t offset;
+    uint16_t size; //<! Length of the string for `s`
+} JsStructField;
+
+typedef struct {
+    char* format;
+    bool big_endian;
+    size_t size; //<! Of a record
+    size_t n_values;
+    size_t n_fields;
+    JsStructField fields[];
+} JsStructLayout;
+
+ARRAY_DEF(JsStructLayoutArray, JsStructLayout*, M_PTR_OPLIST); //-V575
+
+/**
+ * @brief What a layout object made by `compile()` refers to. The names are
+ * copied, so that scripts can't change them under `pack()` and `unpack()`.
+ */
+typedef struct {
+    const JsStructLayout* layout;
+    char** names; //<! One per value, or NULL if the values aren't named
+} JsStructView;
+
+ARRAY_DEF(JsStructViewArray, JsStructView*, M_PTR_OPLIST); //-V575
+
+typedef struct {
+    JsStructLayoutArray_t layouts; //<! Compiled so far, by format
+    JsStructViewArray_t views; //<! Made so far, by layout and names
+} JsStruct;
+
+/**
+ * @brief Compiles a format like `"<HHIf8s"`: an optional byte order, `<`
+ * (the default) or `>`/`!`, then codes, each with an optional count
+ * @returns NULL and sets `error` if the format is invalid
+ */
+static JsStructLayout* js_struct_compile_format(const char* format, const char** error) {
+    JsStructField fields[STRUCT_FIELDS_MAX];
+    size_t n_fields = 0, n_values = 0, size = 0;
+    bool big_endian = false;
+
+    const char* at = format;
+    if(*at == '<') {
+        at++;
+    } else if(*at == '>' || *at == '!') {
+        big_endian = true;
+        at++;
+    }
+
+    while(*at) {
+        size_t count = 1;
+        if(*at >= '0' && *at <= '9') {
+            count = 0;
+            for(; *at >= '0' && *at <= '9'; at++)
+                count = MIN(count * 10 + (*at - '0'), STRUCT_SIZE_MAX + 1U);
+        }
+
+        const JsStructCode* code = NULL;
+        for(size_t i = 0; i < COUNT_OF(js_struct_codes); i++) {
+            if(js_struct_codes[i].code == *at) code = &js_struct_codes[i];
+        }
+        if(!code) {
+            *error = *at ? "unknown format code" : "count without a code";
+            return NULL;
+        }
+        at++;
+
+        // `8s` is one string of 8 bytes, `3x` 3 pad bytes, `3H` 3 values
+        bool single = code->type == JsStructTypeBytes || code->type == JsStructTypePad;
+        size_t n_new = single ? 1 : count;
+        size_t field_size = single ? count : code->size;
+        if(n_fields + n_new > STRUCT_FIELDS_MAX) {
+            *error = "too many fields";
+            return NULL;
+        }
+        if(size + count * code->size > STRUCT_SIZE_MAX) {
+            *error = "record too long";
+            return NULL;
+        }
+        for(size_t i = 0; i < n_new; i++) {
+            fields[n_fields++] = (JsStructField){
+                .type = code->type,
+                .offset = size,
+                .size = field_size,
+            };
+            size += field_size;
+        }
+        if(code->type != JsStructTypePad) n_values += n_new;
+    }
+
+    JsStructLayout* layout = malloc(sizeof(JsStructLayout) + n_fields * sizeof(JsStructField));
+    layout->format = strdup(format);
+    layout->big_endian = big_endian;
+    layout->size = size;
+    layout->n_values = n_values;
+    layout->n_fields = n_fields;
+    memcpy(layout->fields, fields, n_fields * sizeof(JsStructField));
+    return layout;
+}
+
+static uint64_t js_struct_load(const uint8_t* at, size_t size, bool big_endian) {
+    uint64_t value = 0;
+    for(size_t i = 0; i < size; i++)
+        value = (value << 8) | at[big_endian ? i : size - 1 - i];
+    return value;
+}
+
+static void js_struct_store(uint8_t* at, size_t size, bool big_endian, uint64_t value) {
+    for(size_t i = 0; i < size; i++)
+        at[big_endian ? size - 1 - i : i] = value >> (i * 8);
+}
+
+static mjs_val_t js_struct_load_field(
+    struct mjs* mjs,
+    const JsStructLayout* layout,
+    const JsStructField* field,
+    const uint8_t* record) {
+    const uint8_t* at = &record[field->offset];
+    if(field->type == JsStructTypeBytes) {
+        return mjs_mk_string(mjs, (const char*)at, strnlen((const char*)at, field->size), true);
+    }
+
+    uint64_t bits = js_struct_load(at, field->size, layout->big_endian);
+    switch(field->type) {
+    case JsStructTypeInt:
+        if(field->size < 8 && (bits >> (field->size * 8 - 1))) {
+            bits |= UINT64_MAX << (field->size * 8); // sign extend
+        }
+        return mjs_mk_number(mjs, (double)(int64_t)bits);
+    case JsStructTypeBool:
+        return mjs_mk_boolean(mjs, bits != 0);
+    case JsStructTypeFloat:
+        if(field->size == 4) {
+            uint32_t bits32 = bits;
+            float single;
+            memcpy(&single, &bits32, sizeof(single));
+            return mjs_mk_number(mjs, single);
+        } else {
+            double dbl;
+            memcpy(&dbl, &bits, sizeof(dbl));
+            return mjs_mk_number(mjs, dbl);
+        }
+    default:
+        return mjs_mk_number(mjs, (double)bits);
+    }
+}
+
+/**
+ * @returns false if the value doesn't fit the field
+ */
+static bool js_struct_store_field(
+    struct mjs* mjs,
+    const JsStructLayout* layout,
+    const JsStructField* field,
+    uint8_t* record,
+    mjs_val_t value) {
+    uint8_t* at = &record[field->offset];
+    if(field->type == JsStructTypeBytes) {
+        size_t len;
+        const char* data;
+        if(mjs_is_string(value)) {
+            data = mjs_get_string(mjs, &value, &len);
+        } else if(mjs_is_array_buf(value)) {
+            data = mjs_array_buf_get_ptr(mjs, value, &len);
+        } else {
+            return false;
+        }
+        len = MIN(len, field->size);
+        memcpy(at, data, len);
+        memset(&at[len], 0, field->size - len);
+        return true;
+    }
+
+    uint64_t bits;
+    if(field->type == JsStructTypeBool) {
+        if(!mjs_is_boolean(value)) return false;
+        bits = mjs_get_bool(mjs, value);
+    } else if(!mjs_is_number(value)) {
+        return false;
+    } else if(field->type == JsStructTypeFloat) {
+        double number = mjs_get_double(mjs, value);
+        if(field->size == 4) {
+            float single = number;
+            uint32_t bits32;
+            memcpy(&bits32, &single, sizeof(bits32));
+            bits = bits32;
+        } else {
+            memcpy(&bits, &number, sizeof(bits));
+        }
+    } else {
+        double number = mjs_get_double(mjs, value);
+        // the limits of the field, in doubles so that 64 bits fit
+        double max = field->type == JsStructTypeUint ? ldexp(1, field->size * 8) :
+                                                       ldexp(1, field->size * 8 - 1);
+        double min = field->type == JsStructTypeUint ? 0 : -max;
+        if(!(number >= min && number < max)) return false;
+        bits = number < 0 ? (uint64_t)(int64_t)number : (uint64_t)number;
+    }
+    js_struct_store(at, field->size, layout->big_endian, bits);
+    return true;
+}
+
+/**
+ * @brief Unpacks a record into an array, or into an object if the layout
+ * has names
+ */
+static mjs_val_t
+    js_struct_unpack_record(struct mjs* mjs, const JsStructView* view, const uint8_t* record) {
+    const JsStructLayout* layout = view->layout;
+    mjs_val_t result = view->names ? mjs_mk_object(mjs) : mjs_mk_array(mjs);
+    size_t index = 0;
+    for(size_t i = 0; i < layout->n_fields; i++) {
+        const JsStructField* field = &layout->fields[i];
+        if(field->type == JsStructTypePad) continue;
+        mjs_val_t value = js_struct_load_field(mjs, layout, field, record);
+        if(view->names) {
+            mjs_set(mjs, result, view->names[index], ~0, value);
+        } else {
+            mjs_array_push(mjs, result, value);
+        }
+        index++;
+    }
+    return result;
+}
+
+/**
+ * @brief Finds the bytes of an ArrayBuffer, typed array or DataView
+ */
+static uint8_t* js_struct_get_bytes(struct mjs* mjs, mjs_val_t buf, size_t* len) {
+    if(mjs_is_data_view(buf)) buf = mjs_dataview_get_buf(mjs, buf);
+    if(!mjs_is_array_buf(buf) && !mjs_is_typed_array(buf)) return NULL;
+    *len = 0;
+    return (uint8_t*)mjs_array_buf_get_ptr(mjs, buf, len);
+}
+
+/**
+ * @brief Unpacks `count` records, or one if `count` is negative
+ */
+static void
+    js_struct_unpack_common(struct mjs* mjs, mjs_val_t buf, int32_t offset, int32_t count) {
+    JsStructView* view = JS_GET_CONTEXT(mjs);
+    const JsStructLayout* layout = view->layout;
+    size_t n_records = count < 0 ? 1 : (size_t)count;
+
+    size_t len;
+    const uint8_t* data = js_struct_get_bytes(mjs, buf, &len);
+    if(!data) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer or DataView");
+    if(offset < 0 || (size_t)offset > len || (len - offset) / MAX(layout->size, 1U) < n_records)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "records out of bounds");
+
+    // the buffer can move as values are made, so the records are copied once
+    size_t total = n_records * layout->size;
+    uint8_t* records = malloc(MAX(total, 1U));
+    memcpy(records, &data[offset], total);
+
+    mjs_val_t result;
+    if(count < 0) {
+        result = js_struct_unpack_record(mjs, view, records);
+    } else {
+        result = mjs_mk_array(mjs);
+        for(size_t i = 0; i < n_records; i++) {
+            const uint8_t* record = &records[i * layout->size];
+            mjs_array_push(mjs, result, js_struct_unpack_record(mjs, view, record));
+        }
+    }
+    free(records);
+    mjs_return(mjs, result);
+}
+
+static void js_struct_unpack(struct mjs* mjs) {
+    static const JsValueDeclaration js_struct_unpack_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 0),
+    };
+    static const JsValueArguments js_struct_unpack_args = JS_VALUE_ARGS(js_struct_unpack_arg_list);
+
+    mjs_val_t buf;
+    int32_t offset;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_struct_unpack_args, &buf, &offset);
+    js_struct_unpack_common(mjs, buf, offset, -1);
+}
+
+static void js_struct_unpack_array(struct mjs* mjs) {
+    static const JsValueDeclaration js_struct_unpack_array_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAny),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+    };
+    static const JsValueArguments js_struct_unpack_array_args =
+        JS_VALUE_ARGS(js_struct_unpack_array_arg_list);
+
+    mjs_val_t buf;
+    int32_t offset, count;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_struct_unpack_array_args, &buf, &offset, &count);
+    if(count < 0) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "negative count");
+    js_struct_unpack_common(mjs, buf, offset, count);
+}
+
+static void js_struct_pack(struct mjs* mjs) {
+    static const JsValueDeclaration js_struct_pack_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeAnyObject),
+        JS_VALUE_SIMPLE(JsValueTypeAny), // optional buffer to pack into
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 0),
+    };
+    static const JsValueArguments js_struct_pack_args = JS_VALUE_ARGS(js_struct_pack_arg_list);
+
+    mjs_val_t values, buf;
+    int32_t offset;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_struct_pack_args, &values, &buf, &offset);
+    JsStructView* view = JS_GET_CONTEXT(mjs);
+    const JsStructLayout* layout = view->layout;
+
+    // a new record is packed in C memory, and into a buffer in place, since
+    // reading the values makes nothing new and the buffer stays put
+    uint8_t* record;
+    if(mjs_is_undefined(buf)) {
+        record = malloc(MAX(layout->size, 1U));
+    } else {
+        size_t len;
+        uint8_t* data = js_struct_get_bytes(mjs, buf, &len);
+        if(!data)
+            JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected an ArrayBuffer or DataView");
+        if(offset < 0 || (size_t)offset > len || len - offset < layout->size)
+            JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "record out of bounds");
+        record = &data[offset];
+    }
+    size_t index = 0;
+    for(size_t i = 0; i < layout->n_fields; i++) {
+        const JsStructField* field = &layout->fields[i];
+        if(field->type == JsStructTypePad) {
+            memset(&record[field->offset], 0, field->size);
+            continue;
+        }
+        mjs_val_t value;
+        if(view->names) {
+            value = mjs_get(mjs, values, view->names[index], ~0);
+        } else {
+            value = mjs_array_get(mjs, values, index);
+        }
+        if(!js_struct_store_field(mjs, layout, field, record, value)) {
+            if(mjs_is_undefined(buf)) free(record);
+            JS_ERROR_AND_RETURN(
+                mjs, MJS_BAD_ARGS_ERROR, "value %zu doesn't fit the format", index);
+        }
+        index++;
+    }
+
+    if(mjs_is_undefined(buf)) {
+        buf = mjs_mk_array_buf(mjs, (char*)record, layout->size);
+        free(record);
+    }
+    mjs_return(mjs, buf);
+}
+
+static bool js_struct_names_equal(
+    struct mjs* mjs,
+    const JsStructView* view,
+    const JsStructLayout* layout,
+    mjs_val_t names) {
+    if(view->layout != layout) return false;
+    if(!view->names || !mjs_is_array(names)) return !view->names && !mjs_is_array(names);
+    for(size_t i = 0; i < layout->n_values; i++) {
+        mjs_val_t name = mjs_array_get(mjs, names, i);
+        size_t name_len;
+        const char* name_str = mjs_get_string(mjs, &name, &name_len);
+        if(strlen(view->names[i]) != name_len || memcmp(view->names[i], name_str, name_len))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Finds or makes the view of a layout with names that have been
+ * checked already
+ */
+static JsStructView* js_struct_get_view(
+    struct mjs* mjs,
+    JsStruct* js_struct,
+    const JsStructLayout* layout,
+    mjs_val_t names) {
+    JsStructViewArray_it_t it;
+    for(JsStructViewArray_it(it, js_struct->views); !JsStructViewArray_end_p(it);
+        JsStructViewArray_next(it)) {
+        JsStructView* view = *JsStructViewArray_cref(it);
+        if(js_struct_names_equal(mjs, view, layout, names)) return view;
+    }
+
+    JsStructView* view = malloc(sizeof(JsStructView));
+    view->layout = layout;
+    view->names = NULL;
+    if(mjs_is_array(names)) {
+        view->names = malloc(layout->n_values * sizeof(char*));
+        for(size_t i = 0; i < layout->n_values; i++) {
+            mjs_val_t name = mjs_array_get(mjs, names, i);
+            size_t name_len;
+            const char* name_str = mjs_get_string(mjs, &name, &name_len);
+            view->names[i] = strndup(name_str, name_len);
+        }
+    }
+    JsStructViewArray_push_back(js_struct->views, view);
+    return view;
+}
+
+static void js_struct_compile(struct mjs* mjs) {
+    static const JsValueDeclaration js_struct_compile_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeString),
+        JS_VALUE_SIMPLE(JsValueTypeAny), // optional names
+    };
+    static const JsValueArguments js_struct_compile_args =
+        JS_VALUE_ARGS(js_struct_compile_arg_list);
+
+    const char* format;
+    mjs_val_t names;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_struct_compile_args, &format, &names);
+    JsStruct* js_struct = JS_GET_CONTEXT(mjs);
+
+    // layouts live until the script ends, so each format is compiled once
+    JsStructLayout* layout = NULL;
+    JsStructLayoutArray_it_t it;
+    for(JsStructLayoutArray_it(it, js_struct->layouts); !JsStructLayoutArray_end_p(it);
+        JsStructLayoutArray_next(it)) {
+        JsStructLayout* compiled = *JsStructLayoutArray_cref(it);
+        if(strcmp(compiled->format, format) == 0) layout = compiled;
+    }
+    if(!layout) {
+        const char* error;
+        layout = js_struct_compile_format(format, &error);
+        if(!layout) JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "%s in \"%s\"", error, format);
+        JsStructLayoutArray_push_back(js_struct->layouts, layout);
+    }
+
+    if(mjs_is_array(names)) {
+        bool names_ok = mjs_array_length(mjs, names) == layout->n_values;
+        for(size_t i = 0; names_ok && i < layout->n_values; i++) {
+            names_ok = mjs_is_string(mjs_array_get(mjs, names, i));
+        }
+        if(!names_ok)
+            JS_ERROR_AND_RETURN(
+                mjs, MJS_BAD_ARGS_ERROR, "expected %zu names as strings", layout->n_values);
+    } else if(!mjs_is_undefined(names)) {
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "names must be an array");
+    }
+
+    JsStructView* view = js_struct_get_view(mjs, js_struct, layout, names);
+    mjs_val_t layout_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, layout_obj) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, view));
+        JS_FIELD("size", mjs_mk_number(mjs, layout->size));
+        JS_FIELD("names", names);
+        JS_FIELD("unpack", MJS_MK_FN(js_struct_unpack));
+        JS_FIELD("unpackArray", MJS_MK_FN(js_struct_unpack_array));
+        JS_FIELD("pack", MJS_MK_FN(js_struct_pack));
+    }
+    mjs_return(mjs, layout_obj);
+}
+
+void* js_struct_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+    UNUSED(modules);
+    JsStruct* js_struct = malloc(sizeof(JsStruct));
+    JsStructLayoutArray_init(js_struct->layouts);
+    JsStructViewArray_init(js_struct->views);
+
+    mjs_val_t struct_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, struct_obj) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, js_struct));
+        JS_FIELD("compile", MJS_MK_FN(js_struct_compile));
+    }
+    *object = struct_obj;
+
+    return js_struct;
+}
+
+void js_struct_destroy(void* inst) {
+    JsStruct* js_struct = inst;
+    JsStructViewArray_it_t view_it;
+    for(JsStructViewArray_it(view_it, js_struct->views); !JsStructViewArray_end_p(view_it);
+        JsStructViewArray_next(view_it)) {
+        JsStructView* view = *JsStructViewArray_cref(view_it);
+        if(view->names) {
+            for(size_t i = 0; i < view->layout->n_values; i++)
+                free(view->names[i]);
+            free(view->names);
+        }
+        free(view);
+    }
+    JsStructViewArray_clear(js_struct->views);
+
+    JsStructLayoutArray_it_t it;
+    for(JsStructLayoutArray_it(it, js_struct->layouts); !JsStructLayoutArray_end_p(it);
+        JsStructLayoutArray_next(it)) {
+        JsStructLayout* layout = *JsStructLayoutArray_cref(it);
+        free(layout->format);
+        free(layout);
+    }
+    JsStructLayoutArray_clear(js_struct->layouts);
+    free(js_struct);
+}
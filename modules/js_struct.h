@@ -0,0 +1,23 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_struct.h
+ *
+ * Built-in `struct` module for packing binary records.
+ * `struct.compile(format, names?)` compiles a format like `"<HHIf8s"` into a
+ * layout with:
+ *   - `size`: bytes per record;
+ *   - `unpack(buf, offset = 0)`: one record;
+ *   - `unpackArray(buf, offset, count)`: an array of records;
+ *   - `pack(values, buf?, offset = 0)`: a new ArrayBuffer, or the values
+ *     written into `buf` in place.
+ *
+ * Records are arrays, or objects keyed by `names` when those are given. The
+ * names are copied when the layout is compiled.
+ */
+
+void* js_struct_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
+
+void js_struct_destroy(void* inst);
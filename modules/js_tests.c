@@ -2,9 +2,15 @@
 #include <core/common_defines.h>
 #include <furi_hal_version.h>
 #include <power/power_service/power.h>
+#include <furi_hal.h>
 
 #define TAG "JsTests"
 
+typedef struct {
+    uint32_t passed;
+    uint64_t cycles; //<! Spent in `tests.run()`
+} JsTests;
+
 static void js_tests_fail(struct mjs* mjs) {
     furi_check(mjs_nargs(mjs) == 1);
     mjs_val_t message_arg = mjs_arg(mjs, 0);
@@ -24,7 +30,7 @@ static void js_tests_assert_eq(struct mjs* mjs) {
         int32_t expected = mjs_get_int32(mjs, expected_arg);
         int32_t result = mjs_get_int32(mjs, result_arg);
         if(expected == result) {
-            FURI_LOG_T(TAG, "eq passed (exp=%ld res=%ld)", expected, result);
+            FURI_LOG_T(TAG, "eq passed (exp=%ld res=%ld)", (long)expected, (long)result);
         } else {
             mjs_prepend_errorf(mjs, MJS_INTERNAL_ERROR, "expected %d, found %d", expected, result);
         }
@@ -92,13 +98,78 @@ static void js_tests_assert_float_close(struct mjs* mjs) {
     mjs_return(mjs, MJS_UNDEFINED);
 }
 
+/**
+ * @brief Runs a test function and times it. A failing test stops the script
+ * like a failed assertion does, with the test name prepended to the error.
+ * @returns time the test took in microseconds
+ */
+static void js_tests_run(struct mjs* mjs) {
+    static const JsValueDeclaration js_tests_run_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeString),
+        JS_VALUE_SIMPLE(JsValueTypeFunction),
+    };
+    static const JsValueArguments js_tests_run_args = JS_VALUE_ARGS(js_tests_run_arg_list);
+
+    const char* name;
+    mjs_val_t test;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_tests_run_args, &name, &test);
+    JsTests* tests = JS_GET_CONTEXT(mjs);
+
+    // the name may move while the test allocates
+    FuriString* test_name = furi_string_alloc_set(name);
+    mjs_val_t result;
+    uint32_t start = DWT->CYCCNT;
+    mjs_err_t error = mjs_apply(mjs, &result, test, MJS_UNDEFINED, 0, NULL);
+    uint32_t cycles = DWT->CYCCNT - start;
+    uint32_t us = cycles / furi_hal_cortex_instructions_per_microsecond();
+
+    if(error != MJS_OK) {
+        FURI_LOG_E(TAG, "FAIL %s (%luus)", furi_string_get_cstr(test_name), (unsigned long)us);
+        mjs_prepend_errorf(mjs, error, "test \"%s\" failed: ", furi_string_get_cstr(test_name));
+    } else {
+        FURI_LOG_I(TAG, "PASS %s (%luus)", furi_string_get_cstr(test_name), (unsigned long)us);
+        tests->passed++;
+        tests->cycles += cycles;
+    }
+    furi_string_free(test_name);
+    mjs_return(mjs, mjs_mk_number(mjs, us));
+}
+
+/**
+ * @brief Summarizes the tests that have passed so far
+ */
+static void js_tests_summary(struct mjs* mjs) {
+    JsTests* tests = JS_GET_CONTEXT(mjs);
+    char summary[64];
+    snprintf(
+        summary,
+        sizeof(summary),
+        "%lu passed in %luus",
+        (unsigned long)tests->passed,
+        (unsigned long)(tests->cycles / furi_hal_cortex_instructions_per_microsecond()));
+    mjs_return(mjs, mjs_mk_string(mjs, summary, ~0, true));
+}
+
 void* js_tests_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
     UNUSED(modules);
+    JsTests* tests = malloc(sizeof(JsTests));
+    tests->passed = 0;
+    tests->cycles = 0;
+
     mjs_val_t tests_obj = mjs_mk_object(mjs);
-    mjs_set(mjs, tests_obj, "fail", ~0, MJS_MK_FN(js_tests_fail));
-    mjs_set(mjs, tests_obj, "assert_eq", ~0, MJS_MK_FN(js_tests_assert_eq));
-    mjs_set(mjs, tests_obj, "assert_float_close", ~0, MJS_MK_FN(js_tests_assert_float_close));
+    JS_ASSIGN_MULTI(mjs, tests_obj) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, tests));
+        JS_FIELD("fail", MJS_MK_FN(js_tests_fail));
+        JS_FIELD("assert_eq", MJS_MK_FN(js_tests_assert_eq));
+        JS_FIELD("assert_float_close", MJS_MK_FN(js_tests_assert_float_close));
+        JS_FIELD("run", MJS_MK_FN(js_tests_run));
+        JS_FIELD("summary", MJS_MK_FN(js_tests_summary));
+    }
     *object = tests_obj;
 
-    return (void*)1;
+    return tests;
+}
+
+void js_tests_destroy(void* inst) {
+    free(inst);
 }
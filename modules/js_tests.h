@@ -3,3 +3,5 @@
 #include "../js_modules.h"
 
 void* js_tests_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
+
+void js_tests_destroy(void* inst);
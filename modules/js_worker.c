@@ -0,0 +1,414 @@
+#include <core/common_defines.h>
+#include <furi_hal.h>
+#include "js_worker.h"
+#include "js_event_loop/js_event_loop.h"
+#include <m-array.h>
+
+#define TAG "JsWorker"
+
+/**
+ * @brief Messages that may be in flight in each direction
+ */
+#define QUEUE_LEN 16
+
+/**
+ * @brief How often `receive()` checks whether the script has been stopped
+ */
+#define RECEIVE_POLL_TICKS 10
+
+/**
+ * @brief Longest sleep that `benchmark()` measures, in milliseconds. The
+ * cycle counter wraps in about 67 s at 64 MHz, so one sleep and how late it
+ * is have to fit well within that.
+ */
+#define BENCHMARK_INTERVAL_MAX 10000
+
+/**
+ * @brief Serialized message. The data is a private copy, so no mJS heap is
+ * ever shared between the interpreters.
+ */
+typedef struct {
+    uint8_t* data;
+    uint32_t size;
+    bool is_string; //<! Received as a string rather than an `ArrayBuffer`
+} JsWorkerMessage;
+
+/**
+ * @brief Queues between a parent and one of its workers
+ */
+typedef struct {
+    FuriMessageQueue* to_worker;
+    FuriMessageQueue* to_parent;
+} JsWorkerChannel;
+
+/**
+ * @brief One end of a channel, as seen by one of the scripts
+ */
+typedef struct {
+    JsEventLoopContract contract; //<! Delivers received messages
+    FuriMessageQueue* rx;
+    FuriMessageQueue* tx;
+    FuriEventLoop* loop;
+    struct mjs* mjs;
+} JsWorkerPort;
+
+/**
+ * @brief Worker spawned by this script
+ */
+typedef struct {
+    JsWorkerPort port; //<! First, so that the JS object of a worker is also a port
+    JsThread* thread; //<! NULL once terminated
+    JsWorkerChannel channel;
+} JsWorkerHandle;
+
+ARRAY_DEF(JsWorkerArray, JsWorkerHandle*, M_PTR_OPLIST); //-V575
+
+typedef struct {
+    FuriEventLoop* loop;
+    JsWorkerArray_t workers;
+    JsWorkerPort parent; //<! Only used if this script is a worker
+    bool is_worker;
+} JsWorkerInst;
+
+/**
+ * @brief Turns a message into a JS value and frees it
+ */
+static mjs_val_t js_worker_message_unpack(struct mjs* mjs, JsWorkerMessage* message) {
+    mjs_val_t value = message->is_string ?
+                          mjs_mk_string(mjs, (const char*)message->data, message->size, true) :
+                          mjs_mk_array_buf(mjs, (char*)message->data, message->size);
+    free(message->data);
+    return value;
+}
+
+static mjs_val_t js_worker_transformer(struct mjs* mjs, FuriMessageQueue* queue, void* context) {
+    UNUSED(context);
+    JsWorkerMessage message;
+    furi_check(furi_message_queue_get(queue, &message, 0) == FuriStatusOk);
+    return js_worker_message_unpack(mjs, &message);
+}
+
+static void js_worker_queue_flush(FuriMessageQueue* queue) {
+    JsWorkerMessage message;
+    while(furi_message_queue_get(queue, &message, 0) == FuriStatusOk)
+        free(message.data);
+}
+
+static void js_worker_port_init(
+    JsWorkerPort* port,
+    struct mjs* mjs,
+    FuriEventLoop* loop,
+    FuriMessageQueue* rx,
+    FuriMessageQueue* tx) {
+    port->rx = rx;
+    port->tx = tx;
+    port->loop = loop;
+    port->mjs = mjs;
+    port->contract = (JsEventLoopContract){
+        .magic = JsForeignMagic_JsEventLoopContract,
+        .object_type = JsEventLoopObjectTypeQueue,
+        .object = rx,
+        .non_timer =
+            {
+                .event = FuriEventLoopEventIn,
+                .transformer = (JsEventLoopTransformer)js_worker_transformer,
+                .priority = JsEventLoopPriorityNormal,
+            },
+    };
+}
+
+/**
+ * @brief Serializes a string, `ArrayBuffer`, typed array or `DataView` and
+ * sends it to the other end: `send(data)`
+ * @returns false if the other end is not keeping up and the message was
+ * dropped
+ */
+static void js_worker_port_send(struct mjs* mjs) {
+    JsWorkerPort* port = JS_GET_CONTEXT(mjs);
+    if(!port->tx) JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "worker is terminated");
+
+    mjs_val_t arg = mjs_arg(mjs, 0);
+    const char* data;
+    size_t size;
+    bool is_string = mjs_is_string(arg);
+    if(is_string) {
+        data = mjs_get_string(mjs, &arg, &size);
+    } else if(mjs_is_typed_array(arg)) {
+        mjs_val_t array_buf = mjs_is_data_view(arg) ? mjs_dataview_get_buf(mjs, arg) : arg;
+        data = mjs_array_buf_get_ptr(mjs, array_buf, &size);
+    } else {
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "expected a string or a buffer");
+    }
+
+    JsWorkerMessage message = {
+        .data = malloc(MAX(size, 1U)),
+        .size = size,
+        .is_string = is_string,
+    };
+    memcpy(message.data, data, size);
+    bool sent = furi_message_queue_put(port->tx, &message, 0) == FuriStatusOk;
+    if(!sent) free(message.data);
+    mjs_return(mjs, mjs_mk_boolean(mjs, sent));
+}
+
+/**
+ * @brief Waits for a message without the event loop: `receive(timeout)`.
+ * Waits forever if the timeout is omitted.
+ * @returns The message, or `undefined` on timeout
+ */
+static void js_worker_port_receive(struct mjs* mjs) {
+    static const JsValueDeclaration js_worker_receive_arg_list[] = {
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, -1),
+    };
+    static const JsValueArguments js_worker_receive_args =
+        JS_VALUE_ARGS(js_worker_receive_arg_list);
+
+    int32_t timeout;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_worker_receive_args, &timeout);
+
+    JsWorkerPort* port = JS_GET_CONTEXT(mjs);
+    if(!port->rx) JS_ERROR_AND_RETURN(mjs, MJS_INTERNAL_ERROR, "worker is terminated");
+
+    uint32_t start = furi_get_tick();
+    uint32_t timeout_ticks = timeout < 0 ? FuriWaitForever : furi_ms_to_ticks(timeout);
+    JsWorkerMessage message;
+    while(true) {
+        // wake up regularly to check whether the script has been stopped
+        uint32_t elapsed = furi_get_tick() - start;
+        uint32_t wait = RECEIVE_POLL_TICKS;
+        if(timeout_ticks != FuriWaitForever) wait = MIN(wait, timeout_ticks - elapsed);
+        if(furi_message_queue_get(port->rx, &message, wait) == FuriStatusOk) {
+            mjs_return(mjs, js_worker_message_unpack(mjs, &message));
+            return;
+        }
+        if(js_delay_with_flags(mjs, 0)) break;
+        if(timeout_ticks != FuriWaitForever && furi_get_tick() - start >= timeout_ticks) break;
+    }
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static mjs_val_t js_worker_port_make(struct mjs* mjs, JsWorkerPort* port) {
+    mjs_val_t port_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, port_obj) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, port));
+        JS_FIELD("message", mjs_mk_foreign(mjs, &port->contract));
+        JS_FIELD("send", MJS_MK_FN(js_worker_port_send));
+        JS_FIELD("receive", MJS_MK_FN(js_worker_port_receive));
+    }
+    return port_obj;
+}
+
+/**
+ * @brief Stops a worker and drops the messages in flight. The queues are
+ * kept until the module is destroyed, as subscriptions may still refer to
+ * them.
+ */
+static void js_worker_handle_terminate(JsWorkerHandle* worker) {
+    if(!worker->thread) return;
+    js_thread_stop(worker->thread);
+    worker->thread = NULL;
+
+    js_worker_queue_flush(worker->channel.to_worker);
+    js_worker_queue_flush(worker->channel.to_parent);
+    worker->port.rx = worker->port.tx = NULL;
+}
+
+static void js_worker_handle_free(JsWorkerHandle* worker) {
+    js_worker_handle_terminate(worker);
+    furi_event_loop_maybe_unsubscribe(worker->port.loop, worker->channel.to_parent);
+    furi_message_queue_free(worker->channel.to_worker);
+    furi_message_queue_free(worker->channel.to_parent);
+    free(worker);
+}
+
+/**
+ * @brief Stops a worker: `terminate()`
+ */
+static void js_worker_terminate(struct mjs* mjs) {
+    JsWorkerHandle* worker = JS_GET_CONTEXT(mjs);
+    js_worker_handle_terminate(worker);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static JsWorkerHandle*
+    js_worker_handle_spawn(JsWorkerInst* inst, struct mjs* mjs, const char* path) {
+    JsWorkerHandle* worker = malloc(sizeof(JsWorkerHandle));
+    worker->channel.to_worker = furi_message_queue_alloc(QUEUE_LEN, sizeof(JsWorkerMessage));
+    worker->channel.to_parent = furi_message_queue_alloc(QUEUE_LEN, sizeof(JsWorkerMessage));
+    js_worker_port_init(
+        &worker->port, mjs, inst->loop, worker->channel.to_parent, worker->channel.to_worker);
+    worker->thread = js_thread_spawn(mjs, path, &worker->channel);
+    JsWorkerArray_push_back(inst->workers, worker);
+    return worker;
+}
+
+/**
+ * @brief Runs a script on its own thread and interpreter: `spawn(path)`
+ *
+ * The worker gets its own modules and communicates with this script through
+ * `send()` and the `message` contract of the returned object, and through
+ * `require("worker").parent` on its side.
+ */
+static void js_worker_spawn(struct mjs* mjs) {
+    static const JsValueDeclaration js_worker_spawn_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeString),
+    };
+    static const JsValueArguments js_worker_spawn_args = JS_VALUE_ARGS(js_worker_spawn_arg_list);
+
+    const char* path;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_worker_spawn_args, &path);
+
+    JsWorkerInst* inst = JS_GET_CONTEXT(mjs);
+    JsWorkerHandle* worker = js_worker_handle_spawn(inst, mjs, path);
+
+    mjs_val_t worker_obj = js_worker_port_make(mjs, &worker->port);
+    mjs_set(mjs, worker_obj, "terminate", ~0, MJS_MK_FN(js_worker_terminate));
+    mjs_return(mjs, worker_obj);
+}
+
+typedef struct {
+    uint32_t avg_us;
+    uint32_t max_us;
+} JsWorkerLatency;
+
+/**
+ * @brief Measures how late this thread wakes up from sleeping
+ */
+static bool js_worker_measure_latency(
+    struct mjs* mjs,
+    uint32_t samples,
+    uint32_t interval,
+    JsWorkerLatency* latency) {
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    uint64_t expected = (uint64_t)interval * 1000 * cycles_per_us;
+    uint64_t total = 0;
+    uint32_t max = 0;
+
+    for(uint32_t i = 0; i < samples; i++) {
+        uint32_t start = DWT->CYCCNT;
+        if(js_delay_with_flags(mjs, interval)) return false;
+        uint32_t elapsed = DWT->CYCCNT - start;
+        uint32_t late = elapsed > expected ? elapsed - (uint32_t)expected : 0;
+        total += late;
+        max = MAX(max, late);
+    }
+
+    latency->avg_us = total / samples / cycles_per_us;
+    latency->max_us = max / cycles_per_us;
+    return true;
+}
+
+static mjs_val_t js_worker_make_latency(struct mjs* mjs, const JsWorkerLatency* latency) {
+    mjs_val_t result = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, result) {
+        JS_FIELD("avgUs", mjs_mk_number(mjs, latency->avg_us));
+        JS_FIELD("maxUs", mjs_mk_number(mjs, latency->max_us));
+    }
+    return result;
+}
+
+/**
+ * @brief Measures how responsive this script stays while a worker is busy:
+ * `benchmark(path, samples, intervalMs)`
+ *
+ * Measures how late this thread wakes up from `intervalMs` long sleeps, first
+ * on its own and then while the worker at `path` runs. Pass a script that
+ * keeps the CPU busy.
+ *
+ * @returns `{ idle: { avgUs, maxUs }, busy: { avgUs, maxUs } }`
+ */
+static void js_worker_benchmark(struct mjs* mjs) {
+    static const JsValueDeclaration js_worker_benchmark_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeString),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 50),
+        JS_VALUE_SIMPLE_W_DEFAULT(JsValueTypeInt32, int32_val, 10),
+    };
+    static const JsValueArguments js_worker_benchmark_args =
+        JS_VALUE_ARGS(js_worker_benchmark_arg_list);
+
+    const char* path;
+    int32_t samples, interval;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_worker_benchmark_args, &path, &samples, &interval);
+    if(samples <= 0 || interval <= 0)
+        JS_ERROR_AND_RETURN(mjs, MJS_BAD_ARGS_ERROR, "samples and interval must be positive");
+    if(interval > BENCHMARK_INTERVAL_MAX)
+        JS_ERROR_AND_RETURN(
+            mjs, MJS_BAD_ARGS_ERROR, "interval must be at most %d ms", BENCHMARK_INTERVAL_MAX);
+
+    JsWorkerInst* inst = JS_GET_CONTEXT(mjs);
+    JsWorkerLatency idle, busy;
+    if(!js_worker_measure_latency(mjs, samples, interval, &idle)) {
+        mjs_return(mjs, MJS_UNDEFINED);
+        return;
+    }
+
+    JsWorkerHandle* worker = js_worker_handle_spawn(inst, mjs, path);
+    bool done = js_worker_measure_latency(mjs, samples, interval, &busy);
+    js_worker_handle_terminate(worker);
+    if(!done) {
+        mjs_return(mjs, MJS_UNDEFINED);
+        return;
+    }
+
+    FURI_LOG_I(
+        TAG,
+        "Latency idle: avg %luus max %luus, busy: avg %luus max %luus",
+        idle.avg_us,
+        idle.max_us,
+        busy.avg_us,
+        busy.max_us);
+
+    mjs_val_t result = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, result) {
+        JS_FIELD("idle", js_worker_make_latency(mjs, &idle));
+        JS_FIELD("busy", js_worker_make_latency(mjs, &busy));
+    }
+    mjs_return(mjs, result);
+}
+
+void* js_worker_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
+    // get event loop
+    JsEventLoop* js_loop = js_module_get(modules, "event_loop");
+    if(M_UNLIKELY(!js_loop)) return NULL;
+
+    JsWorkerInst* inst = malloc(sizeof(JsWorkerInst));
+    inst->loop = js_event_loop_get_loop(js_loop);
+    JsWorkerArray_init(inst->workers);
+
+    mjs_val_t worker_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, worker_obj) {
+        JS_FIELD(INST_PROP_NAME, mjs_mk_foreign(mjs, inst));
+        JS_FIELD("spawn", MJS_MK_FN(js_worker_spawn));
+        JS_FIELD("benchmark", MJS_MK_FN(js_worker_benchmark));
+    }
+
+    JsWorkerChannel* channel = js_thread_get_channel(mjs);
+    inst->is_worker = channel != NULL;
+    if(inst->is_worker) {
+        js_worker_port_init(
+            &inst->parent, mjs, inst->loop, channel->to_worker, channel->to_parent);
+        mjs_set(mjs, worker_obj, "parent", ~0, js_worker_port_make(mjs, &inst->parent));
+    } else {
+        mjs_set(mjs, worker_obj, "parent", ~0, MJS_UNDEFINED);
+    }
+
+    *object = worker_obj;
+    return inst;
+}
+
+void js_worker_destroy(void* inst) {
+    JsWorkerInst* js_worker = inst;
+
+    JsWorkerArray_it_t iterator;
+    for(JsWorkerArray_it(iterator, js_worker->workers); !JsWorkerArray_end_p(iterator);
+        JsWorkerArray_next(iterator)) {
+        js_worker_handle_free(*JsWorkerArray_cref(iterator));
+    }
+    JsWorkerArray_clear(js_worker->workers);
+
+    // the queues belong to the parent, which frees them once we're gone
+    if(js_worker->is_worker)
+        furi_event_loop_maybe_unsubscribe(js_worker->loop, js_worker->parent.rx);
+
+    free(js_worker);
+}
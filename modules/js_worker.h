@@ -0,0 +1,20 @@
+#pragma once
+#include "../js_thread_i.h"
+#include "../js_modules.h"
+
+/**
+ * @file js_worker.h
+ *
+ * Built-in `worker` module, which runs scripts on their own thread and
+ * interpreter and passes copied messages between them:
+ *   - `worker.spawn(path)`: starts a worker and returns its port;
+ *   - `worker.parent`: the port to the parent, in worker scripts only;
+ *   - `worker.benchmark(path)`: measures event loop latency with and without
+ *     a busy worker.
+ *
+ * Requires `event_loop` to be loaded first.
+ */
+
+void* js_worker_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules);
+
+void js_worker_destroy(void* inst);
@@ -0,0 +1,205 @@
+#include "playlist.h"
+#include <furi.h>
+#include <m-array.h>
+
+#define PLAYLIST_ARENA_SIZE_MIN 256
+
+typedef struct {
+    uint32_t path; //<! Arena offset
+    uint32_t group; //<! Arena offset
+    uint32_t group_hash; //<! Lets `playlist_intern_group` skip most `strcmp`s
+    uint16_t name; //<! Offset of the file name in the path
+    PlaylistMeta meta;
+} PlaylistEntry;
+
+ARRAY_DEF(PlaylistEntryArray, PlaylistEntry, M_POD_OPLIST);
+
+struct Playlist {
+    PlaylistEntryArray_t entries;
+    char* arena;
+    size_t arena_size;
+    size_t arena_used;
+    size_t garbage; //<! Bytes of the arena that no entry refers to
+};
+
+Playlist* playlist_alloc(void) {
+    Playlist* playlist = malloc(sizeof(Playlist));
+    PlaylistEntryArray_init(playlist->entries);
+    playlist->arena_size = PLAYLIST_ARENA_SIZE_MIN;
+    playlist->arena = malloc(playlist->arena_size);
+    playlist->arena_used = 0;
+    playlist->garbage = 0;
+    return playlist;
+}
+
+void playlist_free(Playlist* playlist) {
+    PlaylistEntryArray_clear(playlist->entries);
+    free(playlist->arena);
+    free(playlist);
+}
+
+void playlist_reset(Playlist* playlist) {
+    PlaylistEntryArray_reset(playlist->entries);
+    playlist->arena_used = 0;
+    playlist->garbage = 0;
+}
+
+size_t playlist_count(const Playlist* playlist) {
+    return PlaylistEntryArray_size(playlist->entries);
+}
+
+/**
+ * @brief FNV-1a
+ */
+static uint32_t playlist_hash(const char* str) {
+    uint32_t hash = 2166136261u;
+    while(*str)
+        hash = (hash ^ (uint8_t)*str++) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief Appends a string to the arena
+ * @returns arena offset of the string
+ */
+static uint32_t playlist_append(Playlist* playlist, const char* str) {
+    size_t size = strlen(str) + 1;
+    if(playlist->arena_used + size > playlist->arena_size) {
+        playlist->arena_size = MAX(playlist->arena_size * 2, playlist->arena_used + size);
+        playlist->arena = realloc(playlist->arena, playlist->arena_size); //-V701
+    }
+    uint32_t offset = playlist->arena_used;
+    memcpy(&playlist->arena[offset], str, size);
+    playlist->arena_used += size;
+    return offset;
+}
+
+/**
+ * @brief Finds a group that one of the first `entries` entries refers to, or
+ * appends it to the arena. Paths are not shared, as they are rarely equal.
+ * @returns arena offset of the group
+ */
+static uint32_t
+    playlist_intern_group(Playlist* playlist, const char* group, uint32_t hash, size_t entries) {
+    for(size_t i = 0; i < entries; i++) {
+        const PlaylistEntry* entry = PlaylistEntryArray_cget(playlist->entries, i);
+        if(entry->group_hash == hash && strcmp(&playlist->arena[entry->group], group) == 0)
+            return entry->group;
+    }
+    return playlist_append(playlist, group);
+}
+
+/**
+ * @brief Rebuilds the arena with only the strings that are referred to
+ */
+static void playlist_compact(Playlist* playlist) {
+    char* old_arena = playlist->arena;
+    playlist->arena = malloc(playlist->arena_size);
+    playlist->arena_used = 0;
+    playlist->garbage = 0;
+
+    for(size_t i = 0; i < PlaylistEntryArray_size(playlist->entries); i++) {
+        PlaylistEntry* entry = PlaylistEntryArray_get(playlist->entries, i);
+        // the entries before this one have been moved already
+        entry->path = playlist_append(playlist, &old_arena[entry->path]);
+        entry->group =
+            playlist_intern_group(playlist, &old_arena[entry->group], entry->group_hash, i);
+    }
+    free(old_arena);
+}
+
+/**
+ * @brief Counts a group as garbage if no entry refers to it anymore
+ */
+static void playlist_release_group(Playlist* playlist, uint32_t group) {
+    for(size_t i = 0; i < PlaylistEntryArray_size(playlist->entries); i++) {
+        if(PlaylistEntryArray_cget(playlist->entries, i)->group == group) return;
+    }
+    playlist->garbage += strlen(&playlist->arena[group]) + 1;
+}
+
+static void playlist_compact_if_needed(Playlist* playlist) {
+    if(playlist->garbage * 2 > playlist->arena_used) playlist_compact(playlist);
+}
+
+/**
+ * @brief Gets the name of the folder that a path is in
+ */
+static void playlist_folder_of(const char* path, size_t name, char* folder, size_t folder_size) {
+    size_t end = name ? name - 1 : 0;
+    size_t start = end;
+    while(start > 0 && path[start - 1] != '/')
+        start--;
+    snprintf(folder, folder_size, "%.*s", (int)(end - start), &path[start]);
+}
+
+int32_t playlist_add(Playlist* playlist, const char* path, const char* group) {
+    size_t index = PlaylistEntryArray_size(playlist->entries);
+    if(index >= PLAYLIST_SIZE_MAX) return -1;
+
+    const char* name = strrchr(path, '/');
+    PlaylistEntry entry = {
+        .name = name ? name - path + 1 : 0,
+        .meta = {0},
+    };
+
+    char folder[64];
+    if(!group) {
+        playlist_folder_of(path, entry.name, folder, sizeof(folder));
+        group = folder;
+    }
+    entry.path = playlist_append(playlist, path);
+    entry.group_hash = playlist_hash(group);
+    entry.group = playlist_intern_group(playlist, group, entry.group_hash, index);
+    PlaylistEntryArray_push_back(playlist->entries, entry);
+    return index;
+}
+
+void playlist_remove(Playlist* playlist, size_t index) {
+    const PlaylistEntry* entry = PlaylistEntryArray_cget(playlist->entries, index);
+    // paths belong to one entry, groups only once the last entry in them is gone
+    playlist->garbage += strlen(&playlist->arena[entry->path]) + 1;
+    uint32_t group = entry->group;
+    PlaylistEntryArray_erase(playlist->entries, index);
+    playlist_release_group(playlist, group);
+
+    playlist_compact_if_needed(playlist);
+}
+
+void playlist_move(Playlist* playlist, size_t from, size_t to) {
+    if(from == to) return;
+    PlaylistEntry entry = *PlaylistEntryArray_get(playlist->entries, from);
+    PlaylistEntryArray_erase(playlist->entries, from);
+    PlaylistEntryArray_push_at(playlist->entries, to, entry);
+}
+
+const char* playlist_get_path(const Playlist* playlist, size_t index) {
+    return &playlist->arena[PlaylistEntryArray_cget(playlist->entries, index)->path];
+}
+
+const char* playlist_get_name(const Playlist* playlist, size_t index) {
+    const PlaylistEntry* entry = PlaylistEntryArray_cget(playlist->entries, index);
+    return &playlist->arena[entry->path + entry->name];
+}
+
+const char* playlist_get_group(const Playlist* playlist, size_t index) {
+    return &playlist->arena[PlaylistEntryArray_cget(playlist->entries, index)->group];
+}
+
+void playlist_set_group(Playlist* playlist, size_t index, const char* group) {
+    size_t count = PlaylistEntryArray_size(playlist->entries);
+    uint32_t hash = playlist_hash(group);
+    uint32_t offset = playlist_intern_group(playlist, group, hash, count);
+    PlaylistEntry* entry = PlaylistEntryArray_get(playlist->entries, index);
+    uint32_t old_group = entry->group;
+    entry->group = offset;
+    entry->group_hash = hash;
+    if(old_group == offset) return;
+
+    playlist_release_group(playlist, old_group);
+    playlist_compact_if_needed(playlist);
+}
+
+PlaylistMeta* playlist_get_meta(Playlist* playlist, size_t index) {
+    return &PlaylistEntryArray_get(playlist->entries, index)->meta;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include "js_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file playlist.h
+ *
+ * Ordered list of scripts with per-entry metadata.
+ *
+ * Strings live in one growable arena and entries refer to them by offset.
+ * Equal groups are stored once, since those are shared by many entries, and
+ * found by hash. The file name of each entry is located when it's
+ * added, so listing names doesn't touch the paths again. The arena is
+ * compacted once removed entries, and groups that no entry is in anymore,
+ * have left more garbage than live data.
+ */
+
+#define PLAYLIST_SIZE_MAX 512
+
+typedef struct Playlist Playlist;
+
+typedef struct {
+    uint16_t run_count;
+    uint32_t last_duration_ms; //<! 0 if the script has never finished
+    JsThreadResources hints; //<! Passed to the script when it's run
+} PlaylistMeta;
+
+Playlist* playlist_alloc(void);
+
+void playlist_free(Playlist* playlist);
+
+void playlist_reset(Playlist* playlist);
+
+size_t playlist_count(const Playlist* playlist);
+
+/**
+ * @brief Appends a script
+ * @param group Group of the entry, NULL to use the folder of the script
+ * @returns index of the entry, or -1 if the playlist is full
+ */
+int32_t playlist_add(Playlist* playlist, const char* path, const char* group);
+
+void playlist_remove(Playlist* playlist, size_t index);
+
+/**
+ * @brief Moves an entry, shifting the ones in between
+ */
+void playlist_move(Playlist* playlist, size_t from, size_t to);
+
+const char* playlist_get_path(const Playlist* playlist, size_t index);
+
+/**
+ * @brief Gets the file name part of the path
+ */
+const char* playlist_get_name(const Playlist* playlist, size_t index);
+
+const char* playlist_get_group(const Playlist* playlist, size_t index);
+
+void playlist_set_group(Playlist* playlist, size_t index, const char* group);
+
+PlaylistMeta* playlist_get_meta(Playlist* playlist, size_t index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,6 +10,11 @@ static constexpr auto app_api_table = sort(create_array_t<sym_entry>(
     API_METHOD(js_flags_set, void, (struct mjs*, uint32_t)),
     API_METHOD(js_flags_wait, uint32_t, (struct mjs*, uint32_t, uint32_t)),
     API_METHOD(js_module_get, void*, (JsModules*, const char*)),
+    API_METHOD(js_thread_spawn, JsThread*, (struct mjs*, const char*, void*)),
+    API_METHOD(js_thread_get_channel, void*, (struct mjs*)),
+    API_METHOD(js_thread_run_deferred, void, (struct mjs*)),
+    API_METHOD(js_thread_stop, void, (JsThread*)),
+    API_METHOD(js_profile_mk_fn, mjs_val_t, (struct mjs*, mjs_func_ptr_t, const char*)),
     API_METHOD(js_value_buffer_size, size_t, (const JsValueParseDeclaration declaration)),
     API_METHOD(
         js_value_parse,
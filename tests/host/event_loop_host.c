@@ -0,0 +1,324 @@
+#include <furi/core/event_loop.h>
+#include <furi/core/event_loop_timer.h>
+
+#define TAG "EventLoop"
+
+typedef enum {
+    FuriEventLoopObjectTypeSemaphore,
+    FuriEventLoopObjectTypeQueue,
+} FuriEventLoopObjectType;
+
+typedef struct FuriEventLoopSubscription {
+    struct FuriEventLoopSubscription* next;
+    uint32_t id; //<! Tells a subscription apart from a later one at the same address
+    FuriEventLoopObject* object;
+    FuriEventLoopObjectType type;
+    FuriEventLoopEvent event;
+    FuriEventLoopEventCallback callback;
+    void* context;
+} FuriEventLoopSubscription;
+
+typedef struct FuriEventLoopPending {
+    struct FuriEventLoopPending* next;
+    FuriEventLoopPendingCallback callback;
+    void* context;
+} FuriEventLoopPending;
+
+struct FuriEventLoopTimer {
+    FuriEventLoopTimer* next;
+    FuriEventLoop* loop;
+    FuriEventLoopTimerCallback callback;
+    FuriEventLoopTimerType type;
+    void* context;
+    uint32_t interval;
+    uint32_t deadline;
+    bool running;
+};
+
+struct FuriEventLoop {
+    FuriEventLoopSubscription* subscriptions;
+    FuriEventLoopTimer* timers;
+    FuriEventLoopPending* pending;
+    FuriEventLoopPending** pending_tail;
+    uint32_t next_id;
+    bool running;
+    bool stop;
+};
+
+FuriEventLoop* furi_event_loop_alloc(void) {
+    FuriEventLoop* instance = malloc(sizeof(FuriEventLoop));
+    instance->subscriptions = NULL;
+    instance->timers = NULL;
+    instance->pending = NULL;
+    instance->pending_tail = &instance->pending;
+    instance->next_id = 1;
+    instance->running = false;
+    instance->stop = false;
+    return instance;
+}
+
+void furi_event_loop_free(FuriEventLoop* instance) {
+    furi_check(!instance->running);
+    // the device crashes on leftovers as well
+    furi_check(!instance->subscriptions);
+    furi_check(!instance->timers);
+    while(instance->pending) {
+        FuriEventLoopPending* pending = instance->pending;
+        instance->pending = pending->next;
+        free(pending);
+    }
+    free(instance);
+}
+
+void furi_event_loop_stop(FuriEventLoop* instance) {
+    instance->stop = true;
+}
+
+void furi_event_loop_pend_callback(
+    FuriEventLoop* instance,
+    FuriEventLoopPendingCallback callback,
+    void* context) {
+    FuriEventLoopPending* pending = malloc(sizeof(FuriEventLoopPending));
+    pending->next = NULL;
+    pending->callback = callback;
+    pending->context = context;
+    *instance->pending_tail = pending;
+    instance->pending_tail = &pending->next;
+}
+
+// =============
+// Subscriptions
+// =============
+
+static FuriEventLoopSubscription**
+    furi_event_loop_find(FuriEventLoop* instance, FuriEventLoopObject* object) {
+    FuriEventLoopSubscription** link = &instance->subscriptions;
+    while(*link && (*link)->object != object) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void furi_event_loop_subscribe(
+    FuriEventLoop* instance,
+    FuriEventLoopObject* object,
+    FuriEventLoopObjectType type,
+    FuriEventLoopEvent event,
+    FuriEventLoopEventCallback callback,
+    void* context) {
+    furi_check(callback);
+    furi_check(!*furi_event_loop_find(instance, object));
+
+    FuriEventLoopSubscription* subscription = malloc(sizeof(FuriEventLoopSubscription));
+    subscription->id = instance->next_id++;
+    subscription->object = object;
+    subscription->type = type;
+    subscription->event = event;
+    subscription->callback = callback;
+    subscription->context = context;
+
+    // keep the order of subscription, which is the order of the checks
+    FuriEventLoopSubscription** link = &instance->subscriptions;
+    while(*link) {
+        link = &(*link)->next;
+    }
+    subscription->next = NULL;
+    *link = subscription;
+}
+
+void furi_event_loop_subscribe_message_queue(
+    FuriEventLoop* instance,
+    FuriMessageQueue* message_queue,
+    FuriEventLoopEvent event,
+    FuriEventLoopEventCallback callback,
+    void* context) {
+    furi_event_loop_subscribe(
+        instance, message_queue, FuriEventLoopObjectTypeQueue, event, callback, context);
+}
+
+void furi_event_loop_subscribe_semaphore(
+    FuriEventLoop* instance,
+    FuriSemaphore* semaphore,
+    FuriEventLoopEvent event,
+    FuriEventLoopEventCallback callback,
+    void* context) {
+    furi_event_loop_subscribe(
+        instance, semaphore, FuriEventLoopObjectTypeSemaphore, event, callback, context);
+}
+
+void furi_event_loop_unsubscribe(FuriEventLoop* instance, FuriEventLoopObject* object) {
+    FuriEventLoopSubscription** link = furi_event_loop_find(instance, object);
+    FuriEventLoopSubscription* subscription = *link;
+    furi_check(subscription);
+    *link = subscription->next;
+    free(subscription);
+}
+
+bool furi_event_loop_is_subscribed(FuriEventLoop* instance, FuriEventLoopObject* object) {
+    return *furi_event_loop_find(instance, object) != NULL;
+}
+
+/**
+ * @brief Whether the object is in the state that the subscription waits for.
+ * Events are level triggered: a callback that doesn't consume its event is
+ * called again on the next pass.
+ */
+static bool furi_event_loop_is_ready(const FuriEventLoopSubscription* subscription) {
+    bool in = (subscription->event & FuriEventLoopEventMask) == FuriEventLoopEventIn;
+
+    if(subscription->type == FuriEventLoopObjectTypeQueue) {
+        FuriMessageQueue* queue = subscription->object;
+        return in ? furi_message_queue_get_count(queue) > 0 :
+                    furi_message_queue_get_space(queue) > 0;
+    } else {
+        FuriSemaphore* semaphore = subscription->object;
+        return in ? furi_semaphore_get_count(semaphore) > 0 : true;
+    }
+}
+
+// ======
+// Timers
+// ======
+
+FuriEventLoopTimer* furi_event_loop_timer_alloc(
+    FuriEventLoop* instance,
+    FuriEventLoopTimerCallback callback,
+    FuriEventLoopTimerType type,
+    void* context) {
+    furi_check(callback);
+    FuriEventLoopTimer* timer = malloc(sizeof(FuriEventLoopTimer));
+    timer->loop = instance;
+    timer->callback = callback;
+    timer->type = type;
+    timer->context = context;
+    timer->interval = 0;
+    timer->deadline = 0;
+    timer->running = false;
+    timer->next = instance->timers;
+    instance->timers = timer;
+    return timer;
+}
+
+void furi_event_loop_timer_free(FuriEventLoopTimer* timer) {
+    FuriEventLoopTimer** link = &timer->loop->timers;
+    while(*link != timer) {
+        furi_check(*link);
+        link = &(*link)->next;
+    }
+    *link = timer->next;
+    free(timer);
+}
+
+void furi_event_loop_timer_start(FuriEventLoopTimer* timer, uint32_t interval) {
+    furi_check(interval);
+    timer->interval = interval;
+    timer->deadline = furi_get_tick() + interval;
+    timer->running = true;
+}
+
+void furi_event_loop_timer_restart(FuriEventLoopTimer* timer) {
+    furi_event_loop_timer_start(timer, timer->interval);
+}
+
+void furi_event_loop_timer_stop(FuriEventLoopTimer* timer) {
+    timer->running = false;
+}
+
+uint32_t furi_event_loop_timer_get_remaining_time(const FuriEventLoopTimer* timer) {
+    if(!timer->running) return 0;
+    int32_t remaining = (int32_t)(timer->deadline - furi_get_tick());
+    return MAX(remaining, 0);
+}
+
+uint32_t furi_event_loop_timer_get_interval(const FuriEventLoopTimer* timer) {
+    return timer->interval;
+}
+
+bool furi_event_loop_timer_is_running(const FuriEventLoopTimer* timer) {
+    return timer->running;
+}
+
+/**
+ * @brief Finds the running timer that's due the soonest
+ */
+static FuriEventLoopTimer* furi_event_loop_next_timer(FuriEventLoop* instance) {
+    FuriEventLoopTimer* next = NULL;
+    for(FuriEventLoopTimer* timer = instance->timers; timer; timer = timer->next) {
+        if(!timer->running) continue;
+        if(!next || (int32_t)(timer->deadline - next->deadline) < 0) next = timer;
+    }
+    return next;
+}
+
+// ====
+// Loop
+// ====
+
+/**
+ * @brief Runs one round of pending callbacks, due timers and ready objects
+ * @returns whether anything ran
+ */
+static bool furi_event_loop_process(FuriEventLoop* instance) {
+    bool processed = false;
+
+    // callbacks that these pend go to the next round
+    FuriEventLoopPending* pending = instance->pending;
+    instance->pending = NULL;
+    instance->pending_tail = &instance->pending;
+    while(pending) {
+        FuriEventLoopPending* next = pending->next;
+        if(!instance->stop) pending->callback(pending->context);
+        free(pending);
+        pending = next;
+        processed = true;
+    }
+
+    for(FuriEventLoopTimer* timer; !instance->stop;) {
+        timer = furi_event_loop_next_timer(instance);
+        if(!timer || (int32_t)(timer->deadline - furi_get_tick()) > 0) break;
+        if(timer->type == FuriEventLoopTimerTypePeriodic) {
+            timer->deadline += timer->interval;
+        } else {
+            timer->running = false;
+        }
+        // the callback may free the timer
+        timer->callback(timer->context);
+        processed = true;
+    }
+
+    // callbacks may unsubscribe any subscription, check each one by its id
+    uint32_t last_id = 0;
+    while(!instance->stop) {
+        FuriEventLoopSubscription* subscription = instance->subscriptions;
+        while(subscription && subscription->id <= last_id) {
+            subscription = subscription->next;
+        }
+        if(!subscription) break;
+        last_id = subscription->id;
+        if(!furi_event_loop_is_ready(subscription)) continue;
+        subscription->callback(subscription->object, subscription->context);
+        processed = true;
+    }
+
+    return processed;
+}
+
+void furi_event_loop_run(FuriEventLoop* instance) {
+    furi_check(!instance->running);
+    instance->running = true;
+    instance->stop = false;
+
+    while(!instance->stop) {
+        if(furi_event_loop_process(instance) || instance->stop) continue;
+
+        FuriEventLoopTimer* timer = furi_event_loop_next_timer(instance);
+        if(!timer) {
+            // the device would wait for a thread that doesn't exist here
+            FURI_LOG_W(TAG, "Nothing left to wait for, stopping");
+            break;
+        }
+        furi_delay_ms(furi_event_loop_timer_get_remaining_time(timer));
+    }
+
+    instance->running = false;
+}
@@ -0,0 +1,629 @@
+#include <furi.h>
+#include <furi_hal.h>
+#include <expansion/expansion.h>
+#include <toolbox/strint.h>
+#include <toolbox/version.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// the names of the generic string functions are macros in furi.h
+#undef furi_string_alloc_set
+#undef furi_string_set
+#undef furi_string_cat
+#undef furi_string_cmp
+#undef furi_string_equal
+
+void furi_host_crash(const char* file, int line, const char* message) {
+    fflush(stdout);
+    fprintf(stderr, "furi_crash at %s:%d: %s\n", file, line, message);
+    abort();
+}
+
+size_t furi_host_strlcpy(char* dst, const char* src, size_t size) {
+    size_t src_len = strlen(src);
+    if(size) {
+        size_t copy_len = MIN(src_len, size - 1);
+        memcpy(dst, src, copy_len);
+        dst[copy_len] = '\0';
+    }
+    return src_len;
+}
+
+// =======
+// Logging
+// =======
+
+static FuriLogLevel furi_log_level = FuriLogLevelInfo;
+
+void furi_log_set_level(FuriLogLevel level) {
+    furi_log_level = level;
+}
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
+    static const char letters[] = " EWIDT";
+    if(level > furi_log_level) return;
+
+    printf("[%c][%s] ", letters[level], tag);
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+// ======
+// String
+// ======
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 <= string->capacity) return;
+    string->capacity = MAX(size + 1, string->capacity * 2);
+    string->data = realloc(string->data, string->capacity);
+    furi_check(string->data);
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    string->data = NULL;
+    string->size = 0;
+    string->capacity = 0;
+    furi_string_reserve(string, 15);
+    string->data[0] = '\0';
+    return string;
+}
+
+FuriString* furi_string_alloc_set(const FuriString* source) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set(string, source);
+    return string;
+}
+
+FuriString* furi_string_alloc_set_str(const char cstr_source[]) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set_str(string, cstr_source);
+    return string;
+}
+
+FuriString* furi_string_alloc_printf(const char format[], ...) {
+    FuriString* string = furi_string_alloc();
+    va_list args;
+    va_start(args, format);
+    furi_string_vprintf(string, format, args);
+    va_end(args);
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+bool furi_string_empty(const FuriString* string) {
+    return string->size == 0;
+}
+
+char furi_string_get_char(const FuriString* string, size_t index) {
+    furi_check(index < string->size);
+    return string->data[index];
+}
+
+void furi_string_set_strn(FuriString* string, const char cstr[], size_t n) {
+    furi_string_reserve(string, n);
+    memmove(string->data, cstr, n);
+    string->size = n;
+    string->data[n] = '\0';
+}
+
+void furi_string_set_str(FuriString* string, const char cstr[]) {
+    furi_string_set_strn(string, cstr, strlen(cstr));
+}
+
+void furi_string_set(FuriString* string, const FuriString* source) {
+    furi_string_set_strn(string, source->data, source->size);
+}
+
+static void furi_string_cat_strn(FuriString* string, const char cstr[], size_t n) {
+    furi_string_reserve(string, string->size + n);
+    memmove(string->data + string->size, cstr, n);
+    string->size += n;
+    string->data[string->size] = '\0';
+}
+
+void furi_string_cat_str(FuriString* string, const char cstr[]) {
+    furi_string_cat_strn(string, cstr, strlen(cstr));
+}
+
+void furi_string_cat(FuriString* string, const FuriString* append) {
+    furi_string_cat_strn(string, append->data, append->size);
+}
+
+int furi_string_cmp_str(const FuriString* string1, const char string2[]) {
+    return strcmp(string1->data, string2);
+}
+
+int furi_string_cmp(const FuriString* string1, const FuriString* string2) {
+    return strcmp(string1->data, string2->data);
+}
+
+bool furi_string_equal_str(const FuriString* string1, const char string2[]) {
+    return strcmp(string1->data, string2) == 0;
+}
+
+bool furi_string_equal(const FuriString* string1, const FuriString* string2) {
+    return string1->size == string2->size && strcmp(string1->data, string2->data) == 0;
+}
+
+void furi_string_push_back(FuriString* string, char c) {
+    furi_string_cat_strn(string, &c, 1);
+}
+
+void furi_string_left(FuriString* string, size_t index) {
+    if(index >= string->size) return;
+    string->size = index;
+    string->data[index] = '\0';
+}
+
+void furi_string_right(FuriString* string, size_t index) {
+    index = MIN(index, string->size);
+    furi_string_set_strn(string, string->data + index, string->size - index);
+}
+
+void furi_string_mid(FuriString* string, size_t index, size_t size) {
+    furi_string_right(string, index);
+    furi_string_left(string, size);
+}
+
+size_t furi_string_search_char(const FuriString* string, char c, size_t start) {
+    if(start >= string->size) return FURI_STRING_FAILURE;
+    const char* found = memchr(string->data + start, c, string->size - start);
+    return found ? (size_t)(found - string->data) : FURI_STRING_FAILURE;
+}
+
+size_t furi_string_search_rchar(const FuriString* string, char c, size_t start) {
+    for(size_t i = string->size; i > start; i--) {
+        if(string->data[i - 1] == c) return i - 1;
+    }
+    return FURI_STRING_FAILURE;
+}
+
+void furi_string_replace_all_str(FuriString* string, const char needle[], const char replace[]) {
+    size_t needle_len = strlen(needle);
+    if(!needle_len) return;
+
+    FuriString* result = furi_string_alloc();
+    const char* rest = string->data;
+    for(const char* found; (found = strstr(rest, needle)) != NULL; rest = found + needle_len) {
+        furi_string_cat_strn(result, rest, found - rest);
+        furi_string_cat_str(result, replace);
+    }
+    furi_string_cat_str(result, rest);
+    furi_string_set(string, result);
+    furi_string_free(result);
+}
+
+int furi_string_cat_vprintf(FuriString* string, const char format[], va_list args) {
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int len = vsnprintf(NULL, 0, format, args_copy);
+    va_end(args_copy);
+    if(len < 0) return len;
+
+    furi_string_reserve(string, string->size + len);
+    vsnprintf(string->data + string->size, len + 1, format, args);
+    string->size += len;
+    return len;
+}
+
+int furi_string_vprintf(FuriString* string, const char format[], va_list args) {
+    furi_string_reset(string);
+    return furi_string_cat_vprintf(string, format, args);
+}
+
+int furi_string_printf(FuriString* string, const char format[], ...) {
+    va_list args;
+    va_start(args, format);
+    int len = furi_string_vprintf(string, format, args);
+    va_end(args);
+    return len;
+}
+
+int furi_string_cat_printf(FuriString* string, const char format[], ...) {
+    va_list args;
+    va_start(args, format);
+    int len = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+    return len;
+}
+
+// =======
+// Toolbox
+// =======
+
+StrintParseError strint_to_uint32(const char* str, char** end, uint32_t* out, uint8_t base) {
+    while(*str == ' ' || *str == '\t')
+        str++;
+    if(*str == '-') return StrintParseSignError;
+
+    char* parsed_end;
+    errno = 0;
+    unsigned long long value = strtoull(str, &parsed_end, base);
+    if(end) *end = parsed_end;
+    if(parsed_end == str) return StrintParseAbsentError;
+    if(errno == ERANGE || value > UINT32_MAX) return StrintParseOverflowError;
+    *out = value;
+    return StrintParseNoError;
+}
+
+StrintParseError strint_to_int32(const char* str, char** end, int32_t* out, uint8_t base) {
+    char* parsed_end;
+    errno = 0;
+    long long value = strtoll(str, &parsed_end, base);
+    if(end) *end = parsed_end;
+    if(parsed_end == str) return StrintParseAbsentError;
+    if(errno == ERANGE || value > INT32_MAX || value < INT32_MIN) return StrintParseOverflowError;
+    *out = value;
+    return StrintParseNoError;
+}
+
+const char* version_get_version(const Version* v) {
+    UNUSED(v);
+    return "host";
+}
+
+// ======
+// Kernel
+// ======
+
+static uint64_t furi_host_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+uint32_t furi_get_tick(void) {
+    static uint64_t start_ns = 0;
+    if(!start_ns) start_ns = furi_host_now_ns();
+    return (furi_host_now_ns() - start_ns) / 1000000ULL;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    struct timespec delay = {
+        .tv_sec = microseconds / 1000000UL,
+        .tv_nsec = (microseconds % 1000000UL) * 1000UL,
+    };
+    while(nanosleep(&delay, &delay) != 0) {
+    }
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    for(; milliseconds >= 1000; milliseconds -= 1000) {
+        furi_delay_us(1000000UL);
+    }
+    furi_delay_us(milliseconds * 1000UL);
+}
+
+void furi_delay_tick(uint32_t ticks) {
+    furi_delay_ms(ticks);
+}
+
+// ======
+// Thread
+// ======
+
+static uint32_t furi_thread_flags = 0;
+
+FuriThreadId furi_thread_get_current_id(void) {
+    return &furi_thread_flags;
+}
+
+size_t furi_thread_get_stack_space(FuriThreadId thread_id) {
+    UNUSED(thread_id);
+    return 64 * 1024;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    UNUSED(thread_id);
+    furi_thread_flags |= flags;
+    return furi_thread_flags;
+}
+
+uint32_t furi_thread_flags_clear(uint32_t flags) {
+    uint32_t previous = furi_thread_flags;
+    furi_thread_flags &= ~flags;
+    return previous;
+}
+
+uint32_t furi_thread_flags_get(void) {
+    return furi_thread_flags;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    // no other thread could set the flags while this one waits
+    UNUSED(timeout);
+    uint32_t raised = furi_thread_flags & flags;
+    bool done = (options & FuriFlagWaitAll) ? raised == flags : raised != 0;
+    if(!done) return FuriFlagErrorTimeout;
+
+    uint32_t result = furi_thread_flags;
+    if(!(options & FuriFlagNoClear)) furi_thread_flags &= ~flags;
+    return result;
+}
+
+// =======
+// Records
+// =======
+
+static char furi_record_dummy;
+
+void* furi_record_open(const char* name) {
+    // services of the host keep no state in their record
+    UNUSED(name);
+    return &furi_record_dummy;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+// =============
+// Message queue
+// =============
+
+struct FuriMessageQueue {
+    uint32_t capacity;
+    uint32_t msg_size;
+    uint32_t head;
+    uint32_t count;
+    uint8_t* buffer;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    furi_check(msg_count && msg_size);
+    FuriMessageQueue* instance = malloc(sizeof(FuriMessageQueue));
+    instance->capacity = msg_count;
+    instance->msg_size = msg_size;
+    instance->head = 0;
+    instance->count = 0;
+    instance->buffer = malloc(msg_count * msg_size);
+    return instance;
+}
+
+void furi_message_queue_free(FuriMessageQueue* instance) {
+    free(instance->buffer);
+    free(instance);
+}
+
+FuriStatus
+    furi_message_queue_put(FuriMessageQueue* instance, const void* msg_ptr, uint32_t timeout) {
+    if(instance->count == instance->capacity) {
+        return timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+    }
+    uint32_t tail = (instance->head + instance->count) % instance->capacity;
+    memcpy(instance->buffer + tail * instance->msg_size, msg_ptr, instance->msg_size);
+    instance->count++;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg_ptr, uint32_t timeout) {
+    if(!instance->count) {
+        return timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+    }
+    memcpy(msg_ptr, instance->buffer + instance->head * instance->msg_size, instance->msg_size);
+    instance->head = (instance->head + 1) % instance->capacity;
+    instance->count--;
+    return FuriStatusOk;
+}
+
+uint32_t furi_message_queue_get_capacity(FuriMessageQueue* instance) {
+    return instance->capacity;
+}
+
+uint32_t furi_message_queue_get_message_size(FuriMessageQueue* instance) {
+    return instance->msg_size;
+}
+
+uint32_t furi_message_queue_get_count(FuriMessageQueue* instance) {
+    return instance->count;
+}
+
+uint32_t furi_message_queue_get_space(FuriMessageQueue* instance) {
+    return instance->capacity - instance->count;
+}
+
+FuriStatus furi_message_queue_reset(FuriMessageQueue* instance) {
+    instance->head = 0;
+    instance->count = 0;
+    return FuriStatusOk;
+}
+
+// =========
+// Semaphore
+// =========
+
+struct FuriSemaphore {
+    uint32_t max_count;
+    uint32_t count;
+};
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count) {
+    furi_check(max_count && initial_count <= max_count);
+    FuriSemaphore* instance = malloc(sizeof(FuriSemaphore));
+    instance->max_count = max_count;
+    instance->count = initial_count;
+    return instance;
+}
+
+void furi_semaphore_free(FuriSemaphore* instance) {
+    free(instance);
+}
+
+FuriStatus furi_semaphore_acquire(FuriSemaphore* instance, uint32_t timeout) {
+    if(!instance->count) return timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+    instance->count--;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_semaphore_release(FuriSemaphore* instance) {
+    if(instance->count == instance->max_count) return FuriStatusErrorResource;
+    instance->count++;
+    return FuriStatusOk;
+}
+
+uint32_t furi_semaphore_get_count(FuriSemaphore* instance) {
+    return instance->count;
+}
+
+// =============
+// Stream buffer
+// =============
+
+struct FuriStreamBuffer {
+    size_t size;
+    size_t head;
+    size_t count;
+    uint8_t* buffer;
+};
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level) {
+    UNUSED(trigger_level);
+    furi_check(size);
+    FuriStreamBuffer* stream_buffer = malloc(sizeof(FuriStreamBuffer));
+    stream_buffer->size = size;
+    stream_buffer->head = 0;
+    stream_buffer->count = 0;
+    stream_buffer->buffer = malloc(size);
+    return stream_buffer;
+}
+
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer) {
+    free(stream_buffer->buffer);
+    free(stream_buffer);
+}
+
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout) {
+    UNUSED(timeout);
+    const uint8_t* bytes = data;
+    size_t sent = MIN(length, stream_buffer->size - stream_buffer->count);
+    for(size_t i = 0; i < sent; i++) {
+        size_t tail = (stream_buffer->head + stream_buffer->count) % stream_buffer->size;
+        stream_buffer->buffer[tail] = bytes[i];
+        stream_buffer->count++;
+    }
+    return sent;
+}
+
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout) {
+    UNUSED(timeout);
+    uint8_t* bytes = data;
+    size_t received = MIN(length, stream_buffer->count);
+    for(size_t i = 0; i < received; i++) {
+        bytes[i] = stream_buffer->buffer[stream_buffer->head];
+        stream_buffer->head = (stream_buffer->head + 1) % stream_buffer->size;
+        stream_buffer->count--;
+    }
+    return received;
+}
+
+size_t furi_stream_buffer_bytes_available(FuriStreamBuffer* stream_buffer) {
+    return stream_buffer->count;
+}
+
+size_t furi_stream_buffer_spaces_available(FuriStreamBuffer* stream_buffer) {
+    return stream_buffer->size - stream_buffer->count;
+}
+
+bool furi_stream_buffer_is_full(FuriStreamBuffer* stream_buffer) {
+    return stream_buffer->count == stream_buffer->size;
+}
+
+bool furi_stream_buffer_is_empty(FuriStreamBuffer* stream_buffer) {
+    return stream_buffer->count == 0;
+}
+
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer) {
+    stream_buffer->head = 0;
+    stream_buffer->count = 0;
+    return FuriStatusOk;
+}
+
+// ===
+// HAL
+// ===
+
+FuriHalHostDwt* furi_hal_host_dwt(void) {
+    static FuriHalHostDwt dwt = {.CTRL = DWT_CTRL_CYCCNTENA_Msk};
+    dwt.CYCCNT = (uint32_t)(furi_host_now_ns() * FURI_HAL_HOST_CYCLES_PER_US / 1000ULL);
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return FURI_HAL_HOST_CYCLES_PER_US;
+}
+
+void furi_hal_cortex_delay_us(uint32_t microseconds) {
+    furi_delay_us(microseconds);
+}
+
+uint32_t furi_hal_random_get(void) {
+    static uint64_t state = 0;
+    if(!state) state = furi_host_now_ns() | 1;
+    // xorshift64*, plenty for scripts that want a random number
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (state * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+void furi_hal_random_fill_buf(uint8_t* buf, uint32_t len) {
+    for(uint32_t i = 0; i < len; i++) {
+        buf[i] = furi_hal_random_get();
+    }
+}
+
+const char* furi_hal_version_get_name_ptr(void) {
+    return "Host";
+}
+
+void expansion_enable(Expansion* instance) {
+    UNUSED(instance);
+}
+
+void expansion_disable(Expansion* instance) {
+    UNUSED(instance);
+}
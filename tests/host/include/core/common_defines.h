@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * @file common_defines.h
+ * Host copy of the furi helper macros the JS modules use
+ */
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MAX
+#define MAX(a, b)               \
+    ({                          \
+        __typeof__(a) _a = (a); \
+        __typeof__(b) _b = (b); \
+        _a > _b ? _a : _b;      \
+    })
+#endif
+
+#ifndef MIN
+#define MIN(a, b)               \
+    ({                          \
+        __typeof__(a) _a = (a); \
+        __typeof__(b) _b = (b); \
+        _a < _b ? _a : _b;      \
+    })
+#endif
+
+#ifndef ABS
+#define ABS(a) ({ (a) < 0 ? -(a) : (a); })
+#endif
+
+#ifndef CLAMP
+#define CLAMP(x, upper, lower) (MIN(upper, MAX(x, lower)))
+#endif
+
+#ifndef COUNT_OF
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#endif
+
+#ifndef UNUSED
+#define UNUSED(X) (void)(X)
+#endif
+
+#ifndef FURI_PACKED
+#define FURI_PACKED __attribute__((packed))
+#endif
+
+#ifndef FURI_WEAK
+#define FURI_WEAK __attribute__((weak))
+#endif
+
+#ifndef FURI_BIT
+#define FURI_BIT(x, n) (((x) >> (n)) & 1)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
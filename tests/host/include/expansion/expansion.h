@@ -0,0 +1,23 @@
+#pragma once
+
+/**
+ * @file expansion.h
+ * The host has no expansion modules, so handing over the serial port to
+ * them and back does nothing
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_EXPANSION "expansion"
+
+typedef struct Expansion Expansion;
+
+void expansion_enable(Expansion* instance);
+
+void expansion_disable(Expansion* instance);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * @file flipper_application.h
+ * Plugin types only: the host links every module in, so nothing is loaded
+ * and no API table is ever resolved
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t Elf32_Addr;
+
+typedef struct ElfApiInterface {
+    uint16_t api_version_major;
+    uint16_t api_version_minor;
+    bool (*resolver_callback)(
+        const struct ElfApiInterface* interface,
+        uint32_t hash,
+        Elf32_Addr* address);
+} ElfApiInterface;
+
+typedef struct {
+    const char* appid;
+    uint32_t ep_api_version;
+    const void* entry_point;
+} FlipperAppPluginDescriptor;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "../flipper_application.h"
+
+typedef struct CompositeApiResolver CompositeApiResolver;
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "../flipper_application.h"
@@ -0,0 +1,247 @@
+#pragma once
+
+/**
+ * @file furi.h
+ * Host stand-ins for the parts of furi that the JS modules use. The host is
+ * a single thread: waits that would block return at once, since nothing else
+ * could ever wake them up.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <core/common_defines.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =========
+// C library
+// =========
+
+/** Provided by newlib on the device, glibc only has it from 2.38 on */
+size_t furi_host_strlcpy(char* dst, const char* src, size_t size);
+
+#define strlcpy furi_host_strlcpy
+
+// ======
+// Status
+// ======
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+    FuriStatusErrorParameter = -4,
+    FuriStatusErrorNoMemory = -5,
+    FuriStatusErrorISR = -6,
+} FuriStatus;
+
+typedef enum {
+    FuriFlagWaitAny = 0x00000000U,
+    FuriFlagWaitAll = 0x00000001U,
+    FuriFlagNoClear = 0x00000002U,
+    FuriFlagError = 0x80000000U,
+    FuriFlagErrorUnknown = 0xFFFFFFFFU,
+    FuriFlagErrorTimeout = 0xFFFFFFFEU,
+    FuriFlagErrorResource = 0xFFFFFFFDU,
+    FuriFlagErrorParameter = 0xFFFFFFFCU,
+    FuriFlagErrorISR = 0xFFFFFFFAU,
+} FuriFlag;
+
+// ==================
+// Checks and crashes
+// ==================
+
+__attribute__((noreturn)) void furi_host_crash(const char* file, int line, const char* message);
+
+#define furi_crash(...) furi_host_crash(__FILE__, __LINE__, "" __VA_ARGS__)
+#define furi_check(__e, ...) \
+    ((__e) ? (void)0 : furi_host_crash(__FILE__, __LINE__, "furi_check failed: " #__e))
+#define furi_assert(__e, ...) furi_check(__e)
+
+// =======
+// Logging
+// =======
+
+typedef enum {
+    FuriLogLevelNone,
+    FuriLogLevelError,
+    FuriLogLevelWarn,
+    FuriLogLevelInfo,
+    FuriLogLevelDebug,
+    FuriLogLevelTrace,
+} FuriLogLevel;
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+void furi_log_set_level(FuriLogLevel level);
+
+#define FURI_LOG_E(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelError, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_W(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelWarn, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_I(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelInfo, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_D(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelDebug, tag, format, ##__VA_ARGS__)
+#define FURI_LOG_T(tag, format, ...) \
+    furi_log_print_format(FuriLogLevelTrace, tag, format, ##__VA_ARGS__)
+
+// ======
+// String
+// ======
+
+typedef struct FuriString FuriString;
+
+#define FURI_STRING_FAILURE ((size_t)-1)
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_set(const FuriString* source);
+FuriString* furi_string_alloc_set_str(const char cstr_source[]);
+FuriString* furi_string_alloc_printf(const char format[], ...)
+    __attribute__((format(printf, 1, 2)));
+void furi_string_free(FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_reserve(FuriString* string, size_t size);
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+bool furi_string_empty(const FuriString* string);
+char furi_string_get_char(const FuriString* string, size_t index);
+void furi_string_set(FuriString* string, const FuriString* source);
+void furi_string_set_str(FuriString* string, const char cstr[]);
+void furi_string_set_strn(FuriString* string, const char cstr[], size_t n);
+void furi_string_cat(FuriString* string, const FuriString* append);
+void furi_string_cat_str(FuriString* string, const char cstr[]);
+int furi_string_cmp(const FuriString* string1, const FuriString* string2);
+int furi_string_cmp_str(const FuriString* string1, const char string2[]);
+bool furi_string_equal(const FuriString* string1, const FuriString* string2);
+bool furi_string_equal_str(const FuriString* string1, const char string2[]);
+void furi_string_push_back(FuriString* string, char c);
+void furi_string_left(FuriString* string, size_t index);
+void furi_string_right(FuriString* string, size_t index);
+void furi_string_mid(FuriString* string, size_t index, size_t size);
+size_t furi_string_search_char(const FuriString* string, char c, size_t start);
+size_t furi_string_search_rchar(const FuriString* string, char c, size_t start);
+void furi_string_replace_all_str(FuriString* string, const char needle[], const char replace[]);
+int furi_string_printf(FuriString* string, const char format[], ...)
+    __attribute__((format(printf, 2, 3)));
+int furi_string_vprintf(FuriString* string, const char format[], va_list args);
+int furi_string_cat_printf(FuriString* string, const char format[], ...)
+    __attribute__((format(printf, 2, 3)));
+int furi_string_cat_vprintf(FuriString* string, const char format[], va_list args);
+
+#define FURI_STRING_SELECT(func_name, arg) \
+    _Generic((arg),                        \
+        char*: func_name##_str,            \
+        const char*: func_name##_str,      \
+        FuriString*: func_name,            \
+        const FuriString*: func_name)
+
+#define furi_string_alloc_set(a) FURI_STRING_SELECT(furi_string_alloc_set, a)(a)
+#define furi_string_set(a, b)    FURI_STRING_SELECT(furi_string_set, b)(a, b)
+#define furi_string_cat(a, b)    FURI_STRING_SELECT(furi_string_cat, b)(a, b)
+#define furi_string_cmp(a, b)    FURI_STRING_SELECT(furi_string_cmp, b)(a, b)
+#define furi_string_equal(a, b)  FURI_STRING_SELECT(furi_string_equal, b)(a, b)
+
+// ======
+// Kernel
+// ======
+
+uint32_t furi_get_tick(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+uint32_t furi_kernel_get_tick_frequency(void);
+void furi_delay_tick(uint32_t ticks);
+void furi_delay_ms(uint32_t milliseconds);
+void furi_delay_us(uint32_t microseconds);
+
+#define FURI_CRITICAL_ENTER()
+#define FURI_CRITICAL_EXIT()
+
+// ======
+// Thread
+// ======
+
+typedef void* FuriThreadId;
+
+FuriThreadId furi_thread_get_current_id(void);
+size_t furi_thread_get_stack_space(FuriThreadId thread_id);
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_clear(uint32_t flags);
+uint32_t furi_thread_flags_get(void);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+// =======
+// Records
+// =======
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+// =============
+// Message queue
+// =============
+
+typedef struct FuriMessageQueue FuriMessageQueue;
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size);
+void furi_message_queue_free(FuriMessageQueue* instance);
+FuriStatus
+    furi_message_queue_put(FuriMessageQueue* instance, const void* msg_ptr, uint32_t timeout);
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg_ptr, uint32_t timeout);
+uint32_t furi_message_queue_get_capacity(FuriMessageQueue* instance);
+uint32_t furi_message_queue_get_message_size(FuriMessageQueue* instance);
+uint32_t furi_message_queue_get_count(FuriMessageQueue* instance);
+uint32_t furi_message_queue_get_space(FuriMessageQueue* instance);
+FuriStatus furi_message_queue_reset(FuriMessageQueue* instance);
+
+// =========
+// Semaphore
+// =========
+
+typedef struct FuriSemaphore FuriSemaphore;
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count);
+void furi_semaphore_free(FuriSemaphore* instance);
+FuriStatus furi_semaphore_acquire(FuriSemaphore* instance, uint32_t timeout);
+FuriStatus furi_semaphore_release(FuriSemaphore* instance);
+uint32_t furi_semaphore_get_count(FuriSemaphore* instance);
+
+// =============
+// Stream buffer
+// =============
+
+typedef struct FuriStreamBuffer FuriStreamBuffer;
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level);
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer);
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout);
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout);
+size_t furi_stream_buffer_bytes_available(FuriStreamBuffer* stream_buffer);
+size_t furi_stream_buffer_spaces_available(FuriStreamBuffer* stream_buffer);
+bool furi_stream_buffer_is_full(FuriStreamBuffer* stream_buffer);
+bool furi_stream_buffer_is_empty(FuriStreamBuffer* stream_buffer);
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file event_loop.h
+ * Host event loop: one thread polls its subscriptions, timers and pending
+ * callbacks until it's stopped or has nothing left to wait for
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    FuriEventLoopEventIn = 0x00000001U,
+    FuriEventLoopEventOut = 0x00000002U,
+    FuriEventLoopEventMask = 0x00000003U,
+    FuriEventLoopEventFlagEdge = 0x00000004U,
+    FuriEventLoopEventFlagOnce = 0x00000008U,
+} FuriEventLoopEvent;
+
+typedef struct FuriEventLoop FuriEventLoop;
+
+typedef void FuriEventLoopObject;
+
+typedef void (*FuriEventLoopEventCallback)(FuriEventLoopObject* object, void* context);
+
+typedef void (*FuriEventLoopPendingCallback)(void* context);
+
+FuriEventLoop* furi_event_loop_alloc(void);
+
+void furi_event_loop_free(FuriEventLoop* instance);
+
+void furi_event_loop_run(FuriEventLoop* instance);
+
+void furi_event_loop_stop(FuriEventLoop* instance);
+
+void furi_event_loop_pend_callback(
+    FuriEventLoop* instance,
+    FuriEventLoopPendingCallback callback,
+    void* context);
+
+void furi_event_loop_subscribe_message_queue(
+    FuriEventLoop* instance,
+    FuriMessageQueue* message_queue,
+    FuriEventLoopEvent event,
+    FuriEventLoopEventCallback callback,
+    void* context);
+
+void furi_event_loop_subscribe_semaphore(
+    FuriEventLoop* instance,
+    FuriSemaphore* semaphore,
+    FuriEventLoopEvent event,
+    FuriEventLoopEventCallback callback,
+    void* context);
+
+void furi_event_loop_unsubscribe(FuriEventLoop* instance, FuriEventLoopObject* object);
+
+bool furi_event_loop_is_subscribed(FuriEventLoop* instance, FuriEventLoopObject* object);
+
+#ifdef __cplusplus
+}
+#endif
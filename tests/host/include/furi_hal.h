@@ -0,0 +1,395 @@
+#pragma once
+
+/**
+ * @file furi_hal.h
+ * Host stand-ins for the HAL: a cycle counter derived from the monotonic
+ * clock, a serial port that loops transmitted bytes back to its receiver and
+ * a USB HID keyboard that only keeps track of the keys held down
+ */
+
+#include <furi.h>
+#include <furi_hal_random.h>
+#include <furi_hal_version.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======
+// Cortex
+// ======
+
+/** Clock of the emulated core, matches the 64 MHz of the device */
+#define FURI_HAL_HOST_CYCLES_PER_US 64
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} FuriHalHostDwt;
+
+/**
+ * @brief Samples the monotonic clock into the cycle counter
+ * @returns the counter, so that `DWT->CYCCNT` reads the current time
+ */
+FuriHalHostDwt* furi_hal_host_dwt(void);
+
+#define DWT                    (furi_hal_host_dwt())
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+void furi_hal_cortex_delay_us(uint32_t microseconds);
+
+// ======
+// Serial
+// ======
+
+typedef enum {
+    FuriHalSerialIdUsart,
+    FuriHalSerialIdLpuart,
+    FuriHalSerialIdMax,
+} FuriHalSerialId;
+
+typedef enum {
+    FuriHalSerialDataBits6,
+    FuriHalSerialDataBits7,
+    FuriHalSerialDataBits8,
+    FuriHalSerialDataBits9,
+} FuriHalSerialDataBits;
+
+typedef enum {
+    FuriHalSerialParityNone,
+    FuriHalSerialParityEven,
+    FuriHalSerialParityOdd,
+} FuriHalSerialParity;
+
+typedef enum {
+    FuriHalSerialStopBits0_5,
+    FuriHalSerialStopBits1,
+    FuriHalSerialStopBits1_5,
+    FuriHalSerialStopBits2,
+} FuriHalSerialStopBits;
+
+typedef enum {
+    FuriHalSerialRxEventData = (1 << 0),
+    FuriHalSerialRxEventIdle = (1 << 1),
+    FuriHalSerialRxEventFrameError = (1 << 2),
+    FuriHalSerialRxEventNoiseError = (1 << 3),
+    FuriHalSerialRxEventOverrunError = (1 << 4),
+} FuriHalSerialRxEvent;
+
+typedef struct FuriHalSerialHandle FuriHalSerialHandle;
+
+typedef void (*FuriHalSerialAsyncRxCallback)(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    void* context);
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id);
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud);
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_configure_framing(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialDataBits data_bits,
+    FuriHalSerialParity parity,
+    FuriHalSerialStopBits stop_bits);
+
+/**
+ * @brief Sends the data to the receiver of the same port, byte by byte, from
+ * within the call
+ */
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size);
+
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors);
+
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle);
+
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle);
+
+bool furi_hal_serial_async_rx_available(FuriHalSerialHandle* handle);
+
+// =======
+// USB HID
+// =======
+
+typedef struct FuriHalUsbInterface FuriHalUsbInterface;
+
+/** The interface the device boots with */
+extern FuriHalUsbInterface usb_cdc_single;
+extern FuriHalUsbInterface usb_hid;
+
+typedef struct {
+    uint32_t vid;
+    uint32_t pid;
+    char manuf[32];
+    char product[32];
+} FuriHalUsbHidConfig;
+
+/** Number of keys that one report can hold down, modifiers aside */
+#define HID_KB_MAX_KEYS 6
+
+enum HidKeyboardMods {
+    KEY_MOD_LEFT_CTRL = (1 << 8),
+    KEY_MOD_LEFT_SHIFT = (1 << 9),
+    KEY_MOD_LEFT_ALT = (1 << 10),
+    KEY_MOD_LEFT_GUI = (1 << 11),
+    KEY_MOD_RIGHT_CTRL = (1 << 12),
+    KEY_MOD_RIGHT_SHIFT = (1 << 13),
+    KEY_MOD_RIGHT_ALT = (1 << 14),
+    KEY_MOD_RIGHT_GUI = (1 << 15),
+};
+
+enum HidKeyboardLeds {
+    HID_KB_LED_NUM = (1 << 0),
+    HID_KB_LED_CAPS = (1 << 1),
+    HID_KB_LED_SCROLL = (1 << 2),
+};
+
+enum HidKeyboardKeys {
+    HID_KEYBOARD_NONE = 0x00,
+    HID_KEYBOARD_A = 0x04,
+    HID_KEYBOARD_B = 0x05,
+    HID_KEYBOARD_C = 0x06,
+    HID_KEYBOARD_D = 0x07,
+    HID_KEYBOARD_E = 0x08,
+    HID_KEYBOARD_F = 0x09,
+    HID_KEYBOARD_G = 0x0A,
+    HID_KEYBOARD_H = 0x0B,
+    HID_KEYBOARD_I = 0x0C,
+    HID_KEYBOARD_J = 0x0D,
+    HID_KEYBOARD_K = 0x0E,
+    HID_KEYBOARD_L = 0x0F,
+    HID_KEYBOARD_M = 0x10,
+    HID_KEYBOARD_N = 0x11,
+    HID_KEYBOARD_O = 0x12,
+    HID_KEYBOARD_P = 0x13,
+    HID_KEYBOARD_Q = 0x14,
+    HID_KEYBOARD_R = 0x15,
+    HID_KEYBOARD_S = 0x16,
+    HID_KEYBOARD_T = 0x17,
+    HID_KEYBOARD_U = 0x18,
+    HID_KEYBOARD_V = 0x19,
+    HID_KEYBOARD_W = 0x1A,
+    HID_KEYBOARD_X = 0x1B,
+    HID_KEYBOARD_Y = 0x1C,
+    HID_KEYBOARD_Z = 0x1D,
+    HID_KEYBOARD_1 = 0x1E,
+    HID_KEYBOARD_2 = 0x1F,
+    HID_KEYBOARD_3 = 0x20,
+    HID_KEYBOARD_4 = 0x21,
+    HID_KEYBOARD_5 = 0x22,
+    HID_KEYBOARD_6 = 0x23,
+    HID_KEYBOARD_7 = 0x24,
+    HID_KEYBOARD_8 = 0x25,
+    HID_KEYBOARD_9 = 0x26,
+    HID_KEYBOARD_0 = 0x27,
+    HID_KEYBOARD_RETURN = 0x28,
+    HID_KEYBOARD_ESCAPE = 0x29,
+    HID_KEYBOARD_DELETE = 0x2A,
+    HID_KEYBOARD_TAB = 0x2B,
+    HID_KEYBOARD_SPACEBAR = 0x2C,
+    HID_KEYBOARD_MINUS = 0x2D,
+    HID_KEYBOARD_EQUAL_SIGN = 0x2E,
+    HID_KEYBOARD_OPEN_BRACKET = 0x2F,
+    HID_KEYBOARD_CLOSE_BRACKET = 0x30,
+    HID_KEYBOARD_BACKSLASH = 0x31,
+    HID_KEYBOARD_SEMICOLON = 0x33,
+    HID_KEYBOARD_APOSTROPHE = 0x34,
+    HID_KEYBOARD_GRAVE_ACCENT = 0x35,
+    HID_KEYBOARD_COMMA = 0x36,
+    HID_KEYBOARD_DOT = 0x37,
+    HID_KEYBOARD_SLASH = 0x38,
+    HID_KEYBOARD_CAPS_LOCK = 0x39,
+    HID_KEYBOARD_F1 = 0x3A,
+    HID_KEYBOARD_F2 = 0x3B,
+    HID_KEYBOARD_F3 = 0x3C,
+    HID_KEYBOARD_F4 = 0x3D,
+    HID_KEYBOARD_F5 = 0x3E,
+    HID_KEYBOARD_F6 = 0x3F,
+    HID_KEYBOARD_F7 = 0x40,
+    HID_KEYBOARD_F8 = 0x41,
+    HID_KEYBOARD_F9 = 0x42,
+    HID_KEYBOARD_F10 = 0x43,
+    HID_KEYBOARD_F11 = 0x44,
+    HID_KEYBOARD_F12 = 0x45,
+    HID_KEYBOARD_PRINT_SCREEN = 0x46,
+    HID_KEYBOARD_SCROLL_LOCK = 0x47,
+    HID_KEYBOARD_PAUSE = 0x48,
+    HID_KEYBOARD_INSERT = 0x49,
+    HID_KEYBOARD_HOME = 0x4A,
+    HID_KEYBOARD_PAGE_UP = 0x4B,
+    HID_KEYBOARD_DELETE_FORWARD = 0x4C,
+    HID_KEYBOARD_END = 0x4D,
+    HID_KEYBOARD_PAGE_DOWN = 0x4E,
+    HID_KEYBOARD_RIGHT_ARROW = 0x4F,
+    HID_KEYBOARD_LEFT_ARROW = 0x50,
+    HID_KEYBOARD_DOWN_ARROW = 0x51,
+    HID_KEYBOARD_UP_ARROW = 0x52,
+    HID_KEYPAD_NUMLOCK = 0x53,
+    HID_KEYPAD_1 = 0x59,
+    HID_KEYPAD_2 = 0x5A,
+    HID_KEYPAD_3 = 0x5B,
+    HID_KEYPAD_4 = 0x5C,
+    HID_KEYPAD_5 = 0x5D,
+    HID_KEYPAD_6 = 0x5E,
+    HID_KEYPAD_7 = 0x5F,
+    HID_KEYPAD_8 = 0x60,
+    HID_KEYPAD_9 = 0x61,
+    HID_KEYPAD_0 = 0x62,
+    HID_KEYBOARD_APPLICATION = 0x65,
+    HID_KEYBOARD_LOCK_NUM_LOCK = 0x83,
+    HID_KEYBOARD_F13 = 0x68,
+    HID_KEYBOARD_F14 = 0x69,
+    HID_KEYBOARD_F15 = 0x6A,
+    HID_KEYBOARD_F16 = 0x6B,
+    HID_KEYBOARD_F17 = 0x6C,
+    HID_KEYBOARD_F18 = 0x6D,
+    HID_KEYBOARD_F19 = 0x6E,
+    HID_KEYBOARD_F20 = 0x6F,
+    HID_KEYBOARD_F21 = 0x70,
+    HID_KEYBOARD_F22 = 0x71,
+    HID_KEYBOARD_F23 = 0x72,
+    HID_KEYBOARD_F24 = 0x73,
+};
+
+/** US layout, the device loads other layouts over it from files */
+static const uint16_t hid_asciimap[128] = {
+    ['\b'] = HID_KEYBOARD_DELETE,
+    ['\t'] = HID_KEYBOARD_TAB,
+    ['\n'] = HID_KEYBOARD_RETURN,
+    ['\r'] = HID_KEYBOARD_RETURN,
+    ['\033'] = HID_KEYBOARD_ESCAPE,
+    [' '] = HID_KEYBOARD_SPACEBAR,
+    ['!'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_1,
+    ['"'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_APOSTROPHE,
+    ['#'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_3,
+    ['$'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_4,
+    ['%'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_5,
+    ['&'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_7,
+    ['\''] = HID_KEYBOARD_APOSTROPHE,
+    ['('] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_9,
+    [')'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_0,
+    ['*'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_8,
+    ['+'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_EQUAL_SIGN,
+    [','] = HID_KEYBOARD_COMMA,
+    ['-'] = HID_KEYBOARD_MINUS,
+    ['.'] = HID_KEYBOARD_DOT,
+    ['/'] = HID_KEYBOARD_SLASH,
+    ['0'] = HID_KEYBOARD_0,
+    ['1'] = HID_KEYBOARD_1,
+    ['2'] = HID_KEYBOARD_2,
+    ['3'] = HID_KEYBOARD_3,
+    ['4'] = HID_KEYBOARD_4,
+    ['5'] = HID_KEYBOARD_5,
+    ['6'] = HID_KEYBOARD_6,
+    ['7'] = HID_KEYBOARD_7,
+    ['8'] = HID_KEYBOARD_8,
+    ['9'] = HID_KEYBOARD_9,
+    [':'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_SEMICOLON,
+    [';'] = HID_KEYBOARD_SEMICOLON,
+    ['<'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_COMMA,
+    ['='] = HID_KEYBOARD_EQUAL_SIGN,
+    ['>'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_DOT,
+    ['?'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_SLASH,
+    ['@'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_2,
+    ['A'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_A,
+    ['B'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_B,
+    ['C'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_C,
+    ['D'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_D,
+    ['E'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_E,
+    ['F'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_F,
+    ['G'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_G,
+    ['H'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_H,
+    ['I'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_I,
+    ['J'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_J,
+    ['K'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_K,
+    ['L'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_L,
+    ['M'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_M,
+    ['N'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_N,
+    ['O'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_O,
+    ['P'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_P,
+    ['Q'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_Q,
+    ['R'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_R,
+    ['S'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_S,
+    ['T'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_T,
+    ['U'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_U,
+    ['V'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_V,
+    ['W'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_W,
+    ['X'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_X,
+    ['Y'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_Y,
+    ['Z'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_Z,
+    ['['] = HID_KEYBOARD_OPEN_BRACKET,
+    ['\\'] = HID_KEYBOARD_BACKSLASH,
+    [']'] = HID_KEYBOARD_CLOSE_BRACKET,
+    ['^'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_6,
+    ['_'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_MINUS,
+    ['`'] = HID_KEYBOARD_GRAVE_ACCENT,
+    ['a'] = HID_KEYBOARD_A,
+    ['b'] = HID_KEYBOARD_B,
+    ['c'] = HID_KEYBOARD_C,
+    ['d'] = HID_KEYBOARD_D,
+    ['e'] = HID_KEYBOARD_E,
+    ['f'] = HID_KEYBOARD_F,
+    ['g'] = HID_KEYBOARD_G,
+    ['h'] = HID_KEYBOARD_H,
+    ['i'] = HID_KEYBOARD_I,
+    ['j'] = HID_KEYBOARD_J,
+    ['k'] = HID_KEYBOARD_K,
+    ['l'] = HID_KEYBOARD_L,
+    ['m'] = HID_KEYBOARD_M,
+    ['n'] = HID_KEYBOARD_N,
+    ['o'] = HID_KEYBOARD_O,
+    ['p'] = HID_KEYBOARD_P,
+    ['q'] = HID_KEYBOARD_Q,
+    ['r'] = HID_KEYBOARD_R,
+    ['s'] = HID_KEYBOARD_S,
+    ['t'] = HID_KEYBOARD_T,
+    ['u'] = HID_KEYBOARD_U,
+    ['v'] = HID_KEYBOARD_V,
+    ['w'] = HID_KEYBOARD_W,
+    ['x'] = HID_KEYBOARD_X,
+    ['y'] = HID_KEYBOARD_Y,
+    ['z'] = HID_KEYBOARD_Z,
+    ['{'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_OPEN_BRACKET,
+    ['|'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_BACKSLASH,
+    ['}'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_CLOSE_BRACKET,
+    ['~'] = KEY_MOD_LEFT_SHIFT | HID_KEYBOARD_GRAVE_ACCENT,
+};
+
+/**
+ * @brief Switches the emulated port, the HID is connected for as long as
+ * `usb_hid` is set
+ */
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx);
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void);
+
+bool furi_hal_hid_is_connected(void);
+
+/** @brief Num lock is reported on, as most hosts keep it */
+uint8_t furi_hal_hid_get_led_state(void);
+
+/**
+ * @brief Holds a key down, a key that doesn't fit in the report only sets
+ * its modifiers, as on the device
+ */
+bool furi_hal_hid_kb_press(uint16_t button);
+
+bool furi_hal_hid_kb_release(uint16_t button);
+
+bool furi_hal_hid_kb_release_all(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FURI_HAL_RANDOM_MAX 0xFFFFFFFF
+
+uint32_t furi_hal_random_get(void);
+
+void furi_hal_random_fill_buf(uint8_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
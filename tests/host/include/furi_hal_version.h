@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char* furi_hal_version_get_name_ptr(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Appends a path component, with a separator unless there's one
+ */
+void path_append(FuriString* path, const char* suffix);
+
+/**
+ * @brief Sets `dirname` to everything before the last separator, or to the
+ * whole path if there's none
+ */
+void path_extract_dirname(const char* path, FuriString* dirname);
+
+#ifdef __cplusplus
+}
+#endif
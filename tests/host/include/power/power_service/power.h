@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @file power.h
+ * Empty on the host: there's no battery to report on
+ */
+
+#define RECORD_POWER "power"
+
+typedef struct Power Power;
@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ * @file storage.h
+ * Host storage: `/ext`, `/int` and `/data` live in a directory on the host,
+ * see `storage_host_set_root()`. Other paths are used as they are.
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_STORAGE "storage"
+
+#define STORAGE_INT_PATH_PREFIX      "/int"
+#define STORAGE_EXT_PATH_PREFIX      "/ext"
+#define STORAGE_APP_DATA_PATH_PREFIX "/data"
+
+#define INT_PATH(path)      STORAGE_INT_PATH_PREFIX "/" path
+#define EXT_PATH(path)      STORAGE_EXT_PATH_PREFIX "/" path
+#define APP_DATA_PATH(path) STORAGE_APP_DATA_PATH_PREFIX "/" path
+
+typedef enum {
+    FSAM_READ = (1 << 0),
+    FSAM_WRITE = (1 << 1),
+    FSAM_READ_WRITE = FSAM_READ | FSAM_WRITE,
+} FS_AccessMode;
+
+typedef enum {
+    FSOM_OPEN_EXISTING = 1,
+    FSOM_OPEN_ALWAYS = 2,
+    FSOM_OPEN_APPEND = 4,
+    FSOM_CREATE_NEW = 8,
+    FSOM_CREATE_ALWAYS = 16,
+} FS_OpenMode;
+
+typedef enum {
+    FSE_OK,
+    FSE_NOT_READY,
+    FSE_EXIST,
+    FSE_NOT_EXIST,
+    FSE_INVALID_PARAMETER,
+    FSE_DENIED,
+    FSE_INVALID_NAME,
+    FSE_INTERNAL,
+    FSE_NOT_IMPLEMENTED,
+    FSE_ALREADY_OPEN,
+} FS_Error;
+
+typedef enum {
+    FSF_DIRECTORY = (1 << 0),
+} FS_Flags;
+
+typedef struct {
+    uint32_t flags;
+    uint64_t size;
+} FileInfo;
+
+typedef struct Storage Storage;
+
+typedef struct File File;
+
+/**
+ * @brief Sets the host directory that stands in for the storage devices
+ */
+void storage_host_set_root(const char* root);
+
+bool file_info_is_dir(const FileInfo* file_info);
+
+File* storage_file_alloc(Storage* storage);
+
+void storage_file_free(File* file);
+
+bool storage_file_open(
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode);
+
+bool storage_file_close(File* file);
+
+bool storage_file_is_open(File* file);
+
+bool storage_file_is_dir(File* file);
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read);
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write);
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start);
+
+uint64_t storage_file_tell(File* file);
+
+bool storage_file_truncate(File* file);
+
+uint64_t storage_file_size(File* file);
+
+bool storage_file_sync(File* file);
+
+bool storage_file_eof(File* file);
+
+bool storage_file_exists(Storage* storage, const char* path);
+
+bool storage_file_copy_to_file(File* source, File* destination, size_t size);
+
+bool storage_dir_open(File* file, const char* path);
+
+bool storage_dir_close(File* file);
+
+bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_length);
+
+bool storage_dir_exists(Storage* storage, const char* path);
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp);
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo);
+
+FS_Error storage_common_remove(Storage* storage, const char* path);
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path);
+
+FS_Error storage_common_copy(Storage* storage, const char* old_path, const char* new_path);
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path);
+
+FS_Error storage_common_fs_info(
+    Storage* storage,
+    const char* fs_path,
+    uint64_t* total_space,
+    uint64_t* free_space);
+
+bool storage_common_exists(Storage* storage, const char* path);
+
+bool storage_common_equivalent_path(Storage* storage, const char* path1, const char* path2);
+
+bool storage_common_is_subdir(Storage* storage, const char* parent, const char* child);
+
+bool storage_simply_remove(Storage* storage, const char* path);
+
+bool storage_simply_remove_recursive(Storage* storage, const char* path);
+
+bool storage_simply_mkdir(Storage* storage, const char* path);
+
+void storage_get_next_filename(
+    Storage* storage,
+    const char* dirname,
+    const char* filename,
+    const char* fileextension,
+    FuriString* nextfilename,
+    uint8_t max_len);
+
+#ifdef __cplusplus
+}
+#endif
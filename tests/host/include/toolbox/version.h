@@ -0,0 +1,17 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Version Version;
+
+/**
+ * @brief Version string of the firmware, "host" here
+ * @param v Ignored, the device reads the current version when it's NULL
+ */
+const char* version_get_version(const Version* v);
+
+#ifdef __cplusplus
+}
+#endif
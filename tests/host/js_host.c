@@ -0,0 +1,437 @@
+#include "../../js_modules.h"
+#include "../../js_latency.h"
+#include "../../modules/js_tests.h"
+#include "../../modules/js_bench.h"
+#include "../../modules/js_badusb.h"
+#include "../../modules/js_json.h"
+#include "../../modules/js_msgpack.h"
+#include "../../modules/js_struct.h"
+#include "../../modules/js_bytes.h"
+#include "../../modules/js_event_loop/js_event_loop.h"
+#include <storage/storage.h>
+#include <sys/stat.h>
+
+#define TAG "JsHost"
+
+#define JS_HOST_MODULES_MAX 16
+
+/**
+ * @brief Times the stages of the current run, NULL unless running with `-l`
+ */
+static JsLatency* js_host_latency = NULL;
+
+// the modules that are plugins on the device are linked in here
+const FlipperAppPluginDescriptor* js_math_ep(void);
+const FlipperAppPluginDescriptor* js_serial_ep(void);
+const FlipperAppPluginDescriptor* js_storage_ep(void);
+
+// nothing is resolved through the API table of a built-in module
+const ElfApiInterface js_event_loop_hashtable_api_interface = {0};
+
+static const JsModuleDescriptor js_host_modules_builtin[] = {
+    {"tests", js_tests_create, js_tests_destroy, NULL},
+    {"bench", js_bench_create, js_bench_destroy, NULL},
+    {"json", js_json_create, NULL, NULL},
+    {"msgpack", js_msgpack_create, NULL, NULL},
+    {"struct", js_struct_create, js_struct_destroy, NULL},
+    {"bytes", js_bytes_create, NULL, NULL},
+    {"badusb", js_badusb_create, js_badusb_destroy, NULL},
+    {"event_loop",
+     js_event_loop_create,
+     js_event_loop_destroy,
+     &js_event_loop_hashtable_api_interface},
+};
+
+static const FlipperAppPluginDescriptor* (*const js_host_plugins[])(void) = {
+    js_math_ep,
+    js_serial_ep,
+    js_storage_ep,
+};
+
+typedef struct {
+    const JsModuleDescriptor* descriptor;
+    void* context;
+} JsHostModule;
+
+struct JsModules {
+    struct mjs* mjs;
+    size_t count;
+    JsHostModule modules[JS_HOST_MODULES_MAX]; //<! In the order they were required
+};
+
+// =======
+// Modules
+// =======
+
+static const JsModuleDescriptor* js_host_find_descriptor(const char* name, size_t name_len) {
+    for(size_t i = 0; i < COUNT_OF(js_host_modules_builtin); i++) {
+        const JsModuleDescriptor* descriptor = &js_host_modules_builtin[i];
+        if(strlen(descriptor->name) == name_len && strncmp(descriptor->name, name, name_len) == 0)
+            return descriptor;
+    }
+    for(size_t i = 0; i < COUNT_OF(js_host_plugins); i++) {
+        const JsModuleDescriptor* descriptor = js_host_plugins[i]()->entry_point;
+        if(strlen(descriptor->name) == name_len && strncmp(descriptor->name, name, name_len) == 0)
+            return descriptor;
+    }
+    return NULL;
+}
+
+static JsHostModule* js_host_find_module(JsModules* modules, const char* name, size_t name_len) {
+    for(size_t i = 0; i < modules->count; i++) {
+        const char* loaded_name = modules->modules[i].descriptor->name;
+        if(strlen(loaded_name) == name_len && strncmp(loaded_name, name, name_len) == 0)
+            return &modules->modules[i];
+    }
+    return NULL;
+}
+
+JsModules* js_modules_create(struct mjs* mjs, CompositeApiResolver* resolver) {
+    UNUSED(resolver);
+    JsModules* modules = malloc(sizeof(JsModules));
+    modules->mjs = mjs;
+    modules->count = 0;
+    return modules;
+}
+
+void js_modules_destroy(JsModules* modules) {
+    // like on the device, the last module to be required goes first
+    while(modules->count) {
+        JsHostModule* module = &modules->modules[--modules->count];
+        FURI_LOG_T(TAG, "Tearing down %s", module->descriptor->name);
+        if(module->descriptor->destroy) module->descriptor->destroy(module->context);
+    }
+    free(modules);
+}
+
+mjs_val_t js_module_require(JsModules* modules, const char* name, size_t name_len) {
+    const char* optional_module_prefix = "@" JS_SDK_VENDOR "/fz-sdk/";
+    size_t prefix_len = strlen(optional_module_prefix);
+    if(name_len >= prefix_len && strncmp(name, optional_module_prefix, prefix_len) == 0) {
+        name += prefix_len;
+        name_len -= prefix_len;
+    }
+
+    if(js_host_find_module(modules, name, name_len)) {
+        mjs_prepend_errorf(
+            modules->mjs,
+            MJS_BAD_ARGS_ERROR,
+            "\"%.*s\" module is already installed",
+            (int)name_len,
+            name);
+        return MJS_UNDEFINED;
+    }
+
+    const JsModuleDescriptor* descriptor = js_host_find_descriptor(name, name_len);
+    if(!descriptor || modules->count == JS_HOST_MODULES_MAX) {
+        mjs_prepend_errorf(
+            modules->mjs,
+            MJS_BAD_ARGS_ERROR,
+            "\"%.*s\" module load fail",
+            (int)name_len,
+            name);
+        return MJS_UNDEFINED;
+    }
+
+    JsHostModule* module = &modules->modules[modules->count++];
+    module->descriptor = descriptor;
+    module->context = NULL;
+    mjs_val_t module_object = MJS_UNDEFINED;
+    if(descriptor->create) {
+        module->context = descriptor->create(modules->mjs, &module_object, modules);
+    }
+    if(module_object == MJS_UNDEFINED) {
+        mjs_prepend_errorf(
+            modules->mjs, MJS_BAD_ARGS_ERROR, "\"%s\" module load fail", descriptor->name);
+    }
+    return module_object;
+}
+
+void* js_module_get(JsModules* modules, const char* name) {
+    JsHostModule* module = js_host_find_module(modules, name, strlen(name));
+    return module ? module->context : NULL;
+}
+
+// ======
+// Thread
+// ======
+
+void js_thread_run_deferred(struct mjs* mjs) {
+    // the host has no low memory callback to defer
+    UNUSED(mjs);
+}
+
+bool js_delay_with_flags(struct mjs* mjs, uint32_t time) {
+    if(furi_thread_flags_get() & ThreadEventStop) {
+        mjs_exit(mjs);
+        return true;
+    }
+    furi_delay_ms(time);
+    return false;
+}
+
+void js_flags_set(struct mjs* mjs, uint32_t flags) {
+    UNUSED(mjs);
+    furi_thread_flags_set(furi_thread_get_current_id(), flags);
+}
+
+uint32_t js_flags_wait(struct mjs* mjs, uint32_t flags_mask, uint32_t timeout) {
+    flags_mask |= ThreadEventStop;
+    uint32_t flags = furi_thread_flags_get();
+    if(flags == 0) {
+        flags = furi_thread_flags_wait(flags_mask, FuriFlagWaitAny | FuriFlagNoClear, timeout);
+    } else {
+        furi_thread_flags_clear(flags & flags_mask);
+    }
+
+    if(flags & FuriFlagError) {
+        return 0;
+    }
+    if(flags & ThreadEventStop) {
+        mjs_exit(mjs);
+    }
+    return flags;
+}
+
+// =======
+// Globals
+// =======
+
+static void js_host_str_print(FuriString* msg_str, struct mjs* mjs) {
+    size_t num_args = mjs_nargs(mjs);
+    for(size_t i = 0; i < num_args; i++) {
+        char* name = NULL;
+        size_t name_len = 0;
+        int need_free = 0;
+        mjs_val_t arg = mjs_arg(mjs, i);
+        mjs_err_t err = mjs_to_string(mjs, &arg, &name, &name_len, &need_free);
+        if(err != MJS_OK) {
+            furi_string_cat_printf(msg_str, "err %s ", mjs_strerror(mjs, err));
+        } else {
+            furi_string_cat_printf(msg_str, "%s ", name);
+        }
+        if(need_free) {
+            free(name);
+        }
+    }
+}
+
+static void js_host_print(struct mjs* mjs) {
+    if(js_host_latency) js_latency_end_once(js_host_latency, JsLatencyStageFirstPrint);
+    FuriString* msg_str = furi_string_alloc();
+    js_host_str_print(msg_str, mjs);
+    printf("%s\n", furi_string_get_cstr(msg_str));
+    furi_string_free(msg_str);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static void js_host_console_log(struct mjs* mjs) {
+    FuriString* msg_str = furi_string_alloc();
+    js_host_str_print(msg_str, mjs);
+    FURI_LOG_I("JsThread", "%s", furi_string_get_cstr(msg_str));
+    furi_string_free(msg_str);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static void js_host_console_warn(struct mjs* mjs) {
+    FuriString* msg_str = furi_string_alloc();
+    js_host_str_print(msg_str, mjs);
+    FURI_LOG_W("JsThread", "%s", furi_string_get_cstr(msg_str));
+    furi_string_free(msg_str);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static void js_host_console_error(struct mjs* mjs) {
+    FuriString* msg_str = furi_string_alloc();
+    js_host_str_print(msg_str, mjs);
+    FURI_LOG_E("JsThread", "%s", furi_string_get_cstr(msg_str));
+    furi_string_free(msg_str);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static void js_host_console_debug(struct mjs* mjs) {
+    FuriString* msg_str = furi_string_alloc();
+    js_host_str_print(msg_str, mjs);
+    FURI_LOG_D("JsThread", "%s", furi_string_get_cstr(msg_str));
+    furi_string_free(msg_str);
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static void js_host_delay(struct mjs* mjs) {
+    static const JsValueDeclaration js_host_delay_arg_list[] = {
+        JS_VALUE_SIMPLE(JsValueTypeInt32),
+    };
+    static const JsValueArguments js_host_delay_args = JS_VALUE_ARGS(js_host_delay_arg_list);
+
+    int32_t ms;
+    JS_VALUE_PARSE_ARGS_OR_RETURN(mjs, &js_host_delay_args, &ms);
+    js_delay_with_flags(mjs, MAX(ms, 0));
+    mjs_return(mjs, MJS_UNDEFINED);
+}
+
+static void js_host_require(struct mjs* mjs) {
+    mjs_val_t name_v = mjs_arg(mjs, 0);
+    size_t len;
+    const char* name = mjs_get_string(mjs, &name_v, &len);
+    mjs_val_t req_object = MJS_UNDEFINED;
+    if((len == 0) || (name == NULL)) {
+        mjs_prepend_errorf(mjs, MJS_BAD_ARGS_ERROR, "String argument is expected");
+    } else {
+        JsModules* modules = mjs_get_context(mjs);
+        if(js_host_latency) js_latency_begin(js_host_latency, JsLatencyStageRequire);
+        req_object = js_module_require(modules, name, len);
+        if(js_host_latency) js_latency_end(js_host_latency, JsLatencyStageRequire);
+    }
+    mjs_return(mjs, req_object);
+}
+
+static void js_host_exit_flag_poll(struct mjs* mjs) {
+    if(furi_thread_flags_get() & ThreadEventStop) mjs_exit(mjs);
+}
+
+// ======
+// Runner
+// ======
+
+/**
+ * @brief Text that the error of a `*.fail.js` script has to contain
+ */
+#define JS_HOST_EXPECTED_ERROR "expected failure"
+
+/**
+ * @brief Whether a script tests an error path, which is named `*.fail.js`
+ */
+static bool js_host_expects_failure(const char* script_path) {
+    const char* suffix = ".fail.js";
+    size_t path_len = strlen(script_path);
+    size_t suffix_len = strlen(suffix);
+    return path_len >= suffix_len && strcmp(script_path + path_len - suffix_len, suffix) == 0;
+}
+
+/**
+ * @brief Runs a script with fresh modules and reports how long it took
+ * @returns true if the script ran to the end, or for a `*.fail.js` script,
+ * if it stopped with the expected error
+ */
+static bool js_host_run(const char* script_path) {
+    furi_thread_flags_clear(UINT32_MAX);
+
+    if(js_host_latency) js_latency_begin(js_host_latency, JsLatencyStageSetup);
+    JsModules* modules = js_modules_create(NULL, NULL);
+    struct mjs* mjs = mjs_create(modules);
+    modules->mjs = mjs;
+
+    mjs_val_t global = mjs_get_global(mjs);
+    mjs_val_t console_obj = mjs_mk_object(mjs);
+    JS_ASSIGN_MULTI(mjs, global) {
+        JS_FIELD("__filename", mjs_mk_string(mjs, script_path, ~0, true));
+        JS_FIELD("print", MJS_MK_FN(js_host_print));
+        JS_FIELD("delay", MJS_MK_FN(js_host_delay));
+        JS_FIELD("require", MJS_MK_FN(js_host_require));
+        JS_FIELD("console", console_obj);
+    }
+    JS_ASSIGN_MULTI(mjs, console_obj) {
+        JS_FIELD("log", MJS_MK_FN(js_host_console_log));
+        JS_FIELD("warn", MJS_MK_FN(js_host_console_warn));
+        JS_FIELD("error", MJS_MK_FN(js_host_console_error));
+        JS_FIELD("debug", MJS_MK_FN(js_host_console_debug));
+    }
+    mjs_set_exec_flags_poller(mjs, js_host_exit_flag_poll);
+    if(js_host_latency) {
+        js_latency_end(js_host_latency, JsLatencyStageSetup);
+        js_latency_begin(js_host_latency, JsLatencyStageFirstPrint);
+        js_latency_begin(js_host_latency, JsLatencyStageExec);
+    }
+
+    uint32_t start = furi_get_tick();
+    mjs_err_t err = mjs_exec_file(mjs, script_path, NULL);
+    uint32_t elapsed = furi_get_tick() - start;
+    if(js_host_latency) js_latency_end(js_host_latency, JsLatencyStageExec);
+
+    bool passed = err == MJS_OK;
+    if(js_host_expects_failure(script_path)) {
+        passed = err != MJS_OK && strstr(mjs_strerror(mjs, err), JS_HOST_EXPECTED_ERROR);
+        if(err == MJS_OK) {
+            printf("FAIL %s (%lums): ran to the end\n", script_path, (unsigned long)elapsed);
+        } else {
+            printf(
+                "%s %s (%lums): %s\n",
+                passed ? "PASS" : "FAIL",
+                script_path,
+                (unsigned long)elapsed,
+                mjs_strerror(mjs, err));
+        }
+    } else if(passed) {
+        printf("PASS %s (%lums)\n", script_path, (unsigned long)elapsed);
+    } else {
+        printf(
+            "FAIL %s (%lums): %s\n",
+            script_path,
+            (unsigned long)elapsed,
+            mjs_strerror(mjs, err));
+        const char* stack_trace = mjs_get_stack_trace(mjs);
+        if(stack_trace) printf("%s", stack_trace);
+    }
+
+    if(js_host_latency) js_latency_begin(js_host_latency, JsLatencyStageTeardown);
+    mjs_destroy(mjs);
+    js_modules_destroy(modules);
+    if(js_host_latency) js_latency_end(js_host_latency, JsLatencyStageTeardown);
+    return passed;
+}
+
+/**
+ * @brief Runs a script with its launch stages timed, like the `latency` hint
+ * does on the device, and appends them to `<script>.latency.csv`
+ *
+ * There are no hints to read here, so that stage is left empty.
+ */
+static bool js_host_run_timed(const char* script_path) {
+    js_host_latency = js_latency_alloc();
+    bool passed = js_host_run(script_path);
+
+    FuriString* summary = furi_string_alloc();
+    if(!js_latency_write_report(js_host_latency, script_path, summary)) passed = false;
+    printf("%s\n", furi_string_get_cstr(summary));
+    furi_string_free(summary);
+
+    js_latency_free(js_host_latency);
+    js_host_latency = NULL;
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    int first_script = 1;
+    bool timed = false;
+    for(; first_script < argc && argv[first_script][0] == '-'; first_script++) {
+        if(strcmp(argv[first_script], "-v") == 0) {
+            furi_log_set_level(FuriLogLevelTrace);
+        } else if(strcmp(argv[first_script], "-l") == 0) {
+            timed = true;
+        } else {
+            break;
+        }
+    }
+    if(first_script >= argc || argv[first_script][0] == '-') {
+        fprintf(stderr, "usage: %s [-v] [-l] script.js...\n", argv[0]);
+        return 2;
+    }
+
+    // every run gets empty storage, which is removed afterwards
+    char root[] = "/tmp/js_host.XXXXXX";
+    furi_check(mkdtemp(root));
+    storage_host_set_root(root);
+    storage_simply_mkdir(NULL, STORAGE_EXT_PATH_PREFIX);
+    storage_simply_mkdir(NULL, STORAGE_INT_PATH_PREFIX);
+    storage_simply_mkdir(NULL, STORAGE_APP_DATA_PATH_PREFIX);
+
+    int failed = 0;
+    for(int i = first_script; i < argc; i++) {
+        bool passed = timed ? js_host_run_timed(argv[i]) : js_host_run(argv[i]);
+        if(!passed) failed++;
+    }
+    printf("%d of %d scripts passed\n", argc - first_script - failed, argc - first_script);
+
+    storage_simply_remove_recursive(NULL, root);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+// A launch that does some work before and after its first print
+let json = require("json");
+let text = json.stringify({
+    name: "latency",
+    values: [1, 2, 3, 4, 5, 6, 7, 8],
+    nested: { ok: true }
+});
+print("encoded", text.length);
+for (let i = 0; i < 200; i++) {
+    let value = json.parse(text);
+    text = json.stringify(value);
+}
+print("done");
@@ -0,0 +1,6 @@
+// Launch cost of the modules that most scripts start with
+let eventLoop = require("event_loop");
+let json = require("json");
+let math = require("math");
+let storage = require("storage");
+print("required");
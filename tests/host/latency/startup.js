@@ -0,0 +1,2 @@
+// Smallest launch: no modules, a print right away
+print("started");
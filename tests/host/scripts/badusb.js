@@ -0,0 +1,34 @@
+let tests = require("tests");
+let badusb = require("badusb");
+
+let macro = "REM host\nDEFAULT_DELAY 0\nSTRING hello\nCTRL-ALT DELETE\nENTER\n";
+
+tests.run("setup and quit", function () {
+    tests.assert_eq(false, badusb.isConnected());
+    badusb.setup();
+    tests.assert_eq(true, badusb.isConnected());
+    badusb.quit();
+    tests.assert_eq(false, badusb.isConnected());
+});
+
+tests.run("compile and play", function () {
+    let code = badusb.compile(macro);
+    tests.assert_eq(true, code.byteLength > 0);
+    badusb.setup();
+    badusb.play(code);
+    badusb.quit();
+});
+
+tests.run("compile cache", function () {
+    let path = "/ext/js_host_badusb/macro.bin";
+    let compiled = badusb.compile(macro, path);
+    let cached = badusb.compile(macro, path);
+    tests.assert_eq(compiled.byteLength, cached.byteLength);
+});
+
+tests.run("lookup benchmark", function () {
+    let result = badusb.benchmarkLookup(100);
+    tests.assert_eq(200, result.lookups);
+});
+
+print(tests.summary());
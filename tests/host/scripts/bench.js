@@ -0,0 +1,34 @@
+let tests = require("tests");
+let bench = require("bench");
+
+tests.run("clock", function () {
+    let start = bench.cycles();
+    let end = bench.cycles();
+    tests.assert_eq(true, bench.ns(start, end) >= 0);
+});
+
+tests.run("run", function () {
+    let calls = 0;
+    let result = bench.run("count", function () {
+        calls++;
+    }, { iterations: 20, warmup: 5 });
+    tests.assert_eq(25, calls);
+    tests.assert_eq("count", result.name);
+    tests.assert_eq(20, result.iterations);
+    tests.assert_eq(true, result.min <= result.median);
+    tests.assert_eq(true, result.median <= result.p99);
+});
+
+tests.run("no warmup", function () {
+    let calls = 0;
+    bench.run("once", function () {
+        calls++;
+    }, { iterations: 1, warmup: 0 });
+    tests.assert_eq(1, calls);
+});
+
+tests.run("save", function () {
+    tests.assert_eq(true, bench.save("/ext/js_host_bench.json"));
+});
+
+print(tests.summary());
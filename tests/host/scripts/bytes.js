@@ -0,0 +1,57 @@
+let tests = require("tests");
+let bytes = require("bytes");
+
+tests.run("hex", function () {
+    let buf = bytes.fromHex("00ff10");
+    tests.assert_eq(3, buf.byteLength);
+    tests.assert_eq("00ff10", bytes.toHex(buf));
+});
+
+tests.run("base64", function () {
+    tests.assert_eq("aGVsbG8=", bytes.toBase64(bytes.fromHex("68656c6c6f")));
+    tests.assert_eq("68656c6c6f", bytes.toHex(bytes.fromBase64("aGVsbG8=")));
+});
+
+tests.run("fill and copyWithin", function () {
+    let buf = bytes.fromHex("0000000000");
+    bytes.fill(buf, 0xab, 1, -1);
+    tests.assert_eq("00ababab00", bytes.toHex(buf));
+    bytes.copyWithin(buf, 0, 3);
+    tests.assert_eq("ab00abab00", bytes.toHex(buf));
+});
+
+tests.run("indexOf and compare", function () {
+    let buf = bytes.fromHex("0102030102");
+    tests.assert_eq(2, bytes.indexOf(buf, 3));
+    tests.assert_eq(3, bytes.indexOf(buf, bytes.fromHex("0102"), 1));
+    tests.assert_eq(-1, bytes.indexOf(buf, 9));
+    tests.assert_eq(0, bytes.compare(buf, bytes.fromHex("0102030102")));
+    tests.assert_eq(-1, bytes.compare(bytes.fromHex("01"), bytes.fromHex("02")));
+});
+
+tests.run("bitwise", function () {
+    let buf = bytes.fromHex("0f0f0f0f0f");
+    bytes.xor(buf, bytes.fromHex("ff00"));
+    tests.assert_eq("f00ff00ff0", bytes.toHex(buf));
+    bytes.and(buf, 0xf0);
+    tests.assert_eq("f000f000f0", bytes.toHex(buf));
+    bytes.or(buf, 0x01);
+    tests.assert_eq("f101f101f1", bytes.toHex(buf));
+});
+
+tests.run("swap", function () {
+    let buf = bytes.fromHex("0102030405060708");
+    bytes.swap(buf, 4);
+    tests.assert_eq("0403020108070605", bytes.toHex(buf));
+});
+
+tests.run("xor throughput", function () {
+    let buf = bytes.fromBase64("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA");
+    let key = bytes.fromHex("0123456789abcdef");
+    for (let i = 0; i < 1000; i++) {
+        bytes.xor(buf, key);
+    }
+    tests.assert_eq(0, bytes.indexOf(buf, 0));
+});
+
+print(tests.summary());
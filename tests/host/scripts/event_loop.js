@@ -0,0 +1,240 @@
+// The host has a single thread: run() returns once there is nothing left to
+// do, with a warning, instead of waiting for events that nothing could send
+let tests = require("tests");
+let eventLoop = require("event_loop");
+
+tests.run("setTimeout", function () {
+    let order = [];
+    eventLoop.setTimeout(function (tag) { order.push(tag); }, 20, "late");
+    eventLoop.setTimeout(function (tag) { order.push(tag); }, 5, "early");
+    eventLoop.run();
+    tests.assert_eq(2, order.length);
+    tests.assert_eq("early", order[0]);
+    tests.assert_eq("late", order[1]);
+});
+
+tests.run("clearTimeout", function () {
+    let fired = false;
+    let id = eventLoop.setTimeout(function () { fired = true; }, 5);
+    eventLoop.clearTimeout(id);
+    eventLoop.clearTimeout(id);
+    eventLoop.run();
+    tests.assert_eq(false, fired);
+});
+
+tests.run("setInterval", function () {
+    let count = 0;
+    let id = eventLoop.setInterval(function () {
+        count++;
+        if (count === 3) eventLoop.clearInterval(id);
+    }, 2);
+    eventLoop.run();
+    tests.assert_eq(3, count);
+});
+
+tests.run("timer subscription", function () {
+    let count = 0;
+    eventLoop.subscribe(eventLoop.timer("periodic", 2), function (subscription, item, step) {
+        count += step;
+        if (count >= 10) subscription.cancel();
+        return [step * 2];
+    }, 1);
+    eventLoop.run();
+    // 1 + 2 + 4 + 8
+    tests.assert_eq(15, count);
+});
+
+tests.run("queue", function () {
+    let queue = eventLoop.queue(4);
+    let received = [];
+    eventLoop.subscribe(queue.input, function (subscription, item) {
+        received.push(item);
+        if (received.length === 3) subscription.cancel();
+    });
+    queue.send("a");
+    queue.send(2);
+    queue.send({ key: "c" });
+    eventLoop.run();
+    tests.assert_eq(3, received.length);
+    tests.assert_eq("a", received[0]);
+    tests.assert_eq(2, received[1]);
+    tests.assert_eq("c", received[2].key);
+});
+
+tests.run("queue drops when full", function () {
+    let queue = eventLoop.queue(2);
+    let received = 0;
+    eventLoop.subscribe(queue.input, function (subscription) {
+        received++;
+    });
+    queue.send(1);
+    queue.send(2);
+    queue.send(3);
+    eventLoop.run();
+    tests.assert_eq(2, received);
+});
+
+tests.run("benchmark", function () {
+    let calls = 0;
+    let result = eventLoop.benchmark(function () { calls++; }, 1000);
+    tests.assert_eq(1000, result.events);
+    tests.assert_eq(1000, calls);
+    print("dispatch:", result.eventsPerSecond, "events/s");
+
+    let stateless = eventLoop.benchmark(function () {}, 1000, true);
+    tests.assert_eq(1000, stateless.events);
+    print("stateless dispatch:", stateless.eventsPerSecond, "events/s");
+});
+
+tests.run("stateless subscription", function () {
+    let queue = eventLoop.queue(4);
+    let steps = [];
+    eventLoop.subscribeWith(queue.input, { stateless: true }, function (subscription, item, step) {
+        steps.push(step);
+        if (steps.length === 3) subscription.cancel();
+        // ignored, so every call gets the original argument
+        return [step * 2];
+    }, 1);
+    queue.send(1);
+    queue.send(2);
+    queue.send(3);
+    eventLoop.run();
+    tests.assert_eq(3, steps.length);
+    tests.assert_eq(1, steps[0]);
+    tests.assert_eq(1, steps[1]);
+    tests.assert_eq(1, steps[2]);
+});
+
+tests.run("batched subscription", function () {
+    let queue = eventLoop.queue(8);
+    let batches = [];
+    eventLoop.subscribeWith(queue.input, { batch: 4 }, function (subscription, items) {
+        batches.push(items);
+        subscription.cancel();
+    });
+    queue.send("a");
+    queue.send("b");
+    queue.send("c");
+    eventLoop.run();
+    // everything pending arrives in one call, in the order it was sent
+    tests.assert_eq(1, batches.length);
+    tests.assert_eq(3, batches[0].length);
+    tests.assert_eq("a", batches[0][0]);
+    tests.assert_eq("b", batches[0][1]);
+    tests.assert_eq("c", batches[0][2]);
+});
+
+tests.run("batch size limit", function () {
+    let queue = eventLoop.queue(8);
+    let sizes = [];
+    let items = [];
+    eventLoop.subscribeWith(queue.input, { batch: 2 }, function (subscription, batch) {
+        sizes.push(batch.length);
+        for (let i = 0; i < batch.length; i++) items.push(batch[i]);
+        if (items.length === 5) subscription.cancel();
+    });
+    for (let i = 0; i < 5; i++) queue.send(i);
+    eventLoop.run();
+    tests.assert_eq(3, sizes.length);
+    tests.assert_eq(2, sizes[0]);
+    tests.assert_eq(2, sizes[1]);
+    tests.assert_eq(1, sizes[2]);
+    for (let i = 0; i < 5; i++) tests.assert_eq(i, items[i]);
+});
+
+tests.run("priorities", function () {
+    let lowQueue = eventLoop.queue(8);
+    let highQueue = eventLoop.queue(8);
+    let order = [];
+    // subscribed first, so that on its own it would be called first
+    let low = eventLoop.subscribeWith(lowQueue.input, { priority: "low" }, function (s, item) {
+        order.push("low");
+    });
+    let high = eventLoop.subscribeWith(highQueue.input, { priority: "high" }, function (s, item) {
+        order.push("high");
+    });
+    for (let i = 0; i < 8; i++) {
+        lowQueue.send(i);
+        highQueue.send(i);
+    }
+    eventLoop.run();
+    tests.assert_eq(16, order.length);
+
+    // low priority runs out of budget and waits, high priority never does
+    let lastHigh = -1;
+    let lastLow = -1;
+    for (let i = 0; i < order.length; i++) {
+        if (order[i] === "high") lastHigh = i;
+        if (order[i] === "low") lastLow = i;
+    }
+    tests.assert_eq(true, lastHigh < lastLow);
+
+    let lowStats = low.stats();
+    let highStats = high.stats();
+    tests.assert_eq("low", lowStats.priority);
+    tests.assert_eq(8, lowStats.dispatched);
+    tests.assert_eq(true, lowStats.deferred > 0);
+    tests.assert_eq(0, lowStats.backlog);
+    tests.assert_eq("high", highStats.priority);
+    tests.assert_eq(8, highStats.dispatched);
+    tests.assert_eq(0, highStats.deferred);
+    tests.assert_eq(0, highStats.backlog);
+    tests.assert_eq(0, highStats.pending);
+
+    // the loop lists them in the order they were subscribed
+    let all = eventLoop.stats();
+    tests.assert_eq(true, all.length >= 2);
+    tests.assert_eq("low", all[all.length - 2].priority);
+    tests.assert_eq(8, all[all.length - 2].dispatched);
+    tests.assert_eq("high", all[all.length - 1].priority);
+    tests.assert_eq(8, all[all.length - 1].dispatched);
+
+    low.cancel();
+    high.cancel();
+    tests.assert_eq(all.length - 2, eventLoop.stats().length);
+});
+
+tests.run("task", function () {
+    let done = [];
+    let task = eventLoop.task(function (state) {
+        state.sum += state.next;
+        state.next++;
+        if (state.next <= 100) return true;
+        return "finished";
+    }, { sum: 0, next: 1 }, {
+        onDone: function (result, state) {
+            done.push(result);
+            done.push(state.sum);
+        }
+    });
+    tests.assert_eq(0, task.stats().steps);
+    eventLoop.run();
+    tests.assert_eq(2, done.length);
+    tests.assert_eq("finished", done[0]);
+    tests.assert_eq(5050, done[1]);
+    // a finished task is freed, cancelling it again does nothing
+    task.cancel();
+});
+
+tests.run("task cancel", function () {
+    let steps = 0;
+    let finished = false;
+    let task = eventLoop.task(function (state) {
+        steps++;
+        return true;
+    }, undefined, {
+        slice: 1,
+        onDone: function () { finished = true; }
+    });
+    eventLoop.setTimeout(function () {
+        let stats = task.stats();
+        tests.assert_eq(true, stats.turns > 0);
+        tests.assert_eq(steps, stats.steps);
+        task.cancel();
+    }, 5);
+    eventLoop.run();
+    tests.assert_eq(true, steps > 0);
+    tests.assert_eq(false, finished);
+});
+
+print(tests.summary());
@@ -0,0 +1,78 @@
+let tests = require("tests");
+let json = require("json");
+let storage = require("storage");
+
+tests.run("parse", function () {
+    let value = json.parse(
+        "{\"a\": [1, 2.5, -3e2], \"b\": {\"c\": \"d\\n\\u0041\"}, \"e\": null, \"f\": true}"
+    );
+    tests.assert_eq(3, value.a.length);
+    tests.assert_float_close(2.5, value.a[1], 0);
+    tests.assert_eq(-300, value.a[2]);
+    tests.assert_eq("d\nA", value.b.c);
+    tests.assert_eq(true, value.e === null);
+    tests.assert_eq(true, value.f);
+});
+
+tests.run("stringify", function () {
+    tests.assert_eq(
+        "{\"a\":[1,\"x\\\"y\"],\"b\":false}",
+        json.stringify({ a: [1, "x\"y"], b: false })
+    );
+    tests.assert_eq("[null,null,null]", json.stringify([0 / 0, 1 / 0, -1 / 0]));
+    let control = json.parse("\"\\u0001\"");
+    tests.assert_eq("\"\\u0001\"", json.stringify(control));
+});
+
+tests.run("parseEvents", function () {
+    let keys = [];
+    let values = 0;
+    let ok = json.parseEvents("{\"x\": 1, \"y\": [2, 3], \"z\": 4}", {
+        onKey: function (key) { keys.push(key); },
+        onValue: function (value) {
+            values++;
+            // stop inside the array
+            return value !== 3;
+        }
+    });
+    tests.assert_eq(false, ok);
+    tests.assert_eq(2, keys.length);
+    tests.assert_eq(3, values);
+});
+
+tests.run("parseEvents keeps its source across allocations", function () {
+    let source = json.stringify({ key: "a value that the handler outlives", next: 2 });
+    let count = 0;
+    json.parseEvents(source, {
+        onValue: function (value) {
+            for (let i = 0; i < 200; i++) {
+                let garbage = { index: i, text: json.stringify([i, value]) };
+            }
+            count++;
+        }
+    });
+    tests.assert_eq(2, count);
+});
+
+tests.run("files", function () {
+    let path = "/ext/js_host_json.json";
+    let file = storage.openFile(path, "w", "create_always");
+    tests.assert_eq(true, json.stringify({ list: [1, 2, 3], name: "file" }, file));
+    file.close();
+    file = storage.openFile(path, "r", "open_existing");
+    let value = json.parse(file);
+    file.close();
+    storage.remove(path);
+    tests.assert_eq("file", value.name);
+    tests.assert_eq(3, value.list.length);
+});
+
+tests.run("parse throughput", function () {
+    let items = [];
+    for (let i = 0; i < 200; i++) {
+        items.push({ id: i, ok: true });
+    }
+    tests.assert_eq(200, json.parse(json.stringify(items)).length);
+});
+
+print(tests.summary());
@@ -0,0 +1,51 @@
+let tests = require("tests");
+let math = require("math");
+
+tests.run("constants", function () {
+    tests.assert_float_close(3.14159265, math.PI, 0.0000001);
+    tests.assert_float_close(2.71828182, math.E, 0.0000001);
+});
+
+tests.run("rounding", function () {
+    tests.assert_eq(2, math.floor(2.7));
+    tests.assert_eq(3, math.ceil(2.1));
+    tests.assert_eq(-2, math.trunc(-2.7));
+    tests.assert_eq(5, math.abs(-5));
+    tests.assert_eq(-1, math.sign(-0.5));
+    tests.assert_eq(0, math.sign(0));
+});
+
+tests.run("min and max", function () {
+    tests.assert_eq(1, math.min(3, 1));
+    tests.assert_eq(3, math.max(3, 1));
+});
+
+tests.run("powers and roots", function () {
+    tests.assert_eq(1024, math.pow(2, 10));
+    tests.assert_float_close(1.41421356, math.sqrt(2), 0.0000001);
+    tests.assert_float_close(3, math.cbrt(27), 0.0000001);
+    tests.assert_float_close(1, math.log(math.E), 0.0000001);
+    tests.assert_float_close(math.E, math.exp(1), 0.0000001);
+    tests.assert_eq(31, math.clz32(1));
+});
+
+tests.run("trigonometry", function () {
+    tests.assert_float_close(0, math.sin(0), 0.0000001);
+    tests.assert_float_close(-1, math.cos(math.PI), 0.0000001);
+    tests.assert_float_close(math.PI / 4, math.atan2(1, 1), 0.0000001);
+    tests.assert_float_close(math.PI / 2, math.asin(1), 0.0000001);
+});
+
+tests.run("isEqual", function () {
+    tests.assert_eq(true, math.isEqual(0.1 + 0.2, 0.3, math.EPSILON));
+    tests.assert_eq(false, math.isEqual(1, 1.1, math.EPSILON));
+});
+
+tests.run("random", function () {
+    for (let i = 0; i < 100; i++) {
+        let value = math.random();
+        tests.assert_eq(true, value >= 0 && value < 1);
+    }
+});
+
+print(tests.summary());
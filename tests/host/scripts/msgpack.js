@@ -0,0 +1,109 @@
+let tests = require("tests");
+let msgpack = require("msgpack");
+let storage = require("storage");
+
+let sample = {
+    small: 5,
+    negative: -33,
+    wide: 70000,
+    float: 1.5,
+    text: "hello",
+    flag: true,
+    nothing: null,
+    list: [1, "two", [3]],
+    nested: { depth: { more: "yes" } }
+};
+
+function checkSample(value) {
+    tests.assert_eq(5, value.small);
+    tests.assert_eq(-33, value.negative);
+    tests.assert_eq(70000, value.wide);
+    tests.assert_float_close(1.5, value.float, 0);
+    tests.assert_eq("hello", value.text);
+    tests.assert_eq(true, value.flag);
+    tests.assert_eq(true, value.nothing === null);
+    tests.assert_eq(3, value.list.length);
+    tests.assert_eq("two", value.list[1]);
+    tests.assert_eq(3, value.list[2][0]);
+    tests.assert_eq("yes", value.nested.depth.more);
+}
+
+tests.run("smallest forms", function () {
+    tests.assert_eq(1, msgpack.encode(5).byteLength);
+    tests.assert_eq(1, msgpack.encode(-5).byteLength);
+    tests.assert_eq(2, msgpack.encode(200).byteLength);
+    tests.assert_eq(3, msgpack.encode(-1000).byteLength);
+    tests.assert_eq(5, msgpack.encode(1.5).byteLength);
+    tests.assert_eq(6, msgpack.encode("hello").byteLength);
+});
+
+tests.run("round trip", function () {
+    checkSample(msgpack.decode(msgpack.encode(sample)));
+});
+
+tests.run("binary round trip", function () {
+    let bytes = msgpack.encode("abc");
+    let copy = msgpack.decode(msgpack.encode(bytes));
+    tests.assert_eq(bytes.byteLength, copy.byteLength);
+    tests.assert_eq("abc", msgpack.decode(copy));
+});
+
+tests.run("truncated input waits for more", function () {
+    let bytes = msgpack.encode(sample);
+    let decoder = msgpack.decoder();
+    let values = decoder.push(bytes.slice(0, bytes.byteLength - 1));
+    tests.assert_eq(0, values.length);
+    tests.assert_eq(bytes.byteLength - 1, decoder.pending.byteLength);
+    values = decoder.push(bytes.slice(bytes.byteLength - 1, bytes.byteLength));
+    tests.assert_eq(1, values.length);
+    tests.assert_eq(0, decoder.pending.byteLength);
+    checkSample(values[0]);
+});
+
+tests.run("byte at a time", function () {
+    let bytes = msgpack.encode([sample, "second", 3]);
+    let decoder = msgpack.decoder();
+    let values = [];
+    for (let i = 0; i < bytes.byteLength; i++) {
+        let done = decoder.push(bytes.slice(i, i + 1));
+        for (let j = 0; j < done.length; j++) values.push(done[j]);
+    }
+    tests.assert_eq(1, values.length);
+    checkSample(values[0][0]);
+    tests.assert_eq("second", values[0][1]);
+    tests.assert_eq(3, values[0][2]);
+});
+
+tests.run("several values per push", function () {
+    let decoder = msgpack.decoder();
+    let first = msgpack.encode("one");
+    let second = msgpack.encode(2);
+    let values = decoder.push(first);
+    values = decoder.push(second);
+    tests.assert_eq(1, values.length);
+    tests.assert_eq(2, values[0]);
+});
+
+tests.run("files", function () {
+    let path = "/ext/js_host_msgpack.bin";
+    let file = storage.openFile(path, "w", "create_always");
+    tests.assert_eq(true, msgpack.encode(sample, file));
+    tests.assert_eq(true, msgpack.encode("after", file));
+    file.close();
+    file = storage.openFile(path, "r", "open_existing");
+    checkSample(msgpack.decode(file));
+    tests.assert_eq("after", msgpack.decode(file));
+    tests.assert_eq(true, msgpack.decode(file) === undefined);
+    file.close();
+    storage.remove(path);
+});
+
+tests.run("throughput", function () {
+    let bytes = msgpack.encode(sample);
+    for (let i = 0; i < 200; i++) {
+        bytes = msgpack.encode(msgpack.decode(bytes));
+    }
+    checkSample(msgpack.decode(bytes));
+});
+
+print(tests.summary());
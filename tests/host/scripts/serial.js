@@ -0,0 +1,54 @@
+// The host serial port loops its output back to its input, and reads of an
+// empty buffer time out at once, so each test writes what it reads
+let tests = require("tests");
+let serial = require("serial");
+
+serial.setup("usart", 115200, { dataBits: "8", parity: "none", stopBits: "1" });
+
+tests.run("read", function () {
+    serial.write("hello");
+    tests.assert_eq("hel", serial.read(3, 0));
+    tests.assert_eq("lo", serial.read(10, 0));
+    tests.assert_eq(true, serial.read(1, 0) === undefined);
+});
+
+tests.run("readln", function () {
+    serial.write("first\nsecond\n");
+    tests.assert_eq("first", serial.readln(0));
+    tests.assert_eq("second", serial.readln(0));
+});
+
+tests.run("write numbers and arrays", function () {
+    serial.write(0x41, 0x42);
+    serial.write([0x43, 0x44]);
+    tests.assert_eq("ABCD", serial.read(4, 0));
+});
+
+tests.run("readBytes", function () {
+    serial.write([1, 2, 3, 4]);
+    tests.assert_eq(4, serial.readBytes(4, 0).byteLength);
+});
+
+tests.run("readAny", function () {
+    serial.write("xyz");
+    tests.assert_eq("xyz", serial.readAny(0));
+});
+
+tests.run("expect", function () {
+    serial.write("noise OK");
+    tests.assert_eq(0, serial.expect("OK", 0));
+    serial.write("ERROR");
+    tests.assert_eq(1, serial.expect(["OK", "ERROR"], 0));
+    tests.assert_eq(true, serial.expect("OK", 0) === undefined);
+});
+
+tests.run("loopback throughput", function () {
+    let line = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcde";
+    for (let i = 0; i < 100; i++) {
+        serial.write(line + "\n");
+        tests.assert_eq(line, serial.readln(0));
+    }
+});
+
+serial.end();
+print(tests.summary());
@@ -0,0 +1,95 @@
+let tests = require("tests");
+let storage = require("storage");
+
+let dir = "/ext/js_host";
+storage.rmrf(dir);
+
+tests.run("directories", function () {
+    tests.assert_eq(true, storage.makeDirectory(dir));
+    tests.assert_eq(true, storage.directoryExists(dir));
+    tests.assert_eq(false, storage.fileExists(dir));
+    tests.assert_eq(0, storage.readDirectory(dir).length);
+});
+
+tests.run("write and read back", function () {
+    let file = storage.openFile(dir + "/a.txt", "w", "create_always");
+    tests.assert_eq(true, file.isOpen());
+    tests.assert_eq(11, file.write("hello world"));
+    file.close();
+    tests.assert_eq(false, file.isOpen());
+
+    file = storage.openFile(dir + "/a.txt", "r", "open_existing");
+    tests.assert_eq(11, file.size());
+    tests.assert_eq("hello", file.read("ascii", 5));
+    tests.assert_eq(5, file.tell());
+    file.seekRelative(1);
+    tests.assert_eq("world", file.read("ascii", 100));
+    tests.assert_eq(true, file.eof());
+    file.seekAbsolute(0);
+    tests.assert_eq(11, file.read("binary", 11).byteLength);
+    file.close();
+});
+
+tests.run("append and truncate", function () {
+    let file = storage.openFile(dir + "/a.txt", "rw", "open_append");
+    file.write("!");
+    tests.assert_eq(12, file.size());
+    file.seekAbsolute(5);
+    file.truncate();
+    tests.assert_eq(5, file.size());
+    file.close();
+});
+
+tests.run("open missing file", function () {
+    tests.assert_eq(true, storage.openFile(dir + "/none", "r", "open_existing") === undefined);
+});
+
+tests.run("stat and listing", function () {
+    let info = storage.stat(dir + "/a.txt");
+    tests.assert_eq(5, info.size);
+    tests.assert_eq(false, info.isDirectory);
+    let entries = storage.readDirectory(dir);
+    tests.assert_eq(1, entries.length);
+    tests.assert_eq("a.txt", entries[0].path);
+});
+
+tests.run("copy, rename and remove", function () {
+    tests.assert_eq(true, storage.copy(dir + "/a.txt", dir + "/b.txt"));
+    tests.assert_eq(true, storage.copy(dir + "/a.txt", dir + "/b.txt"));
+    tests.assert_eq(true, storage.rename(dir + "/b.txt", dir + "/c.txt"));
+    tests.assert_eq(false, storage.fileExists(dir + "/b.txt"));
+    tests.assert_eq(true, storage.fileOrDirExists(dir + "/c.txt"));
+    tests.assert_eq(true, storage.remove(dir + "/c.txt"));
+    tests.assert_eq(false, storage.fileExists(dir + "/c.txt"));
+});
+
+tests.run("copyTo", function () {
+    let src = storage.openFile(dir + "/a.txt", "r", "open_existing");
+    let dst = storage.openFile(dir + "/d.txt", "w", "create_always");
+    src.copyTo(dst, 3);
+    dst.close();
+    src.close();
+    tests.assert_eq(3, storage.stat(dir + "/d.txt").size);
+});
+
+tests.run("paths", function () {
+    tests.assert_eq("a1", storage.nextAvailableFilename(dir, "a", ".txt", 16));
+    tests.assert_eq("e", storage.nextAvailableFilename(dir, "e", ".txt", 16));
+    tests.assert_eq(true, storage.arePathsEqual(dir + "/a.txt", dir + "/a.txt"));
+    tests.assert_eq(true, storage.isSubpathOf(dir, dir + "/a.txt"));
+    tests.assert_eq(false, storage.isSubpathOf(dir + "/a.txt", dir));
+});
+
+tests.run("write throughput", function () {
+    let chunk = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+    let file = storage.openFile(dir + "/big.bin", "w", "create_always");
+    for (let i = 0; i < 256; i++) {
+        file.write(chunk);
+    }
+    file.close();
+    tests.assert_eq(16384, storage.stat(dir + "/big.bin").size);
+});
+
+tests.assert_eq(true, storage.rmrf(dir));
+tests.assert_eq(false, storage.directoryExists(dir));
+print(tests.summary());
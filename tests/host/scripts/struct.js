@@ -0,0 +1,69 @@
+let tests = require("tests");
+let struct = require("struct");
+
+tests.run("pack and unpack", function () {
+    let layout = struct.compile("<HhIf4s");
+    tests.assert_eq(16, layout.size);
+    let record = layout.unpack(layout.pack([513, -2, 70000, 1.5, "ab"]));
+    tests.assert_eq(513, record[0]);
+    tests.assert_eq(-2, record[1]);
+    tests.assert_eq(70000, record[2]);
+    tests.assert_float_close(1.5, record[3], 0);
+    tests.assert_eq("ab", record[4]);
+});
+
+tests.run("byte order", function () {
+    let little = struct.compile("<H").pack([1]);
+    let big = struct.compile(">H").pack([1]);
+    tests.assert_eq(1, struct.compile("B").unpack(little)[0]);
+    tests.assert_eq(0, struct.compile("B").unpack(big)[0]);
+    tests.assert_eq(256, struct.compile("<H").unpack(big)[0]);
+});
+
+tests.run("names", function () {
+    let layout = struct.compile("<B2xH", ["id", "value"]);
+    let record = layout.unpack(layout.pack({ id: 7, value: 1000 }));
+    tests.assert_eq(7, record.id);
+    tests.assert_eq(1000, record.value);
+});
+
+tests.run("names are copied at compile time", function () {
+    let names = ["id", "value"];
+    let layout = struct.compile("<BH", names);
+    layout.names = [1];
+    names[0] = 2;
+    let record = layout.unpack(layout.pack({ id: 3, value: 4 }));
+    tests.assert_eq(3, record.id);
+    tests.assert_eq(4, record.value);
+});
+
+tests.run("unpackArray", function () {
+    let layout = struct.compile("<H");
+    let buf = struct.compile("<HHH").pack([1, 2, 3]);
+    let records = layout.unpackArray(buf, 2, 2);
+    tests.assert_eq(2, records.length);
+    tests.assert_eq(2, records[0][0]);
+    tests.assert_eq(3, records[1][0]);
+});
+
+tests.run("pack in place", function () {
+    let layout = struct.compile("<I");
+    let buf = struct.compile("<II").pack([0, 0]);
+    layout.pack([123456], buf, 4);
+    tests.assert_eq(123456, struct.compile("<II").unpack(buf)[1]);
+});
+
+tests.run("throughput", function () {
+    let layout = struct.compile("<HHIf", ["a", "b", "c", "d"]);
+    let records = [];
+    for (let i = 0; i < 100; i++) {
+        records.push(layout.pack({ a: i, b: i * 2, c: i * 1000, d: i / 4 }));
+    }
+    let sum = 0;
+    for (let i = 0; i < 100; i++) {
+        sum += layout.unpack(records[i]).b;
+    }
+    tests.assert_eq(9900, sum);
+});
+
+print(tests.summary());
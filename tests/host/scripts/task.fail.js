@@ -0,0 +1,22 @@
+// A step that fails stops the loop and the script with its error. Its task
+// doesn't finish and no other task gets a turn, so any other error here
+// fails the test.
+let tests = require("tests");
+let eventLoop = require("event_loop");
+
+let steps = 0;
+eventLoop.task(function (state) {
+    steps++;
+    if (steps < 3) return true;
+    tests.fail("expected failure: the third step");
+    return true;
+}, undefined, {
+    onDone: function () { tests.fail("onDone of a failed task was called"); }
+});
+eventLoop.task(function (state) {
+    tests.fail("a task ran after another one has failed");
+    return false;
+}, undefined);
+
+eventLoop.run();
+tests.fail("run() returned after a failed step");
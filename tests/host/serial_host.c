@@ -0,0 +1,90 @@
+#include <furi_hal.h>
+
+struct FuriHalSerialHandle {
+    bool acquired;
+    uint32_t baud;
+    FuriHalSerialAsyncRxCallback rx_callback;
+    void* rx_context;
+    uint8_t rx_byte; //<! The byte that the receive callback is being told about
+    bool rx_available;
+};
+
+static FuriHalSerialHandle furi_hal_serial_handles[FuriHalSerialIdMax];
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id) {
+    furi_check(serial_id < FuriHalSerialIdMax);
+    FuriHalSerialHandle* handle = &furi_hal_serial_handles[serial_id];
+    if(handle->acquired) return NULL;
+    memset(handle, 0, sizeof(FuriHalSerialHandle));
+    handle->acquired = true;
+    return handle;
+}
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle) {
+    furi_check(handle->acquired);
+    furi_check(!handle->rx_callback);
+    handle->acquired = false;
+}
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud) {
+    furi_check(handle->acquired);
+    handle->baud = baud;
+}
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle) {
+    handle->baud = 0;
+}
+
+void furi_hal_serial_configure_framing(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialDataBits data_bits,
+    FuriHalSerialParity parity,
+    FuriHalSerialStopBits stop_bits) {
+    UNUSED(data_bits);
+    UNUSED(parity);
+    UNUSED(stop_bits);
+    furi_check(handle->baud);
+}
+
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size) {
+    furi_check(handle->baud);
+    for(size_t i = 0; i < buffer_size; i++) {
+        // a port that isn't receiving drops the byte, like an idle line would
+        if(!handle->rx_callback) continue;
+        handle->rx_byte = buffer[i];
+        handle->rx_available = true;
+        handle->rx_callback(handle, FuriHalSerialRxEventData, handle->rx_context);
+        handle->rx_available = false;
+    }
+}
+
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors) {
+    UNUSED(report_errors);
+    furi_check(handle->baud);
+    furi_check(callback);
+    handle->rx_callback = callback;
+    handle->rx_context = context;
+}
+
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle) {
+    handle->rx_callback = NULL;
+    handle->rx_context = NULL;
+}
+
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle) {
+    furi_check(handle->rx_available);
+    handle->rx_available = false;
+    return handle->rx_byte;
+}
+
+bool furi_hal_serial_async_rx_available(FuriHalSerialHandle* handle) {
+    return handle->rx_available;
+}
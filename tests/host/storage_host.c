@@ -0,0 +1,486 @@
+#include <storage/storage.h>
+#include <path.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+struct File {
+    int fd;
+    DIR* dir;
+    FuriString* path; //<! Host path of an open directory
+};
+
+static FuriString* storage_host_root = NULL;
+
+void storage_host_set_root(const char* root) {
+    if(!storage_host_root) storage_host_root = furi_string_alloc();
+    furi_string_set_str(storage_host_root, root);
+}
+
+/**
+ * @brief Maps a device path to the host. Storage paths are put under the
+ * root, the rest is left as it is.
+ */
+static FuriString* storage_host_path(const char* path) {
+    static const char* const prefixes[] = {
+        STORAGE_EXT_PATH_PREFIX,
+        STORAGE_INT_PATH_PREFIX,
+        STORAGE_APP_DATA_PATH_PREFIX,
+    };
+
+    FuriString* host_path = furi_string_alloc_set_str(path);
+    for(size_t i = 0; i < COUNT_OF(prefixes); i++) {
+        size_t prefix_len = strlen(prefixes[i]);
+        if(strncmp(path, prefixes[i], prefix_len) != 0) continue;
+        if(path[prefix_len] != '/' && path[prefix_len] != '\0') continue;
+        furi_check(storage_host_root);
+        furi_string_printf(host_path, "%s%s", furi_string_get_cstr(storage_host_root), path);
+        break;
+    }
+
+    // the FAT driver doesn't mind a trailing slash, stat() and friends do
+    while(furi_string_size(host_path) > 1 &&
+          furi_string_get_char(host_path, furi_string_size(host_path) - 1) == '/') {
+        furi_string_left(host_path, furi_string_size(host_path) - 1);
+    }
+    return host_path;
+}
+
+static FS_Error storage_host_error(int error) {
+    switch(error) {
+    case 0:
+        return FSE_OK;
+    case EEXIST:
+    case ENOTEMPTY:
+        return FSE_EXIST;
+    case ENOENT:
+    case ENOTDIR:
+        return FSE_NOT_EXIST;
+    case EACCES:
+    case EPERM:
+    case EISDIR:
+        return FSE_DENIED;
+    case ENAMETOOLONG:
+    case EINVAL:
+        return FSE_INVALID_NAME;
+    default:
+        return FSE_INTERNAL;
+    }
+}
+
+static FS_Error storage_host_stat(const char* path, struct stat* st) {
+    FuriString* host_path = storage_host_path(path);
+    int result = stat(furi_string_get_cstr(host_path), st);
+    furi_string_free(host_path);
+    return result == 0 ? FSE_OK : storage_host_error(errno);
+}
+
+bool file_info_is_dir(const FileInfo* file_info) {
+    return file_info->flags & FSF_DIRECTORY;
+}
+
+// =====
+// Files
+// =====
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    File* file = malloc(sizeof(File));
+    file->fd = -1;
+    file->dir = NULL;
+    file->path = furi_string_alloc();
+    return file;
+}
+
+void storage_file_free(File* file) {
+    if(file->fd >= 0) storage_file_close(file);
+    if(file->dir) storage_dir_close(file);
+    furi_string_free(file->path);
+    free(file);
+}
+
+bool storage_file_open(
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    furi_check(file->fd < 0 && !file->dir);
+
+    int flags = 0;
+    switch(access_mode) {
+    case FSAM_READ:
+        flags = O_RDONLY;
+        break;
+    case FSAM_WRITE:
+        flags = O_WRONLY;
+        break;
+    case FSAM_READ_WRITE:
+        flags = O_RDWR;
+        break;
+    }
+    switch(open_mode) {
+    case FSOM_OPEN_EXISTING:
+        break;
+    case FSOM_OPEN_ALWAYS:
+    case FSOM_OPEN_APPEND:
+        flags |= O_CREAT;
+        break;
+    case FSOM_CREATE_NEW:
+        flags |= O_CREAT | O_EXCL;
+        break;
+    case FSOM_CREATE_ALWAYS:
+        flags |= O_CREAT | O_TRUNC;
+        break;
+    }
+
+    FuriString* host_path = storage_host_path(path);
+    file->fd = open(furi_string_get_cstr(host_path), flags, 0644);
+    furi_string_free(host_path);
+    if(file->fd < 0) return false;
+
+    // an appended file starts at the end, but can seek back unlike O_APPEND
+    if(open_mode == FSOM_OPEN_APPEND) lseek(file->fd, 0, SEEK_END);
+    return true;
+}
+
+bool storage_file_close(File* file) {
+    if(file->fd < 0) return false;
+    bool closed = close(file->fd) == 0;
+    file->fd = -1;
+    return closed;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->fd >= 0 || file->dir;
+}
+
+bool storage_file_is_dir(File* file) {
+    return file->dir != NULL;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    size_t total = 0;
+    while(total < bytes_to_read) {
+        ssize_t got = read(file->fd, (uint8_t*)buff + total, bytes_to_read - total);
+        if(got <= 0) break;
+        total += got;
+    }
+    return total;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    size_t total = 0;
+    while(total < bytes_to_write) {
+        ssize_t put = write(file->fd, (const uint8_t*)buff + total, bytes_to_write - total);
+        if(put <= 0) break;
+        total += put;
+    }
+    return total;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    if(from_start) return lseek(file->fd, offset, SEEK_SET) >= 0;
+    // like FatFs: the offset wraps around, and reading can't go past the end
+    uint32_t position = lseek(file->fd, 0, SEEK_CUR) + offset;
+    off_t size = lseek(file->fd, 0, SEEK_END);
+    return lseek(file->fd, MIN((off_t)position, size), SEEK_SET) >= 0;
+}
+
+uint64_t storage_file_tell(File* file) {
+    off_t position = lseek(file->fd, 0, SEEK_CUR);
+    return position < 0 ? 0 : (uint64_t)position;
+}
+
+bool storage_file_truncate(File* file) {
+    return ftruncate(file->fd, storage_file_tell(file)) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    struct stat st;
+    if(fstat(file->fd, &st) != 0) return 0;
+    return st.st_size;
+}
+
+bool storage_file_sync(File* file) {
+    return fsync(file->fd) == 0;
+}
+
+bool storage_file_eof(File* file) {
+    return storage_file_tell(file) >= storage_file_size(file);
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    struct stat st;
+    return storage_host_stat(path, &st) == FSE_OK && !S_ISDIR(st.st_mode);
+}
+
+bool storage_file_copy_to_file(File* source, File* destination, size_t size) {
+    uint8_t buffer[512];
+    while(size) {
+        size_t chunk = storage_file_read(source, buffer, MIN(size, sizeof(buffer)));
+        if(!chunk) break;
+        if(storage_file_write(destination, buffer, chunk) != chunk) return false;
+        size -= chunk;
+    }
+    return true;
+}
+
+// ===========
+// Directories
+// ===========
+
+bool storage_dir_open(File* file, const char* path) {
+    furi_check(file->fd < 0 && !file->dir);
+    FuriString* host_path = storage_host_path(path);
+    file->dir = opendir(furi_string_get_cstr(host_path));
+    furi_string_set(file->path, host_path);
+    furi_string_free(host_path);
+    return file->dir != NULL;
+}
+
+bool storage_dir_close(File* file) {
+    if(!file->dir) return false;
+    closedir(file->dir);
+    file->dir = NULL;
+    return true;
+}
+
+bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_length) {
+    if(!file->dir) return false;
+
+    struct dirent* entry;
+    do {
+        entry = readdir(file->dir);
+    } while(entry && (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0));
+    if(!entry) return false;
+
+    if(name) snprintf(name, name_length, "%s", entry->d_name);
+    if(fileinfo) {
+        FuriString* entry_path = furi_string_alloc_set(file->path);
+        path_append(entry_path, entry->d_name);
+        struct stat st = {0};
+        stat(furi_string_get_cstr(entry_path), &st);
+        furi_string_free(entry_path);
+        fileinfo->flags = S_ISDIR(st.st_mode) ? FSF_DIRECTORY : 0;
+        fileinfo->size = S_ISDIR(st.st_mode) ? 0 : st.st_size;
+    }
+    return true;
+}
+
+bool storage_dir_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    struct stat st;
+    return storage_host_stat(path, &st) == FSE_OK && S_ISDIR(st.st_mode);
+}
+
+// =================
+// Common operations
+// =================
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp) {
+    UNUSED(storage);
+    struct stat st;
+    FS_Error error = storage_host_stat(path, &st);
+    if(error == FSE_OK) *timestamp = st.st_mtime;
+    return error;
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    struct stat st;
+    FS_Error error = storage_host_stat(path, &st);
+    if(error == FSE_OK && fileinfo) {
+        fileinfo->flags = S_ISDIR(st.st_mode) ? FSF_DIRECTORY : 0;
+        fileinfo->size = S_ISDIR(st.st_mode) ? 0 : st.st_size;
+    }
+    return error;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    FuriString* host_path = storage_host_path(path);
+    int result = remove(furi_string_get_cstr(host_path));
+    furi_string_free(host_path);
+    return result == 0 ? FSE_OK : storage_host_error(errno);
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    if(storage_common_exists(storage, new_path)) return FSE_EXIST;
+    FuriString* host_old = storage_host_path(old_path);
+    FuriString* host_new = storage_host_path(new_path);
+    int result = rename(furi_string_get_cstr(host_old), furi_string_get_cstr(host_new));
+    furi_string_free(host_old);
+    furi_string_free(host_new);
+    return result == 0 ? FSE_OK : storage_host_error(errno);
+}
+
+FS_Error storage_common_copy(Storage* storage, const char* old_path, const char* new_path) {
+    if(storage_common_exists(storage, new_path)) return FSE_EXIST;
+
+    FileInfo info;
+    FS_Error error = storage_common_stat(storage, old_path, &info);
+    if(error != FSE_OK) return error;
+
+    if(file_info_is_dir(&info)) {
+        error = storage_common_mkdir(storage, new_path);
+        File* dir = storage_file_alloc(storage);
+        if(error == FSE_OK && !storage_dir_open(dir, old_path)) error = FSE_INTERNAL;
+        char name[256];
+        FuriString* old_child = furi_string_alloc();
+        FuriString* new_child = furi_string_alloc();
+        while(error == FSE_OK && storage_dir_read(dir, NULL, name, sizeof(name))) {
+            furi_string_set_str(old_child, old_path);
+            path_append(old_child, name);
+            furi_string_set_str(new_child, new_path);
+            path_append(new_child, name);
+            error = storage_common_copy(
+                storage, furi_string_get_cstr(old_child), furi_string_get_cstr(new_child));
+        }
+        furi_string_free(old_child);
+        furi_string_free(new_child);
+        storage_file_free(dir);
+        return error;
+    }
+
+    File* source = storage_file_alloc(storage);
+    File* destination = storage_file_alloc(storage);
+    error = FSE_INTERNAL;
+    if(storage_file_open(source, old_path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_open(destination, new_path, FSAM_WRITE, FSOM_CREATE_NEW) &&
+       storage_file_copy_to_file(source, destination, info.size)) {
+        error = FSE_OK;
+    }
+    storage_file_free(source);
+    storage_file_free(destination);
+    return error;
+}
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    FuriString* host_path = storage_host_path(path);
+    int result = mkdir(furi_string_get_cstr(host_path), 0755);
+    furi_string_free(host_path);
+    return result == 0 ? FSE_OK : storage_host_error(errno);
+}
+
+FS_Error storage_common_fs_info(
+    Storage* storage,
+    const char* fs_path,
+    uint64_t* total_space,
+    uint64_t* free_space) {
+    UNUSED(storage);
+    FuriString* host_path = storage_host_path(fs_path);
+    struct statvfs st;
+    int result = statvfs(furi_string_get_cstr(host_path), &st);
+    furi_string_free(host_path);
+    if(result != 0) return storage_host_error(errno);
+    if(total_space) *total_space = (uint64_t)st.f_blocks * st.f_frsize;
+    if(free_space) *free_space = (uint64_t)st.f_bavail * st.f_frsize;
+    return FSE_OK;
+}
+
+bool storage_common_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    struct stat st;
+    return storage_host_stat(path, &st) == FSE_OK;
+}
+
+bool storage_common_equivalent_path(Storage* storage, const char* path1, const char* path2) {
+    UNUSED(storage);
+    FuriString* host_path1 = storage_host_path(path1);
+    FuriString* host_path2 = storage_host_path(path2);
+    bool equivalent = furi_string_equal(host_path1, host_path2);
+    furi_string_free(host_path1);
+    furi_string_free(host_path2);
+    return equivalent;
+}
+
+bool storage_common_is_subdir(Storage* storage, const char* parent, const char* child) {
+    UNUSED(storage);
+    FuriString* host_parent = storage_host_path(parent);
+    FuriString* host_child = storage_host_path(child);
+    size_t parent_len = furi_string_size(host_parent);
+    const char* child_str = furi_string_get_cstr(host_child);
+    bool is_subdir = strncmp(furi_string_get_cstr(host_parent), child_str, parent_len) == 0 &&
+                     (child_str[parent_len] == '/' || child_str[parent_len] == '\0');
+    furi_string_free(host_parent);
+    furi_string_free(host_child);
+    return is_subdir;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    FS_Error error = storage_common_remove(storage, path);
+    return error == FSE_OK || error == FSE_NOT_EXIST;
+}
+
+bool storage_simply_remove_recursive(Storage* storage, const char* path) {
+    if(storage_dir_exists(storage, path)) {
+        File* dir = storage_file_alloc(storage);
+        bool removed = storage_dir_open(dir, path);
+        char name[256];
+        FuriString* child = furi_string_alloc();
+        while(removed && storage_dir_read(dir, NULL, name, sizeof(name))) {
+            furi_string_set_str(child, path);
+            path_append(child, name);
+            removed = storage_simply_remove_recursive(storage, furi_string_get_cstr(child));
+        }
+        furi_string_free(child);
+        storage_file_free(dir);
+        if(!removed) return false;
+    }
+    return storage_simply_remove(storage, path);
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    FS_Error error = storage_common_mkdir(storage, path);
+    return error == FSE_OK || error == FSE_EXIST;
+}
+
+void storage_get_next_filename(
+    Storage* storage,
+    const char* dirname,
+    const char* filename,
+    const char* fileextension,
+    FuriString* nextfilename,
+    uint8_t max_len) {
+    FuriString* path = furi_string_alloc_printf("%s/%s%s", dirname, filename, fileextension);
+    uint32_t num = 0;
+    while(storage_common_exists(storage, furi_string_get_cstr(path))) {
+        num++;
+        furi_string_printf(
+            path, "%s/%s%lu%s", dirname, filename, (unsigned long)num, fileextension);
+    }
+
+    if(num) {
+        furi_string_printf(nextfilename, "%s%lu", filename, (unsigned long)num);
+    } else {
+        furi_string_printf(nextfilename, "%s", filename);
+    }
+    if(max_len && furi_string_size(nextfilename) > max_len) {
+        furi_string_left(nextfilename, max_len);
+    }
+    furi_string_free(path);
+}
+
+// ====
+// Path
+// ====
+
+void path_append(FuriString* path, const char* suffix) {
+    size_t size = furi_string_size(path);
+    if(size && furi_string_get_char(path, size - 1) != '/') furi_string_push_back(path, '/');
+    furi_string_cat_str(path, suffix);
+}
+
+void path_extract_dirname(const char* path, FuriString* dirname) {
+    const char* separator = strrchr(path, '/');
+    if(separator) {
+        furi_string_set_strn(dirname, path, separator - path);
+    } else {
+        furi_string_set_str(dirname, path);
+    }
+}
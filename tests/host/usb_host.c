@@ -0,0 +1,66 @@
+#include <furi_hal.h>
+
+struct FuriHalUsbInterface {
+    const char* name;
+};
+
+FuriHalUsbInterface usb_cdc_single = {.name = "cdc_single"};
+FuriHalUsbInterface usb_hid = {.name = "hid"};
+
+static FuriHalUsbInterface* furi_hal_usb_config = &usb_cdc_single;
+
+typedef struct {
+    uint8_t mods;
+    uint8_t keys[HID_KB_MAX_KEYS];
+} FuriHalHidReport;
+
+static FuriHalHidReport furi_hal_hid_report;
+
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx) {
+    UNUSED(ctx);
+    furi_check(new_if);
+    furi_hal_usb_config = new_if;
+    memset(&furi_hal_hid_report, 0, sizeof(furi_hal_hid_report));
+    return true;
+}
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void) {
+    return furi_hal_usb_config;
+}
+
+bool furi_hal_hid_is_connected(void) {
+    return furi_hal_usb_config == &usb_hid;
+}
+
+uint8_t furi_hal_hid_get_led_state(void) {
+    return HID_KB_LED_NUM;
+}
+
+bool furi_hal_hid_kb_press(uint16_t button) {
+    uint8_t key = button & 0xFF;
+    for(size_t i = 0; key && i < HID_KB_MAX_KEYS; i++) {
+        if(furi_hal_hid_report.keys[i] == 0) {
+            furi_hal_hid_report.keys[i] = key;
+            break;
+        }
+    }
+    furi_hal_hid_report.mods |= button >> 8;
+    return furi_hal_hid_is_connected();
+}
+
+bool furi_hal_hid_kb_release(uint16_t button) {
+    uint8_t key = button & 0xFF;
+    for(size_t i = 0; key && i < HID_KB_MAX_KEYS; i++) {
+        if(furi_hal_hid_report.keys[i] == key) {
+            furi_hal_hid_report.keys[i] = 0;
+            break;
+        }
+    }
+    furi_hal_hid_report.mods &= ~(button >> 8);
+    return furi_hal_hid_is_connected();
+}
+
+bool furi_hal_hid_kb_release_all(void) {
+    memset(&furi_hal_hid_report, 0, sizeof(furi_hal_hid_report));
+    return furi_hal_hid_is_connected();
+}
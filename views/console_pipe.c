@@ -0,0 +1,250 @@
+#include "console_pipe.h"
+#include <furi.h>
+#include <storage/storage.h>
+#include <toolbox/path.h>
+
+#define TAG "ConsolePipe"
+
+#define CONSOLE_PIPE_SIZE       2048 //<! Must be a power of 2
+#define CONSOLE_PIPE_LINE_MAX   255
+#define CONSOLE_PIPE_HEADER     sizeof(uint8_t)
+#define CONSOLE_PIPE_SHOW_MAX   8 //<! Lines shown per drain, older ones only go to the log
+#define CONSOLE_LOG_SIZE_MAX    (16 * 1024)
+#define CONSOLE_LOG_BATCH_MAX   512
+#define CONSOLE_PIPE_BURST      32 //<! Lines that producers may print at once
+#define CONSOLE_PIPE_TICK_LINES 1 //<! Lines per tick that producers get back
+
+struct JsConsolePipe {
+    JsConsoleView* console_view;
+
+    // ring: `head` is only written by producers, `tail` by the GUI thread
+    uint8_t ring[CONSOLE_PIPE_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+
+    // producer side, serialized since workers and the GUI print too
+    FuriMutex* producer_mutex;
+    char last[CONSOLE_PIPE_LINE_MAX];
+    size_t last_len;
+    uint32_t repeats;
+    uint32_t tokens; //<! Lines that may still be queued before the rate limit applies
+    uint32_t token_tick; //<! Tick at which `tokens` was last refilled
+
+    // consumer side
+    char line[CONSOLE_PIPE_LINE_MAX + 1];
+    FuriString* log_path;
+    Storage* storage;
+    File* log;
+    size_t log_size;
+    char log_batch[CONSOLE_LOG_BATCH_MAX];
+    size_t log_batch_len;
+};
+
+static void
+    console_pipe_ring_write(JsConsolePipe* pipe, uint32_t at, const void* data, size_t len) {
+    size_t offset = at & (CONSOLE_PIPE_SIZE - 1);
+    size_t first = MIN(len, CONSOLE_PIPE_SIZE - offset);
+    memcpy(&pipe->ring[offset], data, first);
+    memcpy(pipe->ring, (const uint8_t*)data + first, len - first);
+}
+
+static void console_pipe_ring_read(JsConsolePipe* pipe, uint32_t at, void* data, size_t len) {
+    size_t offset = at & (CONSOLE_PIPE_SIZE - 1);
+    size_t first = MIN(len, CONSOLE_PIPE_SIZE - offset);
+    memcpy(data, &pipe->ring[offset], first);
+    memcpy((uint8_t*)data + first, pipe->ring, len - first);
+}
+
+/**
+ * @brief Appends a record to the ring, with the producer mutex held
+ * @returns false if the ring was full and the record has been dropped
+ */
+static bool console_pipe_put(JsConsolePipe* pipe, const char* text, size_t len) {
+    uint32_t head = pipe->head;
+    uint32_t tail = __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE);
+    if(CONSOLE_PIPE_SIZE - (head - tail) < CONSOLE_PIPE_HEADER + len) {
+        __atomic_fetch_add(&pipe->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    uint8_t header = len;
+    console_pipe_ring_write(pipe, head, &header, CONSOLE_PIPE_HEADER);
+    console_pipe_ring_write(pipe, head + CONSOLE_PIPE_HEADER, text, len);
+    __atomic_store_n(&pipe->head, head + CONSOLE_PIPE_HEADER + len, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Takes a token for one line, with the producer mutex held
+ *
+ * Producers may print `CONSOLE_PIPE_BURST` lines at once, and get
+ * `CONSOLE_PIPE_TICK_LINES` lines back per tick. Lines over that rate are
+ * dropped before they take ring space from the ones that can still be shown.
+ *
+ * @returns false if the line is over the rate and has been counted as dropped
+ */
+static bool console_pipe_take_token(JsConsolePipe* pipe) {
+    uint32_t now = furi_get_tick();
+    uint32_t ticks = MIN(now - pipe->token_tick, (uint32_t)CONSOLE_PIPE_BURST);
+    pipe->tokens = MIN(pipe->tokens + ticks * CONSOLE_PIPE_TICK_LINES, CONSOLE_PIPE_BURST);
+    pipe->token_tick = now;
+
+    if(!pipe->tokens) {
+        __atomic_fetch_add(&pipe->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    pipe->tokens--;
+    return true;
+}
+
+static void console_pipe_put_repeats(JsConsolePipe* pipe) {
+    if(!pipe->repeats) return;
+    char text[32];
+    int len = snprintf(text, sizeof(text), "  (repeated %lu times)", pipe->repeats);
+    console_pipe_put(pipe, text, len);
+    pipe->repeats = 0;
+}
+
+void console_pipe_print(JsConsolePipe* pipe, const char* text) {
+    size_t len = MIN(strlen(text), (size_t)CONSOLE_PIPE_LINE_MAX);
+
+    furi_mutex_acquire(pipe->producer_mutex, FuriWaitForever);
+    if(len == pipe->last_len && memcmp(text, pipe->last, len) == 0) {
+        pipe->repeats++;
+    } else {
+        console_pipe_put_repeats(pipe);
+        if(console_pipe_take_token(pipe) && console_pipe_put(pipe, text, len)) {
+            memcpy(pipe->last, text, len);
+            pipe->last_len = len;
+        } else {
+            // a dropped line isn't shown, so its repeats must not be folded
+            pipe->last_len = SIZE_MAX;
+        }
+    }
+    furi_mutex_release(pipe->producer_mutex);
+}
+
+void console_pipe_flush(JsConsolePipe* pipe) {
+    furi_mutex_acquire(pipe->producer_mutex, FuriWaitForever);
+    console_pipe_put_repeats(pipe);
+    // the next line is shown even if it repeats the last one
+    pipe->last_len = SIZE_MAX;
+    furi_mutex_release(pipe->producer_mutex);
+}
+
+static void console_pipe_log_write(JsConsolePipe* pipe) {
+    if(!pipe->log) pipe->log_batch_len = 0;
+    if(!pipe->log_batch_len) return;
+
+    if(pipe->log_size + pipe->log_batch_len > CONSOLE_LOG_SIZE_MAX) {
+        FuriString* old_path =
+            furi_string_alloc_printf("%s.1", furi_string_get_cstr(pipe->log_path));
+        storage_file_close(pipe->log);
+        storage_common_remove(pipe->storage, furi_string_get_cstr(old_path));
+        storage_common_rename(
+            pipe->storage, furi_string_get_cstr(pipe->log_path), furi_string_get_cstr(old_path));
+        furi_string_free(old_path);
+        if(!storage_file_open(
+               pipe->log, furi_string_get_cstr(pipe->log_path), FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+            FURI_LOG_E(TAG, "Failed to rotate %s", furi_string_get_cstr(pipe->log_path));
+            storage_file_free(pipe->log);
+            pipe->log = NULL;
+            pipe->log_batch_len = 0;
+            return;
+        }
+        pipe->log_size = 0;
+    }
+
+    pipe->log_size += storage_file_write(pipe->log, pipe->log_batch, pipe->log_batch_len);
+    pipe->log_batch_len = 0;
+}
+
+static void console_pipe_log_line(JsConsolePipe* pipe, const char* line, size_t len) {
+    if(pipe->log_batch_len + len + 1 > CONSOLE_LOG_BATCH_MAX) console_pipe_log_write(pipe);
+    memcpy(&pipe->log_batch[pipe->log_batch_len], line, len);
+    pipe->log_batch_len += len;
+    pipe->log_batch[pipe->log_batch_len++] = '\n';
+}
+
+void console_pipe_drain(JsConsolePipe* pipe) {
+    uint32_t tail = pipe->tail;
+    uint32_t head = __atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE);
+    uint32_t dropped = __atomic_exchange_n(&pipe->dropped, 0, __ATOMIC_RELAXED);
+    if(tail == head && !dropped) return;
+
+    // only the last lines of a burst would stay on screen anyway
+    size_t lines = 0;
+    for(uint32_t at = tail; at != head; lines++) {
+        uint8_t len;
+        console_pipe_ring_read(pipe, at, &len, CONSOLE_PIPE_HEADER);
+        at += CONSOLE_PIPE_HEADER + len;
+    }
+    size_t hidden = lines > CONSOLE_PIPE_SHOW_MAX ? lines - CONSOLE_PIPE_SHOW_MAX : 0;
+
+    if(dropped) {
+        int len = snprintf(pipe->line, sizeof(pipe->line), "[%lu lines dropped]", dropped);
+        console_pipe_log_line(pipe, pipe->line, len);
+        console_view_print(pipe->console_view, pipe->line);
+    }
+    if(hidden) {
+        snprintf(pipe->line, sizeof(pipe->line), "[%zu lines in log]", hidden);
+        console_view_print(pipe->console_view, pipe->line);
+    }
+
+    for(size_t i = 0; i < lines; i++) {
+        uint8_t len;
+        console_pipe_ring_read(pipe, tail, &len, CONSOLE_PIPE_HEADER);
+        console_pipe_ring_read(pipe, tail + CONSOLE_PIPE_HEADER, pipe->line, len);
+        pipe->line[len] = '\0';
+        tail += CONSOLE_PIPE_HEADER + len;
+        __atomic_store_n(&pipe->tail, tail, __ATOMIC_RELEASE);
+
+        console_pipe_log_line(pipe, pipe->line, len);
+        if(i >= hidden) console_view_print(pipe->console_view, pipe->line);
+    }
+
+    console_pipe_log_write(pipe);
+}
+
+JsConsolePipe* console_pipe_alloc(JsConsoleView* console_view, const char* log_path) {
+    JsConsolePipe* pipe = malloc(sizeof(JsConsolePipe));
+    pipe->console_view = console_view;
+    pipe->head = pipe->tail = pipe->dropped = 0;
+    pipe->producer_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    pipe->last_len = SIZE_MAX;
+    pipe->repeats = 0;
+    pipe->tokens = CONSOLE_PIPE_BURST;
+    pipe->token_tick = furi_get_tick();
+    pipe->log_batch_len = 0;
+
+    pipe->log_path = furi_string_alloc_set(log_path);
+    pipe->storage = furi_record_open(RECORD_STORAGE);
+    FuriString* log_dir = furi_string_alloc();
+    path_extract_dirname(log_path, log_dir);
+    storage_common_mkdir(pipe->storage, furi_string_get_cstr(log_dir));
+    furi_string_free(log_dir);
+
+    pipe->log = storage_file_alloc(pipe->storage);
+    if(storage_file_open(pipe->log, log_path, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        pipe->log_size = storage_file_size(pipe->log);
+    } else {
+        FURI_LOG_E(TAG, "Failed to open %s", log_path);
+        storage_file_free(pipe->log);
+        pipe->log = NULL;
+    }
+    return pipe;
+}
+
+void console_pipe_free(JsConsolePipe* pipe) {
+    console_pipe_flush(pipe);
+    console_pipe_drain(pipe);
+    if(pipe->log) {
+        storage_file_close(pipe->log);
+        storage_file_free(pipe->log);
+    }
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(pipe->log_path);
+    furi_mutex_free(pipe->producer_mutex);
+    free(pipe);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "console_view.h"
+
+/**
+ * Console output pipeline.
+ *
+ * Printing copies the line into a ring buffer and returns, the GUI thread
+ * drains the ring at frame rate with `console_pipe_drain`. A line that
+ * repeats the previous one is only counted, and reported once a different
+ * line arrives. Every line is appended to a size-capped log file that's
+ * rotated to `<log>.1`, while the console only shows the most recent lines
+ * of each frame. Producers share a line budget that refills every tick, and
+ * lines over it are dropped, as are lines that don't fit in the ring when
+ * it fills up faster than it's drained. The number of dropped lines is
+ * reported on the console and in the log.
+ */
+typedef struct JsConsolePipe JsConsolePipe;
+
+JsConsolePipe* console_pipe_alloc(JsConsoleView* console_view, const char* log_path);
+
+void console_pipe_free(JsConsolePipe* pipe);
+
+/**
+ * @brief Queues a line, can be called from any thread
+ */
+void console_pipe_print(JsConsolePipe* pipe, const char* text);
+
+/**
+ * @brief Queues the repeat count of the last line, if it's been repeated
+ */
+void console_pipe_flush(JsConsolePipe* pipe);
+
+/**
+ * @brief Shows and logs the queued lines, call from the GUI thread only
+ */
+void console_pipe_drain(JsConsolePipe* pipe);
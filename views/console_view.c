@@ -3,17 +3,47 @@
 
 #define CONSOLE_LINES   8
 #define CONSOLE_CHAR_W  5
-#define LINE_BREAKS_MAX 3
+#define LINE_BREAKS_MAX 15
 #define LINE_LEN_MAX    (128 / CONSOLE_CHAR_W)
+#define LINE_SIZE_AVG   16 //<! Estimate that sizes the line index for the arena
 
 struct JsConsoleView {
     View* view;
+    ViewNavigationCallback previous_callback;
+    void* previous_context;
 };
 
+/**
+ * Scrollback: lines are packed NUL-terminated into `arena`, which is used as
+ * a ring. A line never wraps around the end of the arena, the space left
+ * there is skipped instead. `offsets` is a ring of the arena offsets of the
+ * lines, oldest first. Pushing a line evicts the oldest ones that it would
+ * overwrite.
+ */
 typedef struct {
-    FuriString* text[CONSOLE_LINES];
+    char* arena;
+    size_t arena_size;
+    size_t head; //<! Arena offset of the next line
+    uint16_t* offsets;
+    size_t lines_max;
+    size_t first; //<! Slot in `offsets` of the oldest line
+    size_t count;
+    size_t scroll; //<! Lines scrolled up from the newest one
 } JsConsoleViewModel;
 
+static const char* console_view_line(JsConsoleViewModel* model, size_t index) {
+    return &model->arena[model->offsets[(model->first + index) % model->lines_max]];
+}
+
+static void console_view_evict(JsConsoleViewModel* model) {
+    model->first = (model->first + 1) % model->lines_max;
+    model->count--;
+}
+
+static size_t console_view_scroll_max(JsConsoleViewModel* model) {
+    return model->count > CONSOLE_LINES ? model->count - CONSOLE_LINES : 0;
+}
+
 static void console_view_draw_callback(Canvas* canvas, void* _model) {
     JsConsoleViewModel* model = _model;
 
@@ -21,125 +51,245 @@ static void console_view_draw_callback(Canvas* canvas, void* _model) {
     canvas_set_custom_u8g2_font(canvas, u8g2_font_spleen5x8_mr);
     uint8_t line_h = canvas_current_font_height(canvas);
 
-    for(size_t i = 0; i < CONSOLE_LINES; i++) {
-        canvas_draw_str(canvas, 0, (i + 1) * line_h - 1, furi_string_get_cstr(model->text[i]));
-        if(furi_string_size(model->text[i]) > LINE_LEN_MAX) {
+    // only the visible window is drawn, bottom-aligned like a terminal
+    size_t visible = MIN(model->count, (size_t)CONSOLE_LINES);
+    size_t top = model->count - visible - model->scroll;
+    size_t row = CONSOLE_LINES - visible;
+    for(size_t i = 0; i < visible; i++, row++) {
+        const char* text = console_view_line(model, top + i);
+        canvas_draw_str(canvas, 0, (row + 1) * line_h - 1, text);
+        if(strlen(text) > LINE_LEN_MAX) {
             canvas_set_font(canvas, FontSecondary);
-            canvas_draw_str(canvas, 128 - 7, (i + 1) * line_h - 1, "...");
+            canvas_draw_str(canvas, 128 - 7, (row + 1) * line_h - 1, "...");
             canvas_set_custom_u8g2_font(canvas, u8g2_font_spleen5x8_mr);
         }
     }
+
+    if(model->scroll) {
+        // scrollbar in the spare pixels on the right
+        size_t bar_h = MAX((size_t)2, 64 * CONSOLE_LINES / model->count);
+        size_t bar_y = (64 - bar_h) * top / console_view_scroll_max(model);
+        canvas_draw_line(canvas, 127, bar_y, 127, bar_y + bar_h - 1);
+    }
 }
 
 static bool console_view_input_callback(InputEvent* event, void* context) {
-    UNUSED(event);
-    UNUSED(context);
-    return false;
-}
+    JsConsoleView* console_view = context;
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) return false;
+    if(event->key != InputKeyUp && event->key != InputKeyDown) return false;
 
-void console_view_push_line(JsConsoleView* console_view, const char* text, bool line_trimmed) {
     with_view_model(
         console_view->view,
         JsConsoleViewModel * model,
         {
-            FuriString* str_temp = model->text[0];
-            for(size_t i = 0; i < CONSOLE_LINES - 1; i++) {
-                model->text[i] = model->text[i + 1];
-            }
-            if(!line_trimmed) {
-                furi_string_printf(str_temp, "%.*s", LINE_LEN_MAX, text);
+            size_t step = event->type == InputTypeRepeat ? CONSOLE_LINES / 2 : 1;
+            if(event->key == InputKeyUp) {
+                model->scroll = MIN(model->scroll + step, console_view_scroll_max(model));
             } else {
-                // Leave some space for dots
-                furi_string_printf(str_temp, "%.*s  ", LINE_LEN_MAX - 1, text);
+                model->scroll -= MIN(model->scroll, step);
             }
-            model->text[CONSOLE_LINES - 1] = str_temp;
         },
         true);
+    return true;
 }
 
-void console_view_print(JsConsoleView* console_view, const char* text) {
-    char line_buf[LINE_LEN_MAX + 1];
-    uint8_t line_buf_cnt = 0;
-    uint8_t utf8_bytes_left = 0;
-    uint8_t line_break_cnt = 0;
-    bool line_trim = false;
-
-    for(size_t i = 0; i < strlen(text); i++) {
-        if(text[i] & 0x80) { // UTF8 or another non-ascii character byte
-            if(utf8_bytes_left > 0) {
-                utf8_bytes_left--;
-                if(utf8_bytes_left == 0) {
-                    line_buf[line_buf_cnt++] = '?';
-                }
-            } else {
-                if((text[i] & 0xE0) == 0xC0) {
-                    utf8_bytes_left = 1;
-                } else if((text[i] & 0xF0) == 0xE0) {
-                    utf8_bytes_left = 2;
-                } else if((text[i] & 0xF8) == 0xF0) {
-                    utf8_bytes_left = 3;
-                } else {
-                    line_buf[line_buf_cnt++] = '?';
-                }
-            }
+static uint32_t console_view_previous_callback(void* context) {
+    JsConsoleView* console_view = context;
+    return console_view->previous_callback ?
+               console_view->previous_callback(console_view->previous_context) :
+               VIEW_NONE;
+}
+
+static void console_view_model_push(JsConsoleViewModel* model, const char* text, size_t len) {
+    size_t need = len + 1;
+    if(model->count == model->lines_max) console_view_evict(model);
+
+    // find room for the line, evicting the oldest ones
+    while(model->count) {
+        size_t oldest = model->offsets[model->first];
+        if(model->head > oldest) {
+            if(model->arena_size - model->head >= need) break;
+            model->head = 0;
+        } else if(oldest - model->head >= need) {
+            break;
         } else {
-            if(utf8_bytes_left > 0) {
-                utf8_bytes_left = 0;
-                line_buf[line_buf_cnt++] = '?';
-                if(line_buf_cnt >= LINE_LEN_MAX) {
-                    line_break_cnt++;
-                    if(line_break_cnt >= LINE_BREAKS_MAX) {
-                        line_trim = true;
-                        break;
-                    }
-                    line_buf[line_buf_cnt] = '\0';
-                    console_view_push_line(console_view, line_buf, false);
-                    line_buf_cnt = 1;
-                    line_buf[0] = ' ';
-                }
-            }
+            console_view_evict(model);
+        }
+    }
+    if(!model->count) model->head = 0;
+
+    memcpy(&model->arena[model->head], text, len);
+    model->arena[model->head + len] = '\0';
+    model->offsets[(model->first + model->count) % model->lines_max] = model->head;
+    model->count++;
+    model->head += need;
+
+    // keep a scrolled view on the same lines
+    if(model->scroll) model->scroll = MIN(model->scroll + 1, console_view_scroll_max(model));
+}
+
+/**
+ * @brief Glyphs of the font for Latin-1 letters U+00C0..U+00FF, without
+ * their accents
+ */
+static const char console_view_latin1_glyphs[] =
+    "AAAAAAACEEEEIIIIDNOOOOOxOUUUUYPs"
+    "aaaaaaaceeeeiiiidnooooo/ouuuuypy";
+
+/**
+ * @brief Maps a code point to a glyph of `u8g2_font_spleen5x8_mr`, which only
+ * has printable ASCII
+ * @returns the glyph, 0 to skip the code point, or '?' if there's no match
+ */
+static char console_view_glyph(uint32_t code_point) {
+    if(code_point >= ' ' && code_point < 0x7F) return code_point;
+    if(code_point >= 0xC0 && code_point <= 0xFF) return console_view_latin1_glyphs[code_point - 0xC0];
+
+    switch(code_point) {
+    case '\t':
+    case 0xA0: // no-break space
+        return ' ';
+    case '\r':
+        return 0;
+    case 0xB7: // middle dot
+    case 0x2026: // ellipsis
+        return '.';
+    case 0x2010 ... 0x2015: // hyphens and dashes
+    case 0x2212: // minus
+        return '-';
+    case 0x2018 ... 0x201B: // single quotes
+        return '\'';
+    case 0xAB: // guillemets
+    case 0xBB:
+    case 0x201C ... 0x201F: // double quotes
+        return '"';
+    case 0x2022: // bullet
+        return '*';
+    default:
+        return '?';
+    }
+}
+
+typedef struct {
+    JsConsoleViewModel* model;
+    char line[LINE_LEN_MAX + 2];
+    size_t len;
+    size_t breaks;
+} JsConsoleViewWrap;
 
-            if(text[i] == '\n') {
-                line_buf[line_buf_cnt] = '\0';
-                line_buf_cnt = 0;
-                console_view_push_line(console_view, line_buf, false);
+static void console_view_wrap_push(JsConsoleViewWrap* wrap, bool trimmed) {
+    if(trimmed) {
+        // Leave some space for dots
+        wrap->len = MIN(wrap->len, (size_t)LINE_LEN_MAX - 1);
+        wrap->line[wrap->len++] = ' ';
+        wrap->line[wrap->len++] = ' ';
+    }
+    console_view_model_push(wrap->model, wrap->line, wrap->len);
+}
+
+/**
+ * @brief Appends a glyph, breaking the line when it's full
+ * @returns false once the text has been broken too many times
+ */
+static bool console_view_wrap_put(JsConsoleViewWrap* wrap, char glyph) {
+    if(!glyph) return true;
+    if(glyph == '\n') {
+        console_view_wrap_push(wrap, false);
+        wrap->len = 0;
+        return true;
+    }
+
+    wrap->line[wrap->len++] = glyph;
+    if(wrap->len >= LINE_LEN_MAX) {
+        if(++wrap->breaks >= LINE_BREAKS_MAX) return false;
+        console_view_wrap_push(wrap, false);
+        wrap->line[0] = ' ';
+        wrap->len = 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes UTF-8 and wraps it into lines in one pass. Malformed
+ * sequences show as '?'.
+ */
+static void console_view_model_print(JsConsoleViewModel* model, const uint8_t* text, size_t len) {
+    JsConsoleViewWrap wrap = {.model = model, .len = 0, .breaks = 0};
+    uint32_t code_point = 0;
+    uint8_t continuation = 0; //<! Bytes left in the current sequence
+
+    bool fits = true;
+    for(size_t i = 0; fits && i < len; i++) {
+        uint8_t byte = text[i];
+        if((byte & 0xC0) == 0x80) {
+            if(!continuation) {
+                fits = console_view_wrap_put(&wrap, '?');
             } else {
-                line_buf[line_buf_cnt++] = text[i];
+                code_point = (code_point << 6) | (byte & 0x3F);
+                if(!--continuation) fits = console_view_wrap_put(&wrap, console_view_glyph(code_point));
             }
+            continue;
+        }
 
-            if(line_buf_cnt >= LINE_LEN_MAX) {
-                line_break_cnt++;
-                if(line_break_cnt >= LINE_BREAKS_MAX) {
-                    line_trim = true;
-                    break;
-                }
-                line_buf[line_buf_cnt] = '\0';
-                console_view_push_line(console_view, line_buf, false);
-                line_buf_cnt = 1;
-                line_buf[0] = ' ';
-            }
+        // a lead byte cuts short a pending sequence
+        if(continuation) {
+            continuation = 0;
+            fits = console_view_wrap_put(&wrap, '?');
+            if(!fits) break;
+        }
+
+        if(byte < 0x80) {
+            fits = console_view_wrap_put(&wrap, byte == '\n' ? '\n' : console_view_glyph(byte));
+        } else if((byte & 0xE0) == 0xC0) {
+            code_point = byte & 0x1F;
+            continuation = 1;
+        } else if((byte & 0xF0) == 0xE0) {
+            code_point = byte & 0x0F;
+            continuation = 2;
+        } else if((byte & 0xF8) == 0xF0) {
+            code_point = byte & 0x07;
+            continuation = 3;
+        } else {
+            fits = console_view_wrap_put(&wrap, '?');
         }
     }
-    if(line_buf_cnt > 0) {
-        line_buf[line_buf_cnt] = '\0';
-        console_view_push_line(console_view, line_buf, line_trim);
-    }
+    if(fits && continuation) fits = console_view_wrap_put(&wrap, '?');
+
+    if(wrap.len > 0) console_view_wrap_push(&wrap, !fits);
+}
+
+void console_view_print(JsConsoleView* console_view, const char* text) {
+    size_t len = strlen(text);
+    with_view_model(
+        console_view->view,
+        JsConsoleViewModel * model,
+        { console_view_model_print(model, (const uint8_t*)text, len); },
+        true);
 }
 
-JsConsoleView* console_view_alloc(void) {
+JsConsoleView* console_view_alloc(size_t scrollback_size) {
+    // offsets are 16 bits, and the arena must fit a full line
+    furi_check(scrollback_size > LINE_LEN_MAX + 2 && scrollback_size <= UINT16_MAX);
+
     JsConsoleView* console_view = malloc(sizeof(JsConsoleView));
     console_view->view = view_alloc();
+    console_view->previous_callback = NULL;
+    console_view->previous_context = NULL;
+    view_set_context(console_view->view, console_view);
     view_set_draw_callback(console_view->view, console_view_draw_callback);
     view_set_input_callback(console_view->view, console_view_input_callback);
+    view_set_previous_callback(console_view->view, console_view_previous_callback);
     view_allocate_model(console_view->view, ViewModelTypeLocking, sizeof(JsConsoleViewModel));
 
     with_view_model(
         console_view->view,
         JsConsoleViewModel * model,
         {
-            for(size_t i = 0; i < CONSOLE_LINES; i++) {
-                model->text[i] = furi_string_alloc();
-            }
+            model->arena_size = scrollback_size;
+            model->arena = malloc(scrollback_size);
+            model->lines_max = MAX(scrollback_size / LINE_SIZE_AVG, (size_t)CONSOLE_LINES);
+            model->offsets = malloc(model->lines_max * sizeof(uint16_t));
+            model->head = model->first = model->count = model->scroll = 0;
         },
         true);
     return console_view;
@@ -150,9 +300,8 @@ void console_view_free(JsConsoleView* console_view) {
         console_view->view,
         JsConsoleViewModel * model,
         {
-            for(size_t i = 0; i < CONSOLE_LINES; i++) {
-                furi_string_free(model->text[i]);
-            }
+            free(model->arena);
+            free(model->offsets);
         },
         false);
     view_free(console_view->view);
@@ -162,3 +311,11 @@ void console_view_free(JsConsoleView* console_view) {
 View* console_view_get_view(JsConsoleView* console_view) {
     return console_view->view;
 }
+
+void console_view_set_previous_callback(
+    JsConsoleView* console_view,
+    ViewNavigationCallback callback,
+    void* context) {
+    console_view->previous_callback = callback;
+    console_view->previous_context = context;
+}
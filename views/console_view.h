@@ -4,10 +4,29 @@
 
 typedef struct JsConsoleView JsConsoleView;
 
-JsConsoleView* console_view_alloc(void);
+/**
+ * @brief Scrollback size that keeps a few hundred typical lines
+ */
+#define CONSOLE_SCROLLBACK_SIZE_DEFAULT 4096
+
+/**
+ * @brief Allocates a console that scrolls back through output with Up/Down
+ * @param scrollback_size Bytes of output that are kept, at most 65535. The
+ * line index takes another eighth of that.
+ */
+JsConsoleView* console_view_alloc(size_t scrollback_size);
 
 void console_view_free(JsConsoleView* console_view);
 
 View* console_view_get_view(JsConsoleView* console_view);
 
+/**
+ * @brief Sets the navigation callback of the view. The view's own context is
+ * the console, so use this instead of `view_set_previous_callback`.
+ */
+void console_view_set_previous_callback(
+    JsConsoleView* console_view,
+    ViewNavigationCallback callback,
+    void* context);
+
 void console_view_print(JsConsoleView* console_view, const char* text);
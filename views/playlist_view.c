@@ -0,0 +1,216 @@
+#include "playlist_view.h"
+#include <furi.h>
+#include <gui/elements.h>
+
+#define PLAYLIST_VIEW_HEADER_H 12
+#define PLAYLIST_VIEW_ROW_H    13
+#define PLAYLIST_VIEW_ROWS     ((64 - PLAYLIST_VIEW_HEADER_H) / PLAYLIST_VIEW_ROW_H)
+#define PLAYLIST_VIEW_WIDTH    123 //<! Leaves room for the scrollbar
+
+struct JsPlaylistView {
+    View* view;
+    JsPlaylistViewCallback callback;
+    void* context;
+    ViewNavigationCallback previous_callback;
+    void* previous_context;
+};
+
+/**
+ * The rows are the playlist entries followed by the "Add Script" item, so
+ * there's always one to select.
+ */
+typedef struct {
+    Playlist* playlist;
+    size_t selected;
+    size_t top; //<! First row on screen
+} JsPlaylistViewModel;
+
+static size_t playlist_view_items(JsPlaylistViewModel* model) {
+    return playlist_count(model->playlist) + 1;
+}
+
+/**
+ * @brief Scrolls just enough for the selected row to be on screen
+ */
+static void playlist_view_scroll(JsPlaylistViewModel* model) {
+    size_t items = playlist_view_items(model);
+    if(model->selected >= items) model->selected = items - 1;
+    if(model->selected < model->top) {
+        model->top = model->selected;
+    } else if(model->selected >= model->top + PLAYLIST_VIEW_ROWS) {
+        model->top = model->selected - PLAYLIST_VIEW_ROWS + 1;
+    }
+    // no blank rows at the bottom while there's more above
+    model->top = MIN(model->top, items > PLAYLIST_VIEW_ROWS ? items - PLAYLIST_VIEW_ROWS : 0);
+}
+
+static bool playlist_view_group_starts(JsPlaylistViewModel* model, size_t index) {
+    const char* group = playlist_get_group(model->playlist, index);
+    if(!group[0]) return false;
+    return index == 0 || strcmp(group, playlist_get_group(model->playlist, index - 1)) != 0;
+}
+
+static void playlist_view_draw_callback(Canvas* canvas, void* _model) {
+    JsPlaylistViewModel* model = _model;
+    size_t count = playlist_count(model->playlist);
+    size_t items = count + 1;
+
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontPrimary);
+    canvas_draw_str(canvas, 4, PLAYLIST_VIEW_HEADER_H - 3, "Playlist");
+    canvas_set_font(canvas, FontSecondary);
+
+    for(size_t row = 0; row < PLAYLIST_VIEW_ROWS && model->top + row < items; row++) {
+        size_t index = model->top + row;
+        int32_t y = PLAYLIST_VIEW_HEADER_H + row * PLAYLIST_VIEW_ROW_H;
+        int32_t baseline = y + PLAYLIST_VIEW_ROW_H - 3;
+        bool selected = index == model->selected;
+        Color fg = selected ? ColorWhite : ColorBlack;
+
+        if(selected) canvas_draw_box(canvas, 0, y, PLAYLIST_VIEW_WIDTH, PLAYLIST_VIEW_ROW_H);
+        canvas_set_color(canvas, fg);
+        canvas_draw_str(
+            canvas, 4, baseline, index < count ? playlist_get_name(model->playlist, index) : "+ Add Script");
+
+        if(index < count && playlist_view_group_starts(model, index)) {
+            // tag over the end of the name, inverted against the row
+            const char* group = playlist_get_group(model->playlist, index);
+            size_t tag_w = canvas_string_width(canvas, group) + 4;
+            int32_t tag_x = PLAYLIST_VIEW_WIDTH - 1 - tag_w;
+            canvas_draw_rbox(canvas, tag_x, y + 1, tag_w, PLAYLIST_VIEW_ROW_H - 2, 2);
+            canvas_set_color(canvas, selected ? ColorBlack : ColorWhite);
+            canvas_draw_str(canvas, tag_x + 2, baseline, group);
+        }
+        canvas_set_color(canvas, ColorBlack);
+    }
+
+    elements_scrollbar(canvas, model->selected, items);
+}
+
+static bool playlist_view_input_callback(InputEvent* event, void* context) {
+    JsPlaylistView* playlist_view = context;
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) return false;
+
+    bool consumed = true;
+    bool notify = false;
+    JsPlaylistViewEvent notify_event = JsPlaylistViewEventSelected;
+    size_t notify_index = 0;
+    with_view_model(
+        playlist_view->view,
+        JsPlaylistViewModel * model,
+        {
+            size_t items = playlist_view_items(model);
+            size_t count = items - 1;
+            if(event->key == InputKeyUp) {
+                model->selected = model->selected ? model->selected - 1 : items - 1;
+            } else if(event->key == InputKeyDown) {
+                model->selected = model->selected + 1 < items ? model->selected + 1 : 0;
+            } else if(event->key == InputKeyOk && event->type == InputTypeShort) {
+                notify = true;
+                notify_event = model->selected < count ? JsPlaylistViewEventSelected :
+                                                         JsPlaylistViewEventAdd;
+                notify_index = model->selected;
+            } else if(
+                (event->key == InputKeyLeft && model->selected > 0 && model->selected < count) ||
+                (event->key == InputKeyRight && model->selected + 1 < count)) {
+                size_t to = event->key == InputKeyLeft ? model->selected - 1 : model->selected + 1;
+                playlist_move(model->playlist, model->selected, to);
+                model->selected = to;
+                notify = true;
+                notify_event = JsPlaylistViewEventMoved;
+                notify_index = to;
+            } else {
+                consumed = event->key == InputKeyLeft || event->key == InputKeyRight;
+            }
+            playlist_view_scroll(model);
+        },
+        consumed);
+
+    // outside of the model lock, the callback may change the playlist
+    if(notify && playlist_view->callback) {
+        playlist_view->callback(notify_event, notify_index, playlist_view->context);
+    }
+    return consumed;
+}
+
+static uint32_t playlist_view_previous_callback(void* context) {
+    JsPlaylistView* playlist_view = context;
+    return playlist_view->previous_callback ?
+               playlist_view->previous_callback(playlist_view->previous_context) :
+               VIEW_NONE;
+}
+
+int32_t playlist_view_add(JsPlaylistView* playlist_view, const char* path, const char* group) {
+    int32_t index = -1;
+    with_view_model(
+        playlist_view->view,
+        JsPlaylistViewModel * model,
+        {
+            index = playlist_add(model->playlist, path, group);
+            if(index >= 0) model->selected = index;
+            playlist_view_scroll(model);
+        },
+        true);
+    return index;
+}
+
+void playlist_view_remove(JsPlaylistView* playlist_view, size_t index) {
+    with_view_model(
+        playlist_view->view,
+        JsPlaylistViewModel * model,
+        {
+            playlist_remove(model->playlist, index);
+            if(model->selected > index) model->selected--;
+            playlist_view_scroll(model);
+        },
+        true);
+}
+
+JsPlaylistView* playlist_view_alloc(Playlist* playlist) {
+    JsPlaylistView* playlist_view = malloc(sizeof(JsPlaylistView));
+    playlist_view->view = view_alloc();
+    playlist_view->callback = NULL;
+    playlist_view->context = NULL;
+    playlist_view->previous_callback = NULL;
+    playlist_view->previous_context = NULL;
+    view_set_context(playlist_view->view, playlist_view);
+    view_set_draw_callback(playlist_view->view, playlist_view_draw_callback);
+    view_set_input_callback(playlist_view->view, playlist_view_input_callback);
+    view_set_previous_callback(playlist_view->view, playlist_view_previous_callback);
+    view_allocate_model(playlist_view->view, ViewModelTypeLocking, sizeof(JsPlaylistViewModel));
+
+    with_view_model(
+        playlist_view->view,
+        JsPlaylistViewModel * model,
+        {
+            model->playlist = playlist;
+            model->selected = model->top = 0;
+        },
+        true);
+    return playlist_view;
+}
+
+void playlist_view_free(JsPlaylistView* playlist_view) {
+    view_free(playlist_view->view);
+    free(playlist_view);
+}
+
+View* playlist_view_get_view(JsPlaylistView* playlist_view) {
+    return playlist_view->view;
+}
+
+void playlist_view_set_callback(
+    JsPlaylistView* playlist_view,
+    JsPlaylistViewCallback callback,
+    void* context) {
+    playlist_view->callback = callback;
+    playlist_view->context = context;
+}
+
+void playlist_view_set_previous_callback(
+    JsPlaylistView* playlist_view,
+    ViewNavigationCallback callback,
+    void* context) {
+    playlist_view->previous_callback = callback;
+    playlist_view->previous_context = context;
+}
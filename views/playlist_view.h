@@ -0,0 +1,54 @@
+#pragma once
+
+#include <gui/view.h>
+#include "../playlist.h"
+
+typedef struct JsPlaylistView JsPlaylistView;
+
+typedef enum {
+    JsPlaylistViewEventSelected, //<! OK on an entry
+    JsPlaylistViewEventAdd, //<! OK on the "Add Script" item after the entries
+    JsPlaylistViewEventMoved, //<! An entry was moved with Left/Right
+} JsPlaylistViewEvent;
+
+typedef void (*JsPlaylistViewCallback)(JsPlaylistViewEvent event, size_t index, void* context);
+
+/**
+ * @brief Allocates a list of the entries of a playlist
+ *
+ * Rows are drawn straight from the names that the playlist keeps, and only
+ * the ones on screen, so neither drawing nor changing an entry depends on
+ * the size of the playlist. The first entry of each group is tagged with the
+ * group name. Change the playlist through this view while it's allocated,
+ * since it's drawn from the GUI thread.
+ */
+JsPlaylistView* playlist_view_alloc(Playlist* playlist);
+
+void playlist_view_free(JsPlaylistView* playlist_view);
+
+View* playlist_view_get_view(JsPlaylistView* playlist_view);
+
+void playlist_view_set_callback(
+    JsPlaylistView* playlist_view,
+    JsPlaylistViewCallback callback,
+    void* context);
+
+/**
+ * @brief Sets the navigation callback of the view. The view's own context is
+ * the list, so use this instead of `view_set_previous_callback`.
+ */
+void playlist_view_set_previous_callback(
+    JsPlaylistView* playlist_view,
+    ViewNavigationCallback callback,
+    void* context);
+
+/**
+ * @brief Appends a script to the playlist and selects it
+ * @returns index of the entry, or -1 if the playlist is full
+ */
+int32_t playlist_view_add(JsPlaylistView* playlist_view, const char* path, const char* group);
+
+/**
+ * @brief Removes an entry from the playlist, keeping the selection in place
+ */
+void playlist_view_remove(JsPlaylistView* playlist_view, size_t index);